@@ -0,0 +1,188 @@
+#include "batch_convolution.h"
+#include "buffer_pool.h"
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * A batch seen as planes of rows that are convolved independently: one plane per channel of a planar image, or one plane
+ * per interleaved image, whose rows cover every channel.  The planes are back to back, so plane p starts at element
+ * p * height * rowLength.
+ */
+typedef struct batchPlanes {
+	unsigned int numPlanes;
+	unsigned int height;
+	unsigned int rowLength;	// floats per row of a plane
+	unsigned int tapStride;	// floats between neighbouring taps of an element: 1, or the number of channels of an interleaved row
+} tBatchPlanes;
+
+/**
+ * Checks the buffers of a batch once, for all of its images, and describes it as planes
+ */
+static bool batchPlanesValid(ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, const std::vector<float>& results, tBatchPlanes& planes) {
+	const std::size_t batchSize = static_cast<std::size_t>(numImages) * height * width * numChannels;
+	if ((images.size() < batchSize) || (results.size() < batchSize)) {
+		return false;
+	}
+
+	if (layout == ImageLayout::Planar) {
+		planes = tBatchPlanes{ numImages * numChannels, height, width, 1 };
+	}
+	else {
+		planes = tBatchPlanes{ numImages, height, width * numChannels, numChannels };
+	}
+
+	return true;
+}
+
+/**
+ * Runs \p convolvePlanes for chunks of consecutive planes on \p pool.  About 4 chunks per thread, like the row bands of the
+ * *Parallel functions, so work stealing can even out the load.
+ *
+ * @return  true if every chunk succeeded
+ */
+static bool runPlanes(unsigned int numPlanes, ThreadPool& pool, const std::function<bool(unsigned int, unsigned int)>& convolvePlanes) {
+	const unsigned int chunks = std::max(1U, std::min(numPlanes, 4 * pool.size()));
+
+	std::atomic<bool> succeeded(true);
+	pool.parallelFor(chunks, [&](unsigned int chunk) {
+		const unsigned int planeBegin = static_cast<unsigned int>(static_cast<unsigned long long>(numPlanes) * chunk / chunks);
+		const unsigned int planeEnd = static_cast<unsigned int>(static_cast<unsigned long long>(numPlanes) * (chunk + 1) / chunks);
+
+		if (!convolvePlanes(planeBegin, planeEnd)) {
+			succeeded = false;
+		}
+	});
+
+	return succeeded;
+}
+
+/**
+ * Convolves the interior elements of \p numRows consecutive rows of \p planes horizontally
+ */
+static void convolveRowsHorizontal(const float* kernel, unsigned int kernelSize, const tBatchPlanes& planes, const float* src, unsigned int numRows, float* dst, convolveRowAllChannelsFn convolveRow) {
+	const unsigned int interiorStart = (kernelSize / 2) * planes.tapStride;
+	const unsigned int interiorLength = planes.rowLength - 2 * interiorStart;
+
+	for (unsigned int row = 0; row < numRows; row++) {
+		const std::size_t rowStart = static_cast<std::size_t>(row) * planes.rowLength;
+		convolveRow(kernel, kernelSize, src + rowStart, planes.tapStride, dst + rowStart + interiorStart, interiorLength);
+	}
+}
+
+/**
+ * Convolves \p count elements of the interior rows of a plane vertically.  \p src and \p dst point at the first element of
+ * row 0 to convolve.
+ */
+static void convolvePlaneVertical(const float* kernel, unsigned int kernelSize, const tBatchPlanes& planes, const float* src, float* dst, unsigned int count, std::vector<const float*>& rows, convolveRowVerticalFn convolveRow) {
+	const unsigned int center = kernelSize / 2;
+
+	for (unsigned int row = center; row < planes.height - center; row++) {
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			rows[kernelIndex] = src + static_cast<std::size_t>(row - center + kernelIndex) * planes.rowLength;
+		}
+
+		convolveRow(kernel, kernelSize, rows.data(), 1, dst + static_cast<std::size_t>(row) * planes.rowLength, count);
+	}
+}
+
+bool convolve1DHorizontalBatch(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	tBatchPlanes planes;
+	if (!batchPlanesValid(layout, images, numImages, height, width, numChannels, results, planes)) {
+		return false;
+	}
+
+	// no pixel of a row this narrow has a full neighbourhood
+	if (width < kernelSize) {
+		return true;
+	}
+
+	const convolveRowAllChannelsFn convolveRow = getSimdKernels(level).convolveRowHorizontalAllChannels;
+	const std::size_t planeSize = static_cast<std::size_t>(planes.height) * planes.rowLength;
+
+	// the rows of consecutive planes are consecutive too, so a chunk of planes is a single run of rows
+	return runPlanes(planes.numPlanes, pool, [&](unsigned int planeBegin, unsigned int planeEnd) {
+		convolveRowsHorizontal(kernel, kernelSize, planes, images.data() + planeBegin * planeSize, (planeEnd - planeBegin) * planes.height, results.data() + planeBegin * planeSize, convolveRow);
+		return true;
+	});
+}
+
+bool convolve1DVerticalBatch(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	tBatchPlanes planes;
+	if (!batchPlanesValid(layout, images, numImages, height, width, numChannels, results, planes)) {
+		return false;
+	}
+
+	// no pixel of a column this short has a full neighbourhood
+	if (height < kernelSize) {
+		return true;
+	}
+
+	const convolveRowVerticalFn convolveRow = getSimdKernels(level).convolveRowVertical;
+	const std::size_t planeSize = static_cast<std::size_t>(planes.height) * planes.rowLength;
+
+	return runPlanes(planes.numPlanes, pool, [&](unsigned int planeBegin, unsigned int planeEnd) {
+		std::vector<const float*> rows(kernelSize);
+
+		for (unsigned int plane = planeBegin; plane < planeEnd; plane++) {
+			convolvePlaneVertical(kernel, kernelSize, planes, images.data() + plane * planeSize, results.data() + plane * planeSize, planes.rowLength, rows, convolveRow);
+		}
+
+		return true;
+	});
+}
+
+bool convolve2DSeparableBatch(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if ((horizontalKernelSize % 2 != 1) || (verticalKernelSize % 2 != 1)) {
+		return false;
+	}
+
+	tBatchPlanes planes;
+	if (!batchPlanesValid(layout, images, numImages, height, width, numChannels, results, planes)) {
+		return false;
+	}
+
+	// no pixel has a full neighbourhood under both kernels
+	if ((width < horizontalKernelSize) || (height < verticalKernelSize)) {
+		return true;
+	}
+
+	const tSimdKernels& kernels = getSimdKernels(level);
+	const std::size_t planeSize = static_cast<std::size_t>(planes.height) * planes.rowLength;
+
+	// like convolve2DSeparable, only the interior columns of the intermediate plane are written and read, and only the
+	// interior columns of the interior rows of the result are written
+	const unsigned int interiorStart = (horizontalKernelSize / 2) * planes.tapStride;
+	const unsigned int interiorLength = planes.rowLength - 2 * interiorStart;
+
+	return runPlanes(planes.numPlanes, pool, [&](unsigned int planeBegin, unsigned int planeEnd) {
+		// one plane of intermediate per chunk, reused for every plane of the chunk while it is in the cache
+		const PooledBuffer intermediateBuffer = scratchBufferPool().acquire(planeSize * sizeof(float));
+		float* intermediate = intermediateBuffer.data<float>();
+		if (intermediate == nullptr) {
+			return false;
+		}
+
+		std::vector<const float*> rows(verticalKernelSize);
+
+		for (unsigned int plane = planeBegin; plane < planeEnd; plane++) {
+			convolveRowsHorizontal(horizontalKernel, horizontalKernelSize, planes, images.data() + plane * planeSize, planes.height, intermediate, kernels.convolveRowHorizontalAllChannels);
+			convolvePlaneVertical(verticalKernel, verticalKernelSize, planes, intermediate + interiorStart, results.data() + plane * planeSize + interiorStart, interiorLength, rows, kernels.convolveRowVertical);
+		}
+
+		return true;
+	});
+}
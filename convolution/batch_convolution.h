@@ -0,0 +1,49 @@
+#pragma once
+
+#include "convolution.h"
+#include "thread_pool.h"
+
+#include <vector>
+
+// Convolution of many small images of the same shape, e.g. thumbnails.  The images of a batch are stored back to back in
+// one buffer, each a dense image of height * width * numChannels floats in the layout of the batch, so image i starts at
+// element i * height * width * numChannels.  A batch is validated once, and its images are split into chunks that run on a
+// thread pool, so each chunk pays for a single call and a single dispatch to the SIMD kernels however small its images are.
+
+/**
+ * Performs 1D horizontal convolution on every channel of every image of a batch.  Computes the same pixels as calling
+ * convolve1DHorizontal once per image and channel.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] layout  Layout of the images in \p images and \p results
+ * @param[in] images  \p numImages dense images, back to back
+ * @param[in] numImages  Number of images in the batch
+ * @param[in] height  Height of every image
+ * @param[in] width  Width of every image
+ * @param[in] numChannels  Number of channels of every image
+ * @param[out] results  Out-of-place results, back to back like \p images.  Is expected to have size >= size of \p images.
+ * @param[in] pool  Threads to run the chunks of images on
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false if a kernel is even, a buffer is too small for the batch, or a scratch plane couldn't be allocated
+ */
+bool convolve1DHorizontalBatch(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution on every channel of every image of a batch.  Computes the same pixels as calling
+ * convolve1DVertical once per image and channel.
+ *
+ * See convolve1DHorizontalBatch for the parameters.
+ */
+bool convolve1DVerticalBatch(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Performs a separable 2D convolution on every channel of every image of a batch.  Each channel of a planar image (or each
+ * interleaved image) is convolved horizontally into a scratch image of its size and then vertically into \p results, so for
+ * small images the intermediate image never leaves the cache.  Computes the same pixels as calling convolve2DSeparable once
+ * per image and channel.
+ *
+ * See convolve2DSeparable and convolve1DHorizontalBatch for the parameters.
+ */
+bool convolve2DSeparableBatch(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& images, unsigned int numImages, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& results, ThreadPool& pool, SimdLevel level);
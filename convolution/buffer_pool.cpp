@@ -0,0 +1,179 @@
+#include "buffer_pool.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// smallest size class, and the granularity of every size class
+static const std::size_t pageBytes = 4096;
+
+// buffers at least this large are worth backing with 2 MiB huge pages
+static const std::size_t hugePageBytes = 2 * 1024 * 1024;
+
+PooledBuffer::PooledBuffer()
+	: PooledBuffer(nullptr, nullptr, 0, 0)
+{}
+
+PooledBuffer::PooledBuffer(BufferPool* owner, void* buffer, std::size_t classBytes, std::size_t requestedBytes)
+	: owner(owner), buffer(buffer), classBytes(classBytes), requestedBytes(requestedBytes)
+{}
+
+PooledBuffer::~PooledBuffer() {
+	release();
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other)
+	: PooledBuffer(other.owner, other.buffer, other.classBytes, other.requestedBytes)
+{
+	other.owner = nullptr;
+	other.buffer = nullptr;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) {
+	if (this != &other) {
+		release();
+
+		owner = other.owner;
+		buffer = other.buffer;
+		classBytes = other.classBytes;
+		requestedBytes = other.requestedBytes;
+
+		other.owner = nullptr;
+		other.buffer = nullptr;
+	}
+
+	return *this;
+}
+
+void PooledBuffer::release() {
+	if ((owner != nullptr) && (buffer != nullptr)) {
+		owner->giveBack(buffer, classBytes);
+	}
+
+	owner = nullptr;
+	buffer = nullptr;
+	classBytes = 0;
+	requestedBytes = 0;
+}
+
+BufferPool::BufferPool(bool useHugePages)
+	: useHugePages(useHugePages), allocations(0), cached(0)
+{}
+
+BufferPool::~BufferPool() {
+	trim();
+}
+
+std::size_t BufferPool::sizeClass(std::size_t numBytes) {
+	if (numBytes <= pageBytes) {
+		return pageBytes;
+	}
+
+	// largest power of 2 not above numBytes, split into 4 steps
+	std::size_t powerOf2 = pageBytes;
+	while (powerOf2 <= numBytes / 2) {
+		powerOf2 *= 2;
+	}
+
+	const std::size_t step = powerOf2 / 4;
+	const std::size_t rounded = (numBytes + step - 1) / step * step;
+
+	// the steps of the classes below 4 pages are smaller than a page
+	return (rounded + pageBytes - 1) / pageBytes * pageBytes;
+}
+
+PooledBuffer BufferPool::acquire(std::size_t numBytes) {
+	if (numBytes == 0) {
+		return PooledBuffer();
+	}
+
+	const std::size_t classBytes = sizeClass(numBytes);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto found = freeBuffers.find(classBytes);
+		if ((found != freeBuffers.end()) && !found->second.empty()) {
+			void* buffer = found->second.back();
+			found->second.pop_back();
+			cached -= classBytes;
+			return PooledBuffer(this, buffer, classBytes, numBytes);
+		}
+
+		allocations++;
+	}
+
+	void* buffer = allocate(classBytes);
+	if (buffer == nullptr) {
+		return PooledBuffer();
+	}
+
+	return PooledBuffer(this, buffer, classBytes, numBytes);
+}
+
+void BufferPool::trim() {
+	std::map<std::size_t, std::vector<void*>> released;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		released.swap(freeBuffers);
+		cached = 0;
+	}
+
+	for (const auto& sizeClassBuffers : released) {
+		for (void* buffer : sizeClassBuffers.second) {
+			free(buffer, sizeClassBuffers.first);
+		}
+	}
+}
+
+std::size_t BufferPool::allocationCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return allocations;
+}
+
+std::size_t BufferPool::cachedBytes() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return cached;
+}
+
+void BufferPool::giveBack(void* buffer, std::size_t classBytes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	freeBuffers[classBytes].push_back(buffer);
+	cached += classBytes;
+}
+
+void* BufferPool::allocate(std::size_t classBytes) {
+#if defined(_WIN32)
+	// large pages need the SeLockMemoryPrivilege on Windows, so they are not requested
+	return _aligned_malloc(classBytes, alignment);
+#else
+	// page aligned, so also aligned to the cache line
+	void* buffer = mmap(nullptr, classBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (buffer == MAP_FAILED) {
+		return nullptr;
+	}
+
+#if defined(MADV_HUGEPAGE)
+	if (useHugePages && (classBytes >= hugePageBytes)) {
+		madvise(buffer, classBytes, MADV_HUGEPAGE);
+	}
+#endif
+
+	return buffer;
+#endif
+}
+
+void BufferPool::free(void* buffer, std::size_t classBytes) {
+#if defined(_WIN32)
+	(void)classBytes;
+	_aligned_free(buffer);
+#else
+	munmap(buffer, classBytes);
+#endif
+}
+
+BufferPool& scratchBufferPool() {
+	static BufferPool pool;
+	return pool;
+}
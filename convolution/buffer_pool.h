@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class BufferPool;
+
+/**
+ * Lease of a buffer handed out by a BufferPool.  The buffer goes back to the pool when the lease is destroyed, so the next
+ * acquire of the same size class reuses it instead of asking the OS for fresh (page-faulting) memory.  Move-only.
+ */
+class PooledBuffer {
+public:
+	PooledBuffer();
+	~PooledBuffer();
+
+	PooledBuffer(PooledBuffer&& other);
+	PooledBuffer& operator=(PooledBuffer&& other);
+
+	PooledBuffer(const PooledBuffer&) = delete;
+	PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+	/**
+	 * @return  Start of the buffer, aligned to BufferPool::alignment bytes, or nullptr for an empty lease
+	 */
+	template <typename T>
+	T* data() const {
+		return static_cast<T*>(buffer);
+	}
+
+	/**
+	 * @return  Number of bytes that were requested.  The buffer may be larger (see BufferPool::sizeClass).
+	 */
+	std::size_t size() const {
+		return requestedBytes;
+	}
+
+private:
+	friend class BufferPool;
+
+	PooledBuffer(BufferPool* owner, void* buffer, std::size_t classBytes, std::size_t requestedBytes);
+	void release();
+
+	BufferPool* owner;
+	void* buffer;
+	std::size_t classBytes;
+	std::size_t requestedBytes;
+};
+
+/**
+ * Thread-safe pool of aligned scratch buffers.  Requests are rounded up to a size class, and buffers that are given back are
+ * kept per size class and handed out again, so steady-state calls (e.g. one per video frame) don't allocate, and don't pay
+ * the page faults of touching freshly mapped memory.  Buffers are only returned to the OS by trim() or when the pool is
+ * destroyed.
+ *
+ * The contents of a buffer are unspecified when it is acquired.
+ */
+class BufferPool {
+public:
+	/**
+	 * Bytes every buffer is aligned to
+	 */
+	static const std::size_t alignment = 64;
+
+	/**
+	 * @param[in] useHugePages  If true, ask the OS to back large buffers with huge pages where it supports that (transparent
+	 *                          huge pages on Linux), which cuts page faults and TLB misses on multi-megabyte images.  Ignored
+	 *                          on other platforms.
+	 */
+	explicit BufferPool(bool useHugePages = false);
+	~BufferPool();
+
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	/**
+	 * Hands out a buffer of at least \p numBytes bytes, reusing a cached one of the same size class if there is one
+	 *
+	 * @param[in] numBytes  Number of bytes needed
+	 *
+	 * @return  Lease of the buffer.  An empty lease if \p numBytes is 0 or the allocation failed.
+	 */
+	PooledBuffer acquire(std::size_t numBytes);
+
+	/**
+	 * Returns every cached buffer to the OS.  Buffers that are currently leased are not affected.
+	 */
+	void trim();
+
+	/**
+	 * @return  Number of buffers that were allocated from the OS, i.e. acquires that couldn't reuse a cached buffer
+	 */
+	std::size_t allocationCount() const;
+
+	/**
+	 * @return  Number of bytes in cached (not leased) buffers
+	 */
+	std::size_t cachedBytes() const;
+
+	/**
+	 * Size class a request of \p numBytes is rounded up to: a whole number of pages, and within 25% of \p numBytes for
+	 * requests above a page (4 size classes per power of 2).
+	 */
+	static std::size_t sizeClass(std::size_t numBytes);
+
+private:
+	friend class PooledBuffer;
+
+	void giveBack(void* buffer, std::size_t classBytes);
+
+	void* allocate(std::size_t classBytes);
+	void free(void* buffer, std::size_t classBytes);
+
+	const bool useHugePages;
+
+	mutable std::mutex mutex;
+	std::map<std::size_t, std::vector<void*>> freeBuffers;
+	std::size_t allocations;
+	std::size_t cached;
+};
+
+/**
+ * Process-wide pool the convolution library takes its internal scratch buffers from (e.g. the ring buffer of
+ * convolve2DSeparable and the running sums of the box filters)
+ */
+BufferPool& scratchBufferPool();
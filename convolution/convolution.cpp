@@ -1,29 +1,954 @@
 #include "convolution.h"
+#include "simd_kernels.h"
 
-bool transposePlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst) {
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+/**
+ * The std::vector overloads take a dense image.  Checks that \p image holds all of it and \p result is at least as large.
+ */
+template <typename PixelT>
+static bool denseSizesValid(const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, const std::vector<PixelT>& result) {
 	// size sanity checks
-	if (src.size() > dst.size()) {
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Checks that \p image and \p result are valid views of the same shape, and that \p channelIndex is one of their channels
+ */
+static bool convolutionViewsValid(const ImageView& image, unsigned int channelIndex, const ImageView& result) {
+	if (!isValidImageView(image) || !isValidImageView(result) || !haveSameShape(image, result)) {
+		return false;
+	}
+
+	return channelIndex < image.numChannels;
+}
+
+/**
+ * Checks that \p src and \p dst are valid planar views and that \p dst has the transposed dimensions of \p src
+ */
+static bool transposeViewsValid(const ImageView& src, const ImageView& dst) {
+	if (!isValidImageView(src) || !isValidImageView(dst)) {
+		return false;
+	}
+
+	if ((src.layout != ImageLayout::Planar) || (dst.layout != ImageLayout::Planar)) {
+		return false;
+	}
+
+	return (dst.height == src.width) && (dst.width == src.height) && (dst.numChannels == src.numChannels);
+}
+
+bool transposePlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst) {
+	return transposePlanarTiled(src, height, width, numChannels, dst, getSimdLevel());
+}
+
+bool transposePlanar(const ImageView& src, const MutableImageView& dst) {
+	return transposePlanarTiled(src, dst, getSimdLevel());
+}
+
+bool transposePlanarScalar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst) {
+	if (!denseSizesValid(src, height, width, numChannels, dst)) {
+		return false;
+	}
+
+	return transposePlanarScalar(makeImageView(src, ImageLayout::Planar, height, width, numChannels), makeImageView(dst, ImageLayout::Planar, width, height, numChannels));
+}
+
+bool transposePlanarScalar(const ImageView& src, const MutableImageView& dst) {
+	if (!transposeViewsValid(src, dst)) {
+		return false;
+	}
+
+	for (unsigned int ch = 0; ch < src.numChannels; ch++) {
+		for (unsigned int srcRow = 0; srcRow < src.height; srcRow++) {
+			const float* srcRowStart = src.row(ch, srcRow);
+
+			for (unsigned int srcCol = 0; srcCol < src.width; srcCol++) {
+				dst.row(ch, srcCol)[srcRow] = srcRowStart[srcCol];
+			}
+		}
+	}
+
+	return true;
+}
+
+bool transposePlanarTiled(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level) {
+	if (!denseSizesValid(src, height, width, numChannels, dst)) {
+		return false;
+	}
+
+	return transposePlanarTiled(makeImageView(src, ImageLayout::Planar, height, width, numChannels), makeImageView(dst, ImageLayout::Planar, width, height, numChannels), level);
+}
+
+bool transposePlanarTiled(const ImageView& src, const MutableImageView& dst, SimdLevel level) {
+	if (!transposeViewsValid(src, dst)) {
+		return false;
+	}
+
+	const transposeBlockFn transposeBlock = getSimdKernels(level).transposeBlock;
+
+	const unsigned int height = src.height;
+	const unsigned int width = src.width;
+	const unsigned int srcRowStride = src.rowPitch;
+	const unsigned int dstRowStride = dst.rowPitch;
+
+	for (unsigned int ch = 0; ch < src.numChannels; ch++) {
+		for (unsigned int blockRow = 0; blockRow < height; blockRow += transposeBlockSize) {
+			const unsigned int blockRows = std::min(transposeBlockSize, height - blockRow);
+
+			// a block row of the source, and the block column of the destination it lands in, can be more than 2^32
+			// floats into the channel, so they are addressed through 64-bit row pointers
+			const float* srcBlockRow = src.row(ch, blockRow);
+			float* dstBlockCol = dst.row(ch, 0) + blockRow;
+
+			for (unsigned int blockCol = 0; blockCol < width; blockCol += transposeBlockSize) {
+				const unsigned int blockCols = std::min(transposeBlockSize, width - blockCol);
+
+				transposeBlock(srcBlockRow + blockCol, srcRowStride,
+					dstBlockCol + static_cast<std::size_t>(blockCol) * dstRowStride, dstRowStride,
+					blockRows, blockCols);
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Transposes a square \p size x \p size channel in place.  Swaps each pair of blocks (i, j) and (j, i) across the
+ * diagonal: block (i, j) is transposed into \p scratch, block (j, i) is transposed straight into (i, j), and the scratch
+ * is copied into (j, i).  Blocks on the diagonal are transposed into the scratch and copied back.
+ *
+ * @param[out] scratch  transposeBlockSize * transposeBlockSize floats
+ */
+static void transposeSquareInPlace(float* channel, unsigned int size, float* scratch, transposeBlockFn transposeBlock) {
+	for (unsigned int blockRow = 0; blockRow < size; blockRow += transposeBlockSize) {
+		const unsigned int blockRows = std::min(transposeBlockSize, size - blockRow);
+
+		for (unsigned int blockCol = blockRow; blockCol < size; blockCol += transposeBlockSize) {
+			const unsigned int blockCols = std::min(transposeBlockSize, size - blockCol);
+
+			float* upper = channel + static_cast<std::size_t>(blockRow) * size + blockCol;
+			float* lower = channel + static_cast<std::size_t>(blockCol) * size + blockRow;
+
+			// the scratch holds the transposed upper block: blockCols rows of blockRows floats
+			transposeBlock(upper, size, scratch, transposeBlockSize, blockRows, blockCols);
+			if (blockCol != blockRow) {
+				transposeBlock(lower, size, upper, size, blockCols, blockRows);
+			}
+
+			for (unsigned int row = 0; row < blockCols; row++) {
+				std::copy(scratch + row * transposeBlockSize, scratch + row * transposeBlockSize + blockRows, lower + row * size);
+			}
+		}
+	}
+}
+
+/**
+ * Transposes the contiguous \p rows x \p cols matrix at \p panel in place, through \p scratch (rows * cols floats)
+ */
+static void transposePanelInPlace(float* panel, unsigned int rows, unsigned int cols, float* scratch, transposeBlockFn transposeBlock) {
+	std::copy(panel, panel + static_cast<std::size_t>(rows) * cols, scratch);
+
+	for (unsigned int blockRow = 0; blockRow < rows; blockRow += transposeBlockSize) {
+		const unsigned int blockRows = std::min(transposeBlockSize, rows - blockRow);
+
+		for (unsigned int blockCol = 0; blockCol < cols; blockCol += transposeBlockSize) {
+			const unsigned int blockCols = std::min(transposeBlockSize, cols - blockCol);
+			transposeBlock(scratch + static_cast<std::size_t>(blockRow) * cols + blockCol, cols, panel + static_cast<std::size_t>(blockCol) * rows + blockRow, rows, blockRows, blockCols);
+		}
+	}
+}
+
+/**
+ * Transposes the \p rows x \p cols matrix at \p data in place, whose elements are units of \p unit contiguous floats, by
+ * following the cycles of the permutation.  The unit at index k moves to k * rows mod (rows * cols - 1), so the unit that
+ * ends up at k comes from k * cols mod (rows * cols - 1).  Moving whole units keeps every move a few cache lines long.
+ * The shape must pass unitPermutationFits.
+ *
+ * @param[out] unitScratch  \p unit floats
+ * @param[out] visited  Bitmap of rows * cols bits, which tracks the units already moved
+ */
+static void transposeUnitsInPlace(float* data, unsigned int rows, unsigned int cols, unsigned int unit, float* unitScratch, std::uint8_t* visited) {
+	const std::uint64_t numUnits = static_cast<std::uint64_t>(rows) * cols;
+	if (numUnits < 3) {
+		return;
+	}
+
+	// the first and the last unit stay where they are
+	const std::uint64_t modulus = numUnits - 1;
+	std::fill(visited, visited + (numUnits + 7) / 8, std::uint8_t(0));
+
+	for (std::uint64_t start = 1; start < modulus; start++) {
+		if ((visited[start / 8] & (1U << (start % 8))) != 0) {
+			continue;
+		}
+
+		std::copy(data + start * unit, data + (start + 1) * unit, unitScratch);
+
+		std::uint64_t current = start;
+		for (;;) {
+			visited[current / 8] |= static_cast<std::uint8_t>(1U << (current % 8));
+
+			const std::uint64_t next = current * cols % modulus;
+			if (next == start) {
+				std::copy(unitScratch, unitScratch + unit, data + current * unit);
+				break;
+			}
+
+			std::copy(data + next * unit, data + (next + 1) * unit, data + current * unit);
+			current = next;
+		}
+	}
+}
+
+/**
+ * @return  true if the index products of transposeUnitsInPlace on a \p rows x \p cols matrix of units fit in 64 bits
+ */
+static bool unitPermutationFits(unsigned int rows, unsigned int cols) {
+	const std::uint64_t numUnits = static_cast<std::uint64_t>(rows) * cols;
+	return (numUnits < 3) || (numUnits - 1 <= std::numeric_limits<std::uint64_t>::max() / cols);
+}
+
+/**
+ * @return  The largest divisor of \p value that is at most transposeBlockSize
+ */
+static unsigned int largestBlockDivisor(unsigned int value) {
+	for (unsigned int divisor = std::min(transposeBlockSize, value); divisor > 1; divisor--) {
+		if (value % divisor == 0) {
+			return divisor;
+		}
+	}
+
+	return 1;
+}
+
+bool transposePlanarInPlace(std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, SimdLevel level) {
+	const std::size_t channelSize = static_cast<std::size_t>(height) * width;
+	if (channelSize * numChannels > image.size()) {
 		return false;
 	}
 
-	if (height * width * numChannels > src.size()) {
+	// a single row or column is its own transpose in memory
+	if ((height <= 1) || (width <= 1)) {
+		return true;
+	}
+
+	const transposeBlockFn transposeBlock = getSimdKernels(level).transposeBlock;
+	BufferPool& buffers = scratchBufferPool();
+
+	if (height == width) {
+		const PooledBuffer scratch = buffers.acquire(transposeBlockSize * transposeBlockSize * sizeof(float));
+		if (scratch.data<float>() == nullptr) {
+			return false;
+		}
+
+		for (unsigned int ch = 0; ch < numChannels; ch++) {
+			transposeSquareInPlace(image.data() + ch * channelSize, height, scratch.data<float>(), transposeBlock);
+		}
+
+		return true;
+	}
+
+	// A panel of rowsPerPanel full rows is transposed in place into rowsPerPanel-float units, one per column, and then the
+	// (height / rowsPerPanel) x width matrix of units is transposed.  Or, with the roles swapped, the height x (width /
+	// colsPerPanel) matrix of colsPerPanel-float units is transposed first, which leaves panels of height x colsPerPanel
+	// floats that are transposed in place.  Whichever dimension has the larger divisor gives the larger units.
+	const unsigned int rowsPerPanel = largestBlockDivisor(height);
+	const unsigned int colsPerPanel = largestBlockDivisor(width);
+	const bool panelsFirst = rowsPerPanel >= colsPerPanel;
+	const unsigned int unit = panelsFirst ? rowsPerPanel : colsPerPanel;
+	const std::size_t panelSize = static_cast<std::size_t>(panelsFirst ? width : height) * unit;
+
+	const unsigned int unitRows = panelsFirst ? height / unit : height;
+	const unsigned int unitCols = panelsFirst ? width : width / unit;
+	if (!unitPermutationFits(unitRows, unitCols)) {
 		return false;
 	}
 
-	const unsigned int srcRowStride = width;
-	const unsigned int dstRowStride = height;
+	const PooledBuffer panelScratch = buffers.acquire(panelSize * sizeof(float));
+	const PooledBuffer unitScratch = buffers.acquire(unit * sizeof(float));
+	const PooledBuffer visited = buffers.acquire(static_cast<std::size_t>((static_cast<std::uint64_t>(unitRows) * unitCols + 7) / 8));
+	if ((panelScratch.data<float>() == nullptr) || (unitScratch.data<float>() == nullptr) || (visited.data<std::uint8_t>() == nullptr)) {
+		return false;
+	}
 
 	for (unsigned int ch = 0; ch < numChannels; ch++) {
-		const unsigned int chStart = ch * height * width;
+		float* channel = image.data() + ch * channelSize;
+
+		if (panelsFirst) {
+			for (unsigned int panel = 0; panel < height / unit; panel++) {
+				transposePanelInPlace(channel + panel * panelSize, unit, width, panelScratch.data<float>(), transposeBlock);
+			}
+
+			transposeUnitsInPlace(channel, unitRows, unitCols, unit, unitScratch.data<float>(), visited.data<std::uint8_t>());
+		}
+		else {
+			transposeUnitsInPlace(channel, unitRows, unitCols, unit, unitScratch.data<float>(), visited.data<std::uint8_t>());
+
+			for (unsigned int panel = 0; panel < width / unit; panel++) {
+				transposePanelInPlace(channel + panel * panelSize, height, unit, panelScratch.data<float>(), transposeBlock);
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Checks that \p src and \p dst are valid views of the same dimensions and number of channels, \p src in \p srcLayout and
+ * \p dst in the other layout, and that [\p rowBegin, \p rowEnd) are rows of them
+ */
+static bool layoutConversionViewsValid(const ImageView& src, ImageLayout srcLayout, unsigned int rowBegin, unsigned int rowEnd, const ImageView& dst) {
+	if (!isValidImageView(src) || !isValidImageView(dst)) {
+		return false;
+	}
+
+	if ((src.layout != srcLayout) || (dst.layout == srcLayout)) {
+		return false;
+	}
+
+	if ((dst.height != src.height) || (dst.width != src.width) || (dst.numChannels != src.numChannels)) {
+		return false;
+	}
+
+	return (rowBegin <= rowEnd) && (rowEnd <= src.height);
+}
+
+bool interleavedToPlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level) {
+	if (!denseSizesValid(src, height, width, numChannels, dst)) {
+		return false;
+	}
+
+	return interleavedToPlanar(makeImageView(src, ImageLayout::Interleaved, height, width, numChannels), makeImageView(dst, ImageLayout::Planar, height, width, numChannels), level);
+}
+
+bool interleavedToPlanar(const ImageView& src, const MutableImageView& dst, SimdLevel level) {
+	return interleavedToPlanarRows(src, 0, src.height, dst, level);
+}
+
+bool interleavedToPlanarRows(const ImageView& src, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& dst, SimdLevel level) {
+	if (!layoutConversionViewsValid(src, ImageLayout::Interleaved, rowBegin, rowEnd, dst)) {
+		return false;
+	}
+
+	const deinterleaveRowFn deinterleaveRow = getSimdKernels(level).deinterleaveRow;
+
+	std::vector<float*> dstRows(src.numChannels);
+	for (unsigned int row = rowBegin; row < rowEnd; row++) {
+		for (unsigned int ch = 0; ch < src.numChannels; ch++) {
+			dstRows[ch] = dst.row(ch, row);
+		}
+
+		deinterleaveRow(src.row(0, row), src.numChannels, dstRows.data(), src.width);
+	}
+
+	return true;
+}
+
+bool planarToInterleaved(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level) {
+	if (!denseSizesValid(src, height, width, numChannels, dst)) {
+		return false;
+	}
+
+	return planarToInterleaved(makeImageView(src, ImageLayout::Planar, height, width, numChannels), makeImageView(dst, ImageLayout::Interleaved, height, width, numChannels), level);
+}
+
+bool planarToInterleaved(const ImageView& src, const MutableImageView& dst, SimdLevel level) {
+	return planarToInterleavedRows(src, 0, src.height, dst, level);
+}
+
+bool planarToInterleavedRows(const ImageView& src, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& dst, SimdLevel level) {
+	if (!layoutConversionViewsValid(src, ImageLayout::Planar, rowBegin, rowEnd, dst)) {
+		return false;
+	}
+
+	const interleaveRowFn interleaveRow = getSimdKernels(level).interleaveRow;
+
+	std::vector<const float*> srcRows(src.numChannels);
+	for (unsigned int row = rowBegin; row < rowEnd; row++) {
+		for (unsigned int ch = 0; ch < src.numChannels; ch++) {
+			srcRows[ch] = src.row(ch, row);
+		}
+
+		interleaveRow(srcRows.data(), src.numChannels, dst.row(0, row), src.width);
+	}
+
+	return true;
+}
+
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	return convolve1DHorizontalRows(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, 0, height, result, level);
+}
+
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	return convolve1DHorizontalRows(kernel, kernelSize, image, channelIndex, 0, image.height, result, level);
+}
+
+bool convolve1DHorizontalRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DHorizontalRows(kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, rowBegin, rowEnd, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve1DHorizontalRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!convolutionViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	// no pixel of a row this narrow has a full neighbourhood
+	if (image.width < kernelSize) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const convolveRowFn convolveRow = getSimdKernels(level).convolveRowHorizontal;
+
+	// planar: the channel is contiguous, pixels are adjacent.  interleaved: pixels of the channel are numChannels apart.
+	const unsigned int pxStride = image.pixelStride();
+
+	for (unsigned int row = rowBegin; row < std::min(rowEnd, image.height); row++) {
+		// convolve all pixels in the interior of the image, ignoring the edge pixels
+		convolveRow(kernel, kernelSize, image.row(channelIndex, row), pxStride, result.row(channelIndex, row) + center * pxStride, image.width - 2 * center);
+	}
+
+	return true;
+}
+
+/**
+ * Rows and columns of the tile convolve1DHorizontalTransposed convolves before transposing it.  The 256 KiB tile stays in
+ * L2 between the convolution and the transpose, and every row of the result gets 128 consecutive floats (8 whole cache
+ * lines) per tile, so few of its cache lines are left partially written to be read back and completed by a later tile.
+ */
+static const unsigned int convolveTransposedTileHeight = 4 * transposeBlockSize;
+static const unsigned int convolveTransposedTileWidth = 512;
+
+bool convolve1DHorizontalTransposed(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DHorizontalTransposed(kernel, kernelSize, makeImageView(image, ImageLayout::Planar, height, width, numChannels), channelIndex, makeImageView(result, ImageLayout::Planar, width, height, numChannels), level);
+}
+
+bool convolve1DHorizontalTransposed(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!transposeViewsValid(image, result) || (channelIndex >= image.numChannels)) {
+		return false;
+	}
 
-		for (unsigned int srcRow = 0; srcRow < height; srcRow++) {
-			const unsigned int srcRowStart = chStart + srcRow * srcRowStride;
+	// no pixel of a row this narrow has a full neighbourhood
+	if (image.width < kernelSize) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int interiorWidth = image.width - 2 * center;
+	const tSimdKernels& kernels = getSimdKernels(level);
+
+	const PooledBuffer tileBuffer = scratchBufferPool().acquire(convolveTransposedTileHeight * convolveTransposedTileWidth * sizeof(float));
+	float* tile = tileBuffer.data<float>();
+	if (tile == nullptr) {
+		return false;
+	}
+
+	for (unsigned int tileRowBegin = 0; tileRowBegin < image.height; tileRowBegin += convolveTransposedTileHeight) {
+		const unsigned int tileRows = std::min(convolveTransposedTileHeight, image.height - tileRowBegin);
 
-			for (unsigned int srcCol = 0; srcCol < width; srcCol++) {
-				dst[chStart + srcCol * dstRowStride + srcRow] = src[srcRowStart + srcCol];
+		for (unsigned int col = 0; col < interiorWidth; col += convolveTransposedTileWidth) {
+			const unsigned int tileCols = std::min(convolveTransposedTileWidth, interiorWidth - col);
+
+			for (unsigned int tileRow = 0; tileRow < tileRows; tileRow++) {
+				kernels.convolveRowHorizontal(kernel, kernelSize, image.row(channelIndex, tileRowBegin + tileRow) + col, 1, tile + tileRow * convolveTransposedTileWidth, tileCols);
+			}
+
+			// output pixel center + col of each row is the first element of the tile row, and lands in row center + col.  The
+			// tile is transposed a block of columns at a time, so only transposeBlockSize result rows are written at once.
+			for (unsigned int blockCol = 0; blockCol < tileCols; blockCol += transposeBlockSize) {
+				const unsigned int blockCols = std::min(transposeBlockSize, tileCols - blockCol);
+				kernels.transposeBlock(tile + blockCol, convolveTransposedTileWidth, result.row(channelIndex, center + col + blockCol) + tileRowBegin, result.rowPitch, tileRows, blockCols);
 			}
 		}
 	}
 
 	return true;
-}
\ No newline at end of file
+}
+
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	return convolve1DVerticalRows(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, 0, height, result, level);
+}
+
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	return convolve1DVerticalRows(kernel, kernelSize, image, channelIndex, 0, image.height, result, level);
+}
+
+bool convolve1DVerticalRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DVerticalRows(kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, rowBegin, rowEnd, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve1DVerticalRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!convolutionViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	const unsigned int height = image.height;
+
+	// no pixel of a column this short has a full neighbourhood
+	if (height < kernelSize) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const convolveRowVerticalFn convolveRow = getSimdKernels(level).convolveRowVertical;
+
+	std::vector<const float*> rows(kernelSize);
+
+	// convolve all rows in the interior of the image, ignoring the edge rows.  Each output row reads the kernelSize input
+	// rows centered on it, so a band of output rows reads center rows of halo above and below the band.
+	for (unsigned int row = std::max(rowBegin, center); row < std::min(rowEnd, height - center); row++) {
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			rows[kernelIndex] = image.row(channelIndex, row - center + kernelIndex);
+		}
+
+		convolveRow(kernel, kernelSize, rows.data(), image.pixelStride(), result.row(channelIndex, row), image.width);
+	}
+
+	return true;
+}
+
+/**
+ * Rows of a dense half precision image, and the float scratch its rows are widened into.  A row of the image holds width
+ * pixels of the channel (planar) or width pixels of all channels (interleaved); the float rows have the same layout, so the
+ * float row kernels run on them with the pixel stride of the image.
+ */
+typedef struct halfRows {
+	std::size_t channelStart;	// offset of the channel's first row in the image
+	std::size_t rowStride;		// values per row of the image
+	unsigned int pxStride;		// values between neighbouring pixels of the channel
+	unsigned int channelOffset;	// offset of the channel's first pixel within a row
+} tHalfRows;
+
+static tHalfRows halfRowsOf(ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex) {
+	if (layout == ImageLayout::Planar) {
+		return tHalfRows{ static_cast<std::size_t>(height) * width * channelIndex, width, 1, 0 };
+	}
+
+	return tHalfRows{ 0, static_cast<std::size_t>(width) * numChannels, numChannels, channelIndex };
+}
+
+/**
+ * Rounds \p count pixels, \p pxStride apart in \p src, to half precision and stores them \p pxStride apart in \p dst.
+ * Strided pixels are gathered into \p packed and converted into \p packedHalves first, so the conversion runs on whole rows.
+ */
+static void storeHalfPixels(const float* src, unsigned int pxStride, unsigned int count, tHalf* dst, float* packed, tHalf* packedHalves, convertFloatToHalfFn convertFloatToHalf) {
+	if (pxStride == 1) {
+		convertFloatToHalf(src, dst, count);
+		return;
+	}
+
+	for (unsigned int x = 0; x < count; x++) {
+		packed[x] = src[x * pxStride];
+	}
+
+	convertFloatToHalf(packed, packedHalves, count);
+
+	for (unsigned int x = 0; x < count; x++) {
+		dst[x * pxStride] = packedHalves[x];
+	}
+}
+
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<tHalf>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<tHalf>& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if ((channelIndex >= numChannels) || !denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	// no pixel of a row this narrow has a full neighbourhood
+	if (width < kernelSize) {
+		return true;
+	}
+
+	const tSimdKernels& kernels = getSimdKernels(level);
+	const tHalfRows rows = halfRowsOf(layout, height, width, numChannels, channelIndex);
+	const unsigned int center = kernelSize / 2;
+	const unsigned int interiorWidth = width - 2 * center;
+
+	// a widened input row, the convolved row, and the packed interior pixels for strided rows
+	const PooledBuffer floatBuffer = scratchBufferPool().acquire((2 * rows.rowStride + interiorWidth) * sizeof(float));
+	const PooledBuffer halfBuffer = scratchBufferPool().acquire(interiorWidth * sizeof(tHalf));
+	float* src = floatBuffer.data<float>();
+	tHalf* packedHalves = halfBuffer.data<tHalf>();
+	if ((src == nullptr) || (packedHalves == nullptr)) {
+		return false;
+	}
+
+	float* dst = src + rows.rowStride;
+	float* packed = dst + rows.rowStride;
+
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = rows.channelStart + row * rows.rowStride;
+		kernels.convertHalfToFloat(image.data() + rowStart, src, static_cast<unsigned int>(rows.rowStride));
+
+		const std::size_t interiorStart = rows.channelOffset + static_cast<std::size_t>(center) * rows.pxStride;
+		kernels.convolveRowHorizontal(kernel, kernelSize, src + rows.channelOffset, rows.pxStride, dst + interiorStart, interiorWidth);
+		storeHalfPixels(dst + interiorStart, rows.pxStride, interiorWidth, result.data() + rowStart + interiorStart, packed, packedHalves, kernels.convertFloatToHalf);
+	}
+
+	return true;
+}
+
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<tHalf>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<tHalf>& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if ((channelIndex >= numChannels) || !denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	// no pixel of a column this short has a full neighbourhood
+	if ((height < kernelSize) || (width == 0)) {
+		return true;
+	}
+
+	const tSimdKernels& kernels = getSimdKernels(level);
+	const tHalfRows rows = halfRowsOf(layout, height, width, numChannels, channelIndex);
+	const unsigned int center = kernelSize / 2;
+
+	// the last kernelSize widened input rows (input row r lives in slot r % kernelSize), the convolved row, and the packed
+	// pixels for strided rows
+	const PooledBuffer floatBuffer = scratchBufferPool().acquire(((kernelSize + 1) * rows.rowStride + width) * sizeof(float));
+	const PooledBuffer halfBuffer = scratchBufferPool().acquire(width * sizeof(tHalf));
+	float* ring = floatBuffer.data<float>();
+	tHalf* packedHalves = halfBuffer.data<tHalf>();
+	if ((ring == nullptr) || (packedHalves == nullptr)) {
+		return false;
+	}
+
+	float* dst = ring + kernelSize * rows.rowStride;
+	float* packed = dst + rows.rowStride;
+	std::vector<const float*> ringRows(kernelSize);
+
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = rows.channelStart + row * rows.rowStride;
+		kernels.convertHalfToFloat(image.data() + rowStart, ring + (row % kernelSize) * rows.rowStride, static_cast<unsigned int>(rows.rowStride));
+
+		// input row r completes the window of output row r - center
+		if (row + 1 < kernelSize) {
+			continue;
+		}
+
+		const unsigned int outputRow = row - center;
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			ringRows[kernelIndex] = ring + ((outputRow - center + kernelIndex) % kernelSize) * rows.rowStride + rows.channelOffset;
+		}
+
+		kernels.convolveRowVertical(kernel, kernelSize, ringRows.data(), rows.pxStride, dst + rows.channelOffset, width);
+		storeHalfPixels(dst + rows.channelOffset, rows.pxStride, width, result.data() + rows.channelStart + outputRow * rows.rowStride + rows.channelOffset, packed, packedHalves, kernels.convertFloatToHalf);
+	}
+
+	return true;
+}
+
+bool convolve2DSeparable(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	return convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, layout, image, height, width, numChannels, channelIndex, 0, height, result, level);
+}
+
+bool convolve2DSeparable(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	return convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, image, channelIndex, 0, image.height, result, level);
+}
+
+bool convolve2DSeparableRows(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, rowBegin, rowEnd, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve2DSeparableRows(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if ((horizontalKernelSize % 2 != 1) || (verticalKernelSize % 2 != 1)) {
+		return false;
+	}
+
+	if (!convolutionViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	const unsigned int height = image.height;
+	const unsigned int width = image.width;
+
+	// no pixel has a full neighbourhood under both kernels
+	if ((width < horizontalKernelSize) || (height < verticalKernelSize)) {
+		return true;
+	}
+
+	const unsigned int horizontalCenter = horizontalKernelSize / 2;
+	const unsigned int verticalCenter = verticalKernelSize / 2;
+
+	// output rows to produce, and the input rows they need: verticalCenter rows of halo above and below
+	const unsigned int outputBegin = std::max(rowBegin, verticalCenter);
+	const unsigned int outputEnd = std::min(rowEnd, height - verticalCenter);
+	if (outputBegin >= outputEnd) {
+		return true;
+	}
+
+	const unsigned int inputBegin = outputBegin - verticalCenter;
+	const unsigned int inputEnd = outputEnd + verticalCenter;
+
+	const tSimdKernels& kernels = getSimdKernels(level);
+
+	const unsigned int pxStride = image.pixelStride();
+	const unsigned int rowStride = pxStride * width;
+
+	// the last verticalKernelSize horizontally convolved rows.  Input row r lives in slot r % verticalKernelSize.  Only the
+	// interior columns of a slot are ever written or read, so the pooled buffer needs no initialization.
+	const PooledBuffer ringBuffer = scratchBufferPool().acquire(static_cast<std::size_t>(verticalKernelSize) * rowStride * sizeof(float));
+	float* ring = ringBuffer.data<float>();
+	if (ring == nullptr) {
+		return false;
+	}
+
+	std::vector<const float*> rows(verticalKernelSize);
+
+	const unsigned int interiorWidth = width - 2 * horizontalCenter;
+
+	// the ring rows keep the pixel stride of the image, so interleaved channels sit at the same offset within a slot
+	const unsigned int slotStart = (image.layout == ImageLayout::Planar ? 0 : channelIndex) + horizontalCenter * pxStride;
+
+	for (unsigned int row = inputBegin; row < inputEnd; row++) {
+		float* slot = ring + static_cast<std::size_t>(row % verticalKernelSize) * rowStride;
+
+		kernels.convolveRowHorizontal(horizontalKernel, horizontalKernelSize, image.row(channelIndex, row), pxStride, slot + slotStart, interiorWidth);
+
+		if (row + 1 < inputBegin + verticalKernelSize) {
+			continue;
+		}
+
+		// the rows under the vertical kernel for output row (row - verticalCenter) are all in the ring now
+		const unsigned int firstRow = row + 1 - verticalKernelSize;
+		for (unsigned int kernelIndex = 0; kernelIndex < verticalKernelSize; kernelIndex++) {
+			rows[kernelIndex] = ring + static_cast<std::size_t>((firstRow + kernelIndex) % verticalKernelSize) * rowStride + slotStart;
+		}
+
+		kernels.convolveRowVertical(verticalKernel, verticalKernelSize, rows.data(), pxStride, result.row(channelIndex, row - verticalCenter) + horizontalCenter * pxStride, interiorWidth);
+	}
+
+	return true;
+}
+
+bool convolve1DHorizontalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DHorizontalInterleavedAllChannels(kernel, kernelSize, makeImageView(image, ImageLayout::Interleaved, height, width, numChannels), makeImageView(result, ImageLayout::Interleaved, height, width, numChannels), level);
+}
+
+bool convolve1DHorizontalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if ((image.layout != ImageLayout::Interleaved) || !convolutionViewsValid(image, 0, result)) {
+		return false;
+	}
+
+	// no pixel of a row this narrow has a full neighbourhood
+	if (image.width < kernelSize) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const convolveRowAllChannelsFn convolveRow = getSimdKernels(level).convolveRowHorizontalAllChannels;
+
+	const unsigned int numChannels = image.numChannels;
+
+	for (unsigned int row = 0; row < image.height; row++) {
+		// all channels of the interior pixels, ignoring the edge pixels.  The first tap of the first interior element is the start of the row.
+		convolveRow(kernel, kernelSize, image.row(0, row), numChannels, result.row(0, row) + center * numChannels, (image.width - 2 * center) * numChannels);
+	}
+
+	return true;
+}
+
+bool convolve1DVerticalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DVerticalInterleavedAllChannels(kernel, kernelSize, makeImageView(image, ImageLayout::Interleaved, height, width, numChannels), makeImageView(result, ImageLayout::Interleaved, height, width, numChannels), level);
+}
+
+bool convolve1DVerticalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if ((image.layout != ImageLayout::Interleaved) || !convolutionViewsValid(image, 0, result)) {
+		return false;
+	}
+
+	const unsigned int height = image.height;
+
+	// no pixel of a column this short has a full neighbourhood
+	if (height < kernelSize) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const convolveRowVerticalFn convolveRow = getSimdKernels(level).convolveRowVertical;
+
+	const unsigned int rowLength = image.numChannels * image.width;
+
+	std::vector<const float*> rows(kernelSize);
+
+	// an interleaved row is rowLength contiguous floats, and vertically every float only depends on the same float of the rows above and below
+	for (unsigned int row = center; row < height - center; row++) {
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			rows[kernelIndex] = image.row(0, row - center + kernelIndex);
+		}
+
+		convolveRow(kernel, kernelSize, rows.data(), 1, result.row(0, row), rowLength);
+	}
+
+	return true;
+}
+
+bool boxFilter1DHorizontal(unsigned int radius, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return boxFilter1DHorizontal(radius, makeImageView(image, layout, height, width, numChannels), channelIndex, makeImageView(result, layout, height, width, numChannels));
+}
+
+bool boxFilter1DHorizontal(unsigned int radius, const ImageView& image, unsigned int channelIndex, const MutableImageView& result) {
+	if (!convolutionViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	const unsigned int width = image.width;
+	const unsigned int kernelSize = 2 * radius + 1;
+	if (width < kernelSize) {
+		return true;
+	}
+
+	const unsigned int pxStride = image.pixelStride();
+	const double scale = 1.0 / kernelSize;
+
+	for (unsigned int row = 0; row < image.height; row++) {
+		const float* src = image.row(channelIndex, row);
+		float* dst = result.row(channelIndex, row);
+
+		double sum = 0.0;
+		for (unsigned int col = 0; col < kernelSize; col++) {
+			sum += src[col * pxStride];
+		}
+
+		dst[radius * pxStride] = static_cast<float>(sum * scale);
+
+		// slide the window one pixel at a time: add the pixel entering on the right, subtract the one leaving on the left
+		for (unsigned int col = radius + 1; col < width - radius; col++) {
+			sum += static_cast<double>(src[(col + radius) * pxStride]) - static_cast<double>(src[(col - radius - 1) * pxStride]);
+			dst[col * pxStride] = static_cast<float>(sum * scale);
+		}
+	}
+
+	return true;
+}
+
+bool boxFilter1DVertical(unsigned int radius, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	if (!denseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return boxFilter1DVertical(radius, makeImageView(image, layout, height, width, numChannels), channelIndex, makeImageView(result, layout, height, width, numChannels));
+}
+
+bool boxFilter1DVertical(unsigned int radius, const ImageView& image, unsigned int channelIndex, const MutableImageView& result) {
+	if (!convolutionViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	const unsigned int height = image.height;
+	const unsigned int width = image.width;
+	const unsigned int kernelSize = 2 * radius + 1;
+	if ((height < kernelSize) || (width == 0)) {
+		return true;
+	}
+
+	const unsigned int pxStride = image.pixelStride();
+	const double scale = 1.0 / kernelSize;
+
+	// one running sum per column, initialized with the window of the first interior row
+	const PooledBuffer sumsBuffer = scratchBufferPool().acquire(width * sizeof(double));
+	double* sums = sumsBuffer.data<double>();
+	if (sums == nullptr) {
+		return false;
+	}
+
+	std::fill(sums, sums + width, 0.0);
+	for (unsigned int row = 0; row < kernelSize; row++) {
+		const float* srcRow = image.row(channelIndex, row);
+		for (unsigned int col = 0; col < width; col++) {
+			sums[col] += srcRow[col * pxStride];
+		}
+	}
+
+	for (unsigned int row = radius; row < height - radius; row++) {
+		if (row > radius) {
+			// slide the window one row down
+			const float* entering = image.row(channelIndex, row + radius);
+			const float* leaving = image.row(channelIndex, row - radius - 1);
+			for (unsigned int col = 0; col < width; col++) {
+				sums[col] += static_cast<double>(entering[col * pxStride]) - static_cast<double>(leaving[col * pxStride]);
+			}
+		}
+
+		float* dstRow = result.row(channelIndex, row);
+		for (unsigned int col = 0; col < width; col++) {
+			dstRow[col * pxStride] = static_cast<float>(sums[col] * scale);
+		}
+	}
+
+	return true;
+}
@@ -1,9 +1,33 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "image_view.h"
+#include "pixel_types.h"
+
+#include <array>
+#include <cstddef>
 #include <vector>
 
+/**
+ * Whole-row path of the 1D reference templates for pixel types whose per-pixel conversion costs more than the arithmetic.
+ * The templates widen and narrow every pixel through pixelTraits, unless the path is enabled for their pixel type, in which
+ * case they hand the image to convolve.  Only enabled for tHalf (see the specialization after kernelTaps).
+ */
+template <typename PixelT>
+struct convertedRowsPath {
+	static const bool enabled = false;
+
+	template <typename kernelT>
+	static bool convolve(const kernelT&, bool, bool, const std::vector<PixelT>&, unsigned int, unsigned int, unsigned int, unsigned int, std::vector<PixelT>&) {
+		return false;
+	}
+};
+
 /**
 * Performs 1D horizontal convolution on a single channel of an input planar format image with the given kernel.  Does not compute convolution around edge.
 *
 * @tparam kernelT  Kernel type - must have .size() and operator[] (std::array, std::vector, etc)
+* @tparam PixelT  Pixel type - float, std::uint8_t, std::uint16_t or tHalf.  Accumulated in pixelTraits<PixelT>::accumulatorT, see pixelTraits.
 * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
 * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width.
 * @param[in] height  Height of the input image
@@ -14,8 +38,8 @@
 *
 * @return  true if the convolution succeeded, false otherwise
 */
-template <typename kernelT>
-bool convolve1DHorizontalPlanar(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+template <typename kernelT, typename PixelT = float>
+bool convolve1DHorizontalPlanar(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result) {
 	
 	// only operate on odd-sized kernels
 	if (kernel.size() % 2 != 1) {
@@ -31,29 +55,37 @@ bool convolve1DHorizontalPlanar(const kernelT& kernel, const std::vector<float>&
 		return false;
 	}
 
-	if (height * width * numChannels > image.size()) {
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
 		return false;
 	}
 
+	// half precision rows are converted whole, see convertedRowsPath
+	if (convertedRowsPath<PixelT>::enabled) {
+		return convertedRowsPath<PixelT>::convolve(kernel, false, false, image, height, width, numChannels, channelIndex, result);
+	}
+
 	const unsigned int center = static_cast<unsigned int>(kernel.size()) / 2;
 
-	// for a planar image, the selected channel's data is contiguous.  We assume this image has no padding (stride == width, no padding between channels)
-	const unsigned int channelStart = height * width * channelIndex;
+	// for a planar image, the selected channel's data is contiguous.  We assume this image has no padding (stride == width, no padding between channels).
+	// A channel can hold more than 2^32 pixels, so the row offsets are 64-bit, and the loops index from the row pointers.
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
 
 	// perform a convolution on each row of the input image in the selected channelIndex, storing the result in result
 	for (unsigned int row = 0; row < height; row++) {
-		const unsigned int rowStart = channelStart + row * width;
+		const std::size_t rowStart = channelStart + static_cast<std::size_t>(row) * width;
+		const PixelT* srcRow = image.data() + rowStart;
+		PixelT* dstRow = result.data() + rowStart;
 
 		// convolve all pixels in the interior of the image, ignoring the edge pixels
-		for (unsigned int col = center; col < width - center; col++) {
-			const unsigned int colStart = rowStart + col - center;
+		for (unsigned int col = center; col + center < width; col++) {
+			const PixelT* px = srcRow + col - center;
 
-			float convolutionResult = 0.0f;
+			typename pixelTraits<PixelT>::accumulatorT convolutionResult = 0;
 			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++) {
-				convolutionResult += kernel[kernelIndex] * image[colStart + kernelIndex];
+				convolutionResult += kernel[kernelIndex] * pixelTraits<PixelT>::load(px[kernelIndex]);
 			}
 
-			result[rowStart + col] = convolutionResult;
+			dstRow[col] = pixelTraits<PixelT>::store(convolutionResult);
 		}
 	}
 
@@ -64,6 +96,7 @@ bool convolve1DHorizontalPlanar(const kernelT& kernel, const std::vector<float>&
 * Performs 1D vertical convolution on a single channel of an input planar format image with the given kernel.  Does not compute convolution around edge.
 *
 * @tparam kernelT  Kernel type - must have .size() and operator[] (std::array, std::vector, etc)
+* @tparam PixelT  Pixel type - float, std::uint8_t, std::uint16_t or tHalf.  Accumulated in pixelTraits<PixelT>::accumulatorT, see pixelTraits.
 * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
 * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width.
 * @param[in] height  Height of the input image
@@ -74,8 +107,8 @@ bool convolve1DHorizontalPlanar(const kernelT& kernel, const std::vector<float>&
 *
 * @return  true if the convolution succeeded, false otherwise
 */
-template <typename kernelT>
-bool convolve1DVerticalPlanar(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+template <typename kernelT, typename PixelT = float>
+bool convolve1DVerticalPlanar(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result) {
 	
 	// only operate on odd-sized kernels
 	if (kernel.size() % 2 != 1) {
@@ -91,29 +124,39 @@ bool convolve1DVerticalPlanar(const kernelT& kernel, const std::vector<float>& i
 		return false;
 	}
 
-	if (height * width * numChannels > image.size()) {
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
 		return false;
 	}
 
+	// half precision rows are converted whole, see convertedRowsPath
+	if (convertedRowsPath<PixelT>::enabled) {
+		return convertedRowsPath<PixelT>::convolve(kernel, true, false, image, height, width, numChannels, channelIndex, result);
+	}
+
 	const unsigned int center = static_cast<unsigned int>(kernel.size()) / 2;
 
-	// for a planar image, the selected channel's data is contiguous.  We assume this image has no padding (stride == width, no padding between channels)
-	const unsigned int channelStart = height * width * channelIndex;
+	// for a planar image, the selected channel's data is contiguous.  We assume this image has no padding (stride == width, no padding between channels).
+	// The offsets are 64-bit, see convolve1DHorizontalPlanar.
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
+	const std::size_t rowStride = width;
 
 	// perform a convolution on each column of the input image in the selected channelIndex, storing the result in result
 	for (unsigned int col = 0; col < width; col++) {
-		const unsigned int colStart = channelStart + col;
-
-		// convolve all pixels in the interior of the image, ignoring the edge pixels
-		for (unsigned int row = center; row < height - center; row++) {
-			const unsigned int rowStart = colStart + (row - center) * width;
+		const PixelT* srcCol = image.data() + channelStart + col;
+		PixelT* dstCol = result.data() + channelStart + col;
 
-			float convolutionResult = 0.0f;
-			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++) {
-				convolutionResult += kernel[kernelIndex] * image[rowStart + kernelIndex * width];
+		// convolve all pixels in the interior of the image, ignoring the edge pixels.  The pointers step down the column, so
+		// no offset is multiplied out per pixel.
+		const PixelT* px = srcCol;
+		PixelT* dst = dstCol + center * rowStride;
+		for (unsigned int row = center; row + center < height; row++, px += rowStride, dst += rowStride) {
+			typename pixelTraits<PixelT>::accumulatorT convolutionResult = 0;
+			const PixelT* tap = px;
+			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++, tap += rowStride) {
+				convolutionResult += kernel[kernelIndex] * pixelTraits<PixelT>::load(*tap);
 			}
 
-			result[colStart + row * width] = convolutionResult;
+			*dst = pixelTraits<PixelT>::store(convolutionResult);
 		}
 	}
 
@@ -124,6 +167,7 @@ bool convolve1DVerticalPlanar(const kernelT& kernel, const std::vector<float>& i
 * Performs 1D horizontal convolution on a single channel of an input interleaved format image with the given kernel.  Does not compute convolution around edge.
 *
 * @tparam kernelT  Kernel type - must have .size() and operator[] (std::array, std::vector, etc)
+* @tparam PixelT  Pixel type - float, std::uint8_t, std::uint16_t or tHalf.  Accumulated in pixelTraits<PixelT>::accumulatorT, see pixelTraits.
 * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
 * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width * \p numChannels.
 * @param[in] height  Height of the input image
@@ -134,8 +178,8 @@ bool convolve1DVerticalPlanar(const kernelT& kernel, const std::vector<float>& i
 *
 * @return  true if the convolution succeeded, false otherwise
 */
-template <typename kernelT>
-bool convolve1DHorizontalInterleaved(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+template <typename kernelT, typename PixelT = float>
+bool convolve1DHorizontalInterleaved(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result) {
 	
 	// only operate on odd-sized kernels
 	if (kernel.size() % 2 != 1) {
@@ -151,29 +195,36 @@ bool convolve1DHorizontalInterleaved(const kernelT& kernel, const std::vector<fl
 		return false;
 	}
 
-	if (height * width * numChannels > image.size()) {
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
 		return false;
 	}
 
+	// half precision rows are converted whole, see convertedRowsPath
+	if (convertedRowsPath<PixelT>::enabled) {
+		return convertedRowsPath<PixelT>::convolve(kernel, false, true, image, height, width, numChannels, channelIndex, result);
+	}
+
 	const unsigned int center = static_cast<unsigned int>(kernel.size()) / 2;
 
 	const unsigned int pxStride = numChannels;
-	const unsigned int rowStride = pxStride * width;
+	const std::size_t rowStride = static_cast<std::size_t>(pxStride) * width;
 
 	// perform a convolution on each row of the input image in the selected channelIndex, storing the result in result
 	for (unsigned int row = 0; row < height; row++) {
-		const unsigned int rowStart = row * rowStride + channelIndex;
+		const std::size_t rowStart = row * rowStride + channelIndex;
+		const PixelT* srcRow = image.data() + rowStart;
+		PixelT* dstRow = result.data() + rowStart;
 
 		// convolve all pixels in the interior of the image, ignoring the edge pixels
-		for (unsigned int pxCol = center; pxCol < width - center; pxCol++) {
-			const unsigned int colStart = rowStart + (pxCol - center) * pxStride;
+		for (unsigned int pxCol = center; pxCol + center < width; pxCol++) {
+			const PixelT* px = srcRow + (pxCol - center) * pxStride;
 
-			float convolutionResult = 0.0f;
+			typename pixelTraits<PixelT>::accumulatorT convolutionResult = 0;
 			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++) {
-				convolutionResult += kernel[kernelIndex] * image[colStart + kernelIndex * pxStride];
+				convolutionResult += kernel[kernelIndex] * pixelTraits<PixelT>::load(px[kernelIndex * pxStride]);
 			}
 
-			result[rowStart + pxCol * pxStride] = convolutionResult;
+			dstRow[pxCol * pxStride] = pixelTraits<PixelT>::store(convolutionResult);
 		}
 	}
 
@@ -184,6 +235,7 @@ bool convolve1DHorizontalInterleaved(const kernelT& kernel, const std::vector<fl
 * Performs 1D vertical convolution on a single channel of an input interleaved format image with the given kernel.  Does not compute convolution around edge.
 *
 * @tparam kernelT  Kernel type - must have .size() and operator[] (std::array, std::vector, etc)
+* @tparam PixelT  Pixel type - float, std::uint8_t, std::uint16_t or tHalf.  Accumulated in pixelTraits<PixelT>::accumulatorT, see pixelTraits.
 * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
 * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width * \p numChannels.
 * @param[in] height  Height of the input image
@@ -194,8 +246,8 @@ bool convolve1DHorizontalInterleaved(const kernelT& kernel, const std::vector<fl
 *
 * @return  true if the convolution succeeded, false otherwise
 */
-template <typename kernelT>
-bool convolve1DVerticalInterleaved(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+template <typename kernelT, typename PixelT = float>
+bool convolve1DVerticalInterleaved(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result) {
 	
 	// only operate on odd-sized kernels
 	if (kernel.size() % 2 != 1) {
@@ -211,37 +263,775 @@ bool convolve1DVerticalInterleaved(const kernelT& kernel, const std::vector<floa
 		return false;
 	}
 
-	if (height * width * numChannels > image.size()) {
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
 		return false;
 	}
 
+	// half precision rows are converted whole, see convertedRowsPath
+	if (convertedRowsPath<PixelT>::enabled) {
+		return convertedRowsPath<PixelT>::convolve(kernel, true, true, image, height, width, numChannels, channelIndex, result);
+	}
+
 	const unsigned int center = static_cast<unsigned int>(kernel.size()) / 2;
 
 	const unsigned int pxStride = numChannels;
-	const unsigned int rowStride = pxStride * width;
+	const std::size_t rowStride = static_cast<std::size_t>(pxStride) * width;
 
 	// perform a convolution on each column of the input image in the selected channelIndex, storing the result in result
 	for (unsigned int col = 0; col < width; col++) {
 		const unsigned int colStart = col * pxStride + channelIndex;
+		const PixelT* srcCol = image.data() + colStart;
+		PixelT* dstCol = result.data() + colStart;
 
-		// convolve all pixels in the interior of the image, ignoring the edge pixels
-		for (unsigned int row = center; row < height - center; row++) {
-			const unsigned int rowStart = colStart + (row - center) * rowStride;
+		// convolve all pixels in the interior of the image, ignoring the edge pixels.  The pointers step down the column, so
+		// no offset is multiplied out per pixel.
+		const PixelT* px = srcCol;
+		PixelT* dst = dstCol + center * rowStride;
+		for (unsigned int row = center; row + center < height; row++, px += rowStride, dst += rowStride) {
+			typename pixelTraits<PixelT>::accumulatorT convolutionResult = 0;
+			const PixelT* tap = px;
+			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++, tap += rowStride) {
+				convolutionResult += kernel[kernelIndex] * pixelTraits<PixelT>::load(*tap);
+			}
+
+			*dst = pixelTraits<PixelT>::store(convolutionResult);
+		}
+	}
 
-			float convolutionResult = 0.0f;
+	return true;
+}
+
+/**
+ * How the convolution functions with a border mode read the pixels outside the image.  For a row a b c d:
+ */
+enum class BorderMode {
+	Clamp,		// a a a | a b c d | d d d
+	Mirror,		// d c b | a b c d | c b a  (reflected about the edge pixel, which is not repeated)
+	Wrap,		// b c d | a b c d | a b c
+	Constant	// v v v | a b c d | v v v  (a given border value)
+};
+
+/**
+ * Maps an index that may lie outside a line of \p length pixels to the pixel that \p border reads instead.
+ *
+ * @param[in] index  Index of the pixel, relative to the start of the line.  May be negative.
+ * @param[in] length  Number of pixels in the line
+ * @param[in] border  How pixels outside the line are read
+ * @param[out] sourceIndex  Index of the pixel inside the line to read, if the return value is true
+ *
+ * @return  true if \p sourceIndex holds the pixel to read, false if the border value is read instead (BorderMode::Constant)
+ */
+inline bool borderSourceIndex(long long index, unsigned int length, BorderMode border, unsigned int& sourceIndex) {
+	const long long size = static_cast<long long>(length);
+	if ((index >= 0) && (index < size)) {
+		sourceIndex = static_cast<unsigned int>(index);
+		return true;
+	}
+
+	switch (border) {
+	case BorderMode::Clamp:
+		sourceIndex = index < 0 ? 0 : length - 1;
+		return true;
+	case BorderMode::Mirror: {
+		if (size == 1) {
+			sourceIndex = 0;
+			return true;
+		}
+
+		// reflecting about both ends repeats with a period of 2 * (length - 1)
+		const long long period = 2 * (size - 1);
+		long long folded = index % period;
+		if (folded < 0) {
+			folded += period;
+		}
+		sourceIndex = static_cast<unsigned int>(folded < size ? folded : period - folded);
+		return true;
+	}
+	case BorderMode::Wrap: {
+		long long wrapped = index % size;
+		if (wrapped < 0) {
+			wrapped += size;
+		}
+		sourceIndex = static_cast<unsigned int>(wrapped);
+		return true;
+	}
+	case BorderMode::Constant:
+	default:
+		return false;
+	}
+}
+
+/**
+ * Convolves the pixels of one line (a row or a column of one channel) whose kernel window crosses an end of the line, i.e.
+ * the first and last kernel.size() / 2 pixels.  The taps are summed in the same order as the interior loops, so the
+ * result is bit-identical to padding the line and convolving the padded line.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] line  First pixel of the line
+ * @param[in] length  Number of pixels in the line
+ * @param[in] step  Elements between neighbouring pixels of the line.  64-bit, since the pixels of a column can be more than 2^32 elements apart.
+ * @param[in] border  How pixels outside the line are read
+ * @param[in] borderValue  Pixel read outside the line for BorderMode::Constant
+ * @param[out] resultLine  First pixel of the line in the result, with the same \p step
+ */
+template <typename kernelT, typename PixelT>
+void convolveBorderLine(const kernelT& kernel, const PixelT* line, unsigned int length, std::size_t step, BorderMode border, PixelT borderValue, PixelT* resultLine) {
+	const unsigned int center = static_cast<unsigned int>(kernel.size()) / 2;
+
+	// the interior loops cover [center, length - center).  A line shorter than the kernel has no interior.
+	const unsigned int interiorBegin = center < length ? center : length;
+	const unsigned int interiorEnd = length > 2 * center ? length - center : interiorBegin;
+
+	// the leading edge, then the trailing edge
+	const unsigned int edgeBegin[2] = { 0, interiorEnd };
+	const unsigned int edgeEnd[2] = { interiorBegin, length };
+
+	for (unsigned int edge = 0; edge < 2; edge++) {
+		for (unsigned int pos = edgeBegin[edge]; pos < edgeEnd[edge]; pos++) {
+			typename pixelTraits<PixelT>::accumulatorT convolutionResult = 0;
 			for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++) {
-				convolutionResult += kernel[kernelIndex] * image[rowStart + kernelIndex * rowStride];
+				unsigned int sourceIndex = 0;
+				const long long index = static_cast<long long>(pos) + kernelIndex - center;
+				const PixelT pixel = borderSourceIndex(index, length, border, sourceIndex) ? line[sourceIndex * step] : borderValue;
+				convolutionResult += kernel[kernelIndex] * pixelTraits<PixelT>::load(pixel);
 			}
 
-			result[colStart + row * rowStride] = convolutionResult;
+			resultLine[pos * step] = pixelTraits<PixelT>::store(convolutionResult);
 		}
 	}
+}
+
+/**
+ * Same as convolve1DHorizontalPlanar, but also computes the pixels around the edge, reading the pixels outside the image
+ * as given by \p border.  The interior runs the loop of convolve1DHorizontalPlanar unchanged, without any bounds checks,
+ * and the edge pixels are computed by separate loops.  The result is bit-identical to padding the image by kernel.size() / 2
+ * pixels on each side and calling convolve1DHorizontalPlanar on the padded image.
+ *
+ * @param[in] border  How pixels outside the image are read
+ * @param[in] borderValue  Pixel read outside the image for BorderMode::Constant.  (Declared through std::vector so it
+ *                         isn't used to deduce PixelT, and e.g. 0 can be passed for an 8-bit image.)
+ *
+ * See convolve1DHorizontalPlanar for the other parameters.
+ */
+template <typename kernelT, typename PixelT = float>
+bool convolve1DHorizontalPlanarBordered(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result,
+	BorderMode border, typename std::vector<PixelT>::value_type borderValue = PixelT()) {
+
+	if (!convolve1DHorizontalPlanar(kernel, image, height, width, numChannels, channelIndex, result)) {
+		return false;
+	}
+
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = channelStart + static_cast<std::size_t>(row) * width;
+		convolveBorderLine(kernel, image.data() + rowStart, width, 1, border, borderValue, result.data() + rowStart);
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DVerticalPlanar, but also computes the pixels around the edge.  See
+ * convolve1DHorizontalPlanarBordered.
+ */
+template <typename kernelT, typename PixelT = float>
+bool convolve1DVerticalPlanarBordered(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result,
+	BorderMode border, typename std::vector<PixelT>::value_type borderValue = PixelT()) {
+
+	if (!convolve1DVerticalPlanar(kernel, image, height, width, numChannels, channelIndex, result)) {
+		return false;
+	}
+
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
+	for (unsigned int col = 0; col < width; col++) {
+		const std::size_t colStart = channelStart + col;
+		convolveBorderLine(kernel, image.data() + colStart, height, width, border, borderValue, result.data() + colStart);
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DHorizontalInterleaved, but also computes the pixels around the edge.  See
+ * convolve1DHorizontalPlanarBordered.
+ */
+template <typename kernelT, typename PixelT = float>
+bool convolve1DHorizontalInterleavedBordered(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result,
+	BorderMode border, typename std::vector<PixelT>::value_type borderValue = PixelT()) {
+
+	if (!convolve1DHorizontalInterleaved(kernel, image, height, width, numChannels, channelIndex, result)) {
+		return false;
+	}
+
+	const std::size_t rowStride = static_cast<std::size_t>(numChannels) * width;
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = row * rowStride + channelIndex;
+		convolveBorderLine(kernel, image.data() + rowStart, width, numChannels, border, borderValue, result.data() + rowStart);
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DVerticalInterleaved, but also computes the pixels around the edge.  See
+ * convolve1DHorizontalPlanarBordered.
+ */
+template <typename kernelT, typename PixelT = float>
+bool convolve1DVerticalInterleavedBordered(const kernelT& kernel, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<PixelT>& result,
+	BorderMode border, typename std::vector<PixelT>::value_type borderValue = PixelT()) {
+
+	if (!convolve1DVerticalInterleaved(kernel, image, height, width, numChannels, channelIndex, result)) {
+		return false;
+	}
+
+	const std::size_t rowStride = static_cast<std::size_t>(numChannels) * width;
+	for (unsigned int col = 0; col < width; col++) {
+		const unsigned int colStart = col * numChannels + channelIndex;
+		convolveBorderLine(kernel, image.data() + colStart, height, rowStride, border, borderValue, result.data() + colStart);
+	}
 
 	return true;
 }
 
 /**
- * Transposes the given planar source (src) image
+ * Compile-time unrolled tap loops for kernels whose size is known at compile time (std::array).  unrolledTaps<I> covers the
+ * first I taps.  dot() sums the taps in the same order as the runtime loops above.  foldedDot() adds the two pixels under a
+ * pair of mirrored taps before multiplying, so a symmetric kernel of size N needs N / 2 + 1 multiplies instead of N.
+ */
+template <std::size_t I>
+struct unrolledTaps {
+	template <std::size_t N>
+	static float dot(const std::array<float, N>& kernel, const float* px, std::size_t stride) {
+		return unrolledTaps<I - 1>::dot(kernel, px, stride) + kernel[I - 1] * px[(I - 1) * stride];
+	}
+
+	template <std::size_t N>
+	static float foldedDot(const std::array<float, N>& kernel, const float* px, std::size_t stride) {
+		return unrolledTaps<I - 1>::foldedDot(kernel, px, stride) + kernel[I - 1] * (px[(I - 1) * stride] + px[(N - I) * stride]);
+	}
+};
+
+template <>
+struct unrolledTaps<0> {
+	template <std::size_t N>
+	static float dot(const std::array<float, N>&, const float*, std::size_t) {
+		return 0.0f;
+	}
+
+	template <std::size_t N>
+	static float foldedDot(const std::array<float, N>&, const float*, std::size_t) {
+		return 0.0f;
+	}
+};
+
+/**
+ * Convolves the N pixels starting at \p px, \p stride floats apart, with \p kernel.  All taps are unrolled at compile time.
+ *
+ * @tparam N  Kernel size
+ * @tparam Symmetric  If true, \p kernel must be symmetric (kernel[k] == kernel[N - 1 - k]) and mirrored taps are folded
+ */
+template <std::size_t N, bool Symmetric>
+float convolveUnrolledTaps(const std::array<float, N>& kernel, const float* px, std::size_t stride) {
+	return Symmetric
+		? unrolledTaps<N / 2>::foldedDot(kernel, px, stride) + kernel[N / 2] * px[(N / 2) * stride]
+		: unrolledTaps<N>::dot(kernel, px, stride);
+}
+
+/**
+ * @return  true if kernel[k] == kernel[N - 1 - k] for every k
+ */
+template <std::size_t N>
+bool isSymmetricKernel(const std::array<float, N>& kernel) {
+	for (std::size_t kernelIndex = 0; kernelIndex < N / 2; kernelIndex++) {
+		if (kernel[kernelIndex] != kernel[N - 1 - kernelIndex]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DHorizontalPlanar, specialized for a kernel whose size is known at compile time, so the taps are fully unrolled.
+ *
+ * @tparam N  Kernel size.  Must be odd.
+ * @tparam Symmetric  If true, mirrored taps are folded so only N / 2 + 1 multiplies are needed per pixel (box, Gaussian, ...).
+ *                    The call fails if \p kernel isn't symmetric.
+ *
+ * See convolve1DHorizontalPlanar for the parameters.
+ */
+template <std::size_t N, bool Symmetric = false>
+bool convolve1DHorizontalPlanarUnrolled(const std::array<float, N>& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	static_assert(N % 2 == 1, "only odd-sized kernels are supported");
+
+	if (Symmetric && !isSymmetricKernel(kernel)) {
+		return false;
+	}
+
+	if (channelIndex >= numChannels) {
+		return false;
+	}
+
+	// size sanity checks
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
+		return false;
+	}
+
+	const unsigned int center = static_cast<unsigned int>(N) / 2;
+	if (width < N) {
+		return true;
+	}
+
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
+
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = channelStart + static_cast<std::size_t>(row) * width;
+		const float* srcRow = image.data() + rowStart;
+		float* dstRow = result.data() + rowStart;
+
+		for (unsigned int col = center; col + center < width; col++) {
+			dstRow[col] = convolveUnrolledTaps<N, Symmetric>(kernel, srcRow + col - center, 1);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DVerticalPlanar, specialized for a kernel whose size is known at compile time, so the taps are fully unrolled.
+ *
+ * See convolve1DHorizontalPlanarUnrolled for the template parameters and convolve1DVerticalPlanar for the parameters.
+ */
+template <std::size_t N, bool Symmetric = false>
+bool convolve1DVerticalPlanarUnrolled(const std::array<float, N>& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	static_assert(N % 2 == 1, "only odd-sized kernels are supported");
+
+	if (Symmetric && !isSymmetricKernel(kernel)) {
+		return false;
+	}
+
+	if (channelIndex >= numChannels) {
+		return false;
+	}
+
+	// size sanity checks
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
+		return false;
+	}
+
+	const unsigned int center = static_cast<unsigned int>(N) / 2;
+	if (height < N) {
+		return true;
+	}
+
+	const std::size_t channelStart = static_cast<std::size_t>(height) * width * channelIndex;
+	const std::size_t rowStride = width;
+
+	// same column-major traversal as convolve1DVerticalPlanar, so the benchmark isolates the effect of unrolling
+	for (unsigned int col = 0; col < width; col++) {
+		const float* srcCol = image.data() + channelStart + col;
+		float* dstCol = result.data() + channelStart + col;
+
+		for (unsigned int row = center; row + center < height; row++) {
+			dstCol[row * rowStride] = convolveUnrolledTaps<N, Symmetric>(kernel, srcCol + (row - center) * rowStride, rowStride);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DHorizontalInterleaved, specialized for a kernel whose size is known at compile time, so the taps are fully unrolled.
+ *
+ * See convolve1DHorizontalPlanarUnrolled for the template parameters and convolve1DHorizontalInterleaved for the parameters.
+ */
+template <std::size_t N, bool Symmetric = false>
+bool convolve1DHorizontalInterleavedUnrolled(const std::array<float, N>& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	static_assert(N % 2 == 1, "only odd-sized kernels are supported");
+
+	if (Symmetric && !isSymmetricKernel(kernel)) {
+		return false;
+	}
+
+	if (channelIndex >= numChannels) {
+		return false;
+	}
+
+	// size sanity checks
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
+		return false;
+	}
+
+	const unsigned int center = static_cast<unsigned int>(N) / 2;
+	if (width < N) {
+		return true;
+	}
+
+	const unsigned int pxStride = numChannels;
+	const std::size_t rowStride = static_cast<std::size_t>(pxStride) * width;
+
+	for (unsigned int row = 0; row < height; row++) {
+		const std::size_t rowStart = row * rowStride + channelIndex;
+		const float* srcRow = image.data() + rowStart;
+		float* dstRow = result.data() + rowStart;
+
+		for (unsigned int pxCol = center; pxCol + center < width; pxCol++) {
+			dstRow[pxCol * pxStride] = convolveUnrolledTaps<N, Symmetric>(kernel, srcRow + (pxCol - center) * pxStride, pxStride);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DVerticalInterleaved, specialized for a kernel whose size is known at compile time, so the taps are fully unrolled.
+ *
+ * See convolve1DHorizontalPlanarUnrolled for the template parameters and convolve1DVerticalInterleaved for the parameters.
+ */
+template <std::size_t N, bool Symmetric = false>
+bool convolve1DVerticalInterleavedUnrolled(const std::array<float, N>& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	static_assert(N % 2 == 1, "only odd-sized kernels are supported");
+
+	if (Symmetric && !isSymmetricKernel(kernel)) {
+		return false;
+	}
+
+	if (channelIndex >= numChannels) {
+		return false;
+	}
+
+	// size sanity checks
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	if (static_cast<std::size_t>(height) * width * numChannels > image.size()) {
+		return false;
+	}
+
+	const unsigned int center = static_cast<unsigned int>(N) / 2;
+	if (height < N) {
+		return true;
+	}
+
+	const unsigned int pxStride = numChannels;
+	const std::size_t rowStride = static_cast<std::size_t>(pxStride) * width;
+
+	// same column-major traversal as convolve1DVerticalInterleaved, so the benchmark isolates the effect of unrolling
+	for (unsigned int col = 0; col < width; col++) {
+		const unsigned int colStart = col * pxStride + channelIndex;
+		const float* srcCol = image.data() + colStart;
+		float* dstCol = result.data() + colStart;
+
+		for (unsigned int row = center; row + center < height; row++) {
+			dstCol[row * rowStride] = convolveUnrolledTaps<N, Symmetric>(kernel, srcCol + (row - center) * rowStride, rowStride);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Performs 1D horizontal convolution on a single channel of an input image with the given kernel, using the explicit SIMD
+ * kernels of \p level.  Computes the same pixels as convolve1DHorizontalPlanar / convolve1DHorizontalInterleaved, but
+ * produces 8 (AVX2) or 16 (AVX-512) outputs per instruction.  The results can differ from the templates in the last bits
+ * because the SIMD kernels use fused multiply-adds.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontal, but on image views, so \p image and \p result can have padded rows (e.g. an AlignedImage), be
+ * crops of larger images, or wrap buffers the caller doesn't own.  \p image and \p result must have the same shape; their
+ * pitches may differ.
+ */
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontal, but only computes the output rows in [\p rowBegin, \p rowEnd).  Lets callers split an image
+ * into row bands, e.g. to convolve bands on different threads.
+ */
+bool convolve1DHorizontalRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalRows, on image views
+ */
+bool convolve1DHorizontalRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution on a single channel of an input image with the given kernel, using the explicit SIMD
+ * kernels of \p level.  Computes the same pixels as convolve1DVerticalPlanar / convolve1DVerticalInterleaved, but walks the
+ * output rows in order and accumulates the \p kernelSize input rows under the kernel one whole row at a time, so every load
+ * streams along a row instead of jumping a row stride per tap.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVertical, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontal, for half precision images.  Each row is widened to float with the convertHalfToFloat kernel
+ * of \p level (F16C from AVX2 up), convolved with the float row kernels, and the interior pixels are rounded back with
+ * convertFloatToHalf, so no pixel goes through the per-value software conversion of pixelTraits<tHalf>.  Interleaved rows
+ * are widened whole, all channels at once.
+ */
+bool convolve1DHorizontal(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<tHalf>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<tHalf>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVertical, for half precision images.  Like the half precision convolve1DHorizontal, every input row is
+ * widened once, into a ring of kernelSize float rows, and every output row is rounded back whole.
+ */
+bool convolve1DVertical(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<tHalf>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<tHalf>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVertical, but only computes the output rows in [\p rowBegin, \p rowEnd).  The kernelSize / 2 input rows
+ * above and below the band are read as halo, so bands can be computed independently.
+ */
+bool convolve1DVerticalRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVerticalRows, on image views
+ */
+bool convolve1DVerticalRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs a separable 2D convolution (horizontal pass, then vertical pass) on a single channel of an input image in one
+ * sweep.  Only the last \p verticalKernelSize horizontally convolved rows are kept, in a ring buffer, and each output row
+ * is produced as soon as the rows under the vertical kernel are available, so the intermediate image never goes to memory.
+ * The extra memory is \p verticalKernelSize rows of the image (width * numChannels floats each for interleaved images, so
+ * the ring rows keep the interleaved pixel stride) instead of a whole intermediate image.
+ *
+ * Computes the pixels that have a full neighbourhood under both kernels, i.e. rows [verticalKernelSize / 2, height - verticalKernelSize / 2)
+ * and columns [horizontalKernelSize / 2, width - horizontalKernelSize / 2).  All other pixels of \p result are left untouched.
+ *
+ * @param[in] horizontalKernel  1D kernel to convolve the rows with.  Must have odd length.
+ * @param[in] horizontalKernelSize  Number of elements in \p horizontalKernel
+ * @param[in] verticalKernel  1D kernel to convolve the columns with.  Must have odd length.
+ * @param[in] verticalKernelSize  Number of elements in \p verticalKernel
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the image convolved with both kernels.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve2DSeparable(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve2DSeparable, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve2DSeparable(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Same as convolve2DSeparable, but only computes the output rows in [\p rowBegin, \p rowEnd).  The verticalKernelSize / 2
+ * input rows above and below the band are convolved horizontally again as halo, so bands can be computed independently.
+ */
+bool convolve2DSeparableRows(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve2DSeparableRows, on image views
+ */
+bool convolve2DSeparableRows(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D horizontal convolution on every channel of an input interleaved format image in a single sweep, using the
+ * explicit SIMD kernels of \p level.  Each row is treated as width * numChannels contiguous floats whose taps are
+ * numChannels apart, so whole pixels map onto the SIMD lanes and every cache line that is loaded is fully used, instead of
+ * 1 / numChannels of it per call like convolve1DHorizontalInterleaved.  Computes the same pixels as calling
+ * convolve1DHorizontalInterleaved for every channel.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] image  2D multi-channel interleaved image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width * \p numChannels.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DHorizontalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalInterleavedAllChannels, on image views.  \p image must be interleaved.
+ */
+bool convolve1DHorizontalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution on every channel of an input interleaved format image in a single sweep, using the
+ * explicit SIMD kernels of \p level.  Each output row is accumulated from whole interleaved input rows, all channels at
+ * once.  Computes the same pixels as calling convolve1DVerticalInterleaved for every channel.
+ *
+ * See convolve1DHorizontalInterleavedAllChannels for the parameters.
+ */
+bool convolve1DVerticalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVerticalInterleavedAllChannels, on image views.  \p image must be interleaved.
+ */
+bool convolve1DVerticalInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs a 1D horizontal box filter on 1 channel of an input image with a sliding sum, so the cost per pixel doesn't depend
+ * on \p radius.  Computes the same pixels as convolve1DHorizontal with a kernel of size 2 * \p radius + 1 where every tap is
+ * 1 / (2 * \p radius + 1), up to rounding: the edge pixels are left untouched.
+ *
+ * The sliding sum is kept in double precision.  Adding the entering pixel and subtracting the leaving one in float would
+ * accumulate a rounding error that grows along the row; in double it stays far below the float precision of the result.
+ *
+ * @param[in] radius  Number of pixels on each side of the center pixel that are averaged with it
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to filter.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Channel to filter.  Must be < \p numChannels
+ * @param[out] result  Out-of-place result of the box filter.  Is expected that before the call, \p result has size = size of \p image .
+ *
+ * @return  true if the filter succeeded, false otherwise
+ */
+bool boxFilter1DHorizontal(unsigned int radius, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result);
+
+/**
+ * Same as boxFilter1DHorizontal, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool boxFilter1DHorizontal(unsigned int radius, const ImageView& image, unsigned int channelIndex, const MutableImageView& result);
+
+/**
+ * Performs a 1D vertical box filter on 1 channel of an input image with a sliding sum, so the cost per pixel doesn't depend on
+ * \p radius.  Walks the rows in order and keeps one running sum per column: each output row adds the row entering the window
+ * and subtracts the one leaving it.  Computes the same pixels as convolve1DVertical with a kernel of size 2 * \p radius + 1
+ * where every tap is 1 / (2 * \p radius + 1), up to rounding.  Like boxFilter1DHorizontal, the sums are kept in double precision.
+ *
+ * See boxFilter1DHorizontal for the parameters.
+ */
+bool boxFilter1DVertical(unsigned int radius, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result);
+
+/**
+ * Same as boxFilter1DVertical, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool boxFilter1DVertical(unsigned int radius, const ImageView& image, unsigned int channelIndex, const MutableImageView& result);
+
+/**
+ * Largest kernel the array-ish SIMD templates below accept.  Wider kernels can be passed to the float pointer overloads.
+ */
+const unsigned int maxKernelTaps = 256;
+
+/**
+ * Caller-provided storage for the taps of an array-ish kernel, so the templates don't allocate on every call
+ */
+typedef std::array<float, maxKernelTaps> tKernelTaps;
+
+/**
+ * Copies the taps of an array-ish kernel into a contiguous float buffer for the non-template convolution functions
+ *
+ * @param[in] kernel  Kernel to copy
+ * @param[out] taps  The first kernel.size() elements receive the taps
+ *
+ * @return  true if the kernel has at most maxKernelTaps taps, false otherwise
+ */
+template <typename kernelT>
+bool kernelTaps(const kernelT& kernel, tKernelTaps& taps) {
+	if (kernel.size() > taps.size()) {
+		return false;
+	}
+
+	for (unsigned int kernelIndex = 0; kernelIndex < kernel.size(); kernelIndex++) {
+		taps[kernelIndex] = kernel[kernelIndex];
+	}
+
+	return true;
+}
+
+/**
+ * Half precision images skip the per-pixel conversions of the 1D reference templates: each row is widened whole, convolved
+ * in float and rounded back whole by the half precision convolve1DHorizontal / convolve1DVertical, with the kernels for the
+ * instruction set level returned by getSimdLevel().
+ */
+template <>
+struct convertedRowsPath<tHalf> {
+	static const bool enabled = true;
+
+	template <typename kernelT>
+	static bool convolve(const kernelT& kernel, bool vertical, bool interleaved, const std::vector<tHalf>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<tHalf>& result) {
+		tKernelTaps taps;
+		if (!kernelTaps(kernel, taps)) {
+			return false;
+		}
+
+		const unsigned int kernelSize = static_cast<unsigned int>(kernel.size());
+		const ImageLayout layout = interleaved ? ImageLayout::Interleaved : ImageLayout::Planar;
+		return vertical
+			? convolve1DVertical(taps.data(), kernelSize, layout, image, height, width, numChannels, channelIndex, result, getSimdLevel())
+			: convolve1DHorizontal(taps.data(), kernelSize, layout, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+	}
+};
+
+/**
+ * Same as convolve1DHorizontalPlanar, but runs the SIMD kernels for the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve1DHorizontalPlanarSimd(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DHorizontal(taps.data(), static_cast<unsigned int>(kernel.size()), ImageLayout::Planar, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Same as convolve1DHorizontalInterleaved, but runs the SIMD kernels for the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve1DHorizontalInterleavedSimd(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DHorizontal(taps.data(), static_cast<unsigned int>(kernel.size()), ImageLayout::Interleaved, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Transposes the given planar source (src) image.  Works on cache-sized blocks using the register transpose kernels for
+ * the instruction set level returned by getSimdLevel().
  * 
  * @param[in] src  2D multi-channel planar image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width.
  * @param[in] height  Height of \p src
@@ -251,4 +1041,346 @@ bool convolve1DVerticalInterleaved(const kernelT& kernel, const std::vector<floa
  * 
  * @return true if the image was successfully transposed, false otherwise.
  */
-bool transposePlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst);
\ No newline at end of file
+bool transposePlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst);
+
+/**
+ * Same as transposePlanar, on image views.  \p src and \p dst must be planar, and \p dst must have height = width of
+ * \p src and width = height of \p src.  Rows padded to a multiple of 8 floats and aligned to 32 bytes (e.g. an AlignedImage)
+ * let the AVX kernels use aligned stores.
+ */
+bool transposePlanar(const ImageView& src, const MutableImageView& dst);
+
+/**
+ * Transposes the given planar source (src) image one element at a time.  This is the reference implementation for transposePlanar.
+ *
+ * @param[in] src  2D multi-channel planar image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width.
+ * @param[in] height  Height of \p src
+ * @param[in] width  Width of \p src
+ * @param[in] numChannels  Number of channels in \p src
+ * @param[out] dst  The transposed planar image, with height = \p width and width = \p height.  This is expected to have size >= height * width * numChannels.
+ *
+ * @return true if the image was successfully transposed, false otherwise.
+ */
+bool transposePlanarScalar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst);
+
+/**
+ * Same as transposePlanarScalar, on image views.  See the image view overload of transposePlanar.
+ */
+bool transposePlanarScalar(const ImageView& src, const MutableImageView& dst);
+
+/**
+ * Transposes the given planar source (src) image in blocks of transposeBlockSize x transposeBlockSize elements, so that both
+ * the source rows and the destination rows of a block stay in L1.  Each block is transposed with the 8x8 (AVX) or 4x4 (SSE2)
+ * register kernels of \p level.
+ *
+ * @param[in] src  2D multi-channel planar image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and assumes that stride = \p width.
+ * @param[in] height  Height of \p src
+ * @param[in] width  Width of \p src
+ * @param[in] numChannels  Number of channels in \p src
+ * @param[out] dst  The transposed planar image, with height = \p width and width = \p height.  This is expected to have size >= height * width * numChannels.
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return true if the image was successfully transposed, false otherwise.
+ */
+bool transposePlanarTiled(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level);
+
+/**
+ * Same as transposePlanarTiled, on image views.  See the image view overload of transposePlanar.
+ */
+bool transposePlanarTiled(const ImageView& src, const MutableImageView& dst, SimdLevel level);
+
+/**
+ * Transposes every channel of the given dense planar image in place, so the image needs no second buffer of its size.  A
+ * square channel is transposed by swapping blocks of transposeBlockSize x transposeBlockSize elements across the diagonal
+ * with the register kernels of \p level.  A rectangular channel is transposed in two steps: panels of up to
+ * transposeBlockSize full rows are transposed in place through a scratch panel, which turns each column of a panel into a
+ * short contiguous unit, and then the matrix of units is transposed by following the cycles of the permutation.  Moving
+ * whole units keeps the cycle following cache friendly.  The panel height is the largest divisor of the height (or of the
+ * width, if that is larger) up to transposeBlockSize, so a channel whose height and width are both prime falls back to
+ * moving single elements, which is much slower than transposePlanar.
+ *
+ * The scratch (a panel, and a bit per unit to track the cycles) is a small fraction of the image.
+ *
+ * @param[in,out] image  2D multi-channel planar image with height = \p height width = \p width, number of channels = \p numChannels, and no padding.  Holds the transposed image, with height = \p width and width = \p height, after the call.
+ * @param[in] height  Height of \p image before the call
+ * @param[in] width  Width of \p image before the call
+ * @param[in] numChannels  Number of channels in \p image
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return true if the image was successfully transposed, false if \p image is smaller than \p height * \p width * \p numChannels,
+ *         the scratch couldn't be allocated, or the channel is so large that following the cycles would overflow 64 bits
+ */
+bool transposePlanarInPlace(std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, SimdLevel level);
+
+/**
+ * Edge length, in elements, of the square blocks used by transposePlanarTiled.  A block of the source and the matching
+ * block of the destination together occupy 2 * 4 * 32 * 32 = 8 KiB, which leaves plenty of L1 for the partially
+ * written destination cache lines.
+ */
+const unsigned int transposeBlockSize = 32;
+
+/**
+ * Performs 1D horizontal convolution on a single channel of a planar image and writes the result transposed, so the
+ * convolved row r ends up in column r of \p result.  Calling it again on \p result convolves along the columns of the
+ * original image and transposes back, so two calls are a separable blur in the original orientation without a transpose
+ * pass: the horizontal convolution, transpose, horizontal convolution, transpose sequence of planar7withTranspose with the
+ * transposes folded into the stores of the convolutions.
+ *
+ * The rows are convolved a few hundred pixels at a time into a tile with the SIMD kernels of \p level, and each tile is
+ * transposed into \p result with the register transpose kernels while it is still in L2, so the intermediate image is
+ * written once, already transposed, instead of being written, read back and written again.
+ *
+ * Only the interior pixels are computed, like convolve1DHorizontal: the first and last kernelSize / 2 rows of \p result
+ * are left untouched.
+ *
+ * @param[in] kernel  Kernel taps.  Must have \p kernelSize elements, an odd number.
+ * @param[in] kernelSize  Number of taps in \p kernel
+ * @param[in] image  2D multi-channel planar image with height = \p height, width = \p width, number of channels = \p numChannels, and no padding
+ * @param[in] height  Height of \p image
+ * @param[in] width  Width of \p image
+ * @param[in] numChannels  Number of channels in \p image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Planar image with height = \p width and width = \p height.  Is expected to have size >= size of \p image.
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DHorizontalTransposed(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalTransposed, on image views.  \p image and \p result must be planar, and \p result must have
+ * height = width of \p image and width = height of \p image.  See the image view overload of transposePlanar.
+ */
+bool convolve1DHorizontalTransposed(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalTransposed, for array-ish kernels, running the kernels for the instruction set level returned
+ * by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve1DHorizontalTransposedPlanarSimd(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DHorizontalTransposed(taps.data(), static_cast<unsigned int>(kernel.size()), image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Same as transposePlanar, for images of 8-bit, 16-bit or half precision pixels.  Works on transposeBlockSize x
+ * transposeBlockSize blocks like transposePlanarTiled, but moves the pixels one at a time (the register transpose kernels
+ * are for floats).  A float image uses the non-template overload.
+ *
+ * @tparam PixelT  Pixel type - std::uint8_t, std::uint16_t or tHalf
+ */
+template <typename PixelT>
+bool transposePlanar(const std::vector<PixelT>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<PixelT>& dst) {
+	if (src.size() < static_cast<std::size_t>(height) * width * numChannels) {
+		return false;
+	}
+
+	if (dst.size() < src.size()) {
+		return false;
+	}
+
+	const std::size_t channelSize = static_cast<std::size_t>(height) * width;
+	const std::size_t srcRowStride = width;
+	const std::size_t dstRowStride = height;
+
+	for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+		const PixelT* srcChannel = src.data() + channelIndex * channelSize;
+		PixelT* dstChannel = dst.data() + channelIndex * channelSize;
+
+		for (unsigned int rowBlock = 0; rowBlock < height; rowBlock += transposeBlockSize) {
+			const unsigned int rowEnd = rowBlock + transposeBlockSize < height ? rowBlock + transposeBlockSize : height;
+
+			for (unsigned int colBlock = 0; colBlock < width; colBlock += transposeBlockSize) {
+				const unsigned int colEnd = colBlock + transposeBlockSize < width ? colBlock + transposeBlockSize : width;
+
+				for (unsigned int row = rowBlock; row < rowEnd; row++) {
+					const PixelT* srcRow = srcChannel + row * srcRowStride;
+					PixelT* dstCol = dstChannel + row;
+
+					for (unsigned int col = colBlock; col < colEnd; col++) {
+						dstCol[col * dstRowStride] = srcRow[col];
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Converts an interleaved image to planar layout, one row at a time.  Images with 2, 3 or 4 channels are split with the
+ * register shuffle kernels of \p level, 4 pixels at a time; other channel counts are split in L1-sized blocks of pixels, one
+ * contiguous channel row at a time, instead of scattering every element to a different plane.
+ *
+ * @param[in] src  2D multi-channel interleaved image.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of \p src
+ * @param[in] width  Width of \p src
+ * @param[in] numChannels  Number of channels in \p src
+ * @param[out] dst  The same pixels in planar layout.  Is expected that before the call, \p dst has size >= size of \p src .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return true if the image was successfully converted, false otherwise.
+ */
+bool interleavedToPlanar(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level);
+
+/**
+ * Same as interleavedToPlanar, on image views.  \p src must be interleaved, and \p dst planar with the same dimensions and
+ * number of channels.
+ */
+bool interleavedToPlanar(const ImageView& src, const MutableImageView& dst, SimdLevel level);
+
+/**
+ * Same as the image view overload of interleavedToPlanar, but only converts the rows in [\p rowBegin, \p rowEnd)
+ */
+bool interleavedToPlanarRows(const ImageView& src, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& dst, SimdLevel level);
+
+/**
+ * Converts a planar image to interleaved layout, one row at a time.  The inverse of interleavedToPlanar, with the same kernels.
+ *
+ * @param[in] src  2D multi-channel planar image.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of \p src
+ * @param[in] width  Width of \p src
+ * @param[in] numChannels  Number of channels in \p src
+ * @param[out] dst  The same pixels in interleaved layout.  Is expected that before the call, \p dst has size >= size of \p src .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return true if the image was successfully converted, false otherwise.
+ */
+bool planarToInterleaved(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, SimdLevel level);
+
+/**
+ * Same as planarToInterleaved, on image views.  \p src must be planar, and \p dst interleaved with the same dimensions and
+ * number of channels.
+ */
+bool planarToInterleaved(const ImageView& src, const MutableImageView& dst, SimdLevel level);
+
+/**
+ * Same as the image view overload of planarToInterleaved, but only converts the rows in [\p rowBegin, \p rowEnd)
+ */
+bool planarToInterleavedRows(const ImageView& src, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& dst, SimdLevel level);
+
+/**
+ * Same as interleavedToPlanar, for images of 8-bit, 16-bit or half precision pixels.  Moves the pixels one at a time (the
+ * shuffle kernels are for floats), but writes one contiguous channel row at a time.
+ *
+ * @tparam PixelT  Pixel type - std::uint8_t, std::uint16_t or tHalf
+ */
+template <typename PixelT>
+bool interleavedToPlanar(const std::vector<PixelT>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<PixelT>& dst) {
+	if (src.size() < static_cast<std::size_t>(height) * width * numChannels) {
+		return false;
+	}
+
+	if (dst.size() < src.size()) {
+		return false;
+	}
+
+	const std::size_t channelSize = static_cast<std::size_t>(height) * width;
+
+	for (unsigned int row = 0; row < height; row++) {
+		const PixelT* srcRow = src.data() + static_cast<std::size_t>(row) * width * numChannels;
+
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			PixelT* dstRow = dst.data() + channelIndex * channelSize + static_cast<std::size_t>(row) * width;
+
+			for (unsigned int col = 0; col < width; col++) {
+				dstRow[col] = srcRow[col * numChannels + channelIndex];
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as planarToInterleaved, for images of 8-bit, 16-bit or half precision pixels.  The inverse of the interleavedToPlanar
+ * template.
+ *
+ * @tparam PixelT  Pixel type - std::uint8_t, std::uint16_t or tHalf
+ */
+template <typename PixelT>
+bool planarToInterleaved(const std::vector<PixelT>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<PixelT>& dst) {
+	if (src.size() < static_cast<std::size_t>(height) * width * numChannels) {
+		return false;
+	}
+
+	if (dst.size() < src.size()) {
+		return false;
+	}
+
+	const std::size_t channelSize = static_cast<std::size_t>(height) * width;
+
+	for (unsigned int row = 0; row < height; row++) {
+		PixelT* dstRow = dst.data() + static_cast<std::size_t>(row) * width * numChannels;
+
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			const PixelT* srcRow = src.data() + channelIndex * channelSize + static_cast<std::size_t>(row) * width;
+
+			for (unsigned int col = 0; col < width; col++) {
+				dstRow[col * numChannels + channelIndex] = srcRow[col];
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Same as convolve1DVerticalPlanar, but streams whole rows through the SIMD kernels for the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve1DVerticalPlanarSimd(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DVertical(taps.data(), static_cast<unsigned int>(kernel.size()), ImageLayout::Planar, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Same as convolve1DVerticalInterleaved, but streams whole rows through the SIMD kernels for the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve1DVerticalInterleavedSimd(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DVertical(taps.data(), static_cast<unsigned int>(kernel.size()), ImageLayout::Interleaved, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Convolves a single channel of a planar image with \p kernel horizontally and then vertically in one fused sweep, using
+ * convolve2DSeparable with the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve2DSeparablePlanar(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	const unsigned int kernelSize = static_cast<unsigned int>(kernel.size());
+	return kernelTaps(kernel, taps) && convolve2DSeparable(taps.data(), kernelSize, taps.data(), kernelSize, ImageLayout::Planar, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Convolves a single channel of an interleaved image with \p kernel horizontally and then vertically in one fused sweep,
+ * using convolve2DSeparable with the instruction set level returned by getSimdLevel().
+ */
+template <typename kernelT>
+bool convolve2DSeparableInterleaved(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+	tKernelTaps taps;
+	const unsigned int kernelSize = static_cast<unsigned int>(kernel.size());
+	return kernelTaps(kernel, taps) && convolve2DSeparable(taps.data(), kernelSize, taps.data(), kernelSize, ImageLayout::Interleaved, image, height, width, numChannels, channelIndex, result, getSimdLevel());
+}
+
+/**
+ * Same as convolve1DHorizontalInterleavedAllChannels with the instruction set level returned by getSimdLevel(), for array-ish kernels.
+ */
+template <typename kernelT>
+bool convolve1DHorizontalInterleavedAll(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DHorizontalInterleavedAllChannels(taps.data(), static_cast<unsigned int>(kernel.size()), image, height, width, numChannels, result, getSimdLevel());
+}
+
+/**
+ * Same as convolve1DVerticalInterleavedAllChannels with the instruction set level returned by getSimdLevel(), for array-ish kernels.
+ */
+template <typename kernelT>
+bool convolve1DVerticalInterleavedAll(const kernelT& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result) {
+	tKernelTaps taps;
+	return kernelTaps(kernel, taps) && convolve1DVerticalInterleavedAllChannels(taps.data(), static_cast<unsigned int>(kernel.size()), image, height, width, numChannels, result, getSimdLevel());
+}
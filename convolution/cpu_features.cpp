@@ -0,0 +1,180 @@
+#include "cpu_features.h"
+
+#include <atomic>
+
+#if defined(CONVOLUTION_X86_SIMD)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(CONVOLUTION_X86_SIMD)
+namespace {
+	void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (int i = 0; i < 4; i++) {
+			regs[i] = static_cast<unsigned int>(info[i]);
+		}
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		unsigned int eax = 0;
+		unsigned int edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+	}
+
+	SimdLevel queryCpu() {
+		unsigned int regs[4] = { 0, 0, 0, 0 };
+
+		cpuid(0, 0, regs);
+		const unsigned int maxLeaf = regs[0];
+		if (maxLeaf < 1) {
+			return SimdLevel::Scalar;
+		}
+
+		cpuid(1, 0, regs);
+		const unsigned int leaf1Ecx = regs[2];
+		const unsigned int leaf1Edx = regs[3];
+
+		if ((leaf1Edx & (1U << 26)) == 0) {
+			return SimdLevel::Scalar;
+		}
+
+		// AVX needs both CPU support and the OS saving the YMM state on context switches
+		const bool osxsave = (leaf1Ecx & (1U << 27)) != 0;
+		const bool avx = (leaf1Ecx & (1U << 28)) != 0;
+		if (!osxsave || !avx) {
+			return SimdLevel::SSE2;
+		}
+
+		const unsigned long long xcr0 = xgetbv0();
+		if ((xcr0 & 0x6) != 0x6) {
+			return SimdLevel::SSE2;
+		}
+
+		if (maxLeaf < 7) {
+			return SimdLevel::AVX;
+		}
+
+		cpuid(7, 0, regs);
+		const unsigned int leaf7Ebx = regs[1];
+
+		// every AVX2 CPU also has F16C, which the AVX2 kernels use for half precision conversions
+		const bool fma = (leaf1Ecx & (1U << 12)) != 0;
+		const bool f16c = (leaf1Ecx & (1U << 29)) != 0;
+		const bool avx2 = (leaf7Ebx & (1U << 5)) != 0;
+		if (!fma || !f16c || !avx2) {
+			return SimdLevel::AVX;
+		}
+
+		// AVX-512 additionally needs the opmask and ZMM state enabled by the OS
+		const bool avx512f = (leaf7Ebx & (1U << 16)) != 0;
+		if (!avx512f || ((xcr0 & 0xE6) != 0xE6)) {
+			return SimdLevel::AVX2;
+		}
+
+		return SimdLevel::AVX512;
+	}
+
+	std::string queryBrandString() {
+		unsigned int regs[4] = { 0, 0, 0, 0 };
+
+		cpuid(0x80000000, 0, regs);
+		if (regs[0] < 0x80000004) {
+			return "";
+		}
+
+		// 3 leaves of 16 characters each, NUL-padded
+		char brand[49] = {};
+		for (unsigned int leaf = 0; leaf < 3; leaf++) {
+			cpuid(0x80000002 + leaf, 0, regs);
+			for (unsigned int i = 0; i < 4; i++) {
+				for (unsigned int byte = 0; byte < 4; byte++) {
+					brand[leaf * 16 + i * 4 + byte] = static_cast<char>((regs[i] >> (8 * byte)) & 0xFF);
+				}
+			}
+		}
+
+		std::string name(brand);
+		const std::size_t first = name.find_first_not_of(' ');
+		const std::size_t last = name.find_last_not_of(' ');
+		return first == std::string::npos ? std::string() : name.substr(first, last - first + 1);
+	}
+
+	std::atomic<int> activeLevel{ -1 };
+}
+#endif
+
+SimdLevel detectSimdLevel() {
+#if defined(CONVOLUTION_X86_SIMD)
+	static const SimdLevel detected = queryCpu();
+	return detected;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel getSimdLevel() {
+#if defined(CONVOLUTION_X86_SIMD)
+	const int level = activeLevel.load(std::memory_order_relaxed);
+	if (level < 0) {
+		return detectSimdLevel();
+	}
+
+	return static_cast<SimdLevel>(level);
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel setSimdLevel(SimdLevel level) {
+#if defined(CONVOLUTION_X86_SIMD)
+	if (static_cast<int>(level) > static_cast<int>(detectSimdLevel())) {
+		level = detectSimdLevel();
+	}
+
+	activeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+	return level;
+#else
+	(void)level;
+	return SimdLevel::Scalar;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+	switch (level) {
+	case SimdLevel::SSE2:
+		return "SSE2";
+	case SimdLevel::AVX:
+		return "AVX";
+	case SimdLevel::AVX2:
+		return "AVX2";
+	case SimdLevel::AVX512:
+		return "AVX512";
+	default:
+		return "Scalar";
+	}
+}
+
+std::string cpuModelName() {
+#if defined(CONVOLUTION_X86_SIMD)
+	static const std::string brand = queryBrandString();
+	if (!brand.empty()) {
+		return brand;
+	}
+#endif
+
+	return "unknown";
+}
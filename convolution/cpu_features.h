@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Instruction set levels that the convolution library has specialized kernels for.  Levels are ordered, so a CPU that
+ * supports a given level also supports every level below it.
+ */
+enum class SimdLevel {
+	Scalar,
+	SSE2,
+	AVX,
+	AVX2,	// AVX2 + FMA3 + F16C
+	AVX512	// AVX-512F
+};
+
+/**
+ * Queries the CPU (via CPUID/XGETBV) for the highest instruction set level that both the CPU and the OS support, and
+ * that the library was built with kernels for.  The query is only performed once; subsequent calls return the cached value.
+ *
+ * @return  The highest usable SimdLevel on this machine
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * Returns the instruction set level used by the functions that select their kernels at runtime.  Defaults to
+ * detectSimdLevel().
+ *
+ * @return  The active SimdLevel
+ */
+SimdLevel getSimdLevel();
+
+/**
+ * Overrides the instruction set level used by the functions that select their kernels at runtime.  Levels above
+ * detectSimdLevel() are clamped to detectSimdLevel().
+ *
+ * @param[in] level  Requested instruction set level
+ *
+ * @return  The level that is active after the call
+ */
+SimdLevel setSimdLevel(SimdLevel level);
+
+/**
+ * @param[in] level  Instruction set level
+ *
+ * @return  Human-readable name of \p level, e.g. "AVX2"
+ */
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * Reads the processor brand string (CPUID leaves 0x80000002 to 0x80000004), e.g. "Intel(R) Core(TM) i7-8700 CPU @ 3.20GHz",
+ * with the padding spaces removed.  Identifies the machine that measurements like the planner's were taken on.
+ *
+ * @return  The brand string, or "unknown" if the CPU doesn't report one or isn't an x86 CPU
+ */
+std::string cpuModelName();
@@ -0,0 +1,468 @@
+#include "fft_convolution.h"
+#include "buffer_pool.h"
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+/**
+ * Lines convolved per transform: one in the real and one in the imaginary part of each of the fftLanes complex sequences.  The
+ * kernel is real, so the two don't mix: the real part of the inverse transform is the convolution of the first line and
+ * the imaginary part that of the second.
+ */
+static const unsigned int fftLinesPerTransform = 2 * fftLanes;
+
+/**
+ * Largest number of points per block.  The real and imaginary parts of a block of 4096 points are 512 KiB, which still
+ * stays in L2 from the forward to the inverse transform; longer blocks would only save a few percent of the overlap.
+ */
+static const unsigned int maxFftBlockSize = 4096;
+
+/**
+ * Bytes of blocks the vertical convolution transforms at once, and the most transforms it makes of them (see convolveLinesFft)
+ */
+static const std::size_t fftPanelBytes = 1024 * 1024;
+static const unsigned int maxFftColumnPanel = 4;
+
+/**
+ * Number of kernel spectra kept by fftPlan.  A few kernels are in use at any time (e.g. one per pass of a blur).
+ */
+static const unsigned int fftPlanCacheSize = 16;
+
+/**
+ * What the FFT convolution of a kernel with blocks of \p size points needs besides the image
+ */
+typedef struct fftPlan {
+	std::vector<float> kernel;		// taps the spectrum was computed for
+	unsigned int size;			// points per block, a power of 2
+	std::vector<float> twiddleRe;		// exp(-2 pi i k / size) for k < size / 2
+	std::vector<float> twiddleIm;
+	std::vector<float> spectrumRe;		// spectrum of the reversed kernel in the bit-reversed order of fftForwardLanes, times 1 / size
+	std::vector<float> spectrumIm;
+} tFftPlan;
+
+/**
+ * @return  \p index with its log2(\p size) low bits in reverse order
+ */
+static unsigned int bitReverse(unsigned int index, unsigned int size) {
+	unsigned int reversed = 0;
+	for (unsigned int bit = 1; bit < size; bit *= 2) {
+		reversed = (reversed << 1) | ((index & bit) != 0 ? 1U : 0U);
+	}
+
+	return reversed;
+}
+
+static std::shared_ptr<const tFftPlan> makeFftPlan(const float* kernel, unsigned int kernelSize, unsigned int size) {
+	std::shared_ptr<tFftPlan> plan = std::make_shared<tFftPlan>();
+	plan->kernel.assign(kernel, kernel + kernelSize);
+	plan->size = size;
+
+	// exp(-2 pi i k / size) for every k, in double so the spectrum below is exact to float precision
+	const double pi = 3.14159265358979323846;
+	std::vector<double> cosines(size);
+	std::vector<double> sines(size);
+	for (unsigned int k = 0; k < size; k++) {
+		cosines[k] = std::cos(2.0 * pi * k / size);
+		sines[k] = -std::sin(2.0 * pi * k / size);
+	}
+
+	plan->twiddleRe.assign(cosines.begin(), cosines.begin() + size / 2);
+	plan->twiddleIm.assign(sines.begin(), sines.begin() + size / 2);
+
+	// the library correlates (output pixel x reads the taps at x - center + k), which is a convolution with the reversed
+	// kernel.  Its spectrum is a plain DFT, which is computed once per plan, so the O(size * kernelSize) sum doesn't matter.
+	plan->spectrumRe.resize(size);
+	plan->spectrumIm.resize(size);
+	for (unsigned int frequency = 0; frequency < size; frequency++) {
+		double re = 0.0;
+		double im = 0.0;
+		for (unsigned int tap = 0; tap < kernelSize; tap++) {
+			const unsigned int k = static_cast<unsigned int>((static_cast<unsigned long long>(frequency) * tap) % size);
+			re += kernel[kernelSize - 1 - tap] * cosines[k];
+			im += kernel[kernelSize - 1 - tap] * sines[k];
+		}
+
+		const unsigned int position = bitReverse(frequency, size);
+		plan->spectrumRe[position] = static_cast<float>(re / size);
+		plan->spectrumIm[position] = static_cast<float>(im / size);
+	}
+
+	return plan;
+}
+
+/**
+ * Returns the plan for \p kernel and blocks of \p size points, from the cache if it was made before
+ */
+static std::shared_ptr<const tFftPlan> fftPlan(const float* kernel, unsigned int kernelSize, unsigned int size) {
+	static std::mutex mutex;
+	static std::vector<std::shared_ptr<const tFftPlan>> plans;	// least recently used first
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto it = plans.begin(); it != plans.end(); ++it) {
+		const tFftPlan& plan = **it;
+		if ((plan.size == size) && (plan.kernel.size() == kernelSize) && std::equal(plan.kernel.begin(), plan.kernel.end(), kernel)) {
+			const std::shared_ptr<const tFftPlan> found = *it;
+			plans.erase(it);
+			plans.push_back(found);
+			return found;
+		}
+	}
+
+	plans.push_back(makeFftPlan(kernel, kernelSize, size));
+	if (plans.size() > fftPlanCacheSize) {
+		plans.erase(plans.begin());
+	}
+
+	return plans.back();
+}
+
+/**
+ * Picks the number of points per block for lines of \p length.  A block of size points yields size - kernelSize + 1
+ * outputs for about size * log2(size) work, so larger blocks waste less on the overlap, until the last block of the line
+ * is mostly padding.  Returns the size with the least total work for the line.
+ */
+static unsigned int fftBlockSize(unsigned int kernelSize, unsigned int length) {
+	const unsigned int numOutputs = length - kernelSize + 1;
+
+	unsigned int bestSize = 0;
+	double bestCost = 0.0;
+	for (unsigned int size = 128; (size <= maxFftBlockSize) || (bestSize == 0); size *= 2) {
+		if (size < kernelSize) {
+			continue;
+		}
+
+		const unsigned int outputsPerBlock = size - kernelSize + 1;
+		const unsigned int numBlocks = (numOutputs + outputsPerBlock - 1) / outputsPerBlock;
+		const double cost = static_cast<double>(numBlocks) * size * std::log2(static_cast<double>(size));
+
+		if ((bestSize == 0) || (cost < bestCost)) {
+			bestSize = size;
+			bestCost = cost;
+		}
+	}
+
+	return bestSize;
+}
+
+/**
+ * One channel of an image seen as lines to convolve along: point p of line l is at src[l * srcLineStride + p * srcPointStride],
+ * and its result at dst[l * dstLineStride + p * dstPointStride].  The lines are the rows of the channel for the horizontal
+ * convolution, and its columns for the vertical one.  A channel can be more than 2^32 floats, so the offset of the first
+ * line and point of a batch is computed in 64 bits.
+ */
+typedef struct fftLines {
+	const float* src;
+	float* dst;
+	unsigned int numLines;
+	unsigned int length;
+	unsigned int srcLineStride;
+	unsigned int srcPointStride;
+	unsigned int dstLineStride;
+	unsigned int dstPointStride;
+} tFftLines;
+
+/**
+ * Loads points [\p begin, \p begin + \p count) of lines [\p firstLine, \p firstLine + \p numLines) into the first \p count
+ * points of \p blocks.  Consecutive runs of fftLanes lines go to the lanes of consecutive blocks of \p size points, so
+ * block g holds lines firstLine + g * fftLanes and up, and starts at blocks + g * size * fftLanes.  The points and lanes
+ * past the lines are zeroed, up to the end of the last transform of fftLinesPerTransform lines.
+ */
+static void loadLines(const tFftLines& lines, unsigned int firstLine, unsigned int numLines, unsigned int begin, unsigned int count, unsigned int size, float* blocks, transposeBlockFn transposeBlock) {
+	const unsigned int numBlocks = (numLines + fftLanes - 1) / fftLanes;
+	const float* src = lines.src + static_cast<std::size_t>(firstLine) * lines.srcLineStride + static_cast<std::size_t>(begin) * lines.srcPointStride;
+
+	// up to the imaginary parts of the last transform, which may have no lines at all
+	const unsigned int numTransformBlocks = 2 * ((numLines + fftLinesPerTransform - 1) / fftLinesPerTransform);
+	for (unsigned int block = 0; block < numTransformBlocks; block++) {
+		float* blockStart = blocks + block * size * fftLanes;
+		if (numLines < (block + 1) * fftLanes) {
+			std::fill(blockStart, blockStart + count * fftLanes, 0.0f);
+		}
+		std::fill(blockStart + count * fftLanes, blockStart + size * fftLanes, 0.0f);
+	}
+
+	if (lines.srcPointStride == 1) {
+		// rows of a planar channel: each block is the transpose of fftLanes rows
+		for (unsigned int block = 0; block < numBlocks; block++) {
+			const unsigned int blockLines = std::min(fftLanes, numLines - block * fftLanes);
+			transposeBlock(src + static_cast<std::size_t>(block * fftLanes) * lines.srcLineStride, lines.srcLineStride, blocks + block * size * fftLanes, fftLanes, blockLines, count);
+		}
+	}
+	else if (lines.srcLineStride == 1) {
+		// columns of a planar channel: every point is a run of numLines neighbouring pixels of a row, which is read in one go
+		// for all the blocks, so each row is visited once
+		for (unsigned int point = 0; point < count; point++) {
+			const float* srcPoint = src + static_cast<std::size_t>(point) * lines.srcPointStride;
+
+			for (unsigned int block = 0; block < numBlocks; block++) {
+				const unsigned int blockLines = std::min(fftLanes, numLines - block * fftLanes);
+				std::memcpy(blocks + (block * size + point) * fftLanes, srcPoint + block * fftLanes, blockLines * sizeof(float));
+			}
+		}
+	}
+	else if (lines.srcLineStride < lines.srcPointStride) {
+		// columns of an interleaved channel: still a row at a time
+		for (unsigned int point = 0; point < count; point++) {
+			const float* srcPoint = src + static_cast<std::size_t>(point) * lines.srcPointStride;
+
+			for (unsigned int line = 0; line < numLines; line++) {
+				blocks[((line / fftLanes) * size + point) * fftLanes + line % fftLanes] = srcPoint[static_cast<std::size_t>(line) * lines.srcLineStride];
+			}
+		}
+	}
+	else {
+		// rows of an interleaved channel
+		for (unsigned int line = 0; line < numLines; line++) {
+			float* lane = blocks + (line / fftLanes) * size * fftLanes + line % fftLanes;
+			const float* srcLine = src + static_cast<std::size_t>(line) * lines.srcLineStride;
+
+			for (unsigned int point = 0; point < count; point++) {
+				lane[point * fftLanes] = srcLine[static_cast<std::size_t>(point) * lines.srcPointStride];
+			}
+		}
+	}
+}
+
+/**
+ * Stores points [\p first, \p first + \p count) of \p blocks into points [\p begin, \p begin + \p count) of lines
+ * [\p firstLine, \p firstLine + \p numLines).  The lines are spread over the blocks like in loadLines.
+ */
+static void storeLines(const tFftLines& lines, unsigned int firstLine, unsigned int numLines, unsigned int begin, unsigned int count, unsigned int size, const float* blocks, unsigned int first, transposeBlockFn transposeBlock) {
+	const unsigned int numBlocks = (numLines + fftLanes - 1) / fftLanes;
+	float* dst = lines.dst + static_cast<std::size_t>(firstLine) * lines.dstLineStride + static_cast<std::size_t>(begin) * lines.dstPointStride;
+
+	if (lines.dstPointStride == 1) {
+		for (unsigned int block = 0; block < numBlocks; block++) {
+			const unsigned int blockLines = std::min(fftLanes, numLines - block * fftLanes);
+			transposeBlock(blocks + (block * size + first) * fftLanes, fftLanes, dst + static_cast<std::size_t>(block * fftLanes) * lines.dstLineStride, lines.dstLineStride, count, blockLines);
+		}
+	}
+	else if (lines.dstLineStride == 1) {
+		for (unsigned int point = 0; point < count; point++) {
+			float* dstPoint = dst + static_cast<std::size_t>(point) * lines.dstPointStride;
+
+			for (unsigned int block = 0; block < numBlocks; block++) {
+				const unsigned int blockLines = std::min(fftLanes, numLines - block * fftLanes);
+				std::memcpy(dstPoint + block * fftLanes, blocks + (block * size + first + point) * fftLanes, blockLines * sizeof(float));
+			}
+		}
+	}
+	else if (lines.dstLineStride < lines.dstPointStride) {
+		for (unsigned int point = 0; point < count; point++) {
+			float* dstPoint = dst + static_cast<std::size_t>(point) * lines.dstPointStride;
+
+			for (unsigned int line = 0; line < numLines; line++) {
+				dstPoint[static_cast<std::size_t>(line) * lines.dstLineStride] = blocks[((line / fftLanes) * size + first + point) * fftLanes + line % fftLanes];
+			}
+		}
+	}
+	else {
+		for (unsigned int line = 0; line < numLines; line++) {
+			const float* lane = blocks + ((line / fftLanes) * size + first) * fftLanes + line % fftLanes;
+			float* dstLine = dst + static_cast<std::size_t>(line) * lines.dstLineStride;
+
+			for (unsigned int point = 0; point < count; point++) {
+				dstLine[static_cast<std::size_t>(point) * lines.dstPointStride] = lane[point * fftLanes];
+			}
+		}
+	}
+}
+
+/**
+ * Multiplies every lane of the transformed block by the kernel spectrum.  Both are in bit-reversed order, so the order
+ * doesn't matter here.
+ */
+static void multiplySpectrum(float* re, float* im, const tFftPlan& plan) {
+	for (unsigned int point = 0; point < plan.size; point++) {
+		const float spectrumRe = plan.spectrumRe[point];
+		const float spectrumIm = plan.spectrumIm[point];
+		float* pointRe = re + point * fftLanes;
+		float* pointIm = im + point * fftLanes;
+
+		for (unsigned int lane = 0; lane < fftLanes; lane++) {
+			const float productRe = pointRe[lane] * spectrumRe - pointIm[lane] * spectrumIm;
+			const float productIm = pointRe[lane] * spectrumIm + pointIm[lane] * spectrumRe;
+			pointRe[lane] = productRe;
+			pointIm[lane] = productIm;
+		}
+	}
+}
+
+/**
+ * Convolves the interior points of every line with overlap-save: the block that starts at point b yields the outputs of
+ * points [b + center, b + size - center), from the circular convolution of its size points, whose first kernelSize - 1
+ * outputs wrap around and are dropped.  Lines must be at least \p kernelSize long.
+ *
+ * @return  true if the lines were convolved, false if the blocks couldn't be allocated
+ */
+static bool convolveLinesFft(const float* kernel, unsigned int kernelSize, const tFftLines& lines, SimdLevel level) {
+	const unsigned int size = fftBlockSize(kernelSize, lines.length);
+	const std::shared_ptr<const tFftPlan> plan = fftPlan(kernel, kernelSize, size);
+	const tSimdKernels& kernels = getSimdKernels(level);
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int numOutputs = lines.length - kernelSize + 1;
+	const unsigned int outputsPerBlock = size - kernelSize + 1;
+
+	// columns are loaded a row at a time, and a row of a few transforms' worth of columns costs little more to read than
+	// one, so they are transformed several at a time, as long as their blocks stay in L2
+	const std::size_t transformBytes = 2 * size * fftLanes * sizeof(float);
+	const unsigned int transformsPerPanel = lines.srcLineStride < lines.srcPointStride ? static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(maxFftColumnPanel, fftPanelBytes / transformBytes))) : 1;
+	const unsigned int linesPerPanel = transformsPerPanel * fftLinesPerTransform;
+
+	const PooledBuffer blockBuffer = scratchBufferPool().acquire(transformsPerPanel * transformBytes);
+	float* blocks = blockBuffer.data<float>();
+	if (blocks == nullptr) {
+		return false;
+	}
+
+	for (unsigned int firstLine = 0; firstLine < lines.numLines; firstLine += linesPerPanel) {
+		const unsigned int numLines = std::min(linesPerPanel, lines.numLines - firstLine);
+		const unsigned int numTransforms = (numLines + fftLinesPerTransform - 1) / fftLinesPerTransform;
+
+		for (unsigned int output = 0; output < numOutputs; output += outputsPerBlock) {
+			// output pixel center + output is the first one of the block, and its first tap is point output
+			const unsigned int count = std::min(size, lines.length - output);
+			loadLines(lines, firstLine, numLines, output, count, size, blocks, kernels.transposeBlock);
+
+			for (unsigned int transform = 0; transform < numTransforms; transform++) {
+				// the real parts are one block of lines and the imaginary parts the next
+				float* re = blocks + 2 * transform * size * fftLanes;
+				float* im = re + size * fftLanes;
+
+				kernels.fftForwardLanes(re, im, size, plan->twiddleRe.data(), plan->twiddleIm.data());
+				multiplySpectrum(re, im, *plan);
+				kernels.fftInverseLanes(re, im, size, plan->twiddleRe.data(), plan->twiddleIm.data());
+			}
+
+			storeLines(lines, firstLine, numLines, center + output, std::min(outputsPerBlock, numOutputs - output), size, blocks, kernelSize - 1, kernels.transposeBlock);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Checks that \p image and \p result are valid views of the same shape, and that \p channelIndex is one of their channels
+ */
+static bool fftViewsValid(const ImageView& image, unsigned int channelIndex, const ImageView& result) {
+	if (!isValidImageView(image) || !isValidImageView(result) || !haveSameShape(image, result)) {
+		return false;
+	}
+
+	return channelIndex < image.numChannels;
+}
+
+/**
+ * Checks that \p image holds a dense image of the given dimensions and \p result is at least as large
+ */
+static bool fftDenseSizesValid(const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, const std::vector<float>& result) {
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	return static_cast<std::size_t>(height) * width * numChannels <= image.size();
+}
+
+unsigned int fftCrossoverKernelSize(SimdLevel level) {
+	// below AVX2 the direct convolution runs the scalar kernels
+	switch (getSimdKernels(level).level) {
+	case SimdLevel::AVX512:
+		return 71;
+	case SimdLevel::AVX2:
+		return 63;
+	default:
+		return 15;
+	}
+}
+
+bool convolve1DHorizontalFft(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	if (!fftDenseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DHorizontalFft(kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve1DHorizontalFft(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!fftViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	// no pixel of a row this narrow has a full neighbourhood
+	if (image.width < kernelSize) {
+		return true;
+	}
+
+	const tFftLines rows{ image.row(channelIndex, 0), result.row(channelIndex, 0), image.height, image.width, image.rowPitch, image.pixelStride(), result.rowPitch, result.pixelStride() };
+	return convolveLinesFft(kernel, kernelSize, rows, level);
+}
+
+bool convolve1DVerticalFft(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	if (!fftDenseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve1DVerticalFft(kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve1DVerticalFft(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!fftViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	// no pixel of a column this short has a full neighbourhood
+	if (image.height < kernelSize) {
+		return true;
+	}
+
+	const tFftLines columns{ image.row(channelIndex, 0), result.row(channelIndex, 0), image.width, image.height, image.pixelStride(), image.rowPitch, result.pixelStride(), result.rowPitch };
+	return convolveLinesFft(kernel, kernelSize, columns, level);
+}
+
+bool convolve1DHorizontalAuto(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	if (kernelSize >= fftCrossoverKernelSize(level)) {
+		return convolve1DHorizontalFft(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, result, level);
+	}
+
+	return convolve1DHorizontal(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, result, level);
+}
+
+bool convolve1DHorizontalAuto(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	if (kernelSize >= fftCrossoverKernelSize(level)) {
+		return convolve1DHorizontalFft(kernel, kernelSize, image, channelIndex, result, level);
+	}
+
+	return convolve1DHorizontal(kernel, kernelSize, image, channelIndex, result, level);
+}
+
+bool convolve1DVerticalAuto(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	if (kernelSize >= fftCrossoverKernelSize(level)) {
+		return convolve1DVerticalFft(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, result, level);
+	}
+
+	return convolve1DVertical(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, result, level);
+}
+
+bool convolve1DVerticalAuto(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	if (kernelSize >= fftCrossoverKernelSize(level)) {
+		return convolve1DVerticalFft(kernel, kernelSize, image, channelIndex, result, level);
+	}
+
+	return convolve1DVertical(kernel, kernelSize, image, channelIndex, result, level);
+}
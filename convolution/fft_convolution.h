@@ -0,0 +1,92 @@
+#pragma once
+
+#include "convolution.h"
+
+#include <vector>
+
+// Convolution with wide kernels in the frequency domain.  The direct kernels cost kernelSize multiply-adds per pixel; these
+// cost a few dozen operations per pixel whatever the kernel size, so they win for wide blurs.  Each line (a row for the
+// horizontal and a column for the vertical convolution) is cut into overlapping blocks of a power of 2 points, and every
+// block is transformed, multiplied by the spectrum of the kernel and transformed back (overlap-save).  32 lines are
+// transformed at once, 16 in the real and 16 in the imaginary parts of 16 complex transforms whose butterflies run in the
+// SIMD lanes.
+//
+// The kernel spectra are cached per kernel and block size, so calls for every channel of an image, or for every frame of a
+// video, transform the kernel once.
+//
+// The results are the same pixels as convolve1DHorizontal / convolve1DVertical up to rounding: the difference is at most
+// 1e-5 * (largest absolute input value) * (sum of the absolute taps).  Like them, the edge pixels without a full
+// neighbourhood are left untouched.
+
+/**
+ * Smallest kernel size at which convolve1DHorizontalFft and convolve1DVerticalFft are faster than the direct kernels of
+ * \p level, measured with the -k sweep of interleaved_vs_planar on a 2000 x 3000 x 4 planar image.  The *Auto functions
+ * switch to the FFT at this size.
+ *
+ * @param[in] level  Instruction set level of the kernels.  Clamped to the levels the library was built with.
+ */
+unsigned int fftCrossoverKernelSize(SimdLevel level);
+
+/**
+ * Performs 1D horizontal convolution on a single channel of an input image in the frequency domain.  Computes the same
+ * pixels as convolve1DHorizontal, up to rounding (see above), at a cost per pixel that barely grows with \p kernelSize.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DHorizontalFft(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalFft, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve1DHorizontalFft(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution on a single channel of an input image in the frequency domain.  Computes the same pixels
+ * as convolve1DVertical, up to rounding (see above).  The columns are transformed 32 at a time, so every point of a block
+ * is a run of 32 consecutive floats of a planar row.
+ *
+ * See convolve1DHorizontalFft for the parameters.
+ */
+bool convolve1DVerticalFft(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVerticalFft, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve1DVerticalFft(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D horizontal convolution with convolve1DHorizontalFft if \p kernelSize >= fftCrossoverKernelSize(\p level), and
+ * with convolve1DHorizontal otherwise.
+ *
+ * See convolve1DHorizontalFft for the parameters.
+ */
+bool convolve1DHorizontalAuto(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalAuto, on image views
+ */
+bool convolve1DHorizontalAuto(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution with convolve1DVerticalFft if \p kernelSize >= fftCrossoverKernelSize(\p level), and
+ * with convolve1DVertical otherwise.
+ *
+ * See convolve1DHorizontalFft for the parameters.
+ */
+bool convolve1DVerticalAuto(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve1DVerticalAuto, on image views
+ */
+bool convolve1DVerticalAuto(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
@@ -0,0 +1,295 @@
+#include "frame_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+	typedef std::chrono::steady_clock frameClock;
+
+	/**
+	 * Queue of slot indices passed from one stage to the next.  push waits while the queue holds \p capacity slots, and
+	 * pop waits until there is a slot, or returns false once the queue is closed and empty.
+	 */
+	class SlotQueue {
+	public:
+		explicit SlotQueue(unsigned int capacity)
+			: capacity(capacity), closed(false) {
+		}
+
+		void push(unsigned int slot) {
+			std::unique_lock<std::mutex> lock(mutex);
+			notFull.wait(lock, [this]() { return slots.size() < capacity; });
+			slots.push_back(slot);
+			notEmpty.notify_one();
+		}
+
+		bool pop(unsigned int& slot) {
+			std::unique_lock<std::mutex> lock(mutex);
+			notEmpty.wait(lock, [this]() { return !slots.empty() || closed; });
+			if (slots.empty()) {
+				return false;
+			}
+
+			slot = slots.front();
+			slots.pop_front();
+			notFull.notify_one();
+			return true;
+		}
+
+		/**
+		 * Tells the next stage that no more slots follow
+		 */
+		void close() {
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+			notEmpty.notify_all();
+		}
+
+	private:
+		const unsigned int capacity;
+		std::mutex mutex;
+		std::condition_variable notEmpty;
+		std::condition_variable notFull;
+		std::deque<unsigned int> slots;
+		bool closed;
+	};
+
+	/**
+	 * Running total of the durations of a step, turned into a tFrameTiming at the end of a run
+	 */
+	typedef struct timingSum {
+		void add(double seconds) {
+			totalSeconds += seconds;
+			maxSeconds = std::max(maxSeconds, seconds);
+			count++;
+		}
+
+		tFrameTiming timing() const {
+			return tFrameTiming{ count > 0 ? totalSeconds / count : 0.0, maxSeconds };
+		}
+
+		double totalSeconds;
+		double maxSeconds;
+		unsigned int count;
+	} tTimingSum;
+
+	double secondsBetween(frameClock::time_point start, frameClock::time_point end) {
+		return std::chrono::duration<double>(end - start).count();
+	}
+
+	/**
+	 * Fills \p stats from the timings of a run
+	 */
+	void finishStats(const std::array<tTimingSum, numFrameStages>& stageSums, const tTimingSum& latencySum, double wallSeconds, tFramePipelineStats& stats) {
+		for (unsigned int stage = 0; stage < numFrameStages; stage++) {
+			stats.stages[stage] = stageSums[stage].timing();
+		}
+
+		stats.numFrames = latencySum.count;
+		stats.latency = latencySum.timing();
+		stats.wallSeconds = wallSeconds;
+		stats.framesPerSecond = wallSeconds > 0.0 ? latencySum.count / wallSeconds : 0.0;
+	}
+}
+
+/**
+ * Buffers of a frame in flight, from its load until its store returns
+ */
+struct FramePipeline::frameSlot {
+	frameSlot(unsigned int height, unsigned int width, unsigned int numChannels)
+		: input(height, width, numChannels, ImageLayout::Interleaved),
+		planar(height, width, numChannels, ImageLayout::Planar),
+		intermediate(height, width, numChannels, ImageLayout::Planar),
+		result(height, width, numChannels, ImageLayout::Planar),
+		frameIndex(0) {
+	}
+
+	AlignedImage input;
+	AlignedImage planar;
+	AlignedImage intermediate;
+	AlignedImage result;
+	unsigned int frameIndex;
+	frameClock::time_point loadStart;
+};
+
+FramePipeline::FramePipeline(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize,
+	unsigned int height, unsigned int width, unsigned int numChannels, unsigned int numSlots, SimdLevel level)
+	: horizontalTaps(horizontalKernel, horizontalKernel + horizontalKernelSize), verticalTaps(verticalKernel, verticalKernel + verticalKernelSize),
+	height(height), width(width), numChannels(numChannels), level(level) {
+
+	if (!valid()) {
+		return;
+	}
+
+	const unsigned int count = numSlots > 0 ? numSlots : numFrameStages;
+	for (unsigned int slot = 0; slot < count; slot++) {
+		frameSlots.emplace_back(new tFrameSlot(height, width, numChannels));
+	}
+}
+
+FramePipeline::~FramePipeline() = default;
+
+unsigned int FramePipeline::slots() const {
+	return static_cast<unsigned int>(frameSlots.size());
+}
+
+bool FramePipeline::valid() const {
+	// only operate on odd-sized kernels
+	if ((horizontalTaps.size() % 2 != 1) || (verticalTaps.size() % 2 != 1)) {
+		return false;
+	}
+
+	return (height > 0) && (width > 0) && (numChannels > 0);
+}
+
+bool FramePipeline::runStage(FrameStage stage, tFrameSlot& slot, const frameSourceFn& source, const frameSinkFn& sink) {
+	const unsigned int horizontalKernelSize = static_cast<unsigned int>(horizontalTaps.size());
+	const unsigned int verticalKernelSize = static_cast<unsigned int>(verticalTaps.size());
+
+	bool succeeded = true;
+	switch (stage) {
+	case FrameStage::Load:
+		succeeded = source(slot.frameIndex, slot.input.view());
+		break;
+	case FrameStage::Convert:
+		succeeded = interleavedToPlanar(slot.input.view(), slot.planar.view(), level);
+		break;
+	case FrameStage::Horizontal:
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DHorizontal(horizontalTaps.data(), horizontalKernelSize, slot.planar.view(), channelIndex, slot.intermediate.view(), level);
+		}
+		break;
+	case FrameStage::Vertical:
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DVertical(verticalTaps.data(), verticalKernelSize, slot.intermediate.view(), channelIndex, slot.result.view(), level);
+		}
+		break;
+	case FrameStage::Store:
+		succeeded = sink(slot.frameIndex, slot.result.view());
+		break;
+	}
+
+	return succeeded;
+}
+
+bool FramePipeline::run(unsigned int numFrames, const frameSourceFn& source, const frameSinkFn& sink, tFramePipelineStats& stats) {
+	if (!valid()) {
+		return false;
+	}
+
+	// queue s holds the slots that are ready for stage s.  Queue 0 holds the free slots, which the store stage gives back.
+	std::vector<std::unique_ptr<SlotQueue>> queues;
+	for (unsigned int stage = 0; stage < numFrameStages; stage++) {
+		queues.emplace_back(new SlotQueue(slots()));
+	}
+
+	for (unsigned int slot = 0; slot < slots(); slot++) {
+		queues[0]->push(slot);
+	}
+
+	// each stage only writes its own sum, and the store stage the latencies
+	std::array<tTimingSum, numFrameStages> stageSums{};
+	tTimingSum latencySum{};
+	std::atomic<bool> failed(false);
+
+	const auto runStart = frameClock::now();
+
+	const auto loadStage = [&]() {
+		for (unsigned int frameIndex = 0; (frameIndex < numFrames) && !failed; frameIndex++) {
+			unsigned int slot = 0;
+			queues[0]->pop(slot);
+
+			tFrameSlot& frame = *frameSlots[slot];
+			frame.frameIndex = frameIndex;
+			frame.loadStart = frameClock::now();
+			if (!runStage(FrameStage::Load, frame, source, sink)) {
+				failed = true;
+			}
+			stageSums[0].add(secondsBetween(frame.loadStart, frameClock::now()));
+
+			queues[1]->push(slot);
+		}
+
+		queues[1]->close();
+	};
+
+	// a stage keeps passing slots on after a failure, so they all return to the free queue, but doesn't process them
+	const auto laterStage = [&](unsigned int stage) {
+		unsigned int slot = 0;
+		while (queues[stage]->pop(slot)) {
+			tFrameSlot& frame = *frameSlots[slot];
+			if (!failed) {
+				const auto start = frameClock::now();
+				if (!runStage(static_cast<FrameStage>(stage), frame, source, sink)) {
+					failed = true;
+				}
+				const auto end = frameClock::now();
+				stageSums[stage].add(secondsBetween(start, end));
+
+				if (stage == numFrameStages - 1) {
+					latencySum.add(secondsBetween(frame.loadStart, end));
+				}
+			}
+
+			queues[(stage + 1) % numFrameStages]->push(slot);
+		}
+
+		if (stage + 1 < numFrameStages) {
+			queues[stage + 1]->close();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.emplace_back(loadStage);
+	for (unsigned int stage = 1; stage < numFrameStages; stage++) {
+		threads.emplace_back(laterStage, stage);
+	}
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	finishStats(stageSums, latencySum, secondsBetween(runStart, frameClock::now()), stats);
+
+	return !failed;
+}
+
+bool FramePipeline::runSequential(unsigned int numFrames, const frameSourceFn& source, const frameSinkFn& sink, tFramePipelineStats& stats) {
+	if (!valid()) {
+		return false;
+	}
+
+	std::array<tTimingSum, numFrameStages> stageSums{};
+	tTimingSum latencySum{};
+	bool succeeded = true;
+
+	const auto runStart = frameClock::now();
+
+	tFrameSlot& frame = *frameSlots[0];
+	for (unsigned int frameIndex = 0; (frameIndex < numFrames) && succeeded; frameIndex++) {
+		frame.frameIndex = frameIndex;
+		frame.loadStart = frameClock::now();
+
+		auto start = frame.loadStart;
+		for (unsigned int stage = 0; (stage < numFrameStages) && succeeded; stage++) {
+			succeeded = runStage(static_cast<FrameStage>(stage), frame, source, sink);
+
+			const auto end = frameClock::now();
+			stageSums[stage].add(secondsBetween(start, end));
+			start = end;
+		}
+
+		if (succeeded) {
+			latencySum.add(secondsBetween(frame.loadStart, start));
+		}
+	}
+
+	finishStats(stageSums, latencySum, secondsBetween(runStart, frameClock::now()), stats);
+
+	return succeeded;
+}
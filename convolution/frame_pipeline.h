@@ -0,0 +1,140 @@
+#pragma once
+
+#include "convolution.h"
+#include "image_view.h"
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Separable blur of a continuous stream of frames.  Each frame goes through five stages: it is loaded by the caller as an
+// interleaved image, converted to planar, convolved horizontally and then vertically, and handed back to the caller.  Run
+// one after another, every stage waits for the previous one.  FramePipeline runs each stage on its own thread instead, so
+// stage N of frame i overlaps with stage N - 1 of frame i + 1, and the stages pass preallocated frame buffers to each other
+// through bounded queues.
+
+/**
+ * Stages of a frame in a FramePipeline, in the order they run
+ */
+enum class FrameStage {
+	Load,		// the caller fills the interleaved input frame
+	Convert,	// interleavedToPlanar
+	Horizontal,	// convolve1DHorizontal of every channel
+	Vertical,	// convolve1DVertical of every channel
+	Store		// the caller consumes the planar result
+};
+
+/**
+ * Number of values of FrameStage
+ */
+const unsigned int numFrameStages = 5;
+
+/**
+ * Mean and longest duration of a step over the frames of a run, in seconds
+ */
+typedef struct frameTiming {
+	double meanSeconds;
+	double maxSeconds;
+} tFrameTiming;
+
+/**
+ * Timings of a FramePipeline run
+ */
+typedef struct framePipelineStats {
+	unsigned int numFrames;
+	std::array<tFrameTiming, numFrameStages> stages;	// time spent in each stage, indexed by FrameStage
+	tFrameTiming latency;		// from the start of a frame's load to the end of its store, including the time it waited in the queues
+	double wallSeconds;			// from the start of the first load to the end of the last store
+	double framesPerSecond;		// numFrames / wallSeconds
+} tFramePipelineStats;
+
+/**
+ * Fills the interleaved input frame \p frame with frame number \p frameIndex of the stream
+ *
+ * @return  true if the frame was loaded, false to stop the run
+ */
+typedef std::function<bool(unsigned int frameIndex, const MutableImageView& frame)> frameSourceFn;
+
+/**
+ * Consumes the blurred frame number \p frameIndex, in planar layout.  The view is only valid during the call.
+ *
+ * @return  true if the frame was stored, false to stop the run
+ */
+typedef std::function<bool(unsigned int frameIndex, const ImageView& result)> frameSinkFn;
+
+/**
+ * Blurs a stream of frames of the same shape with a separable kernel, with the stages of consecutive frames running
+ * concurrently.  All frame buffers are allocated by the constructor: every slot holds the interleaved input, the planar
+ * copy, the intermediate image and the planar result of one frame (AlignedImage, so 4 images of the frame's size), and a
+ * frame occupies its slot from its load until its store returns.  A free slot queue hands the slots to the load stage, so
+ * at most numSlots frames are in flight and the load stage waits when the later stages fall behind.
+ *
+ * The source is called for the frames in order, always from the same thread, and so is the sink, so neither is called
+ * concurrently with itself.  A run starts one thread per stage and joins them before it returns; the stages only
+ * overlap if the machine has cores to spare for them.
+ *
+ * Like convolve2DSeparable, the edge pixels without a full neighbourhood are 0 in the result.
+ */
+class FramePipeline {
+public:
+	/**
+	 * @param[in] horizontalKernel  1D kernel to convolve the rows with.  Must have odd length.
+	 * @param[in] horizontalKernelSize  Number of elements in \p horizontalKernel
+	 * @param[in] verticalKernel  1D kernel to convolve the columns with.  Must have odd length.
+	 * @param[in] verticalKernelSize  Number of elements in \p verticalKernel
+	 * @param[in] height  Height of the frames
+	 * @param[in] width  Width of the frames
+	 * @param[in] numChannels  Number of channels in the frames
+	 * @param[in] numSlots  Number of frame buffers, i.e. frames in flight.  0 uses numFrameStages, one per stage, which is
+	 *                      enough for every stage to work on a different frame; 2 double-buffers each pair of stages.
+	 * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+	 */
+	FramePipeline(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize,
+		unsigned int height, unsigned int width, unsigned int numChannels, unsigned int numSlots, SimdLevel level);
+	~FramePipeline();
+
+	FramePipeline(const FramePipeline&) = delete;
+	FramePipeline& operator=(const FramePipeline&) = delete;
+
+	/**
+	 * @return  Number of frame buffers
+	 */
+	unsigned int slots() const;
+
+	/**
+	 * Loads, blurs and stores frames 0 to \p numFrames - 1, with the stages running concurrently on their own threads.
+	 * Returns once every frame was stored, or the run stopped.
+	 *
+	 * @param[in] numFrames  Number of frames in the stream
+	 * @param[in] source  Loads the frames
+	 * @param[in] sink  Stores the results
+	 * @param[out] stats  Timings of the run
+	 *
+	 * @return  true if every frame was stored, false if a kernel has even length, the frames are empty, or the source, the
+	 *          sink or a convolution failed.  Once a stage failed, no more frames are loaded, and the frames in flight are
+	 *          dropped.
+	 */
+	bool run(unsigned int numFrames, const frameSourceFn& source, const frameSinkFn& sink, tFramePipelineStats& stats);
+
+	/**
+	 * Same as run, but runs the stages of each frame one after another on the calling thread, with one slot.  Stores the
+	 * same results, and is the baseline the pipelined run is compared with.
+	 */
+	bool runSequential(unsigned int numFrames, const frameSourceFn& source, const frameSinkFn& sink, tFramePipelineStats& stats);
+
+private:
+	struct frameSlot;
+	typedef frameSlot tFrameSlot;
+
+	bool runStage(FrameStage stage, tFrameSlot& slot, const frameSourceFn& source, const frameSinkFn& sink);
+	bool valid() const;
+
+	std::vector<float> horizontalTaps;
+	std::vector<float> verticalTaps;
+	unsigned int height;
+	unsigned int width;
+	unsigned int numChannels;
+	SimdLevel level;
+	std::vector<std::unique_ptr<tFrameSlot>> frameSlots;
+};
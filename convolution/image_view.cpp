@@ -0,0 +1,109 @@
+#include "image_view.h"
+
+#include <algorithm>
+#include <cstdint>
+
+ImageView makeImageView(const std::vector<float>& image, ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels) {
+	const unsigned int pixelStride = layout == ImageLayout::Planar ? 1 : numChannels;
+	const std::size_t channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1;
+
+	return ImageView{ image.data(), height, width, numChannels, width * pixelStride, channelPitch, layout };
+}
+
+MutableImageView makeImageView(std::vector<float>& image, ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels) {
+	const unsigned int pixelStride = layout == ImageLayout::Planar ? 1 : numChannels;
+	const std::size_t channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1;
+
+	return MutableImageView{ image.data(), height, width, numChannels, width * pixelStride, channelPitch, layout };
+}
+
+bool isValidImageView(const ImageView& view) {
+	if ((view.data == nullptr) || (view.numChannels == 0)) {
+		return false;
+	}
+
+	if (view.rowPitch < static_cast<std::size_t>(view.width) * view.pixelStride()) {
+		return false;
+	}
+
+	if (view.layout == ImageLayout::Interleaved) {
+		// the channels of a pixel are adjacent
+		return view.channelPitch == 1;
+	}
+
+	// planar channels must not overlap.  A single channel doesn't need a channel pitch.
+	return (view.numChannels == 1) || (view.channelPitch >= static_cast<std::size_t>(view.height) * view.rowPitch);
+}
+
+bool haveSameShape(const ImageView& a, const ImageView& b) {
+	return (a.height == b.height) && (a.width == b.width) && (a.numChannels == b.numChannels) && (a.layout == b.layout);
+}
+
+/**
+ * Floats per padded row, and per padded plane, of an AlignedImage
+ */
+static void alignedPitches(unsigned int height, unsigned int width, unsigned int numChannels, ImageLayout layout, unsigned int& rowPitch, std::size_t& channelPitch) {
+	const unsigned int alignmentFloats = AlignedImage::rowAlignment / sizeof(float);
+	const unsigned int pixelStride = layout == ImageLayout::Planar ? 1 : numChannels;
+
+	// round every row up to a whole number of cache lines
+	rowPitch = (width * pixelStride + alignmentFloats - 1) / alignmentFloats * alignmentFloats;
+	channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * rowPitch : 1;
+}
+
+AlignedImage::AlignedImage(unsigned int height, unsigned int width, unsigned int numChannels, ImageLayout layout) {
+	const unsigned int alignmentFloats = rowAlignment / sizeof(float);
+	const unsigned int planes = layout == ImageLayout::Planar ? numChannels : 1;
+
+	unsigned int rowPitch = 0;
+	std::size_t channelPitch = 0;
+	alignedPitches(height, width, numChannels, layout, rowPitch, channelPitch);
+
+	storage.assign(static_cast<std::size_t>(planes) * height * rowPitch + alignmentFloats, 0.0f);
+
+	const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.data());
+	const std::size_t offset = ((rowAlignment - address % rowAlignment) % rowAlignment) / sizeof(float);
+
+	image = MutableImageView{ storage.data() + offset, height, width, numChannels, rowPitch, channelPitch, layout };
+}
+
+AlignedImage::AlignedImage(unsigned int height, unsigned int width, unsigned int numChannels, ImageLayout layout, BufferPool& pool) {
+	static_assert(BufferPool::alignment % rowAlignment == 0, "pool buffers must be aligned like the rows");
+
+	const unsigned int planes = layout == ImageLayout::Planar ? numChannels : 1;
+
+	unsigned int rowPitch = 0;
+	std::size_t channelPitch = 0;
+	alignedPitches(height, width, numChannels, layout, rowPitch, channelPitch);
+
+	pooledStorage = pool.acquire(static_cast<std::size_t>(planes) * height * rowPitch * sizeof(float));
+
+	image = MutableImageView{ pooledStorage.data<float>(), height, width, numChannels, rowPitch, channelPitch, layout };
+}
+
+ImageView AlignedImage::view() const {
+	return image;
+}
+
+MutableImageView AlignedImage::view() {
+	return image;
+}
+
+bool copyImage(const ImageView& src, const MutableImageView& dst) {
+	if (!isValidImageView(src) || !isValidImageView(dst) || !haveSameShape(src, dst)) {
+		return false;
+	}
+
+	// a planar image is numChannels planes of width floats per row, an interleaved one a single plane of width * numChannels floats per row
+	const unsigned int planes = src.layout == ImageLayout::Planar ? src.numChannels : 1;
+	const unsigned int rowLength = src.width * src.pixelStride();
+
+	for (unsigned int plane = 0; plane < planes; plane++) {
+		for (unsigned int row = 0; row < src.height; row++) {
+			const float* srcRow = src.row(plane, row);
+			std::copy(srcRow, srcRow + rowLength, dst.row(plane, row));
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "buffer_pool.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Memory layout of a multi-channel image
+ */
+enum class ImageLayout {
+	Planar,		// all pixels of channel 0, then all pixels of channel 1, ...
+	Interleaved	// all channels of pixel 0, then all channels of pixel 1, ...
+};
+
+/**
+ * Non-owning view of a multi-channel float image whose rows (and, for planar images, channels) may be padded.  The element
+ * of channel c, row r, column x is at
+ *
+ *   data[c * channelPitch + r * rowPitch + x * pixelStride()]
+ *
+ * where pixelStride() is 1 for planar and numChannels for interleaved images.  A dense image has rowPitch = width *
+ * pixelStride(), and channelPitch = height * width (planar) or 1 (interleaved).  A crop of a view keeps the pitches of the
+ * view it was cut from, so a region of interest can be processed in place.
+ *
+ * A row holds fewer than 2^32 floats, but a channel, and the whole image, may hold more: the offsets of rows and channels
+ * are computed in 64 bits, so gigapixel images can be addressed.
+ *
+ * @tparam PixelT  float for a view that can be written to, const float for a read-only view
+ */
+template <typename PixelT>
+struct imageViewT {
+	PixelT* data;
+	unsigned int height;
+	unsigned int width;
+	unsigned int numChannels;
+	unsigned int rowPitch;		// floats from the start of a row to the start of the next row of the same channel
+	std::size_t channelPitch;	// floats from channel c to channel c + 1 of the same pixel
+	ImageLayout layout;
+
+	/**
+	 * @return  Floats between neighbouring pixels of the same channel in a row
+	 */
+	unsigned int pixelStride() const {
+		return layout == ImageLayout::Planar ? 1 : numChannels;
+	}
+
+	/**
+	 * @return  Pointer to the first pixel of \p row in \p channelIndex
+	 */
+	PixelT* row(unsigned int channelIndex, unsigned int row) const {
+		return data + channelIndex * channelPitch + static_cast<std::size_t>(row) * rowPitch;
+	}
+
+	/**
+	 * @return  View of the \p cropHeight x \p cropWidth region whose top left pixel is (\p rowBegin, \p colBegin).  The
+	 *          region must lie inside this view.
+	 */
+	imageViewT crop(unsigned int rowBegin, unsigned int colBegin, unsigned int cropHeight, unsigned int cropWidth) const {
+		imageViewT cropped = *this;
+		cropped.data = data + static_cast<std::size_t>(rowBegin) * rowPitch + colBegin * pixelStride();
+		cropped.height = cropHeight;
+		cropped.width = cropWidth;
+		return cropped;
+	}
+
+	/**
+	 * A writable view can be passed wherever a read-only view is expected
+	 */
+	operator imageViewT<const PixelT>() const {
+		return imageViewT<const PixelT>{ data, height, width, numChannels, rowPitch, channelPitch, layout };
+	}
+};
+
+typedef imageViewT<const float> ImageView;
+typedef imageViewT<float> MutableImageView;
+
+/**
+ * Creates a view of a dense (unpadded) image stored in a vector, as taken by the std::vector overloads of the library.
+ *
+ * @param[in] image  Image with height = \p height width = \p width, number of channels = \p numChannels, and no padding
+ * @param[in] layout  Layout of \p image
+ * @param[in] height  Height of the image
+ * @param[in] width  Width of the image
+ * @param[in] numChannels  Number of channels in the image
+ *
+ * @return  The view.  \p image must outlive it and must not be resized while it is used.
+ */
+ImageView makeImageView(const std::vector<float>& image, ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels);
+
+/**
+ * Same as the const overload, but returns a view that can be written to
+ */
+MutableImageView makeImageView(std::vector<float>& image, ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels);
+
+/**
+ * Checks that the pitches of \p view are consistent with its dimensions, i.e. that no two elements of the view overlap.
+ *
+ * @return  true if \p view is non-null, has at least one channel, and its rows and channels don't overlap
+ */
+bool isValidImageView(const ImageView& view);
+
+/**
+ * @return  true if \p a and \p b have the same dimensions, number of channels and layout (their pitches may differ)
+ */
+bool haveSameShape(const ImageView& a, const ImageView& b);
+
+/**
+ * Owning multi-channel float image whose rows start on 64-byte (cache line) boundaries.  Each row is padded to a multiple of
+ * 16 floats, so every row (and, for planar images, every channel) starts on an aligned address, the SIMD kernels can use
+ * aligned loads and stores, and no row shares a cache line with its neighbour.  The padding is never written by the library.
+ */
+class AlignedImage {
+public:
+	/**
+	 * Bytes every row start is aligned to
+	 */
+	static const unsigned int rowAlignment = 64;
+
+	/**
+	 * Allocates a zero-initialized image
+	 *
+	 * @param[in] height  Height of the image
+	 * @param[in] width  Width of the image
+	 * @param[in] numChannels  Number of channels in the image
+	 * @param[in] layout  Layout of the image
+	 */
+	AlignedImage(unsigned int height, unsigned int width, unsigned int numChannels, ImageLayout layout);
+
+	/**
+	 * Takes the pixels from \p pool instead of allocating them, so images that are created and destroyed once per frame
+	 * reuse the same memory.  The pixels (and the padding) are not initialized.  The image gives its buffer back to \p pool
+	 * when it is destroyed, so \p pool must outlive it.
+	 *
+	 * See the other constructor for the parameters.
+	 */
+	AlignedImage(unsigned int height, unsigned int width, unsigned int numChannels, ImageLayout layout, BufferPool& pool);
+
+	// the view points into storage, so copies would alias the original
+	AlignedImage(const AlignedImage&) = delete;
+	AlignedImage& operator=(const AlignedImage&) = delete;
+	AlignedImage(AlignedImage&&) = default;
+	AlignedImage& operator=(AlignedImage&&) = default;
+
+	/**
+	 * @return  Read-only view of the whole image
+	 */
+	ImageView view() const;
+
+	/**
+	 * @return  Writable view of the whole image
+	 */
+	MutableImageView view();
+
+private:
+	// over-allocated by up to rowAlignment bytes, so the first row can be moved onto an aligned address.  Unused for images from a pool.
+	std::vector<float> storage;
+	PooledBuffer pooledStorage;
+	MutableImageView image;
+};
+
+/**
+ * Copies the pixels of \p src into \p dst, which must have the same shape.  The pitches of \p src and \p dst may differ,
+ * e.g. to copy a dense image into an AlignedImage or a crop into a dense image.
+ *
+ * @return  true if the copy succeeded, false if the views are invalid or their shapes differ
+ */
+bool copyImage(const ImageView& src, const MutableImageView& dst);
@@ -0,0 +1,212 @@
+#include "iterated_convolution.h"
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Granularity of the tile size and of the row pitch of the scratch tiles, in floats: a 64-byte cache line, and a vector of
+ * the widest SIMD level
+ */
+static const unsigned int iteratedTileGranularity = 16;
+
+/**
+ * Largest tile size iteratedTileSize returns, so huge budgets don't loop for long.  Tiles are clipped to the image anyway.
+ */
+static const unsigned int maxIteratedTileSize = 1 << 16;
+
+/**
+ * Rectangle of image rows [rowBegin, rowEnd) and columns [colBegin, colEnd)
+ */
+typedef struct tileRegion {
+	unsigned int rowBegin;
+	unsigned int rowEnd;
+	unsigned int colBegin;
+	unsigned int colEnd;
+} tTileRegion;
+
+/**
+ * @return  \p region grown by \p rows above and below and \p cols left and right, clipped to a \p height x \p width image
+ */
+static tTileRegion expandRegion(const tTileRegion& region, unsigned int rows, unsigned int cols, unsigned int height, unsigned int width) {
+	return tTileRegion{
+		region.rowBegin > rows ? region.rowBegin - rows : 0,
+		height - region.rowEnd > rows ? region.rowEnd + rows : height,
+		region.colBegin > cols ? region.colBegin - cols : 0,
+		width - region.colEnd > cols ? region.colEnd + cols : width
+	};
+}
+
+/**
+ * @return  View of \p region of a scratch tile whose top left pixel is the top left pixel of \p base
+ */
+static MutableImageView tileView(const MutableImageView& tile, const tTileRegion& base, const tTileRegion& region) {
+	return tile.crop(region.rowBegin - base.rowBegin, region.colBegin - base.colBegin, region.rowEnd - region.rowBegin, region.colEnd - region.colBegin);
+}
+
+/**
+ * Sets the pixels of \p region of a scratch tile that lie within \p rows of the top or bottom or \p cols of the left or
+ * right edge of the image to 0, like the edges of a convolution into a zeroed image
+ */
+static void clearTileEdges(const MutableImageView& tile, const tTileRegion& base, const tTileRegion& region, unsigned int rows, unsigned int cols, unsigned int height, unsigned int width) {
+	const unsigned int leftEnd = std::min(region.colEnd, std::max(region.colBegin, cols));
+	const unsigned int rightBegin = std::max(leftEnd, width > cols ? width - cols : 0);
+
+	for (unsigned int row = region.rowBegin; row < region.rowEnd; row++) {
+		// column x of the image is element x - base.colBegin of the row
+		float* dst = tile.row(0, row - base.rowBegin);
+
+		if ((row < rows) || (row + rows >= height)) {
+			std::fill(dst + (region.colBegin - base.colBegin), dst + (region.colEnd - base.colBegin), 0.0f);
+		}
+		else {
+			std::fill(dst + (region.colBegin - base.colBegin), dst + (leftEnd - base.colBegin), 0.0f);
+			if (rightBegin < region.colEnd) {
+				std::fill(dst + (rightBegin - base.colBegin), dst + (region.colEnd - base.colBegin), 0.0f);
+			}
+		}
+	}
+}
+
+/**
+ * Copies \p region of one channel of \p image into a scratch tile, whose top left pixel is the top left pixel of \p region
+ */
+static void gatherTile(const ImageView& image, unsigned int channelIndex, const tTileRegion& region, const MutableImageView& tile) {
+	const unsigned int pxStride = image.pixelStride();
+	const unsigned int cols = region.colEnd - region.colBegin;
+
+	for (unsigned int row = region.rowBegin; row < region.rowEnd; row++) {
+		const float* src = image.row(channelIndex, row) + static_cast<std::size_t>(region.colBegin) * pxStride;
+		float* dst = tile.row(0, row - region.rowBegin);
+
+		if (pxStride == 1) {
+			std::copy(src, src + cols, dst);
+		}
+		else {
+			for (unsigned int x = 0; x < cols; x++) {
+				dst[x] = src[x * pxStride];
+			}
+		}
+	}
+}
+
+/**
+ * Copies \p region of a scratch tile, whose top left pixel is the top left pixel of \p base, into one channel of \p result
+ */
+static void scatterTile(const MutableImageView& tile, const tTileRegion& base, const tTileRegion& region, unsigned int channelIndex, const MutableImageView& result) {
+	const unsigned int pxStride = result.pixelStride();
+	const unsigned int cols = region.colEnd - region.colBegin;
+
+	for (unsigned int row = region.rowBegin; row < region.rowEnd; row++) {
+		const float* src = tile.row(0, row - base.rowBegin) + (region.colBegin - base.colBegin);
+		float* dst = result.row(channelIndex, row) + static_cast<std::size_t>(region.colBegin) * pxStride;
+
+		if (pxStride == 1) {
+			std::copy(src, src + cols, dst);
+		}
+		else {
+			for (unsigned int x = 0; x < cols; x++) {
+				dst[x * pxStride] = src[x];
+			}
+		}
+	}
+}
+
+unsigned int iteratedTileSize(unsigned int horizontalKernelSize, unsigned int verticalKernelSize, unsigned int numPasses, std::size_t maxTileBytes) {
+	const std::uint64_t haloRows = static_cast<std::uint64_t>(numPasses) * (verticalKernelSize > 0 ? verticalKernelSize - 1 : 0);
+	const std::uint64_t haloCols = static_cast<std::uint64_t>(numPasses) * (horizontalKernelSize > 0 ? horizontalKernelSize - 1 : 0);
+
+	const auto tileBytes = [&](std::uint64_t tileSize) {
+		return 2 * (tileSize + haloRows) * (tileSize + haloCols) * sizeof(float);
+	};
+
+	unsigned int tileSize = iteratedTileGranularity;
+	while ((tileSize < maxIteratedTileSize) && (tileBytes(tileSize + iteratedTileGranularity) <= maxTileBytes)) {
+		tileSize += iteratedTileGranularity;
+	}
+
+	return tileSize;
+}
+
+bool convolve2DSeparableIterated(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, unsigned int numPasses,
+	ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, std::size_t maxTileBytes, SimdLevel level) {
+
+	if ((result.size() < image.size()) || (static_cast<std::size_t>(height) * width * numChannels > image.size())) {
+		return false;
+	}
+
+	return convolve2DSeparableIterated(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, numPasses,
+		makeImageView(image, layout, height, width, numChannels), channelIndex, makeImageView(result, layout, height, width, numChannels), maxTileBytes, level);
+}
+
+bool convolve2DSeparableIterated(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, unsigned int numPasses,
+	const ImageView& image, unsigned int channelIndex, const MutableImageView& result, std::size_t maxTileBytes, SimdLevel level) {
+
+	// only operate on odd-sized kernels
+	if ((horizontalKernelSize % 2 != 1) || (verticalKernelSize % 2 != 1) || (numPasses == 0)) {
+		return false;
+	}
+
+	if (!isValidImageView(image) || !isValidImageView(result) || !haveSameShape(image, result) || (channelIndex >= image.numChannels)) {
+		return false;
+	}
+
+	const unsigned int height = image.height;
+	const unsigned int width = image.width;
+	if ((height == 0) || (width == 0)) {
+		return true;
+	}
+
+	const unsigned int horizontalCenter = horizontalKernelSize / 2;
+	const unsigned int verticalCenter = verticalKernelSize / 2;
+	const unsigned int haloRows = numPasses * verticalCenter;
+	const unsigned int haloCols = numPasses * horizontalCenter;
+	const unsigned int tileSize = iteratedTileSize(horizontalKernelSize, verticalKernelSize, numPasses, maxTileBytes);
+
+	// the scratch tiles hold an output tile and its halo, with rows padded to whole cache lines
+	const unsigned int tileRows = static_cast<unsigned int>(std::min<std::uint64_t>(height, static_cast<std::uint64_t>(tileSize) + 2 * haloRows));
+	const unsigned int tileCols = static_cast<unsigned int>(std::min<std::uint64_t>(width, static_cast<std::uint64_t>(tileSize) + 2 * haloCols));
+	const unsigned int tilePitch = (tileCols + iteratedTileGranularity - 1) / iteratedTileGranularity * iteratedTileGranularity;
+	const std::size_t tileFloats = static_cast<std::size_t>(tileRows) * tilePitch;
+
+	BufferPool& buffers = scratchBufferPool();
+	const PooledBuffer frontBuffer = buffers.acquire(tileFloats * sizeof(float));
+	const PooledBuffer backBuffer = buffers.acquire(tileFloats * sizeof(float));
+	if ((frontBuffer.data<float>() == nullptr) || (backBuffer.data<float>() == nullptr)) {
+		return false;
+	}
+
+	MutableImageView front{ frontBuffer.data<float>(), tileRows, tileCols, 1, tilePitch, tileFloats, ImageLayout::Planar };
+	MutableImageView back{ backBuffer.data<float>(), tileRows, tileCols, 1, tilePitch, tileFloats, ImageLayout::Planar };
+
+	for (unsigned int tileRow = 0; tileRow < height; tileRow += tileSize) {
+		for (unsigned int tileCol = 0; tileCol < width; tileCol += tileSize) {
+			const tTileRegion output{ tileRow, tileRow + std::min(tileSize, height - tileRow), tileCol, tileCol + std::min(tileSize, width - tileCol) };
+			const tTileRegion base = expandRegion(output, haloRows, haloCols, height, width);
+
+			gatherTile(image, channelIndex, base, front);
+
+			// pass p reads the output tile grown by (numPasses - p + 1) halos and writes it grown by (numPasses - p) halos.
+			// The pixels of its input region that the kernels don't reach are either outside the region the next pass reads,
+			// or along the edges of the image, where a pass into a zeroed image leaves 0.
+			for (unsigned int pass = 1; pass <= numPasses; pass++) {
+				const unsigned int remainingPasses = numPasses - pass + 1;
+				const tTileRegion region = expandRegion(output, remainingPasses * verticalCenter, remainingPasses * horizontalCenter, height, width);
+
+				const MutableImageView src = tileView(front, base, region);
+				const MutableImageView dst = tileView(back, base, region);
+				if (!convolve2DSeparable(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, src, 0, dst, level)) {
+					return false;
+				}
+
+				clearTileEdges(back, base, region, verticalCenter, horizontalCenter, height, width);
+				std::swap(front, back);
+			}
+
+			scatterTile(front, base, output, channelIndex, result);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "convolution.h"
+
+#include <cstddef>
+#include <vector>
+
+// Several passes of the same separable blur, e.g. 3 or 4 box blurs to approximate a Gaussian.  Applied one after another to
+// the whole image, every pass reads and writes the image once, so once the image no longer fits in the cache, P passes move
+// it through memory 2 * P times.  The iterated functions blur the image tile by tile instead: each tile is copied into a
+// scratch buffer together with a halo of P * kernelSize / 2 pixels on every side, all P passes run on the buffer while it
+// is in the cache, shrinking the valid region by kernelSize / 2 per pass, and only the tile itself is copied out.  The image
+// is read about once and written once whatever P is, at the cost of recomputing the halos of neighbouring tiles.
+
+/**
+ * Budget for the two scratch tiles of convolve2DSeparableIterated when the caller has no better number: half the L2 cache of
+ * current x86 cores, so the tiles stay in the L2 with room for the rows of the fused passes
+ */
+const std::size_t defaultIteratedTileBytes = 512 * 1024;
+
+/**
+ * Side of the square output tiles convolve2DSeparableIterated blurs one at a time.  A tile is copied into a scratch buffer
+ * with numPasses * (kernel size / 2) pixels of halo on every side, and the passes ping-pong between 2 such buffers, so
+ *
+ *   2 * (tileSize + numPasses * (verticalKernelSize - 1)) * (tileSize + numPasses * (horizontalKernelSize - 1)) * sizeof(float) <= \p maxTileBytes
+ *
+ * The tile size is a multiple of 16, and at least 16, even if that exceeds the budget.
+ *
+ * @param[in] horizontalKernelSize  Number of elements in the horizontal kernel
+ * @param[in] verticalKernelSize  Number of elements in the vertical kernel
+ * @param[in] numPasses  Number of passes
+ * @param[in] maxTileBytes  Budget for the 2 scratch buffers
+ *
+ * @return  Number of rows and of columns of an output tile
+ */
+unsigned int iteratedTileSize(unsigned int horizontalKernelSize, unsigned int verticalKernelSize, unsigned int numPasses, std::size_t maxTileBytes);
+
+/**
+ * Performs \p numPasses fused separable 2D convolutions on a single channel of an input image, each on the result of the
+ * previous one, tile by tile (see above).  Computes the same pixels as calling convolve2DSeparable \p numPasses times, every
+ * pass into a zeroed image, up to rounding: the SIMD kernels may round the last pixels of a row differently, and the tiles
+ * end their rows elsewhere than the image.  Unlike convolve2DSeparable, every pixel of the channel in \p result is written,
+ * and the edge pixels without a full neighbourhood are 0.
+ *
+ * @param[in] horizontalKernel  1D kernel to convolve the rows with.  Must have odd length.
+ * @param[in] horizontalKernelSize  Number of elements in \p horizontalKernel
+ * @param[in] verticalKernel  1D kernel to convolve the columns with.  Must have odd length.
+ * @param[in] verticalKernelSize  Number of elements in \p verticalKernel
+ * @param[in] numPasses  Number of times to convolve the image.  Must be at least 1.
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the passes.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] maxTileBytes  Budget for the scratch tiles, see iteratedTileSize
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve2DSeparableIterated(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, unsigned int numPasses,
+	ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, std::size_t maxTileBytes, SimdLevel level);
+
+/**
+ * Same as convolve2DSeparableIterated, on image views.  \p image and \p result must not overlap.  See the image view
+ * overload of convolve1DHorizontal.
+ */
+bool convolve2DSeparableIterated(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, unsigned int numPasses,
+	const ImageView& image, unsigned int channelIndex, const MutableImageView& result, std::size_t maxTileBytes, SimdLevel level);
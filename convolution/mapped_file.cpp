@@ -0,0 +1,243 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedRegion::MappedRegion()
+	: base(nullptr), mappedBytes(0), address(nullptr)
+{}
+
+MappedRegion::~MappedRegion() {
+	unmap();
+}
+
+MappedRegion::MappedRegion(MappedRegion&& other)
+	: base(other.base), mappedBytes(other.mappedBytes), address(other.address)
+{
+	other.base = nullptr;
+	other.mappedBytes = 0;
+	other.address = nullptr;
+}
+
+MappedRegion& MappedRegion::operator=(MappedRegion&& other) {
+	if (this != &other) {
+		unmap();
+
+		base = other.base;
+		mappedBytes = other.mappedBytes;
+		address = other.address;
+
+		other.base = nullptr;
+		other.mappedBytes = 0;
+		other.address = nullptr;
+	}
+
+	return *this;
+}
+
+void MappedRegion::unmap() {
+	if (base != nullptr) {
+#if defined(_WIN32)
+		UnmapViewOfFile(base);
+#else
+		munmap(base, mappedBytes);
+#endif
+	}
+
+	base = nullptr;
+	mappedBytes = 0;
+	address = nullptr;
+}
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile()
+	: file(INVALID_HANDLE_VALUE), mapping(nullptr), writable(false), fileSize(0)
+{}
+
+bool MappedFile::openForReading(const std::string& path) {
+	close();
+
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		close();
+		return false;
+	}
+
+	fileSize = static_cast<std::uint64_t>(size.QuadPart);
+
+	// an empty file can't be mapped, but it has no ranges to map either
+	if (fileSize > 0) {
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MappedFile::create(const std::string& path, std::uint64_t size) {
+	close();
+
+	file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	writable = true;
+	fileSize = size;
+
+	// the mapping object extends the file to its size
+	if (fileSize > 0) {
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+		if (mapping == nullptr) {
+			close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (mapping != nullptr) {
+		CloseHandle(mapping);
+	}
+
+	if (file != INVALID_HANDLE_VALUE) {
+		CloseHandle(file);
+	}
+
+	file = INVALID_HANDLE_VALUE;
+	mapping = nullptr;
+	writable = false;
+	fileSize = 0;
+}
+
+MappedRegion MappedFile::map(std::uint64_t offset, std::size_t length) const {
+	MappedRegion region;
+	if ((mapping == nullptr) || (length == 0) || (offset > fileSize) || (length > fileSize - offset)) {
+		return region;
+	}
+
+	const std::uint64_t mapOffset = offset / granularity() * granularity();
+	const std::size_t mapBytes = static_cast<std::size_t>(offset - mapOffset) + length;
+
+	void* base = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, static_cast<DWORD>(mapOffset >> 32), static_cast<DWORD>(mapOffset & 0xFFFFFFFF), mapBytes);
+	if (base == nullptr) {
+		return region;
+	}
+
+	region.base = base;
+	region.mappedBytes = mapBytes;
+	region.address = static_cast<char*>(base) + (offset - mapOffset);
+	return region;
+}
+
+std::size_t MappedFile::granularity() {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+}
+
+#else
+
+MappedFile::MappedFile()
+	: fd(-1), writable(false), fileSize(0)
+{}
+
+bool MappedFile::openForReading(const std::string& path) {
+	close();
+
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		close();
+		return false;
+	}
+
+	fileSize = static_cast<std::uint64_t>(status.st_size);
+	return true;
+}
+
+bool MappedFile::create(const std::string& path, std::uint64_t size) {
+	close();
+
+	fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+
+	// a sparse file: the zero pages only take disk space once they are written
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+		close();
+		return false;
+	}
+
+	writable = true;
+	fileSize = size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (fd >= 0) {
+		::close(fd);
+	}
+
+	fd = -1;
+	writable = false;
+	fileSize = 0;
+}
+
+MappedRegion MappedFile::map(std::uint64_t offset, std::size_t length) const {
+	MappedRegion region;
+	if ((fd < 0) || (length == 0) || (offset > fileSize) || (length > fileSize - offset)) {
+		return region;
+	}
+
+	const std::uint64_t mapOffset = offset / granularity() * granularity();
+	const std::size_t mapBytes = static_cast<std::size_t>(offset - mapOffset) + length;
+
+	void* base = mmap(nullptr, mapBytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, static_cast<off_t>(mapOffset));
+	if (base == MAP_FAILED) {
+		return region;
+	}
+
+	if (!writable) {
+		madvise(base, mapBytes, MADV_SEQUENTIAL);
+		madvise(base, mapBytes, MADV_WILLNEED);
+	}
+
+	region.base = base;
+	region.mappedBytes = mapBytes;
+	region.address = static_cast<char*>(base) + (offset - mapOffset);
+	return region;
+}
+
+std::size_t MappedFile::granularity() {
+	return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
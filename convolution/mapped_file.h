@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile;
+
+/**
+ * A mapped range of a MappedFile.  The range is unmapped when the region is destroyed, so only the regions that are alive
+ * count towards the resident memory of the process.  Move-only.
+ */
+class MappedRegion {
+public:
+	MappedRegion();
+	~MappedRegion();
+
+	MappedRegion(MappedRegion&& other);
+	MappedRegion& operator=(MappedRegion&& other);
+
+	MappedRegion(const MappedRegion&) = delete;
+	MappedRegion& operator=(const MappedRegion&) = delete;
+
+	/**
+	 * @return  First byte of the requested range, or nullptr if the mapping failed
+	 */
+	template <typename T>
+	T* data() const {
+		return reinterpret_cast<T*>(address);
+	}
+
+	/**
+	 * @return  true if the range is mapped
+	 */
+	bool valid() const {
+		return address != nullptr;
+	}
+
+private:
+	friend class MappedFile;
+
+	void unmap();
+
+	void* base;		// start of the mapping, rounded down to MappedFile::granularity()
+	std::size_t mappedBytes;
+	char* address;		// start of the requested range, inside the mapping
+};
+
+/**
+ * File whose ranges can be mapped into memory, e.g. a raw image that is larger than RAM.  Uses mmap on POSIX systems and
+ * file mappings on Windows.  The file is closed when the object is destroyed, so every region mapped from it must be
+ * destroyed first.
+ */
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * Opens an existing file, whose ranges can then be mapped read-only
+	 *
+	 * @return  true if the file was opened
+	 */
+	bool openForReading(const std::string& path);
+
+	/**
+	 * Creates (or truncates) a file of \p size zero bytes, whose ranges can then be mapped for writing.  Writes to a mapped
+	 * range go to the file when the range is unmapped, or earlier if the OS decides to write them back.
+	 *
+	 * @return  true if the file was created and sized
+	 */
+	bool create(const std::string& path, std::uint64_t size);
+
+	/**
+	 * Closes the file.  Called by the destructor.
+	 */
+	void close();
+
+	/**
+	 * @return  Size of the open file in bytes, or 0 if no file is open
+	 */
+	std::uint64_t size() const {
+		return fileSize;
+	}
+
+	/**
+	 * Maps the \p length bytes at \p offset.  The mapping starts at the offset rounded down to granularity(), so the OS
+	 * only sees aligned offsets, but data() of the region points at \p offset.  Read-only mappings are advised as
+	 * sequential and about to be needed, so the OS reads them ahead.
+	 *
+	 * @return  The region, which is not valid() if the range is outside the file or the mapping failed
+	 */
+	MappedRegion map(std::uint64_t offset, std::size_t length) const;
+
+	/**
+	 * @return  Alignment of the file offsets the OS can map at: the page size, or the allocation granularity on Windows
+	 */
+	static std::size_t granularity();
+
+private:
+#if defined(_WIN32)
+	void* file;		// HANDLE, or INVALID_HANDLE_VALUE
+	void* mapping;		// HANDLE of the file mapping object, or nullptr
+#else
+	int fd;			// -1 if closed
+#endif
+	bool writable;
+	std::uint64_t fileSize;
+};
@@ -0,0 +1,215 @@
+#include "nonseparable_convolution.h"
+#include "buffer_pool.h"
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Output rows per kernel call when an interleaved channel is copied into scratch rows first: the register blocks of the SIMD
+ * kernels are 4 rows high, and the scratch holds kernelSize - 1 rows more than the block.
+ */
+static const unsigned int gatheredRowBlock = 4;
+
+/**
+ * Checks that \p image and \p result are valid views of the same shape, and that \p channelIndex is one of their channels
+ */
+static bool nonSeparableViewsValid(const ImageView& image, unsigned int channelIndex, const ImageView& result) {
+	if (!isValidImageView(image) || !isValidImageView(result) || !haveSameShape(image, result)) {
+		return false;
+	}
+
+	return channelIndex < image.numChannels;
+}
+
+/**
+ * Checks that \p image holds a dense image of the given dimensions and \p result is at least as large
+ */
+static bool nonSeparableDenseSizesValid(const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, const std::vector<float>& result) {
+	if (result.size() < image.size()) {
+		return false;
+	}
+
+	return static_cast<std::size_t>(height) * width * numChannels <= image.size();
+}
+
+/**
+ * Convolves the output rows [\p outputBegin, \p outputEnd) of a view whose rows are contiguous runs of elements, in a single
+ * call of the kernel.  The taps of an element are \p tapStride elements apart, and \p count is the number of interior
+ * elements per row.
+ *
+ * @return  true if the rows were convolved, false if the row pointers couldn't be allocated
+ */
+static bool convolveContiguousRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int outputBegin, unsigned int outputEnd,
+	unsigned int tapStride, unsigned int count, const MutableImageView& result, convolveRows2DFn convolveRows) {
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int numRows = outputEnd - outputBegin;
+
+	const unsigned int numInputRows = numRows + kernelSize - 1;
+
+	BufferPool& buffers = scratchBufferPool();
+	const PooledBuffer rowsBuffer = buffers.acquire(numInputRows * sizeof(const float*));
+	const PooledBuffer dstRowsBuffer = buffers.acquire(numRows * sizeof(float*));
+	const float** rows = rowsBuffer.data<const float*>();
+	float** dstRows = dstRowsBuffer.data<float*>();
+	if ((rows == nullptr) || (dstRows == nullptr)) {
+		return false;
+	}
+
+	for (unsigned int row = 0; row < numInputRows; row++) {
+		rows[row] = image.row(channelIndex, outputBegin - center + row);
+	}
+
+	for (unsigned int row = 0; row < numRows; row++) {
+		dstRows[row] = result.row(channelIndex, outputBegin + row) + center * tapStride;
+	}
+
+	convolveRows(kernel, kernelSize, rows, tapStride, dstRows, numRows, count);
+
+	return true;
+}
+
+/**
+ * Convolves the output rows [\p outputBegin, \p outputEnd) of one channel of an interleaved view.  The input rows are
+ * copied into a ring of kernelSize - 1 + gatheredRowBlock contiguous scratch rows as the output rows reach them, so every
+ * input row is copied once, and each block of output rows is convolved into scratch rows and copied into \p result.
+ *
+ * @return  true if the rows were convolved, false if the scratch rows couldn't be allocated
+ */
+static bool convolveGatheredRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int outputBegin, unsigned int outputEnd,
+	const MutableImageView& result, convolveRows2DFn convolveRows) {
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int width = image.width;
+	const unsigned int interiorWidth = width - 2 * center;
+	const unsigned int pxStride = image.pixelStride();
+	const unsigned int ringRows = kernelSize - 1 + gatheredRowBlock;
+
+	BufferPool& buffers = scratchBufferPool();
+	const PooledBuffer ringBuffer = buffers.acquire(static_cast<std::size_t>(ringRows) * width * sizeof(float));
+	const PooledBuffer outputBuffer = buffers.acquire(static_cast<std::size_t>(gatheredRowBlock) * interiorWidth * sizeof(float));
+	const PooledBuffer rowsBuffer = buffers.acquire(ringRows * sizeof(const float*));
+	const PooledBuffer dstRowsBuffer = buffers.acquire(gatheredRowBlock * sizeof(float*));
+	float* ring = ringBuffer.data<float>();
+	float* output = outputBuffer.data<float>();
+	const float** rows = rowsBuffer.data<const float*>();
+	float** dstRows = dstRowsBuffer.data<float*>();
+	if ((ring == nullptr) || (output == nullptr) || (rows == nullptr) || (dstRows == nullptr)) {
+		return false;
+	}
+
+	for (unsigned int row = 0; row < gatheredRowBlock; row++) {
+		dstRows[row] = output + row * interiorWidth;
+	}
+
+	// input row r lives in slot r % ringRows.  A block needs numRows + kernelSize - 1 <= ringRows consecutive input rows, so
+	// the rows it gathers only overwrite rows above the block's halo.
+	unsigned int gathered = outputBegin - center;
+	for (unsigned int row = outputBegin; row < outputEnd; row += gatheredRowBlock) {
+		const unsigned int numRows = std::min(gatheredRowBlock, outputEnd - row);
+
+		for (; gathered < row + numRows + center; gathered++) {
+			const float* src = image.row(channelIndex, gathered);
+			float* slot = ring + (gathered % ringRows) * width;
+
+			for (unsigned int x = 0; x < width; x++) {
+				slot[x] = src[x * pxStride];
+			}
+		}
+
+		for (unsigned int inputRow = 0; inputRow < numRows + kernelSize - 1; inputRow++) {
+			rows[inputRow] = ring + ((row - center + inputRow) % ringRows) * width;
+		}
+
+		convolveRows(kernel, kernelSize, rows, 1, dstRows, numRows, interiorWidth);
+
+		for (unsigned int outputRow = 0; outputRow < numRows; outputRow++) {
+			const float* src = dstRows[outputRow];
+			float* dst = result.row(channelIndex, row + outputRow) + center * pxStride;
+
+			for (unsigned int x = 0; x < interiorWidth; x++) {
+				dst[x * pxStride] = src[x];
+			}
+		}
+	}
+
+	return true;
+}
+
+bool convolve2D(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level) {
+	return convolve2DRows(kernel, kernelSize, layout, image, height, width, numChannels, channelIndex, 0, height, result, level);
+}
+
+bool convolve2D(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level) {
+	return convolve2DRows(kernel, kernelSize, image, channelIndex, 0, image.height, result, level);
+}
+
+bool convolve2DRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level) {
+	if (!nonSeparableDenseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve2DRows(kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), channelIndex, rowBegin, rowEnd, makeImageView(result, layout, height, width, numChannels), level);
+}
+
+bool convolve2DRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if (!nonSeparableViewsValid(image, channelIndex, result)) {
+		return false;
+	}
+
+	// no pixel has a full neighbourhood
+	if ((image.width < kernelSize) || (image.height < kernelSize)) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int outputBegin = std::max(rowBegin, center);
+	const unsigned int outputEnd = std::min(rowEnd, image.height - center);
+	if (outputBegin >= outputEnd) {
+		return true;
+	}
+
+	const convolveRows2DFn convolveRows = getSimdKernels(level).convolveRows2D;
+
+	if (image.layout == ImageLayout::Planar) {
+		return convolveContiguousRows(kernel, kernelSize, image, channelIndex, outputBegin, outputEnd, 1, image.width - 2 * center, result, convolveRows);
+	}
+
+	return convolveGatheredRows(kernel, kernelSize, image, channelIndex, outputBegin, outputEnd, result, convolveRows);
+}
+
+bool convolve2DInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level) {
+	if (!nonSeparableDenseSizesValid(image, height, width, numChannels, result)) {
+		return false;
+	}
+
+	return convolve2DInterleavedAllChannels(kernel, kernelSize, makeImageView(image, ImageLayout::Interleaved, height, width, numChannels), makeImageView(result, ImageLayout::Interleaved, height, width, numChannels), level);
+}
+
+bool convolve2DInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if (kernelSize % 2 != 1) {
+		return false;
+	}
+
+	if ((image.layout != ImageLayout::Interleaved) || !nonSeparableViewsValid(image, 0, result)) {
+		return false;
+	}
+
+	// no pixel has a full neighbourhood
+	if ((image.width < kernelSize) || (image.height < kernelSize)) {
+		return true;
+	}
+
+	const unsigned int center = kernelSize / 2;
+	const unsigned int numChannels = image.numChannels;
+
+	// every channel of the interior pixels of a row is one run of elements, whose taps are numChannels apart
+	return convolveContiguousRows(kernel, kernelSize, image, 0, center, image.height - center, numChannels, (image.width - 2 * center) * numChannels, result, getSimdKernels(level).convolveRows2D);
+}
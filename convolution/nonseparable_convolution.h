@@ -0,0 +1,65 @@
+#pragma once
+
+#include "convolution.h"
+
+#include <vector>
+
+// Convolution with general 2D kernels, e.g. sharpening, edge detection or learned filters, which can't be split into a
+// horizontal and a vertical pass.  A kernel is kernelSize x kernelSize floats stored row by row, and output pixel (y, x) is
+// the sum over kr and kc of kernel[kr * kernelSize + kc] * image(y - kernelSize / 2 + kr, x - kernelSize / 2 + kc).  Like
+// the separable functions, the edge pixels without a full neighbourhood are left untouched.
+//
+// Every output pixel costs kernelSize * kernelSize multiply-adds, against 2 * kernelSize for a separable kernel, so a kernel
+// that is separable should still go through convolve2DSeparable.  The SIMD kernels compute blocks of 4 output rows by 2
+// vectors at a time in registers, and multiply every input vector they load into all the output rows of the block.
+
+/**
+ * Performs 2D convolution on a single channel of an input image.
+ *
+ * @param[in] kernel  2D kernel to convolve with, \p kernelSize rows of \p kernelSize taps
+ * @param[in] kernelSize  Number of rows and of columns of \p kernel.  Must be odd.
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[in] channelIndex  Index of the channel to convolve
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve2D(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve2D, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve2D(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Same as convolve2D, but only computes the output rows in [\p rowBegin, \p rowEnd).  Reads kernelSize / 2 rows of halo
+ * above and below the band, so bands of the same image can run on different threads.
+ *
+ * See convolve2D for the other parameters.
+ */
+bool convolve2DRows(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve2DRows, on image views.  A channel of an interleaved view is copied into contiguous scratch rows before
+ * it is convolved, so the SIMD kernels never gather pixels that are numChannels apart.
+ */
+bool convolve2DRows(const float* kernel, unsigned int kernelSize, const ImageView& image, unsigned int channelIndex, unsigned int rowBegin, unsigned int rowEnd, const MutableImageView& result, SimdLevel level);
+
+/**
+ * Performs 2D convolution on every channel of an interleaved image at once.  The taps of an element are the same channel of
+ * the neighbouring pixels, so the interleaved rows are convolved as they are, without copying a channel out first.
+ * Computes the same pixels as convolve2D for every channel.
+ *
+ * See convolve2D for the parameters.
+ */
+bool convolve2DInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, SimdLevel level);
+
+/**
+ * Same as convolve2DInterleavedAllChannels, on interleaved image views
+ */
+bool convolve2DInterleavedAllChannels(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, SimdLevel level);
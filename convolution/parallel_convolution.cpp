@@ -0,0 +1,111 @@
+#include "parallel_convolution.h"
+
+#include <algorithm>
+#include <atomic>
+
+// shortest band worth a task of its own
+static const unsigned int minBandRows = 16;
+
+unsigned int parallelBandsPerChannel(unsigned int height, unsigned int numChannels, unsigned int numThreads) {
+	if ((numThreads <= 1) || (numChannels == 0)) {
+		return 1;
+	}
+
+	const unsigned int targetTasks = 4 * numThreads;
+	const unsigned int bands = (targetTasks + numChannels - 1) / numChannels;
+	const unsigned int maxBands = std::max(1U, height / minBandRows);
+
+	return std::max(1U, std::min(bands, maxBands));
+}
+
+/**
+ * Runs \p convolveBand for every (channel, row band) of the image on \p pool.  Tasks are numbered band-major, so the channels
+ * of one band are neighbouring tasks and usually run on the same thread; for interleaved images that keeps threads from
+ * writing to the same cache lines.
+ *
+ * @return  true if every band succeeded
+ */
+static bool runBands(unsigned int height, unsigned int numChannels, ThreadPool& pool, const std::function<bool(unsigned int, unsigned int, unsigned int)>& convolveBand) {
+	const unsigned int bands = parallelBandsPerChannel(height, numChannels, pool.size());
+
+	std::atomic<bool> succeeded(true);
+	pool.parallelFor(bands * numChannels, [&](unsigned int task) {
+		const unsigned int band = task / numChannels;
+		const unsigned int channel = task % numChannels;
+
+		const unsigned int rowBegin = static_cast<unsigned int>(static_cast<unsigned long long>(height) * band / bands);
+		const unsigned int rowEnd = static_cast<unsigned int>(static_cast<unsigned long long>(height) * (band + 1) / bands);
+
+		if (!convolveBand(channel, rowBegin, rowEnd)) {
+			succeeded = false;
+		}
+	});
+
+	return succeeded;
+}
+
+bool convolve1DHorizontalParallel(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(height, numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve1DHorizontalRows(kernel, kernelSize, layout, image, height, width, numChannels, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+bool convolve1DHorizontalParallel(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(image.height, image.numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve1DHorizontalRows(kernel, kernelSize, image, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+bool convolve1DVerticalParallel(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(height, numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve1DVerticalRows(kernel, kernelSize, layout, image, height, width, numChannels, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+bool convolve1DVerticalParallel(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(image.height, image.numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve1DVerticalRows(kernel, kernelSize, image, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+bool convolve2DSeparableParallel(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(height, numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, layout, image, height, width, numChannels, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+bool convolve2DSeparableParallel(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level) {
+	return runBands(image.height, image.numChannels, pool, [&](unsigned int channel, unsigned int rowBegin, unsigned int rowEnd) {
+		return convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, image, channel, rowBegin, rowEnd, result, level);
+	});
+}
+
+// a conversion moves every channel of a row at once, so its bands are run as a single "channel"
+
+bool interleavedToPlanarParallel(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, ThreadPool& pool, SimdLevel level) {
+	if ((static_cast<std::size_t>(height) * width * numChannels > src.size()) || (dst.size() < src.size())) {
+		return false;
+	}
+
+	return interleavedToPlanarParallel(makeImageView(src, ImageLayout::Interleaved, height, width, numChannels), makeImageView(dst, ImageLayout::Planar, height, width, numChannels), pool, level);
+}
+
+bool interleavedToPlanarParallel(const ImageView& src, const MutableImageView& dst, ThreadPool& pool, SimdLevel level) {
+	return runBands(src.height, 1, pool, [&](unsigned int, unsigned int rowBegin, unsigned int rowEnd) {
+		return interleavedToPlanarRows(src, rowBegin, rowEnd, dst, level);
+	});
+}
+
+bool planarToInterleavedParallel(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, ThreadPool& pool, SimdLevel level) {
+	if ((static_cast<std::size_t>(height) * width * numChannels > src.size()) || (dst.size() < src.size())) {
+		return false;
+	}
+
+	return planarToInterleavedParallel(makeImageView(src, ImageLayout::Planar, height, width, numChannels), makeImageView(dst, ImageLayout::Interleaved, height, width, numChannels), pool, level);
+}
+
+bool planarToInterleavedParallel(const ImageView& src, const MutableImageView& dst, ThreadPool& pool, SimdLevel level) {
+	return runBands(src.height, 1, pool, [&](unsigned int, unsigned int rowBegin, unsigned int rowEnd) {
+		return planarToInterleavedRows(src, rowBegin, rowEnd, dst, level);
+	});
+}
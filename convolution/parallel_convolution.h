@@ -0,0 +1,90 @@
+#pragma once
+
+#include "convolution.h"
+#include "thread_pool.h"
+
+#include <vector>
+
+/**
+ * Number of row bands each channel is split into by the *Parallel functions.  Aims for about 4 tasks per thread so work
+ * stealing can even out the load, without making bands so short that the vertical halo dominates.
+ *
+ * @param[in] height  Height of the image
+ * @param[in] numChannels  Number of channels in the image
+ * @param[in] numThreads  Number of threads in the pool
+ *
+ * @return  Number of bands per channel, at least 1
+ */
+unsigned int parallelBandsPerChannel(unsigned int height, unsigned int numChannels, unsigned int numThreads);
+
+/**
+ * Performs 1D horizontal convolution on every channel of an input image, splitting the work into (channel, row band) tasks
+ * that run on \p pool.  Computes the same pixels as calling convolve1DHorizontal once per channel.
+ *
+ * @param[in] kernel  1D kernel to convolve with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] layout  Layout of \p image and \p result
+ * @param[in] image  2D multi-channel image to convolve.  Has height = \p height width = \p width, number of channels = \p numChannels, and no padding.
+ * @param[in] height  Height of the input image
+ * @param[in] width  Width of the input image
+ * @param[in] numChannels  Number of channels in the input image
+ * @param[out] result  Out-of-place result of the image convolved with the kernel.  Is expected that before the call, \p result has size = size of \p image .
+ * @param[in] pool  Threads to run the tasks on
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false otherwise
+ */
+bool convolve1DHorizontalParallel(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as convolve1DHorizontalParallel, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve1DHorizontalParallel(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Performs 1D vertical convolution on every channel of an input image, splitting the work into (channel, row band) tasks
+ * that run on \p pool.  Each band reads kernelSize / 2 rows of halo above and below it from \p image, so the bands are
+ * independent.  Computes the same pixels as calling convolve1DVertical once per channel.
+ *
+ * See convolve1DHorizontalParallel for the parameters.
+ */
+bool convolve1DVerticalParallel(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as convolve1DVerticalParallel, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve1DVerticalParallel(const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Performs a fused separable 2D convolution on every channel of an input image, splitting the work into (channel, row band)
+ * tasks that run on \p pool.  Each band convolves verticalKernelSize / 2 rows of halo above and below it horizontally into
+ * its own ring buffer, so the bands are independent.  Computes the same pixels as calling convolve2DSeparable once per channel.
+ *
+ * See convolve2DSeparable and convolve1DHorizontalParallel for the parameters.
+ */
+bool convolve2DSeparableParallel(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as convolve2DSeparableParallel, on image views.  See the image view overload of convolve1DHorizontal.
+ */
+bool convolve2DSeparableParallel(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, const ImageView& image, const MutableImageView& result, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as interleavedToPlanar, but splits the rows into bands that run on \p pool
+ */
+bool interleavedToPlanarParallel(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as interleavedToPlanarParallel, on image views.  See the image view overload of interleavedToPlanar.
+ */
+bool interleavedToPlanarParallel(const ImageView& src, const MutableImageView& dst, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as planarToInterleaved, but splits the rows into bands that run on \p pool
+ */
+bool planarToInterleavedParallel(const std::vector<float>& src, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& dst, ThreadPool& pool, SimdLevel level);
+
+/**
+ * Same as planarToInterleavedParallel, on image views.  See the image view overload of planarToInterleaved.
+ */
+bool planarToInterleavedParallel(const ImageView& src, const MutableImageView& dst, ThreadPool& pool, SimdLevel level);
@@ -0,0 +1,11 @@
+#include "pixel_types.h"
+
+#include "simd_kernels.h"
+
+void convertHalfToFloat(const tHalf* src, float* dst, unsigned int count, SimdLevel level) {
+	getSimdKernels(level).convertHalfToFloat(src, dst, count);
+}
+
+void convertFloatToHalf(const float* src, tHalf* dst, unsigned int count, SimdLevel level) {
+	getSimdKernels(level).convertFloatToHalf(src, dst, count);
+}
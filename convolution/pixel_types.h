@@ -0,0 +1,179 @@
+#pragma once
+
+#include "cpu_features.h"
+
+#include <cstdint>
+#include <cstring>
+
+/**
+ * IEEE 754 half precision (binary16) pixel, stored as its bit pattern.  Converted to float for arithmetic.
+ */
+typedef struct half {
+	std::uint16_t bits;
+} tHalf;
+
+/**
+ * Converts a half precision value to float.  Exact.  Converts in software, one value at a time, so the result doesn't
+ * depend on the flags a translation unit is compiled with; convertHalfToFloat converts whole buffers with F16C.
+ */
+inline float halfToFloat(tHalf value) {
+	const std::uint32_t sign = static_cast<std::uint32_t>(value.bits & 0x8000) << 16;
+	const std::uint32_t exponent = (value.bits >> 10) & 0x1F;
+	const std::uint32_t mantissa = value.bits & 0x3FF;
+
+	std::uint32_t bits = 0;
+	if (exponent == 0) {
+		// zero or subnormal: mantissa * 2^-24
+		const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+		return sign != 0 ? -magnitude : magnitude;
+	}
+	else if (exponent == 0x1F) {
+		// infinity or NaN
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else {
+		bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+	}
+
+	float result = 0.0f;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+/**
+ * Converts a float to half precision, rounding to the nearest even value.  Values too large for half precision become
+ * infinity.  Converts in software, like halfToFloat; convertFloatToHalf converts whole buffers with F16C.
+ */
+inline tHalf floatToHalf(float value) {
+	std::uint32_t bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	const std::uint32_t sign = (bits >> 16) & 0x8000;
+	const std::uint32_t exponent = (bits >> 23) & 0xFF;
+	std::uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (exponent == 0xFF) {
+		// infinity stays infinity, NaN stays a (quiet) NaN
+		return tHalf{ static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0)) };
+	}
+
+	const int halfExponent = static_cast<int>(exponent) - 127 + 15;
+	if (halfExponent >= 0x1F) {
+		return tHalf{ static_cast<std::uint16_t>(sign | 0x7C00) };
+	}
+
+	if (halfExponent <= 0) {
+		// subnormal half, or too small even for that
+		if (halfExponent < -10) {
+			return tHalf{ static_cast<std::uint16_t>(sign) };
+		}
+
+		mantissa |= 0x800000;
+		const std::uint32_t shift = static_cast<std::uint32_t>(14 - halfExponent);
+		std::uint32_t halfBits = mantissa >> shift;
+		const std::uint32_t remainder = mantissa & ((1U << shift) - 1);
+		const std::uint32_t halfway = 1U << (shift - 1);
+		if ((remainder > halfway) || ((remainder == halfway) && ((halfBits & 1) != 0))) {
+			halfBits++;
+		}
+
+		return tHalf{ static_cast<std::uint16_t>(sign | halfBits) };
+	}
+
+	// a carry out of the mantissa correctly bumps the exponent, up to infinity
+	std::uint32_t halfBits = (static_cast<std::uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+	const std::uint32_t remainder = mantissa & 0x1FFF;
+	if ((remainder > 0x1000) || ((remainder == 0x1000) && ((halfBits & 1) != 0))) {
+		halfBits++;
+	}
+
+	return tHalf{ static_cast<std::uint16_t>(sign | halfBits) };
+}
+
+/**
+ * How the convolution templates read and write a pixel type.  Pixels are widened to the accumulator type when they are
+ * read, the taps are accumulated in it, and the sum is narrowed back when it is stored.  The values are not normalized: an
+ * 8-bit pixel is read as 0 to 255, so a kernel whose taps sum to 1 keeps the result in the range of the pixel type.
+ *
+ * @tparam PixelT  float, std::uint8_t, std::uint16_t or tHalf
+ */
+template <typename PixelT>
+struct pixelTraits;
+
+template <>
+struct pixelTraits<float> {
+	typedef float accumulatorT;
+
+	static float load(float pixel) {
+		return pixel;
+	}
+
+	static float store(float value) {
+		return value;
+	}
+};
+
+/**
+ * Integer pixels are accumulated in float, because the kernels are float.  Stores round to the nearest integer and saturate
+ * to the range of the type, so a kernel with negative taps (e.g. sharpening) clamps at 0 instead of wrapping around.
+ */
+template <typename IntegerT, unsigned int MaxValue>
+struct saturatingPixelTraits {
+	typedef float accumulatorT;
+
+	static float load(IntegerT pixel) {
+		return static_cast<float>(pixel);
+	}
+
+	static IntegerT store(float value) {
+		// also maps NaN to 0
+		if (!(value > 0.0f)) {
+			return 0;
+		}
+
+		if (value >= static_cast<float>(MaxValue)) {
+			return static_cast<IntegerT>(MaxValue);
+		}
+
+		return static_cast<IntegerT>(value + 0.5f);
+	}
+};
+
+template <>
+struct pixelTraits<std::uint8_t> : saturatingPixelTraits<std::uint8_t, 0xFF> {};
+
+template <>
+struct pixelTraits<std::uint16_t> : saturatingPixelTraits<std::uint16_t, 0xFFFF> {};
+
+/**
+ * Half precision pixels are accumulated in float, and the sum is rounded to the nearest half precision value.  The 1D
+ * convolution templates convert whole rows of half precision images with convertHalfToFloat / convertFloatToHalf instead
+ * (see convertedRowsPath in convolution.h); the other templates convert pixel by pixel here.
+ */
+template <>
+struct pixelTraits<tHalf> {
+	typedef float accumulatorT;
+
+	static float load(tHalf pixel) {
+		return halfToFloat(pixel);
+	}
+
+	static tHalf store(float value) {
+		return floatToHalf(value);
+	}
+};
+
+/**
+ * Converts \p count half precision values to float, 8 at a time with the F16C instructions when \p level is AVX2 or higher
+ *
+ * @param[in] src  Values to convert
+ * @param[out] dst  Converted values
+ * @param[in] count  Number of values in \p src and \p dst
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ */
+void convertHalfToFloat(const tHalf* src, float* dst, unsigned int count, SimdLevel level);
+
+/**
+ * Converts \p count floats to half precision, rounding to the nearest even value.  See convertHalfToFloat for the parameters.
+ */
+void convertFloatToHalf(const float* src, tHalf* dst, unsigned int count, SimdLevel level);
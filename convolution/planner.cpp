@@ -0,0 +1,362 @@
+#include "planner.h"
+#include "parallel_convolution.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <utility>
+
+const char* convolutionStrategyName(ConvolutionStrategy strategy) {
+	switch (strategy) {
+	case ConvolutionStrategy::Interleaved:
+		return "interleaved";
+	case ConvolutionStrategy::Planar:
+		return "planar";
+	case ConvolutionStrategy::PlanarTranspose:
+		return "planarTranspose";
+	default:
+		return "fused";
+	}
+}
+
+bool parseConvolutionStrategy(const std::string& name, ConvolutionStrategy& strategy) {
+	const ConvolutionStrategy strategies[] = { ConvolutionStrategy::Interleaved, ConvolutionStrategy::Planar, ConvolutionStrategy::PlanarTranspose, ConvolutionStrategy::Fused };
+	for (const ConvolutionStrategy candidate : strategies) {
+		if (name == convolutionStrategyName(candidate)) {
+			strategy = candidate;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char* pixelTypeName(PixelType pixelType) {
+	switch (pixelType) {
+	case PixelType::UInt8:
+		return "uint8";
+	case PixelType::UInt16:
+		return "uint16";
+	case PixelType::Float16:
+		return "float16";
+	default:
+		return "float32";
+	}
+}
+
+/**
+ * Sets the \p halo rows and columns along every border of \p image to 0, like the template for vectors
+ */
+static void clearImageEdges(const MutableImageView& image, unsigned int halo) {
+	const unsigned int pixelStride = image.pixelStride();
+
+	for (unsigned int channelIndex = 0; channelIndex < image.numChannels; channelIndex++) {
+		for (unsigned int row = 0; row < image.height; row++) {
+			float* rowStart = image.row(channelIndex, row);
+
+			if ((row < halo) || (row + halo >= image.height)) {
+				for (unsigned int col = 0; col < image.width; col++) {
+					rowStart[col * pixelStride] = 0.0f;
+				}
+			}
+			else {
+				for (unsigned int col = 0; col < image.width; col++) {
+					if ((col < halo) || (col + halo >= image.width)) {
+						rowStart[col * pixelStride] = 0.0f;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Converts \p src to the layout of \p dst, on \p pool if there is one
+ */
+static bool convertLayout(const ImageView& src, const MutableImageView& dst, ThreadPool* pool, SimdLevel level) {
+	if (src.layout == ImageLayout::Interleaved) {
+		return pool != nullptr ? interleavedToPlanarParallel(src, dst, *pool, level) : interleavedToPlanar(src, dst, level);
+	}
+
+	return pool != nullptr ? planarToInterleavedParallel(src, dst, *pool, level) : planarToInterleaved(src, dst, level);
+}
+
+static bool horizontalPass(const float* kernel, unsigned int kernelSize, const ImageView& src, const MutableImageView& dst, ThreadPool* pool, SimdLevel level) {
+	if (pool != nullptr) {
+		return convolve1DHorizontalParallel(kernel, kernelSize, src, dst, *pool, level);
+	}
+
+	if (src.layout == ImageLayout::Interleaved) {
+		return convolve1DHorizontalInterleavedAllChannels(kernel, kernelSize, src, dst, level);
+	}
+
+	bool succeeded = true;
+	for (unsigned int channelIndex = 0; channelIndex < src.numChannels; channelIndex++) {
+		succeeded = succeeded && convolve1DHorizontal(kernel, kernelSize, src, channelIndex, dst, level);
+	}
+
+	return succeeded;
+}
+
+static bool verticalPass(const float* kernel, unsigned int kernelSize, const ImageView& src, const MutableImageView& dst, ThreadPool* pool, SimdLevel level) {
+	if (pool != nullptr) {
+		return convolve1DVerticalParallel(kernel, kernelSize, src, dst, *pool, level);
+	}
+
+	if (src.layout == ImageLayout::Interleaved) {
+		return convolve1DVerticalInterleavedAllChannels(kernel, kernelSize, src, dst, level);
+	}
+
+	bool succeeded = true;
+	for (unsigned int channelIndex = 0; channelIndex < src.numChannels; channelIndex++) {
+		succeeded = succeeded && convolve1DVertical(kernel, kernelSize, src, channelIndex, dst, level);
+	}
+
+	return succeeded;
+}
+
+/**
+ * Runs \p strategy on \p src, which is already in the layout of the strategy.  The edges of \p dst are left unspecified.
+ */
+static bool convolveInLayout(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, const ImageView& src, const MutableImageView& dst, ThreadPool* pool, SimdLevel level) {
+	BufferPool& buffers = scratchBufferPool();
+
+	if (strategy == ConvolutionStrategy::Fused) {
+		if (pool != nullptr) {
+			return convolve2DSeparableParallel(kernel, kernelSize, kernel, kernelSize, src, dst, *pool, level);
+		}
+
+		bool succeeded = true;
+		for (unsigned int channelIndex = 0; channelIndex < src.numChannels; channelIndex++) {
+			succeeded = succeeded && convolve2DSeparable(kernel, kernelSize, kernel, kernelSize, src, channelIndex, dst, level);
+		}
+
+		return succeeded;
+	}
+
+	if ((strategy == ConvolutionStrategy::PlanarTranspose) && (pool == nullptr)) {
+		// each pass writes its output transposed, so the second pass brings the image back to its orientation
+		AlignedImage transposed(src.width, src.height, src.numChannels, ImageLayout::Planar, buffers);
+
+		bool succeeded = true;
+		for (unsigned int channelIndex = 0; channelIndex < src.numChannels; channelIndex++) {
+			succeeded = succeeded
+				&& convolve1DHorizontalTransposed(kernel, kernelSize, src, channelIndex, transposed.view(), level)
+				&& convolve1DHorizontalTransposed(kernel, kernelSize, transposed.view(), channelIndex, dst, level);
+		}
+
+		return succeeded;
+	}
+
+	AlignedImage intermediate(src.height, src.width, src.numChannels, src.layout, buffers);
+	if (!horizontalPass(kernel, kernelSize, src, intermediate.view(), pool, level)) {
+		return false;
+	}
+
+	if (strategy != ConvolutionStrategy::PlanarTranspose) {
+		return verticalPass(kernel, kernelSize, intermediate.view(), dst, pool, level);
+	}
+
+	// the columns of the intermediate image are the rows of the transposed one, so the vertical pass becomes a horizontal one
+	AlignedImage transposed(src.width, src.height, src.numChannels, ImageLayout::Planar, buffers);
+	AlignedImage transposedResult(src.width, src.height, src.numChannels, ImageLayout::Planar, buffers);
+
+	return transposePlanarTiled(intermediate.view(), transposed.view(), level)
+		&& horizontalPass(kernel, kernelSize, transposed.view(), transposedResult.view(), pool, level)
+		&& transposePlanarTiled(transposedResult.view(), dst, level);
+}
+
+bool convolve2DWithStrategy(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool* pool, SimdLevel level) {
+	if ((kernelSize % 2 != 1) || !isValidImageView(image) || !isValidImageView(result) || !haveSameShape(image, result)) {
+		return false;
+	}
+
+	ImageLayout blurLayout = image.layout;
+	if (strategy == ConvolutionStrategy::Interleaved) {
+		blurLayout = ImageLayout::Interleaved;
+	}
+	else if (strategy != ConvolutionStrategy::Fused) {
+		blurLayout = ImageLayout::Planar;
+	}
+
+	bool succeeded = false;
+	if (blurLayout == image.layout) {
+		succeeded = convolveInLayout(strategy, kernel, kernelSize, image, result, pool, level);
+	}
+	else {
+		BufferPool& buffers = scratchBufferPool();
+		AlignedImage converted(image.height, image.width, image.numChannels, blurLayout, buffers);
+		AlignedImage blurred(image.height, image.width, image.numChannels, blurLayout, buffers);
+
+		succeeded = convertLayout(image, converted.view(), pool, level)
+			&& convolveInLayout(strategy, kernel, kernelSize, converted.view(), blurred.view(), pool, level)
+			&& convertLayout(blurred.view(), result, pool, level);
+	}
+
+	// the strategies leave different values along the edges (untouched, or convolved scratch memory), so they are cleared
+	if (succeeded) {
+		clearImageEdges(result, kernelSize / 2);
+	}
+
+	return succeeded;
+}
+
+bool convolve2DWithStrategy(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool* pool, SimdLevel level) {
+	if ((static_cast<std::size_t>(height) * width * numChannels > image.size()) || (result.size() < image.size())) {
+		return false;
+	}
+
+	return convolve2DWithStrategy(strategy, kernel, kernelSize, makeImageView(image, layout, height, width, numChannels), makeImageView(result, layout, height, width, numChannels), pool, level);
+}
+
+bool fastestStrategy(const std::vector<ConvolutionStrategy>& candidates, const std::function<bool(ConvolutionStrategy)>& run, unsigned int iterations, ConvolutionStrategy& fastest) {
+	double fastestRuntime = std::numeric_limits<double>::max();
+	bool found = false;
+
+	for (const ConvolutionStrategy candidate : candidates) {
+		// the warm-up run also faults in the scratch buffers of the candidate
+		if (!run(candidate)) {
+			continue;
+		}
+
+		double minRuntime = std::numeric_limits<double>::max();
+		for (unsigned int i = 0; i < iterations; i++) {
+			const auto start = std::chrono::steady_clock::now();
+			run(candidate);
+			const auto end = std::chrono::steady_clock::now();
+
+			const double runtime = std::chrono::duration<double>(end - start).count();
+			if (runtime < minRuntime) {
+				minRuntime = runtime;
+			}
+		}
+
+		if (!found || (minRuntime < fastestRuntime)) {
+			fastestRuntime = minRuntime;
+			fastest = candidate;
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+ConvolutionPlanner::ConvolutionPlanner(const std::string& cachePath)
+	: cachePath(cachePath), cpu(cpuModelName())
+{
+	load();
+}
+
+std::string ConvolutionPlanner::defaultCachePath() {
+	const char* path = std::getenv("CONVOLUTION_PLANNER_CACHE");
+	if ((path != nullptr) && (path[0] != '\0')) {
+		return path;
+	}
+
+#if defined(_WIN32)
+	const char* directory = std::getenv("LOCALAPPDATA");
+	if ((directory != nullptr) && (directory[0] != '\0')) {
+		return std::string(directory) + "\\convolution_planner.txt";
+	}
+#else
+	const char* directory = std::getenv("XDG_CACHE_HOME");
+	if ((directory != nullptr) && (directory[0] != '\0')) {
+		return std::string(directory) + "/convolution_planner.txt";
+	}
+
+	const char* home = std::getenv("HOME");
+	if ((home != nullptr) && (home[0] != '\0')) {
+		return std::string(home) + "/.cache/convolution_planner.txt";
+	}
+#endif
+
+	return "";
+}
+
+std::string ConvolutionPlanner::keyString(const tPlanKey& key) const {
+	std::stringstream ss;
+	ss << cpu << '\t' << (key.layout == ImageLayout::Planar ? "planar" : "interleaved") << '\t' << pixelTypeName(key.pixelType) << '\t'
+		<< key.height << '\t' << key.width << '\t' << key.numChannels << '\t' << key.kernelSize << '\t' << key.numThreads;
+	return ss.str();
+}
+
+bool ConvolutionPlanner::findStrategy(const tPlanKey& key, ConvolutionStrategy& strategy) const {
+	const std::string keyText = keyString(key);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto decision = decisions.find(keyText);
+	if (decision == decisions.end()) {
+		return false;
+	}
+
+	strategy = decision->second;
+	return true;
+}
+
+bool ConvolutionPlanner::setStrategy(const tPlanKey& key, ConvolutionStrategy strategy) {
+	const std::string keyText = keyString(key);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	decisions[keyText] = strategy;
+	return save();
+}
+
+/**
+ * Adds the decisions in the cache file at \p path to \p decisions, except for keys \p decisions already has.  A missing
+ * file adds nothing.
+ */
+static void mergeDecisionFile(const std::string& path, std::map<std::string, ConvolutionStrategy>& decisions) {
+	std::ifstream file(path);
+	std::string line;
+	while (std::getline(file, line)) {
+		// the strategy is the last field, everything before it is the key
+		const std::size_t separator = line.rfind('\t');
+		ConvolutionStrategy strategy;
+		if ((separator == std::string::npos) || !parseConvolutionStrategy(line.substr(separator + 1), strategy)) {
+			continue;
+		}
+
+		decisions.insert(std::make_pair(line.substr(0, separator), strategy));
+	}
+}
+
+void ConvolutionPlanner::load() {
+	if (cachePath.empty()) {
+		return;
+	}
+
+	mergeDecisionFile(cachePath, decisions);
+}
+
+bool ConvolutionPlanner::save() {
+	if (cachePath.empty()) {
+		return true;
+	}
+
+	// other processes may have added decisions since the file was loaded, so they are merged in first, and this planner's
+	// decisions win for the keys both have
+	mergeDecisionFile(cachePath, decisions);
+
+	// written next to the cache and renamed over it, so a process that reads it never sees half a file
+	const std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath);
+		for (const auto& decision : decisions) {
+			file << decision.first << '\t' << convolutionStrategyName(decision.second) << '\n';
+		}
+
+		if (!file) {
+			return false;
+		}
+	}
+
+#if defined(_WIN32)
+	// rename doesn't replace an existing file on Windows
+	std::remove(cachePath.c_str());
+#endif
+
+	return std::rename(temporaryPath.c_str(), cachePath.c_str()) == 0;
+}
@@ -0,0 +1,379 @@
+#pragma once
+
+#include "convolution.h"
+#include "thread_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Ways of computing a separable 2D convolution of every channel of an image.  Which one is fastest depends on the shape of
+ * the image, the kernel size, the pixel type and the number of threads, see ConvolutionPlanner.
+ */
+enum class ConvolutionStrategy {
+	Interleaved,		// horizontal pass, then vertical pass, on the image in interleaved layout
+	Planar,			// horizontal pass, then vertical pass, on the image in planar layout
+	PlanarTranspose,	// planar horizontal pass and transpose, twice (fused into convolve1DHorizontalTransposed for floats on one thread)
+	Fused			// both passes fused row by row (convolve2DSeparable), in the layout of the image.  Float images only.
+};
+
+/**
+ * @return  Name of \p strategy as stored in the planner cache, e.g. "planarTranspose"
+ */
+const char* convolutionStrategyName(ConvolutionStrategy strategy);
+
+/**
+ * Inverse of convolutionStrategyName
+ *
+ * @return  true if \p name is the name of a strategy
+ */
+bool parseConvolutionStrategy(const std::string& name, ConvolutionStrategy& strategy);
+
+/**
+ * Pixel types the planner keeps separate decisions for
+ */
+enum class PixelType {
+	Float32,
+	UInt8,
+	UInt16,
+	Float16
+};
+
+template <typename PixelT>
+struct pixelTypeOf;
+
+template <>
+struct pixelTypeOf<float> {
+	static const PixelType value = PixelType::Float32;
+};
+
+template <>
+struct pixelTypeOf<std::uint8_t> {
+	static const PixelType value = PixelType::UInt8;
+};
+
+template <>
+struct pixelTypeOf<std::uint16_t> {
+	static const PixelType value = PixelType::UInt16;
+};
+
+template <>
+struct pixelTypeOf<tHalf> {
+	static const PixelType value = PixelType::Float16;
+};
+
+/**
+ * @return  Name of \p pixelType as stored in the planner cache, e.g. "uint8"
+ */
+const char* pixelTypeName(PixelType pixelType);
+
+/**
+ * Everything the planner's decision depends on, besides the CPU
+ */
+typedef struct planKey {
+	ImageLayout layout;		// layout of the caller's image and result
+	unsigned int height;
+	unsigned int width;
+	unsigned int numChannels;
+	unsigned int kernelSize;
+	PixelType pixelType;
+	unsigned int numThreads;	// size of the pool, 1 without one
+} tPlanKey;
+
+/**
+ * Performs a separable 2D convolution of every channel of \p image with \p kernel in both directions, computed with
+ * \p strategy.  Strategies that work in the other layout convert the image to it and the result back, so every strategy
+ * takes and returns images in the layout of the caller.  The scratch images are taken from scratchBufferPool().  All
+ * strategies compute the same pixels, up to float rounding: the convolution of the interior, and 0 along the edges (the
+ * kernelSize / 2 rows and columns next to the border).
+ *
+ * @param[in] strategy  How to compute the convolution
+ * @param[in] kernel  1D kernel to convolve the rows and the columns with.  Must have odd length.
+ * @param[in] kernelSize  Number of elements in \p kernel
+ * @param[in] image  Image to convolve
+ * @param[out] result  Image to write the result to, with the same shape as \p image
+ * @param[in] pool  Pool to run the passes on, or nullptr to run them on the calling thread.  The transposes and the layout
+ *                  conversions of the transposing strategy run on the calling thread.
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false if the kernel has even length or the views are invalid or differ in shape
+ */
+bool convolve2DWithStrategy(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, const ImageView& image, const MutableImageView& result, ThreadPool* pool, SimdLevel level);
+
+/**
+ * Same as the image view overload of convolve2DWithStrategy, for a dense image in a vector
+ */
+bool convolve2DWithStrategy(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<float>& result, ThreadPool* pool, SimdLevel level);
+
+/**
+ * Sets the \p halo rows and columns along every border of \p image to 0
+ */
+template <typename PixelT>
+void clearImageEdges(ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int halo, std::vector<PixelT>& image) {
+	const unsigned int pixelStride = layout == ImageLayout::Planar ? 1 : numChannels;
+	const unsigned int rowPitch = width * pixelStride;
+	const std::size_t channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1;
+	const PixelT zero = pixelTraits<PixelT>::store(0.0f);
+
+	for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+		for (unsigned int row = 0; row < height; row++) {
+			PixelT* rowStart = image.data() + channelIndex * channelPitch + static_cast<std::size_t>(row) * rowPitch;
+			const bool edgeRow = (row < halo) || (row + halo >= height);
+
+			for (unsigned int col = 0; col < width; col++) {
+				if (edgeRow || (col < halo) || (col + halo >= width)) {
+					rowStart[col * pixelStride] = zero;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Same as convolve2DWithStrategy, for images of 8-bit, 16-bit or half precision pixels.  The passes use the reference
+ * templates (convolve1DHorizontalPlanar and friends), which run on the calling thread, so \p pool and \p level are unused.
+ * ConvolutionStrategy::Fused is only implemented for floats, and fails.  A float image uses the non-template overload.
+ *
+ * @tparam PixelT  Pixel type - std::uint8_t, std::uint16_t or tHalf
+ */
+template <typename PixelT>
+bool convolve2DWithStrategy(ConvolutionStrategy strategy, const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<PixelT>& result, ThreadPool* pool, SimdLevel level) {
+	(void)pool;
+	(void)level;
+
+	if ((strategy == ConvolutionStrategy::Fused) || (kernelSize % 2 != 1)) {
+		return false;
+	}
+
+	const std::size_t imageSize = static_cast<std::size_t>(height) * width * numChannels;
+	if ((image.size() < imageSize) || (result.size() < imageSize)) {
+		return false;
+	}
+
+	const std::vector<float> taps(kernel, kernel + kernelSize);
+	const ImageLayout blurLayout = strategy == ConvolutionStrategy::Interleaved ? ImageLayout::Interleaved : ImageLayout::Planar;
+
+	// the image and the result in the layout of the strategy
+	std::vector<PixelT> converted;
+	std::vector<PixelT> blurred;
+	if (layout != blurLayout) {
+		converted.resize(imageSize);
+		blurred.resize(imageSize);
+
+		const bool convertedImage = layout == ImageLayout::Interleaved ? interleavedToPlanar(image, height, width, numChannels, converted) : planarToInterleaved(image, height, width, numChannels, converted);
+		if (!convertedImage) {
+			return false;
+		}
+	}
+
+	const std::vector<PixelT>& src = layout != blurLayout ? converted : image;
+	std::vector<PixelT>& dst = layout != blurLayout ? blurred : result;
+	std::vector<PixelT> intermediate(imageSize);
+
+	bool succeeded = true;
+	if (strategy == ConvolutionStrategy::Interleaved) {
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DHorizontalInterleaved(taps, src, height, width, numChannels, channelIndex, intermediate);
+		}
+
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DVerticalInterleaved(taps, intermediate, height, width, numChannels, channelIndex, dst);
+		}
+	}
+	else if (strategy == ConvolutionStrategy::Planar) {
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DHorizontalPlanar(taps, src, height, width, numChannels, channelIndex, intermediate);
+			succeeded = succeeded && convolve1DVerticalPlanar(taps, intermediate, height, width, numChannels, channelIndex, dst);
+		}
+	}
+	else {
+		std::vector<PixelT> transposed(imageSize);
+		std::vector<PixelT> transposedBlurred(imageSize);
+
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DHorizontalPlanar(taps, src, height, width, numChannels, channelIndex, intermediate);
+		}
+
+		succeeded = succeeded && transposePlanar(intermediate, height, width, numChannels, transposed);
+
+		for (unsigned int channelIndex = 0; channelIndex < numChannels; channelIndex++) {
+			succeeded = succeeded && convolve1DHorizontalPlanar(taps, transposed, width, height, numChannels, channelIndex, transposedBlurred);
+		}
+
+		succeeded = succeeded && transposePlanar(transposedBlurred, width, height, numChannels, dst);
+	}
+
+	if (succeeded && (layout != blurLayout)) {
+		succeeded = layout == ImageLayout::Interleaved ? planarToInterleaved(blurred, height, width, numChannels, result) : interleavedToPlanar(blurred, height, width, numChannels, result);
+	}
+
+	if (succeeded) {
+		clearImageEdges(layout, height, width, numChannels, kernelSize / 2, result);
+	}
+
+	return succeeded;
+}
+
+/**
+ * Runs every strategy in \p candidates once to warm up, then \p iterations more times, and picks the one with the lowest
+ * runtime of an iteration.  Candidates whose run fails are skipped.
+ *
+ * @param[in] candidates  Strategies to try
+ * @param[in] run  Computes the convolution with the given strategy, and returns whether it succeeded
+ * @param[in] iterations  Number of timed runs per strategy
+ * @param[out] fastest  The fastest strategy
+ *
+ * @return  true if at least one candidate succeeded
+ */
+bool fastestStrategy(const std::vector<ConvolutionStrategy>& candidates, const std::function<bool(ConvolutionStrategy)>& run, unsigned int iterations, ConvolutionStrategy& fastest);
+
+/**
+ * Picks the fastest ConvolutionStrategy for an image shape, kernel size, pixel type and number of threads by timing all of
+ * them once, on a scratch image of that shape, and remembers the decision.  The decisions are keyed by cpuModelName() as
+ * well, and persisted to a text file, so later calls, and later processes on the same kind of machine, reuse them instead of
+ * tuning again.  A cache file may be shared by machines with different CPUs, and by processes: the file is read again and
+ * merged with the decisions in memory whenever it is rewritten, so the decisions of other CPUs and processes are kept.  Two
+ * processes that rewrite it at the very same time may still lose one of their new decisions, which is only tuned again.
+ *
+ * The cache file has one decision per line, in tab-separated fields:
+ *
+ *   cpu model \t layout \t pixel type \t height \t width \t channels \t kernel size \t threads \t strategy
+ *
+ * Lines that can't be parsed are dropped.  Deleting the file forces a new tuning run.
+ *
+ * The decisions are guarded by a mutex, so a planner can be shared by threads.  Threads that plan the same new key at
+ * the same time may tune it twice.
+ */
+class ConvolutionPlanner {
+public:
+	/**
+	 * Number of timed runs per strategy in a tuning run, after one warm-up run
+	 */
+	static const unsigned int tuningIterations = 3;
+
+	/**
+	 * Loads the decisions in \p cachePath, if the file exists
+	 *
+	 * @param[in] cachePath  File the decisions are read from and written to.  Empty keeps them in memory only.
+	 */
+	explicit ConvolutionPlanner(const std::string& cachePath);
+
+	ConvolutionPlanner(const ConvolutionPlanner&) = delete;
+	ConvolutionPlanner& operator=(const ConvolutionPlanner&) = delete;
+
+	/**
+	 * Path of the cache file for planners that have no better place: the CONVOLUTION_PLANNER_CACHE environment variable if
+	 * it is set, otherwise convolution_planner.txt in the user's cache directory ($XDG_CACHE_HOME, ~/.cache, or
+	 * %LOCALAPPDATA% on Windows), which must exist.  Empty if none of them is set.
+	 */
+	static std::string defaultCachePath();
+
+	/**
+	 * @return  The CPU model the decisions of this planner are stored under
+	 */
+	const std::string& cpuModel() const {
+		return cpu;
+	}
+
+	/**
+	 * Looks up the decision for \p key, without tuning
+	 *
+	 * @return  true if there is one
+	 */
+	bool findStrategy(const tPlanKey& key, ConvolutionStrategy& strategy) const;
+
+	/**
+	 * Stores \p strategy as the decision for \p key, replacing the previous one, and rewrites the cache file.  Lets a
+	 * caller pin a strategy, or import decisions tuned elsewhere.
+	 *
+	 * @return  true if the cache file was written (or there is none)
+	 */
+	bool setStrategy(const tPlanKey& key, ConvolutionStrategy strategy);
+
+	/**
+	 * Returns the decision for the given shape, tuning it first if there is none: every strategy that supports PixelT
+	 * convolves an image of that shape tuningIterations + 1 times, so the first call for a shape allocates a few images of
+	 * that shape and takes as long as a few dozen convolutions.
+	 *
+	 * @param[in] layout  Layout of the images that will be convolved
+	 * @param[in] height  Height of the images
+	 * @param[in] width  Width of the images
+	 * @param[in] numChannels  Number of channels in the images
+	 * @param[in] kernelSize  Number of elements in the kernel.  Must be odd.
+	 * @param[in] pool  Pool the convolutions will run on, or nullptr
+	 * @param[out] strategy  The fastest strategy
+	 *
+	 * @return  true if a strategy was found, false if the kernel size is even or the image is empty
+	 */
+	template <typename PixelT>
+	bool plan(ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int kernelSize, ThreadPool* pool, ConvolutionStrategy& strategy) {
+		if ((kernelSize % 2 != 1) || (height == 0) || (width == 0) || (numChannels == 0)) {
+			return false;
+		}
+
+		const tPlanKey key{ layout, height, width, numChannels, kernelSize, pixelTypeOf<PixelT>::value, pool != nullptr ? pool->size() : 1 };
+		if (findStrategy(key, strategy)) {
+			return true;
+		}
+
+		std::vector<ConvolutionStrategy> candidates{ ConvolutionStrategy::Interleaved, ConvolutionStrategy::Planar, ConvolutionStrategy::PlanarTranspose };
+		if (std::is_same<PixelT, float>::value) {
+			candidates.push_back(ConvolutionStrategy::Fused);
+		}
+
+		// the runtime doesn't depend on the values, as long as they are ordinary numbers
+		std::vector<PixelT> image(static_cast<std::size_t>(height) * width * numChannels);
+		for (std::size_t i = 0; i < image.size(); i++) {
+			image[i] = pixelTraits<PixelT>::store(static_cast<float>(i % 251));
+		}
+
+		std::vector<PixelT> result(image.size());
+		const std::vector<float> kernel(kernelSize, 1.0f / static_cast<float>(kernelSize));
+		const SimdLevel level = getSimdLevel();
+
+		const bool tuned = fastestStrategy(candidates, [&](ConvolutionStrategy candidate) {
+			return convolve2DWithStrategy(candidate, kernel.data(), kernelSize, layout, image, height, width, numChannels, result, pool, level);
+		}, tuningIterations, strategy);
+
+		if (!tuned) {
+			return false;
+		}
+
+		// a cache file that can't be written only costs a tuning run in the next process
+		setStrategy(key, strategy);
+		return true;
+	}
+
+	/**
+	 * Convolves every channel of \p image with \p kernel in both directions, with the strategy plan returns for its shape.
+	 * See convolve2DWithStrategy for the parameters.
+	 *
+	 * @return  true if the convolution succeeded
+	 */
+	template <typename PixelT>
+	bool convolve(const float* kernel, unsigned int kernelSize, ImageLayout layout, const std::vector<PixelT>& image, unsigned int height, unsigned int width, unsigned int numChannels, std::vector<PixelT>& result, ThreadPool* pool) {
+		ConvolutionStrategy strategy;
+		if (!plan<PixelT>(layout, height, width, numChannels, kernelSize, pool, strategy)) {
+			return false;
+		}
+
+		return convolve2DWithStrategy(strategy, kernel, kernelSize, layout, image, height, width, numChannels, result, pool, getSimdLevel());
+	}
+
+private:
+	std::string keyString(const tPlanKey& key) const;
+	void load();
+	bool save();
+
+	const std::string cachePath;
+	const std::string cpu;
+
+	// "cpu model \t ... \t threads" -> decision, for every CPU in the cache file
+	mutable std::mutex mutex;
+	std::map<std::string, ConvolutionStrategy> decisions;
+};
@@ -0,0 +1,207 @@
+#include "simd_kernels.h"
+
+#include <algorithm>
+
+void transposeBlockScalar(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols) {
+	for (unsigned int r = 0; r < rows; r++) {
+		for (unsigned int c = 0; c < cols; c++) {
+			dst[c * dstStride + r] = src[r * srcStride + c];
+		}
+	}
+}
+
+void convolveRowHorizontalScalar(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		const float* px = src + i * pxStride;
+
+		float convolutionResult = 0.0f;
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			convolutionResult += kernel[kernelIndex] * px[kernelIndex * pxStride];
+		}
+
+		dst[i * pxStride] = convolutionResult;
+	}
+}
+
+void convolveRowVerticalScalar(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count) {
+	convolveRowVerticalScalarFrom(kernel, kernelSize, rows, pxStride, dst, 0, count);
+}
+
+void convolveRowVerticalScalarFrom(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int begin, unsigned int count) {
+	for (unsigned int i = begin; i < count; i++) {
+		const unsigned int px = i * pxStride;
+
+		float convolutionResult = 0.0f;
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			convolutionResult += kernel[kernelIndex] * rows[kernelIndex][px];
+		}
+
+		dst[px] = convolutionResult;
+	}
+}
+
+void convolveRowHorizontalAllChannelsScalar(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		float convolutionResult = 0.0f;
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			convolutionResult += kernel[kernelIndex] * src[i + kernelIndex * tapStride];
+		}
+
+		dst[i] = convolutionResult;
+	}
+}
+
+void convolveRows2DScalar(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count) {
+	for (unsigned int row = 0; row < numRows; row++) {
+		for (unsigned int i = 0; i < count; i++) {
+			float convolutionResult = 0.0f;
+			for (unsigned int kernelRow = 0; kernelRow < kernelSize; kernelRow++) {
+				const float* taps = kernel + kernelRow * kernelSize;
+				const float* src = rows[row + kernelRow] + i;
+
+				for (unsigned int kernelCol = 0; kernelCol < kernelSize; kernelCol++) {
+					convolutionResult += taps[kernelCol] * src[kernelCol * tapStride];
+				}
+			}
+
+			dst[row][i] = convolutionResult;
+		}
+	}
+}
+
+void convertHalfToFloatScalar(const tHalf* src, float* dst, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		dst[i] = halfToFloat(src[i]);
+	}
+}
+
+void convertFloatToHalfScalar(const float* src, tHalf* dst, unsigned int count) {
+	for (unsigned int i = 0; i < count; i++) {
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+/**
+ * Pixels per block of the generic (de)interleave kernels.  Each channel is copied out of (or into) the block with a
+ * contiguous walk over its own row, so the block's numChannels * blockPixels interleaved floats (16 KiB) must stay in L1
+ * until the last channel has been through it.
+ */
+static unsigned int interleaveBlockPixels(unsigned int numChannels) {
+	return std::max(16U, 4096U / numChannels);
+}
+
+void deinterleaveRowScalar(const float* src, unsigned int numChannels, float* const* dst, unsigned int count) {
+	const unsigned int blockPixels = interleaveBlockPixels(numChannels);
+
+	for (unsigned int blockBegin = 0; blockBegin < count; blockBegin += blockPixels) {
+		const unsigned int blockEnd = std::min(count, blockBegin + blockPixels);
+
+		for (unsigned int ch = 0; ch < numChannels; ch++) {
+			const float* srcChannel = src + ch;
+			float* dstChannel = dst[ch];
+
+			for (unsigned int i = blockBegin; i < blockEnd; i++) {
+				dstChannel[i] = srcChannel[i * numChannels];
+			}
+		}
+	}
+}
+
+void interleaveRowScalar(const float* const* src, unsigned int numChannels, float* dst, unsigned int count) {
+	const unsigned int blockPixels = interleaveBlockPixels(numChannels);
+
+	for (unsigned int blockBegin = 0; blockBegin < count; blockBegin += blockPixels) {
+		const unsigned int blockEnd = std::min(count, blockBegin + blockPixels);
+
+		for (unsigned int ch = 0; ch < numChannels; ch++) {
+			const float* srcChannel = src[ch];
+			float* dstChannel = dst + ch;
+
+			for (unsigned int i = blockBegin; i < blockEnd; i++) {
+				dstChannel[i * numChannels] = srcChannel[i];
+			}
+		}
+	}
+}
+
+void fftForwardLanesScalar(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	// the butterflies of the first pass are size / 2 points apart, those of the last pass are neighbours
+	for (unsigned int half = size / 2; half >= 1; half /= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				const float wRe = twiddleRe[j * twiddleStep];
+				const float wIm = twiddleIm[j * twiddleStep];
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				for (unsigned int lane = 0; lane < fftLanes; lane++) {
+					const float diffRe = aRe[lane] - bRe[lane];
+					const float diffIm = aIm[lane] - bIm[lane];
+					aRe[lane] += bRe[lane];
+					aIm[lane] += bIm[lane];
+					bRe[lane] = diffRe * wRe - diffIm * wIm;
+					bIm[lane] = diffRe * wIm + diffIm * wRe;
+				}
+			}
+		}
+	}
+}
+
+void fftInverseLanesScalar(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	// the passes of fftForwardLanesScalar in reverse order, with the conjugate twiddles
+	for (unsigned int half = 1; half < size; half *= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				const float wRe = twiddleRe[j * twiddleStep];
+				const float wIm = -twiddleIm[j * twiddleStep];
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				for (unsigned int lane = 0; lane < fftLanes; lane++) {
+					const float productRe = bRe[lane] * wRe - bIm[lane] * wIm;
+					const float productIm = bRe[lane] * wIm + bIm[lane] * wRe;
+					bRe[lane] = aRe[lane] - productRe;
+					bIm[lane] = aIm[lane] - productIm;
+					aRe[lane] += productRe;
+					aIm[lane] += productIm;
+				}
+			}
+		}
+	}
+}
+
+const tSimdKernels& getSimdKernels(SimdLevel level) {
+	static const tSimdKernels scalarKernels{ SimdLevel::Scalar, transposeBlockScalar, convolveRowHorizontalScalar, convolveRowVerticalScalar, convolveRowHorizontalAllChannelsScalar, convolveRows2DScalar, convertHalfToFloatScalar, convertFloatToHalfScalar, deinterleaveRowScalar, interleaveRowScalar, fftForwardLanesScalar, fftInverseLanesScalar };
+
+#if defined(CONVOLUTION_X86_SIMD)
+	static const tSimdKernels sse2Kernels{ SimdLevel::SSE2, transposeBlockSSE2, convolveRowHorizontalScalar, convolveRowVerticalScalar, convolveRowHorizontalAllChannelsScalar, convolveRows2DScalar, convertHalfToFloatScalar, convertFloatToHalfScalar, deinterleaveRowSSE2, interleaveRowSSE2, fftForwardLanesScalar, fftInverseLanesScalar };
+	static const tSimdKernels avxKernels{ SimdLevel::AVX, transposeBlockAVX, convolveRowHorizontalScalar, convolveRowVerticalScalar, convolveRowHorizontalAllChannelsScalar, convolveRows2DScalar, convertHalfToFloatScalar, convertFloatToHalfScalar, deinterleaveRowSSE2, interleaveRowSSE2, fftForwardLanesScalar, fftInverseLanesScalar };
+	static const tSimdKernels avx2Kernels{ SimdLevel::AVX2, transposeBlockAVX, convolveRowHorizontalAVX2, convolveRowVerticalAVX2, convolveRowHorizontalAllChannelsAVX2, convolveRows2DAVX2, convertHalfToFloatAVX2, convertFloatToHalfAVX2, deinterleaveRowSSE2, interleaveRowSSE2, fftForwardLanesAVX2, fftInverseLanesAVX2 };
+	static const tSimdKernels avx512Kernels{ SimdLevel::AVX512, transposeBlockAVX, convolveRowHorizontalAVX512, convolveRowVerticalAVX512, convolveRowHorizontalAllChannelsAVX512, convolveRows2DAVX512, convertHalfToFloatAVX2, convertFloatToHalfAVX2, deinterleaveRowSSE2, interleaveRowSSE2, fftForwardLanesAVX512, fftInverseLanesAVX512 };
+
+	switch (level) {
+	case SimdLevel::AVX512:
+		return avx512Kernels;
+	case SimdLevel::AVX2:
+		return avx2Kernels;
+	case SimdLevel::AVX:
+		return avxKernels;
+	case SimdLevel::SSE2:
+		return sse2Kernels;
+	default:
+		break;
+	}
+#else
+	(void)level;
+#endif
+
+	return scalarKernels;
+}
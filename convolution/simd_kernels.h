@@ -0,0 +1,153 @@
+#pragma once
+
+#include "cpu_features.h"
+#include "pixel_types.h"
+
+// Internal to the convolution library.  Each instruction set level has its own translation unit (simd_kernels_*.cpp),
+// compiled with the matching compiler flags, so none of these kernels may be called unless the CPU supports the level.
+
+/**
+ * Transposes a block of \p rows x \p cols floats.  dst[c * dstStride + r] = src[r * srcStride + c]
+ */
+using transposeBlockFn = void (*)(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols);
+
+/**
+ * 1D convolution of \p count consecutive pixels of a row, where consecutive pixels are \p pxStride floats apart.
+ * dst[i * pxStride] = sum over k of kernel[k] * src[(i + k) * pxStride], so \p src points at the first tap of the first output pixel.
+ */
+using convolveRowFn = void (*)(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count);
+
+/**
+ * 1D vertical convolution of \p count consecutive pixels of a row, accumulating whole input rows one tap at a time so every
+ * load is contiguous (or \p pxStride apart).  dst[i * pxStride] = sum over k of kernel[k] * rows[k][i * pxStride], so
+ * rows[k] points at the first pixel of the input row under tap k.
+ */
+using convolveRowVerticalFn = void (*)(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count);
+
+/**
+ * 1D horizontal convolution of \p count consecutive elements of an interleaved row, covering every channel in one sweep.
+ * dst[i] = sum over k of kernel[k] * src[i + k * tapStride], where tapStride is the number of channels, so the taps of an
+ * element are the same channel of the neighbouring pixels, and the SIMD lanes hold whole pixels (e.g. 2 RGBA pixels per AVX register).
+ */
+using convolveRowAllChannelsFn = void (*)(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count);
+
+/**
+ * 2D convolution of \p count consecutive elements of \p numRows output rows with a \p kernelSize x \p kernelSize kernel,
+ * stored row by row.  dst[r][i] = sum over kr and kc of kernel[kr * kernelSize + kc] * rows[r + kr][i + kc * tapStride], so
+ * \p rows holds the \p numRows + \p kernelSize - 1 input rows under the output rows, each pointing at the first tap of the
+ * first output element.  \p tapStride is 1 for a planar row, or the number of channels of an interleaved row, whose
+ * elements are then convolved with all their channels at once, like convolveRowAllChannelsFn.
+ *
+ * The SIMD kernels accumulate blocks of several output rows and vectors in registers, and load each input vector under a
+ * block once for all the output rows of the block.
+ */
+using convolveRows2DFn = void (*)(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count);
+
+/**
+ * Converts \p count half precision values to float
+ */
+using convertHalfToFloatFn = void (*)(const tHalf* src, float* dst, unsigned int count);
+
+/**
+ * Converts \p count floats to half precision, rounding to the nearest even value
+ */
+using convertFloatToHalfFn = void (*)(const float* src, tHalf* dst, unsigned int count);
+
+/**
+ * Splits \p count pixels of an interleaved row with \p numChannels channels into one row per channel.
+ * dst[c][i] = src[i * numChannels + c]
+ */
+using deinterleaveRowFn = void (*)(const float* src, unsigned int numChannels, float* const* dst, unsigned int count);
+
+/**
+ * Merges one row per channel into \p count pixels of an interleaved row with \p numChannels channels.
+ * dst[i * numChannels + c] = src[c][i]
+ */
+using interleaveRowFn = void (*)(const float* const* src, unsigned int numChannels, float* dst, unsigned int count);
+
+/**
+ * Number of independent sequences the FFT kernels transform at once.  Element n of sequence l is stored at n * fftLanes + l,
+ * so every butterfly works on whole vectors of lanes (one AVX-512 register, two AVX registers).
+ */
+const unsigned int fftLanes = 16;
+
+/**
+ * In-place radix-2 FFT of fftLanes complex sequences of \p size points, where \p size is a power of 2.  Element n of
+ * sequence l is re[n * fftLanes + l] + i * im[n * fftLanes + l].  twiddleRe[k] + i * twiddleIm[k] = exp(-2 pi i k / size)
+ * for k < size / 2.
+ *
+ * The forward transform (decimation in frequency) takes the sequences in natural order and leaves the spectrum in
+ * bit-reversed order.  The inverse transform (decimation in time) takes a spectrum in bit-reversed order and leaves the
+ * sequences in natural order, unscaled, so a forward and an inverse transform multiply the sequences by \p size.
+ */
+using fftLanesFn = void (*)(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+
+/**
+ * Table of the kernels to use for one instruction set level.
+ */
+typedef struct simdKernels {
+	SimdLevel level;
+	transposeBlockFn transposeBlock;
+	convolveRowFn convolveRowHorizontal;
+	convolveRowVerticalFn convolveRowVertical;
+	convolveRowAllChannelsFn convolveRowHorizontalAllChannels;
+	convolveRows2DFn convolveRows2D;
+	convertHalfToFloatFn convertHalfToFloat;
+	convertFloatToHalfFn convertFloatToHalf;
+	deinterleaveRowFn deinterleaveRow;
+	interleaveRowFn interleaveRow;
+	fftLanesFn fftForwardLanes;
+	fftLanesFn fftInverseLanes;
+} tSimdKernels;
+
+/**
+ * Returns the kernel table for \p level.  If the library wasn't built with kernels for \p level, the table for the
+ * highest level below it is returned.
+ */
+const tSimdKernels& getSimdKernels(SimdLevel level);
+
+void transposeBlockScalar(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols);
+void transposeBlockSSE2(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols);
+void transposeBlockAVX(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols);
+
+void convolveRowHorizontalScalar(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count);
+void convolveRowHorizontalAVX2(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count);
+void convolveRowHorizontalAVX512(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count);
+
+void convolveRowVerticalScalar(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count);
+void convolveRowVerticalAVX2(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count);
+void convolveRowVerticalAVX512(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count);
+
+/**
+ * convolveRowVerticalScalar for outputs [\p begin, \p count) of the row only.  The row pointers can't be offset to the first
+ * output like the source of the horizontal kernels, so the SIMD kernels finish their rows with this.
+ */
+void convolveRowVerticalScalarFrom(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int begin, unsigned int count);
+
+void convolveRowHorizontalAllChannelsScalar(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count);
+void convolveRowHorizontalAllChannelsAVX2(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count);
+void convolveRowHorizontalAllChannelsAVX512(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count);
+
+void convolveRows2DScalar(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count);
+void convolveRows2DAVX2(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count);
+void convolveRows2DAVX512(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count);
+
+void convertHalfToFloatScalar(const tHalf* src, float* dst, unsigned int count);
+void convertHalfToFloatAVX2(const tHalf* src, float* dst, unsigned int count);
+
+void convertFloatToHalfScalar(const float* src, tHalf* dst, unsigned int count);
+void convertFloatToHalfAVX2(const float* src, tHalf* dst, unsigned int count);
+
+void deinterleaveRowScalar(const float* src, unsigned int numChannels, float* const* dst, unsigned int count);
+void deinterleaveRowSSE2(const float* src, unsigned int numChannels, float* const* dst, unsigned int count);
+
+void interleaveRowScalar(const float* const* src, unsigned int numChannels, float* dst, unsigned int count);
+void interleaveRowSSE2(const float* const* src, unsigned int numChannels, float* dst, unsigned int count);
+
+void fftForwardLanesScalar(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+void fftForwardLanesAVX2(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+void fftForwardLanesAVX512(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+
+void fftInverseLanesScalar(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+void fftInverseLanesAVX2(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
+void fftInverseLanesAVX512(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm);
@@ -0,0 +1,76 @@
+#include "simd_kernels.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstdint>
+
+static inline __m256 loadRowPair(const float* low, unsigned int highOffset) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(low + highOffset), 1);
+}
+
+void transposeBlockAVX(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols) {
+	// the 32 byte stores split a cache line whenever a destination row isn't 32 byte aligned, which costs more than the
+	// wider registers save.  The buffers malloc hands out, std::vector storage included, are only 16 byte aligned, so the
+	// first source rows, up to the next 32 byte boundary of the destination rows, go to the 4x4 kernel instead, and the
+	// 8x8 transposes start from there.  That only aligns every destination row if the stride is a multiple of 8.
+	if ((dstStride % 8) != 0) {
+		transposeBlockSSE2(src, srcStride, dst, dstStride, rows, cols);
+		return;
+	}
+
+	const unsigned int misalignment = static_cast<unsigned int>((reinterpret_cast<std::uintptr_t>(dst) % 32) / sizeof(float));
+	const unsigned int leadingRows = misalignment == 0 ? 0 : std::min(rows, 8 - misalignment);
+	if (leadingRows > 0) {
+		transposeBlockSSE2(src, srcStride, dst, dstStride, leadingRows, cols);
+		src += leadingRows * srcStride;
+		dst += leadingRows;
+		rows -= leadingRows;
+	}
+
+	const unsigned int rows8 = rows & ~7U;
+	const unsigned int cols8 = cols & ~7U;
+
+	// 8x8 register transposes for the part of the block that is a multiple of 8 in both dimensions
+	for (unsigned int r = 0; r < rows8; r += 8) {
+		const float* srcRow = src + r * srcStride;
+
+		for (unsigned int c = 0; c < cols8; c += 8) {
+			// each register holds 4 columns of row i in its low lane and the same 4 columns of row i + 4 in its high lane,
+			// so the lane crossing happens in the loads and the shuffles below never have to cross lanes
+			const __m256 row0 = loadRowPair(srcRow + c, 4 * srcStride);
+			const __m256 row1 = loadRowPair(srcRow + srcStride + c, 4 * srcStride);
+			const __m256 row2 = loadRowPair(srcRow + 2 * srcStride + c, 4 * srcStride);
+			const __m256 row3 = loadRowPair(srcRow + 3 * srcStride + c, 4 * srcStride);
+			const __m256 row4 = loadRowPair(srcRow + c + 4, 4 * srcStride);
+			const __m256 row5 = loadRowPair(srcRow + srcStride + c + 4, 4 * srcStride);
+			const __m256 row6 = loadRowPair(srcRow + 2 * srcStride + c + 4, 4 * srcStride);
+			const __m256 row7 = loadRowPair(srcRow + 3 * srcStride + c + 4, 4 * srcStride);
+
+			// interleave pairs of rows
+			const __m256 t0 = _mm256_unpacklo_ps(row0, row1);
+			const __m256 t1 = _mm256_unpackhi_ps(row0, row1);
+			const __m256 t2 = _mm256_unpacklo_ps(row2, row3);
+			const __m256 t3 = _mm256_unpackhi_ps(row2, row3);
+			const __m256 t4 = _mm256_unpacklo_ps(row4, row5);
+			const __m256 t5 = _mm256_unpackhi_ps(row4, row5);
+			const __m256 t6 = _mm256_unpacklo_ps(row6, row7);
+			const __m256 t7 = _mm256_unpackhi_ps(row6, row7);
+
+			// gather the 8-element columns
+			float* dstRow = dst + c * dstStride + r;
+			_mm256_storeu_ps(dstRow, _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)));
+			_mm256_storeu_ps(dstRow + dstStride, _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)));
+			_mm256_storeu_ps(dstRow + 2 * dstStride, _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)));
+			_mm256_storeu_ps(dstRow + 3 * dstStride, _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)));
+			_mm256_storeu_ps(dstRow + 4 * dstStride, _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)));
+			_mm256_storeu_ps(dstRow + 5 * dstStride, _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2)));
+			_mm256_storeu_ps(dstRow + 6 * dstStride, _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)));
+			_mm256_storeu_ps(dstRow + 7 * dstStride, _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2)));
+		}
+	}
+
+	// the remaining edges are narrower than 8, so hand them to the 4x4 kernel
+	transposeBlockSSE2(src + cols8, srcStride, dst + cols8 * dstStride, dstStride, rows, cols - cols8);
+	transposeBlockSSE2(src + rows8 * srcStride, srcStride, dst + rows8, dstStride, rows - rows8, cols8);
+}
@@ -0,0 +1,305 @@
+#include "simd_kernels.h"
+
+#include <immintrin.h>
+
+void convolveRowHorizontalAVX2(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	if (pxStride == 1) {
+		// 16 outputs per iteration, in 2 independent accumulators to hide the FMA latency
+		for (; i + 16 <= count; i += 16) {
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m256 tap = _mm256_broadcast_ss(kernel + kernelIndex);
+				acc0 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(src + i + kernelIndex), acc0);
+				acc1 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(src + i + 8 + kernelIndex), acc1);
+			}
+
+			_mm256_storeu_ps(dst + i, acc0);
+			_mm256_storeu_ps(dst + i + 8, acc1);
+		}
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 acc = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				acc = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + kernelIndex), _mm256_loadu_ps(src + i + kernelIndex), acc);
+			}
+
+			_mm256_storeu_ps(dst + i, acc);
+		}
+	}
+	else {
+		// pixels of one channel are pxStride apart, so gather 8 of them per tap.  AVX2 has no scatter, so the results
+		// are written back one at a time.
+		const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(pxStride)));
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 acc = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m256 px = _mm256_i32gather_ps(src + (i + kernelIndex) * pxStride, offsets, 4);
+				acc = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + kernelIndex), px, acc);
+			}
+
+			alignas(32) float results[8];
+			_mm256_store_ps(results, acc);
+			for (unsigned int j = 0; j < 8; j++) {
+				dst[(i + j) * pxStride] = results[j];
+			}
+		}
+	}
+
+	convolveRowHorizontalScalar(kernel, kernelSize, src + i * pxStride, pxStride, dst + i * pxStride, count - i);
+}
+
+void convolveRowVerticalAVX2(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	if (pxStride == 1) {
+		for (; i + 16 <= count; i += 16) {
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m256 tap = _mm256_broadcast_ss(kernel + kernelIndex);
+				const float* row = rows[kernelIndex] + i;
+				acc0 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(row), acc0);
+				acc1 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(row + 8), acc1);
+			}
+
+			_mm256_storeu_ps(dst + i, acc0);
+			_mm256_storeu_ps(dst + i + 8, acc1);
+		}
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 acc = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				acc = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + kernelIndex), _mm256_loadu_ps(rows[kernelIndex] + i), acc);
+			}
+
+			_mm256_storeu_ps(dst + i, acc);
+		}
+	}
+	else {
+		const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(pxStride)));
+
+		for (; i + 8 <= count; i += 8) {
+			__m256 acc = _mm256_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m256 px = _mm256_i32gather_ps(rows[kernelIndex] + i * pxStride, offsets, 4);
+				acc = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + kernelIndex), px, acc);
+			}
+
+			alignas(32) float results[8];
+			_mm256_store_ps(results, acc);
+			for (unsigned int j = 0; j < 8; j++) {
+				dst[(i + j) * pxStride] = results[j];
+			}
+		}
+	}
+
+	convolveRowVerticalScalarFrom(kernel, kernelSize, rows, pxStride, dst, i, count);
+}
+
+void convolveRowHorizontalAllChannelsAVX2(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m256 acc0 = _mm256_setzero_ps();
+		__m256 acc1 = _mm256_setzero_ps();
+
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			const __m256 tap = _mm256_broadcast_ss(kernel + kernelIndex);
+			const float* px = src + i + kernelIndex * tapStride;
+			acc0 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(px), acc0);
+			acc1 = _mm256_fmadd_ps(tap, _mm256_loadu_ps(px + 8), acc1);
+		}
+
+		_mm256_storeu_ps(dst + i, acc0);
+		_mm256_storeu_ps(dst + i + 8, acc1);
+	}
+
+	for (; i + 8 <= count; i += 8) {
+		__m256 acc = _mm256_setzero_ps();
+
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			acc = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + kernelIndex), _mm256_loadu_ps(src + i + kernelIndex * tapStride), acc);
+		}
+
+		_mm256_storeu_ps(dst + i, acc);
+	}
+
+	convolveRowHorizontalAllChannelsScalar(kernel, kernelSize, src + i, tapStride, dst + i, count - i);
+}
+
+/**
+ * convolveRows2DAVX2 for a block of \p numRows output rows.  Like convolveRowBlock2DAVX512, every pair of input vectors is
+ * loaded once and multiplied into each output row of the block whose kernel covers it.
+ */
+template <unsigned int numRows>
+static void convolveRowBlock2DAVX2(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m256 acc[numRows][2];
+		for (unsigned int row = 0; row < numRows; row++) {
+			acc[row][0] = _mm256_setzero_ps();
+			acc[row][1] = _mm256_setzero_ps();
+		}
+
+		for (unsigned int inputRow = 0; inputRow < numRows + kernelSize - 1; inputRow++) {
+			const float* src = rows[inputRow] + i;
+
+			for (unsigned int kernelCol = 0; kernelCol < kernelSize; kernelCol++) {
+				const __m256 px0 = _mm256_loadu_ps(src + kernelCol * tapStride);
+				const __m256 px1 = _mm256_loadu_ps(src + kernelCol * tapStride + 8);
+
+				// output rows whose kernel covers this input row
+				for (unsigned int row = 0; row < numRows; row++) {
+					if ((inputRow >= row) && (inputRow - row < kernelSize)) {
+						const __m256 tap = _mm256_broadcast_ss(kernel + (inputRow - row) * kernelSize + kernelCol);
+						acc[row][0] = _mm256_fmadd_ps(tap, px0, acc[row][0]);
+						acc[row][1] = _mm256_fmadd_ps(tap, px1, acc[row][1]);
+					}
+				}
+			}
+		}
+
+		for (unsigned int row = 0; row < numRows; row++) {
+			_mm256_storeu_ps(dst[row] + i, acc[row][0]);
+			_mm256_storeu_ps(dst[row] + i + 8, acc[row][1]);
+		}
+	}
+
+	// remaining elements 8 at a time, with the last partial vector masked
+	for (; i < count; i += 8) {
+		const int remaining = static_cast<int>(count - i);
+		const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+		__m256 acc[numRows];
+		for (unsigned int row = 0; row < numRows; row++) {
+			acc[row] = _mm256_setzero_ps();
+		}
+
+		for (unsigned int inputRow = 0; inputRow < numRows + kernelSize - 1; inputRow++) {
+			const float* src = rows[inputRow] + i;
+
+			for (unsigned int kernelCol = 0; kernelCol < kernelSize; kernelCol++) {
+				const __m256 px = _mm256_maskload_ps(src + kernelCol * tapStride, mask);
+
+				for (unsigned int row = 0; row < numRows; row++) {
+					if ((inputRow >= row) && (inputRow - row < kernelSize)) {
+						acc[row] = _mm256_fmadd_ps(_mm256_broadcast_ss(kernel + (inputRow - row) * kernelSize + kernelCol), px, acc[row]);
+					}
+				}
+			}
+		}
+
+		for (unsigned int row = 0; row < numRows; row++) {
+			_mm256_maskstore_ps(dst[row] + i, mask, acc[row]);
+		}
+	}
+}
+
+void convolveRows2DAVX2(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count) {
+	unsigned int row = 0;
+
+	for (; row + 4 <= numRows; row += 4) {
+		convolveRowBlock2DAVX2<4>(kernel, kernelSize, rows + row, tapStride, dst + row, count);
+	}
+
+	for (; row < numRows; row++) {
+		convolveRowBlock2DAVX2<1>(kernel, kernelSize, rows + row, tapStride, dst + row, count);
+	}
+}
+
+void convertHalfToFloatAVX2(const tHalf* src, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i halves = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(halves));
+	}
+
+	convertHalfToFloatScalar(src + i, dst + i, count - i);
+}
+
+void convertFloatToHalfAVX2(const float* src, tHalf* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		const __m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), halves);
+	}
+
+	convertFloatToHalfScalar(src + i, dst + i, count - i);
+}
+
+void fftForwardLanesAVX2(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	for (unsigned int half = size / 2; half >= 1; half /= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				const __m256 wRe = _mm256_broadcast_ss(twiddleRe + j * twiddleStep);
+				const __m256 wIm = _mm256_broadcast_ss(twiddleIm + j * twiddleStep);
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				// the 16 lanes are 2 registers
+				for (unsigned int lane = 0; lane < fftLanes; lane += 8) {
+					const __m256 xRe = _mm256_loadu_ps(aRe + lane);
+					const __m256 xIm = _mm256_loadu_ps(aIm + lane);
+					const __m256 yRe = _mm256_loadu_ps(bRe + lane);
+					const __m256 yIm = _mm256_loadu_ps(bIm + lane);
+					const __m256 diffRe = _mm256_sub_ps(xRe, yRe);
+					const __m256 diffIm = _mm256_sub_ps(xIm, yIm);
+
+					_mm256_storeu_ps(aRe + lane, _mm256_add_ps(xRe, yRe));
+					_mm256_storeu_ps(aIm + lane, _mm256_add_ps(xIm, yIm));
+					_mm256_storeu_ps(bRe + lane, _mm256_fmsub_ps(diffRe, wRe, _mm256_mul_ps(diffIm, wIm)));
+					_mm256_storeu_ps(bIm + lane, _mm256_fmadd_ps(diffRe, wIm, _mm256_mul_ps(diffIm, wRe)));
+				}
+			}
+		}
+	}
+}
+
+void fftInverseLanesAVX2(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	for (unsigned int half = 1; half < size; half *= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				// conjugate twiddle
+				const __m256 wRe = _mm256_broadcast_ss(twiddleRe + j * twiddleStep);
+				const __m256 wIm = _mm256_set1_ps(-twiddleIm[j * twiddleStep]);
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				for (unsigned int lane = 0; lane < fftLanes; lane += 8) {
+					const __m256 xRe = _mm256_loadu_ps(aRe + lane);
+					const __m256 xIm = _mm256_loadu_ps(aIm + lane);
+					const __m256 yRe = _mm256_loadu_ps(bRe + lane);
+					const __m256 yIm = _mm256_loadu_ps(bIm + lane);
+					const __m256 productRe = _mm256_fmsub_ps(yRe, wRe, _mm256_mul_ps(yIm, wIm));
+					const __m256 productIm = _mm256_fmadd_ps(yRe, wIm, _mm256_mul_ps(yIm, wRe));
+
+					_mm256_storeu_ps(aRe + lane, _mm256_add_ps(xRe, productRe));
+					_mm256_storeu_ps(aIm + lane, _mm256_add_ps(xIm, productIm));
+					_mm256_storeu_ps(bRe + lane, _mm256_sub_ps(xRe, productRe));
+					_mm256_storeu_ps(bIm + lane, _mm256_sub_ps(xIm, productIm));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,277 @@
+#include "simd_kernels.h"
+
+#include <immintrin.h>
+
+void convolveRowHorizontalAVX512(const float* kernel, unsigned int kernelSize, const float* src, unsigned int pxStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	if (pxStride == 1) {
+		// 32 outputs per iteration, in 2 independent accumulators to hide the FMA latency
+		for (; i + 32 <= count; i += 32) {
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m512 tap = _mm512_set1_ps(kernel[kernelIndex]);
+				acc0 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(src + i + kernelIndex), acc0);
+				acc1 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(src + i + 16 + kernelIndex), acc1);
+			}
+
+			_mm512_storeu_ps(dst + i, acc0);
+			_mm512_storeu_ps(dst + i + 16, acc1);
+		}
+
+		// remaining outputs 16 at a time, with the last partial vector masked
+		for (; i < count; i += 16) {
+			const unsigned int remaining = count - i;
+			const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+			__m512 acc = _mm512_setzero_ps();
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				acc = _mm512_fmadd_ps(_mm512_set1_ps(kernel[kernelIndex]), _mm512_maskz_loadu_ps(mask, src + i + kernelIndex), acc);
+			}
+
+			_mm512_mask_storeu_ps(dst + i, mask, acc);
+		}
+	}
+	else {
+		// pixels of one channel are pxStride apart, so gather and scatter 16 of them at a time
+		const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(pxStride)));
+
+		for (; i < count; i += 16) {
+			const unsigned int remaining = count - i;
+			const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+			__m512 acc = _mm512_setzero_ps();
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m512 px = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, offsets, src + (i + kernelIndex) * pxStride, 4);
+				acc = _mm512_fmadd_ps(_mm512_set1_ps(kernel[kernelIndex]), px, acc);
+			}
+
+			_mm512_mask_i32scatter_ps(dst + i * pxStride, mask, offsets, acc, 4);
+		}
+	}
+}
+
+void convolveRowVerticalAVX512(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int pxStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	if (pxStride == 1) {
+		for (; i + 32 <= count; i += 32) {
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m512 tap = _mm512_set1_ps(kernel[kernelIndex]);
+				const float* row = rows[kernelIndex] + i;
+				acc0 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(row), acc0);
+				acc1 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(row + 16), acc1);
+			}
+
+			_mm512_storeu_ps(dst + i, acc0);
+			_mm512_storeu_ps(dst + i + 16, acc1);
+		}
+
+		for (; i < count; i += 16) {
+			const unsigned int remaining = count - i;
+			const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+			__m512 acc = _mm512_setzero_ps();
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				acc = _mm512_fmadd_ps(_mm512_set1_ps(kernel[kernelIndex]), _mm512_maskz_loadu_ps(mask, rows[kernelIndex] + i), acc);
+			}
+
+			_mm512_mask_storeu_ps(dst + i, mask, acc);
+		}
+	}
+	else {
+		const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(pxStride)));
+
+		for (; i < count; i += 16) {
+			const unsigned int remaining = count - i;
+			const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+			__m512 acc = _mm512_setzero_ps();
+			for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+				const __m512 px = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, offsets, rows[kernelIndex] + i * pxStride, 4);
+				acc = _mm512_fmadd_ps(_mm512_set1_ps(kernel[kernelIndex]), px, acc);
+			}
+
+			_mm512_mask_i32scatter_ps(dst + i * pxStride, mask, offsets, acc, 4);
+		}
+	}
+}
+
+void convolveRowHorizontalAllChannelsAVX512(const float* kernel, unsigned int kernelSize, const float* src, unsigned int tapStride, float* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m512 acc0 = _mm512_setzero_ps();
+		__m512 acc1 = _mm512_setzero_ps();
+
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			const __m512 tap = _mm512_set1_ps(kernel[kernelIndex]);
+			const float* px = src + i + kernelIndex * tapStride;
+			acc0 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(px), acc0);
+			acc1 = _mm512_fmadd_ps(tap, _mm512_loadu_ps(px + 16), acc1);
+		}
+
+		_mm512_storeu_ps(dst + i, acc0);
+		_mm512_storeu_ps(dst + i + 16, acc1);
+	}
+
+	for (; i < count; i += 16) {
+		const unsigned int remaining = count - i;
+		const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+		__m512 acc = _mm512_setzero_ps();
+		for (unsigned int kernelIndex = 0; kernelIndex < kernelSize; kernelIndex++) {
+			acc = _mm512_fmadd_ps(_mm512_set1_ps(kernel[kernelIndex]), _mm512_maskz_loadu_ps(mask, src + i + kernelIndex * tapStride), acc);
+		}
+
+		_mm512_mask_storeu_ps(dst + i, mask, acc);
+	}
+}
+
+/**
+ * convolveRows2DAVX512 for a block of \p numRows output rows.  The input rows under the block are loaded 2 vectors at a
+ * time, and each pair is multiplied into every output row of the block whose kernel covers it (output row r reads input
+ * row j with kernel row j - r), so an input vector is loaded once per block rather than once per output row.  A block of 4
+ * rows keeps 8 independent accumulators in flight.
+ */
+template <unsigned int numRows>
+static void convolveRowBlock2DAVX512(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int count) {
+	unsigned int i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m512 acc[numRows][2];
+		for (unsigned int row = 0; row < numRows; row++) {
+			acc[row][0] = _mm512_setzero_ps();
+			acc[row][1] = _mm512_setzero_ps();
+		}
+
+		for (unsigned int inputRow = 0; inputRow < numRows + kernelSize - 1; inputRow++) {
+			const float* src = rows[inputRow] + i;
+
+			for (unsigned int kernelCol = 0; kernelCol < kernelSize; kernelCol++) {
+				const __m512 px0 = _mm512_loadu_ps(src + kernelCol * tapStride);
+				const __m512 px1 = _mm512_loadu_ps(src + kernelCol * tapStride + 16);
+
+				// output rows whose kernel covers this input row
+				for (unsigned int row = 0; row < numRows; row++) {
+					if ((inputRow >= row) && (inputRow - row < kernelSize)) {
+						const __m512 tap = _mm512_set1_ps(kernel[(inputRow - row) * kernelSize + kernelCol]);
+						acc[row][0] = _mm512_fmadd_ps(tap, px0, acc[row][0]);
+						acc[row][1] = _mm512_fmadd_ps(tap, px1, acc[row][1]);
+					}
+				}
+			}
+		}
+
+		for (unsigned int row = 0; row < numRows; row++) {
+			_mm512_storeu_ps(dst[row] + i, acc[row][0]);
+			_mm512_storeu_ps(dst[row] + i + 16, acc[row][1]);
+		}
+	}
+
+	// remaining elements 16 at a time, with the last partial vector masked
+	for (; i < count; i += 16) {
+		const unsigned int remaining = count - i;
+		const __mmask16 mask = remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1U << remaining) - 1);
+
+		__m512 acc[numRows];
+		for (unsigned int row = 0; row < numRows; row++) {
+			acc[row] = _mm512_setzero_ps();
+		}
+
+		for (unsigned int inputRow = 0; inputRow < numRows + kernelSize - 1; inputRow++) {
+			const float* src = rows[inputRow] + i;
+
+			for (unsigned int kernelCol = 0; kernelCol < kernelSize; kernelCol++) {
+				const __m512 px = _mm512_maskz_loadu_ps(mask, src + kernelCol * tapStride);
+
+				for (unsigned int row = 0; row < numRows; row++) {
+					if ((inputRow >= row) && (inputRow - row < kernelSize)) {
+						acc[row] = _mm512_fmadd_ps(_mm512_set1_ps(kernel[(inputRow - row) * kernelSize + kernelCol]), px, acc[row]);
+					}
+				}
+			}
+		}
+
+		for (unsigned int row = 0; row < numRows; row++) {
+			_mm512_mask_storeu_ps(dst[row] + i, mask, acc[row]);
+		}
+	}
+}
+
+void convolveRows2DAVX512(const float* kernel, unsigned int kernelSize, const float* const* rows, unsigned int tapStride, float* const* dst, unsigned int numRows, unsigned int count) {
+	unsigned int row = 0;
+
+	for (; row + 4 <= numRows; row += 4) {
+		convolveRowBlock2DAVX512<4>(kernel, kernelSize, rows + row, tapStride, dst + row, count);
+	}
+
+	for (; row < numRows; row++) {
+		convolveRowBlock2DAVX512<1>(kernel, kernelSize, rows + row, tapStride, dst + row, count);
+	}
+}
+
+void fftForwardLanesAVX512(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	for (unsigned int half = size / 2; half >= 1; half /= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				const __m512 wRe = _mm512_set1_ps(twiddleRe[j * twiddleStep]);
+				const __m512 wIm = _mm512_set1_ps(twiddleIm[j * twiddleStep]);
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				// the 16 lanes are 1 register
+				const __m512 xRe = _mm512_loadu_ps(aRe);
+				const __m512 xIm = _mm512_loadu_ps(aIm);
+				const __m512 yRe = _mm512_loadu_ps(bRe);
+				const __m512 yIm = _mm512_loadu_ps(bIm);
+				const __m512 diffRe = _mm512_sub_ps(xRe, yRe);
+				const __m512 diffIm = _mm512_sub_ps(xIm, yIm);
+
+				_mm512_storeu_ps(aRe, _mm512_add_ps(xRe, yRe));
+				_mm512_storeu_ps(aIm, _mm512_add_ps(xIm, yIm));
+				_mm512_storeu_ps(bRe, _mm512_fmsub_ps(diffRe, wRe, _mm512_mul_ps(diffIm, wIm)));
+				_mm512_storeu_ps(bIm, _mm512_fmadd_ps(diffRe, wIm, _mm512_mul_ps(diffIm, wRe)));
+			}
+		}
+	}
+}
+
+void fftInverseLanesAVX512(float* re, float* im, unsigned int size, const float* twiddleRe, const float* twiddleIm) {
+	for (unsigned int half = 1; half < size; half *= 2) {
+		const unsigned int twiddleStep = size / (2 * half);
+
+		for (unsigned int group = 0; group < size; group += 2 * half) {
+			for (unsigned int j = 0; j < half; j++) {
+				// conjugate twiddle
+				const __m512 wRe = _mm512_set1_ps(twiddleRe[j * twiddleStep]);
+				const __m512 wIm = _mm512_set1_ps(-twiddleIm[j * twiddleStep]);
+				float* aRe = re + (group + j) * fftLanes;
+				float* aIm = im + (group + j) * fftLanes;
+				float* bRe = aRe + half * fftLanes;
+				float* bIm = aIm + half * fftLanes;
+
+				const __m512 xRe = _mm512_loadu_ps(aRe);
+				const __m512 xIm = _mm512_loadu_ps(aIm);
+				const __m512 yRe = _mm512_loadu_ps(bRe);
+				const __m512 yIm = _mm512_loadu_ps(bIm);
+				const __m512 productRe = _mm512_fmsub_ps(yRe, wRe, _mm512_mul_ps(yIm, wIm));
+				const __m512 productIm = _mm512_fmadd_ps(yRe, wIm, _mm512_mul_ps(yIm, wRe));
+
+				_mm512_storeu_ps(aRe, _mm512_add_ps(xRe, productRe));
+				_mm512_storeu_ps(aIm, _mm512_add_ps(xIm, productIm));
+				_mm512_storeu_ps(bRe, _mm512_sub_ps(xRe, productRe));
+				_mm512_storeu_ps(bIm, _mm512_sub_ps(xIm, productIm));
+			}
+		}
+	}
+}
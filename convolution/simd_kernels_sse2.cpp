@@ -0,0 +1,211 @@
+#include "simd_kernels.h"
+
+#include <emmintrin.h>
+
+void transposeBlockSSE2(const float* src, unsigned int srcStride, float* dst, unsigned int dstStride, unsigned int rows, unsigned int cols) {
+	const unsigned int rows4 = rows & ~3U;
+	const unsigned int cols4 = cols & ~3U;
+
+	// 4x4 register transposes for the part of the block that is a multiple of 4 in both dimensions
+	for (unsigned int r = 0; r < rows4; r += 4) {
+		const float* srcRow = src + r * srcStride;
+
+		for (unsigned int c = 0; c < cols4; c += 4) {
+			__m128 row0 = _mm_loadu_ps(srcRow + c);
+			__m128 row1 = _mm_loadu_ps(srcRow + srcStride + c);
+			__m128 row2 = _mm_loadu_ps(srcRow + 2 * srcStride + c);
+			__m128 row3 = _mm_loadu_ps(srcRow + 3 * srcStride + c);
+
+			_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+			float* dstRow = dst + c * dstStride + r;
+			_mm_storeu_ps(dstRow, row0);
+			_mm_storeu_ps(dstRow + dstStride, row1);
+			_mm_storeu_ps(dstRow + 2 * dstStride, row2);
+			_mm_storeu_ps(dstRow + 3 * dstStride, row3);
+		}
+	}
+
+	// right edge (all rows) and bottom edge (columns covered by the register transposes)
+	transposeBlockScalar(src + cols4, srcStride, dst + cols4 * dstStride, dstStride, rows, cols - cols4);
+	transposeBlockScalar(src + rows4 * srcStride, srcStride, dst + rows4, dstStride, rows - rows4, cols4);
+}
+
+// The (de)interleave kernels move 4 pixels per iteration with register shuffles for 2, 3 and 4 channels, and leave other
+// channel counts to the cache-blocked scalar kernel.  The conversion is bound by memory bandwidth, so the wider levels use
+// these as well.
+
+static void deinterleaveRow2(const float* src, float* const* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		// x0 y0 x1 y1 | x2 y2 x3 y3
+		const __m128 a = _mm_loadu_ps(src + 2 * i);
+		const __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+
+		_mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		dst[0][i] = src[2 * i];
+		dst[1][i] = src[2 * i + 1];
+	}
+}
+
+static void deinterleaveRow3(const float* src, float* const* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		// r0 g0 b0 r1 | g1 b1 r2 g2 | b2 r3 g3 b3
+		const __m128 a = _mm_loadu_ps(src + 3 * i);
+		const __m128 b = _mm_loadu_ps(src + 3 * i + 4);
+		const __m128 c = _mm_loadu_ps(src + 3 * i + 8);
+
+		// each channel is gathered as 2 pairs of duplicated elements (r0 r0 r1 r1 and r2 r2 r3 r3), then the even lanes are merged
+		const __m128 r01 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0));
+		const __m128 r23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+		const __m128 g01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1));
+		const __m128 g23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3));
+		const __m128 b01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2));
+		const __m128 b23 = _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0));
+
+		_mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(g01, g23, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst[2] + i, _mm_shuffle_ps(b01, b23, _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		dst[0][i] = src[3 * i];
+		dst[1][i] = src[3 * i + 1];
+		dst[2][i] = src[3 * i + 2];
+	}
+}
+
+static void deinterleaveRow4(const float* src, float* const* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		// 4 pixels of 4 channels are a 4x4 block, whose transpose is 4 pixels of each channel
+		__m128 px0 = _mm_loadu_ps(src + 4 * i);
+		__m128 px1 = _mm_loadu_ps(src + 4 * i + 4);
+		__m128 px2 = _mm_loadu_ps(src + 4 * i + 8);
+		__m128 px3 = _mm_loadu_ps(src + 4 * i + 12);
+
+		_MM_TRANSPOSE4_PS(px0, px1, px2, px3);
+
+		_mm_storeu_ps(dst[0] + i, px0);
+		_mm_storeu_ps(dst[1] + i, px1);
+		_mm_storeu_ps(dst[2] + i, px2);
+		_mm_storeu_ps(dst[3] + i, px3);
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		for (unsigned int ch = 0; ch < 4; ch++) {
+			dst[ch][i] = src[4 * i + ch];
+		}
+	}
+}
+
+void deinterleaveRowSSE2(const float* src, unsigned int numChannels, float* const* dst, unsigned int count) {
+	switch (numChannels) {
+	case 2:
+		deinterleaveRow2(src, dst, count);
+		break;
+	case 3:
+		deinterleaveRow3(src, dst, count);
+		break;
+	case 4:
+		deinterleaveRow4(src, dst, count);
+		break;
+	default:
+		deinterleaveRowScalar(src, numChannels, dst, count);
+		break;
+	}
+}
+
+static void interleaveRow2(const float* const* src, float* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		const __m128 x = _mm_loadu_ps(src[0] + i);
+		const __m128 y = _mm_loadu_ps(src[1] + i);
+
+		_mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(x, y));
+		_mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(x, y));
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		dst[2 * i] = src[0][i];
+		dst[2 * i + 1] = src[1][i];
+	}
+}
+
+static void interleaveRow3(const float* const* src, float* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		const __m128 r = _mm_loadu_ps(src[0] + i);
+		const __m128 g = _mm_loadu_ps(src[1] + i);
+		const __m128 b = _mm_loadu_ps(src[2] + i);
+
+		// the inverse of deinterleaveRow3: each output register is merged from the even lanes of 2 pairs of duplicated elements
+		const __m128 r0g0 = _mm_shuffle_ps(r, g, _MM_SHUFFLE(0, 0, 0, 0));
+		const __m128 b0r1 = _mm_shuffle_ps(b, r, _MM_SHUFFLE(1, 1, 0, 0));
+		const __m128 g1b1 = _mm_shuffle_ps(g, b, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m128 r2g2 = _mm_shuffle_ps(r, g, _MM_SHUFFLE(2, 2, 2, 2));
+		const __m128 b2r3 = _mm_shuffle_ps(b, r, _MM_SHUFFLE(3, 3, 2, 2));
+		const __m128 g3b3 = _mm_shuffle_ps(g, b, _MM_SHUFFLE(3, 3, 3, 3));
+
+		_mm_storeu_ps(dst + 3 * i, _mm_shuffle_ps(r0g0, b0r1, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst + 3 * i + 4, _mm_shuffle_ps(g1b1, r2g2, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst + 3 * i + 8, _mm_shuffle_ps(b2r3, g3b3, _MM_SHUFFLE(2, 0, 2, 0)));
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		dst[3 * i] = src[0][i];
+		dst[3 * i + 1] = src[1][i];
+		dst[3 * i + 2] = src[2][i];
+	}
+}
+
+static void interleaveRow4(const float* const* src, float* dst, unsigned int count) {
+	const unsigned int count4 = count & ~3U;
+
+	for (unsigned int i = 0; i < count4; i += 4) {
+		__m128 ch0 = _mm_loadu_ps(src[0] + i);
+		__m128 ch1 = _mm_loadu_ps(src[1] + i);
+		__m128 ch2 = _mm_loadu_ps(src[2] + i);
+		__m128 ch3 = _mm_loadu_ps(src[3] + i);
+
+		_MM_TRANSPOSE4_PS(ch0, ch1, ch2, ch3);
+
+		_mm_storeu_ps(dst + 4 * i, ch0);
+		_mm_storeu_ps(dst + 4 * i + 4, ch1);
+		_mm_storeu_ps(dst + 4 * i + 8, ch2);
+		_mm_storeu_ps(dst + 4 * i + 12, ch3);
+	}
+
+	for (unsigned int i = count4; i < count; i++) {
+		for (unsigned int ch = 0; ch < 4; ch++) {
+			dst[4 * i + ch] = src[ch][i];
+		}
+	}
+}
+
+void interleaveRowSSE2(const float* const* src, unsigned int numChannels, float* dst, unsigned int count) {
+	switch (numChannels) {
+	case 2:
+		interleaveRow2(src, dst, count);
+		break;
+	case 3:
+		interleaveRow3(src, dst, count);
+		break;
+	case 4:
+		interleaveRow4(src, dst, count);
+		break;
+	default:
+		interleaveRowScalar(src, numChannels, dst, count);
+		break;
+	}
+}
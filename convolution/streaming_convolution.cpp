@@ -0,0 +1,90 @@
+#include "streaming_convolution.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Bytes of one row of a plane: a row of one channel of a planar image, or a row of all channels of an interleaved one
+ */
+static std::uint64_t planeRowBytes(ImageLayout layout, unsigned int width, unsigned int numChannels) {
+	const unsigned int channelsPerPlane = layout == ImageLayout::Planar ? 1 : numChannels;
+	return static_cast<std::uint64_t>(width) * channelsPerPlane * sizeof(float);
+}
+
+unsigned int mappedStripRows(ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int verticalKernelSize, std::size_t maxResidentBytes) {
+	const std::uint64_t rowBytes = std::max<std::uint64_t>(1, planeRowBytes(layout, width, numChannels));
+	const std::uint64_t haloRows = verticalKernelSize > 0 ? verticalKernelSize - 1 : 0;
+
+	// rows of the input and of the output mapping that fit into the budget
+	const std::uint64_t mappedRows = maxResidentBytes / (2 * rowBytes);
+	const std::uint64_t stripRows = mappedRows > haloRows ? mappedRows - haloRows : 1;
+
+	return static_cast<unsigned int>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(stripRows, height)));
+}
+
+bool convolve2DSeparableMapped(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::string& inputPath, unsigned int height, unsigned int width, unsigned int numChannels, const std::string& outputPath, std::size_t maxResidentBytes, SimdLevel level) {
+	// only operate on odd-sized kernels
+	if ((horizontalKernelSize % 2 != 1) || (verticalKernelSize % 2 != 1) || (numChannels == 0)) {
+		return false;
+	}
+
+	const unsigned int planes = layout == ImageLayout::Planar ? numChannels : 1;
+	const unsigned int channelsPerPlane = layout == ImageLayout::Planar ? 1 : numChannels;
+	const std::uint64_t rowBytes = planeRowBytes(layout, width, numChannels);
+	const std::uint64_t planeBytes = rowBytes * height;
+	const std::uint64_t imageBytes = planeBytes * planes;
+
+	MappedFile input;
+	if (!input.openForReading(inputPath) || (input.size() < imageBytes)) {
+		return false;
+	}
+
+	MappedFile output;
+	if (!output.create(outputPath, imageBytes)) {
+		return false;
+	}
+
+	if (imageBytes == 0) {
+		return true;
+	}
+
+	const unsigned int halo = verticalKernelSize / 2;
+	const unsigned int stripRows = mappedStripRows(layout, height, width, numChannels, verticalKernelSize, maxResidentBytes);
+
+	for (unsigned int plane = 0; plane < planes; plane++) {
+		for (unsigned int stripBegin = 0; stripBegin < height; stripBegin += stripRows) {
+			const unsigned int stripEnd = height - stripBegin > stripRows ? stripBegin + stripRows : height;
+
+			// the strip's output rows and the halo rows above and below them that are inside the image
+			const unsigned int mappedBegin = stripBegin > halo ? stripBegin - halo : 0;
+			const unsigned int mappedEnd = height - stripEnd > halo ? stripEnd + halo : height;
+			const unsigned int mappedRows = mappedEnd - mappedBegin;
+
+			const std::uint64_t offset = plane * planeBytes + mappedBegin * rowBytes;
+			const std::size_t length = static_cast<std::size_t>(mappedRows * rowBytes);
+
+			// the output is mapped over the same rows so both views have the same shape, but only the strip's rows are written
+			const MappedRegion inputRegion = input.map(offset, length);
+			const MappedRegion outputRegion = output.map(offset, length);
+			if (!inputRegion.valid() || !outputRegion.valid()) {
+				return false;
+			}
+
+			const unsigned int rowPitch = width * channelsPerPlane;
+			const std::size_t channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(mappedRows) * width : 1;
+			const ImageView stripImage{ inputRegion.data<const float>(), mappedRows, width, channelsPerPlane, rowPitch, channelPitch, layout };
+			const MutableImageView stripResult{ outputRegion.data<float>(), mappedRows, width, channelsPerPlane, rowPitch, channelPitch, layout };
+
+			// rows of the strip that are within the halo of the top or bottom of the image are left at 0, like the
+			// edges of convolve2DSeparable, because the strip view ends where the image does
+			for (unsigned int ch = 0; ch < channelsPerPlane; ch++) {
+				if (!convolve2DSeparableRows(horizontalKernel, horizontalKernelSize, verticalKernel, verticalKernelSize, stripImage, ch, stripBegin - mappedBegin, stripEnd - mappedBegin, stripResult, level)) {
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "convolution.h"
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Resident memory budget used by convolve2DSeparableMapped when the caller has no better number
+ */
+const std::size_t defaultMappedResidentBytes = 64 * 1024 * 1024;
+
+/**
+ * Number of output rows convolve2DSeparableMapped processes per strip.  A strip maps its output rows plus
+ * verticalKernelSize / 2 rows of halo above and below it, once in the input file and once in the output file, so
+ *
+ *   2 * (stripRows + verticalKernelSize - 1) * bytes per row <= \p maxResidentBytes
+ *
+ * where a row of a planar image is a row of one channel.  The strip is at least 1 row, even if that exceeds the budget.
+ *
+ * @param[in] layout  Layout of the image
+ * @param[in] height  Height of the image
+ * @param[in] width  Width of the image
+ * @param[in] numChannels  Number of channels in the image
+ * @param[in] verticalKernelSize  Number of elements in the vertical kernel
+ * @param[in] maxResidentBytes  Budget for the mapped input and output rows of a strip
+ *
+ * @return  Number of output rows per strip, at most \p height
+ */
+unsigned int mappedStripRows(ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int verticalKernelSize, std::size_t maxResidentBytes);
+
+/**
+ * Performs a fused separable 2D convolution on every channel of an image stored in a raw file, and writes the result to
+ * another raw file, without holding either image in memory.  The image is processed in horizontal strips of
+ * mappedStripRows rows (per channel, for planar images).  Each strip maps the rows it needs from both files, convolves
+ * them with convolve2DSeparableRows, and unmaps them again, so only the rows of one strip (and the ring buffer of the
+ * fused convolution) are resident at a time.  Neighbouring strips share verticalKernelSize / 2 rows of halo, which are
+ * read by both.  Computes the same pixels as calling convolve2DSeparable once per channel on the image in memory, into a
+ * zeroed result: the pixels along the edges are 0 in the output file.
+ *
+ * The files hold the floats of the image in \p layout with no padding or header, in the byte order of the machine.  The
+ * indices within a strip are 32-bit, but the file offsets are 64-bit, so the files can be larger than 4 GiB.
+ *
+ * @param[in] horizontalKernel  1D kernel to convolve the rows with.  Must have odd length.
+ * @param[in] horizontalKernelSize  Number of elements in \p horizontalKernel
+ * @param[in] verticalKernel  1D kernel to convolve the columns with.  Must have odd length.
+ * @param[in] verticalKernelSize  Number of elements in \p verticalKernel
+ * @param[in] layout  Layout of the input and output files
+ * @param[in] inputPath  File with the image to convolve.  Must hold at least \p height * \p width * \p numChannels floats.
+ * @param[in] height  Height of the image
+ * @param[in] width  Width of the image
+ * @param[in] numChannels  Number of channels in the image
+ * @param[in] outputPath  File to write the result to.  Is created, or truncated if it exists.  Must not be \p inputPath.
+ * @param[in] maxResidentBytes  Budget for the mapped rows of a strip, see mappedStripRows
+ * @param[in] level  Instruction set level of the kernels to use.  Clamped to the levels the library was built with.
+ *
+ * @return  true if the convolution succeeded, false if a kernel has even length, or a file couldn't be opened, created or mapped
+ */
+bool convolve2DSeparableMapped(const float* horizontalKernel, unsigned int horizontalKernelSize, const float* verticalKernel, unsigned int verticalKernelSize, ImageLayout layout, const std::string& inputPath, unsigned int height, unsigned int width, unsigned int numChannels, const std::string& outputPath, std::size_t maxResidentBytes, SimdLevel level);
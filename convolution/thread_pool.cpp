@@ -0,0 +1,133 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int numThreads)
+	: generation(0), stopping(false), currentTask(nullptr), remainingTasks(0)
+{
+	if (numThreads == 0) {
+		numThreads = std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	for (unsigned int i = 0; i < numThreads; i++) {
+		queues.emplace_back(new tWorkQueue);
+	}
+
+	// queue 0 belongs to the thread calling parallelFor
+	for (unsigned int i = 1; i < numThreads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		stopping = true;
+	}
+	batchStarted.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+unsigned int ThreadPool::size() const {
+	return static_cast<unsigned int>(queues.size());
+}
+
+void ThreadPool::parallelFor(unsigned int numTasks, const std::function<void(unsigned int)>& task) {
+	if (numTasks == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> batchLock(batchMutex);
+
+	currentTask = &task;
+	remainingTasks.store(numTasks);
+
+	// contiguous chunks, so neighbouring tasks start on the same thread
+	const unsigned int numQueues = size();
+	for (unsigned int q = 0; q < numQueues; q++) {
+		const unsigned int chunkBegin = static_cast<unsigned int>(static_cast<unsigned long long>(numTasks) * q / numQueues);
+		const unsigned int chunkEnd = static_cast<unsigned int>(static_cast<unsigned long long>(numTasks) * (q + 1) / numQueues);
+
+		std::lock_guard<std::mutex> queueLock(queues[q]->mutex);
+		for (unsigned int i = chunkBegin; i < chunkEnd; i++) {
+			queues[q]->tasks.push_back(i);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		generation++;
+	}
+	batchStarted.notify_all();
+
+	runTasks(0);
+
+	// other threads may still be finishing tasks they took
+	std::unique_lock<std::mutex> lock(stateMutex);
+	batchFinished.wait(lock, [this]() { return remainingTasks.load() == 0; });
+
+	currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned int queueIndex) {
+	unsigned long long seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			batchStarted.wait(lock, [&]() { return stopping || (generation != seenGeneration); });
+
+			if (stopping) {
+				return;
+			}
+
+			seenGeneration = generation;
+		}
+
+		runTasks(queueIndex);
+	}
+}
+
+void ThreadPool::runTasks(unsigned int queueIndex) {
+	unsigned int taskIndex = 0;
+
+	while (popTask(queueIndex, taskIndex)) {
+		(*currentTask)(taskIndex);
+
+		if (remainingTasks.fetch_sub(1) == 1) {
+			// take the lock so the notification can't slip in between parallelFor's check and its wait
+			std::lock_guard<std::mutex> lock(stateMutex);
+			batchFinished.notify_all();
+		}
+	}
+}
+
+bool ThreadPool::popTask(unsigned int queueIndex, unsigned int& taskIndex) {
+	// own queue first, in order
+	{
+		tWorkQueue& own = *queues[queueIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()) {
+			taskIndex = own.tasks.front();
+			own.tasks.pop_front();
+			return true;
+		}
+	}
+
+	// then steal from the far end of another queue, starting with the next one so thieves spread out
+	const unsigned int numQueues = size();
+	for (unsigned int offset = 1; offset < numQueues; offset++) {
+		tWorkQueue& victim = *queues[(queueIndex + offset) % numQueues];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			taskIndex = victim.tasks.back();
+			victim.tasks.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size pool of threads that runs batches of independent tasks with work stealing.  Each thread owns a queue of task
+ * indices; a batch is split into contiguous chunks, one per queue, so neighbouring tasks (e.g. neighbouring row bands) tend to
+ * run on the same thread.  A thread takes work from the front of its own queue and, once that is empty, steals from the back
+ * of the other queues, so uneven tasks still keep every thread busy.
+ *
+ * The thread that calls parallelFor participates in the batch, so a pool of size N starts N - 1 background threads.
+ * parallelFor must not be called from inside a task.
+ */
+class ThreadPool {
+public:
+	/**
+	 * @param[in] numThreads  Number of threads that run a batch, including the calling thread.  0 uses std::thread::hardware_concurrency().
+	 */
+	explicit ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @return  Number of threads that run a batch, including the calling thread
+	 */
+	unsigned int size() const;
+
+	/**
+	 * Runs task(i) for every i in [0, \p numTasks) across the pool, and returns once all of them finished.
+	 *
+	 * @param[in] numTasks  Number of tasks in the batch
+	 * @param[in] task  Function to run for each task index.  Called concurrently from several threads.
+	 */
+	void parallelFor(unsigned int numTasks, const std::function<void(unsigned int)>& task);
+
+private:
+	typedef struct workQueue {
+		std::mutex mutex;
+		std::deque<unsigned int> tasks;
+	} tWorkQueue;
+
+	void workerLoop(unsigned int queueIndex);
+	void runTasks(unsigned int queueIndex);
+	bool popTask(unsigned int queueIndex, unsigned int& taskIndex);
+
+	std::vector<std::unique_ptr<tWorkQueue>> queues;
+	std::vector<std::thread> workers;
+
+	// serializes batches from different callers
+	std::mutex batchMutex;
+
+	std::mutex stateMutex;
+	std::condition_variable batchStarted;
+	std::condition_variable batchFinished;
+	unsigned long long generation;
+	bool stopping;
+
+	const std::function<void(unsigned int)>* currentTask;
+	std::atomic<unsigned int> remainingTasks;
+};
@@ -0,0 +1,351 @@
+#include "benchmark_harness.h"
+#include "convolution.h"
+#include "fft_convolution.h"
+#include "nonseparable_convolution.h"
+#include "parallel_convolution.h"
+
+#include <array>
+#include <cstddef>
+
+// Every case blurs every channel of images.src(layout) into images.dst with a kernelSize x kernelSize box-shaped blur,
+// horizontally and then vertically, using images.workingBuffer for the intermediate image.
+
+/**
+ * Bytes and flops of a horizontal and a vertical pass, each of which reads and writes the whole image once and does a
+ * multiply and an add per tap
+ */
+static tBenchmarkWork separableWork(const tBenchmarkParams& params) {
+	const double numElements = static_cast<double>(params.height) * params.width * params.numChannels;
+	return tBenchmarkWork{ 2.0 * 2.0 * numElements * sizeof(float), 2.0 * 2.0 * params.kernelSize * numElements };
+}
+
+/**
+ * The separable passes, plus 2 transposes (or layout conversions) that each read and write the whole image once
+ */
+static tBenchmarkWork transposeWork(const tBenchmarkParams& params) {
+	const double numElements = static_cast<double>(params.height) * params.width * params.numChannels;
+	tBenchmarkWork work = separableWork(params);
+	work.bytes += 2.0 * 2.0 * numElements * sizeof(float);
+	return work;
+}
+
+/**
+ * The arithmetic of the separable passes, but the intermediate rows stay in cache, so the image is read and written once
+ */
+static tBenchmarkWork fusedWork(const tBenchmarkParams& params) {
+	const double numElements = static_cast<double>(params.height) * params.width * params.numChannels;
+	tBenchmarkWork work = separableWork(params);
+	work.bytes = 2.0 * numElements * sizeof(float);
+	return work;
+}
+
+/**
+ * The memory traffic of the separable passes, but an add, a subtract and a multiply per pixel and pass, whatever the kernel size
+ */
+static tBenchmarkWork boxWork(const tBenchmarkParams& params) {
+	const double numElements = static_cast<double>(params.height) * params.width * params.numChannels;
+	tBenchmarkWork work = separableWork(params);
+	work.flops = 2.0 * 3.0 * numElements;
+	return work;
+}
+
+/**
+ * The image is read and written once, with a multiply and an add per tap of the kernelSize x kernelSize kernel
+ */
+static tBenchmarkWork nonSeparableWork(const tBenchmarkParams& params) {
+	const double numElements = static_cast<double>(params.height) * params.width * params.numChannels;
+	return tBenchmarkWork{ 2.0 * numElements * sizeof(float), 2.0 * params.kernelSize * params.kernelSize * numElements };
+}
+
+typedef bool (*runFn)(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images);
+typedef tBenchmarkWork (*workFn)(const tBenchmarkParams& params);
+
+static tBenchmarkCase makeCase(const char* name, ImageLayout layout, bool threaded, runFn run, workFn work) {
+	return tBenchmarkCase{ name, layout, threaded, [run, layout](const tBenchmarkParams& params, tBenchmarkImages& images) { return run(layout, params, images); }, work };
+}
+
+static bool runReference(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const std::vector<float>& src = images.src(layout);
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		const bool succeeded = layout == ImageLayout::Planar
+			? convolve1DHorizontalPlanar(images.kernel, src, params.height, params.width, params.numChannels, ch, images.workingBuffer)
+				&& convolve1DVerticalPlanar(images.kernel, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst)
+			: convolve1DHorizontalInterleaved(images.kernel, src, params.height, params.width, params.numChannels, ch, images.workingBuffer)
+				&& convolve1DVerticalInterleaved(images.kernel, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst);
+		if (!succeeded) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The vertical pass is a transpose, a horizontal pass over the transposed image, and a transpose back.  Planar only.
+ */
+static bool runTranspose(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	if (layout != ImageLayout::Planar) {
+		return false;
+	}
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalPlanar(images.kernel, images.planarSrc, params.height, params.width, params.numChannels, ch, images.workingBuffer)) {
+			return false;
+		}
+	}
+
+	std::vector<float>& transposed = images.transposed();
+	if (!transposePlanar(images.workingBuffer, params.height, params.width, params.numChannels, transposed)) {
+		return false;
+	}
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalPlanar(images.kernel, transposed, params.width, params.height, params.numChannels, ch, images.workingBuffer)) {
+			return false;
+		}
+	}
+
+	return transposePlanar(images.workingBuffer, params.width, params.height, params.numChannels, images.dst);
+}
+
+/**
+ * Same as runTranspose, but transposes in place with transposePlanarInPlace, so it needs no transposed buffer: the horizontal
+ * pass goes into the working buffer, which is transposed in place, blurred again into dst, and dst is transposed back.
+ * Planar only.
+ */
+static bool runTransposeInPlace(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	if (layout != ImageLayout::Planar) {
+		return false;
+	}
+
+	const SimdLevel level = getSimdLevel();
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalPlanar(images.kernel, images.planarSrc, params.height, params.width, params.numChannels, ch, images.workingBuffer)) {
+			return false;
+		}
+	}
+
+	if (!transposePlanarInPlace(images.workingBuffer, params.height, params.width, params.numChannels, level)) {
+		return false;
+	}
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalPlanar(images.kernel, images.workingBuffer, params.width, params.height, params.numChannels, ch, images.dst)) {
+			return false;
+		}
+	}
+
+	return transposePlanarInPlace(images.dst, params.width, params.height, params.numChannels, level);
+}
+
+/**
+ * Same blur as runTranspose, but each horizontal pass writes its output transposed with convolve1DHorizontalTransposed, so
+ * there are no transpose passes.  Planar only.
+ */
+static bool runTransposedConvolve(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	if (layout != ImageLayout::Planar) {
+		return false;
+	}
+
+	const SimdLevel level = getSimdLevel();
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalTransposed(images.kernel.data(), params.kernelSize, images.planarSrc, params.height, params.width, params.numChannels, ch, images.workingBuffer, level)
+			|| !convolve1DHorizontalTransposed(images.kernel.data(), params.kernelSize, images.workingBuffer, params.width, params.height, params.numChannels, ch, images.dst, level)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <std::size_t N, bool Symmetric>
+static bool runUnrolledSize(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	std::array<float, N> kernel;
+	std::copy(images.kernel.begin(), images.kernel.end(), kernel.begin());
+
+	const std::vector<float>& src = images.src(layout);
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		const bool succeeded = layout == ImageLayout::Planar
+			? convolve1DHorizontalPlanarUnrolled<N, Symmetric>(kernel, src, params.height, params.width, params.numChannels, ch, images.workingBuffer)
+				&& convolve1DVerticalPlanarUnrolled<N, Symmetric>(kernel, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst)
+			: convolve1DHorizontalInterleavedUnrolled<N, Symmetric>(kernel, src, params.height, params.width, params.numChannels, ch, images.workingBuffer)
+				&& convolve1DVerticalInterleavedUnrolled<N, Symmetric>(kernel, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst);
+		if (!succeeded) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The unrolled templates need the kernel size at compile time, so only the sizes instantiated here are supported
+ */
+template <bool Symmetric>
+static bool runUnrolled(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	switch (params.kernelSize) {
+	case 3:
+		return runUnrolledSize<3, Symmetric>(layout, params, images);
+	case 5:
+		return runUnrolledSize<5, Symmetric>(layout, params, images);
+	case 7:
+		return runUnrolledSize<7, Symmetric>(layout, params, images);
+	case 9:
+		return runUnrolledSize<9, Symmetric>(layout, params, images);
+	case 11:
+		return runUnrolledSize<11, Symmetric>(layout, params, images);
+	default:
+		return false;
+	}
+}
+
+static bool runSimd(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const SimdLevel level = getSimdLevel();
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontal(images.kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, ch, images.workingBuffer, level)
+			|| !convolve1DVertical(images.kernel.data(), params.kernelSize, layout, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst, level)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The separable passes in the frequency domain.  Uses separableWork, so its gflopPerSecond is the rate of the direct
+ * convolution it replaces.
+ */
+static bool runFft(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const SimdLevel level = getSimdLevel();
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontalFft(images.kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, ch, images.workingBuffer, level)
+			|| !convolve1DVerticalFft(images.kernel.data(), params.kernelSize, layout, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst, level)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The same box as a kernelSize x kernelSize kernel, convolved in a single non-separable 2D pass per channel
+ */
+static bool runNonSeparable(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const SimdLevel level = getSimdLevel();
+	const std::vector<float> kernel(params.kernelSize * params.kernelSize, images.kernel[0] * images.kernel[0]);
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve2D(kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, ch, images.dst, level)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * One call per pass for all channels.  Interleaved only.
+ */
+static bool runAllChannels(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	if (layout != ImageLayout::Interleaved) {
+		return false;
+	}
+
+	const SimdLevel level = getSimdLevel();
+	return convolve1DHorizontalInterleavedAllChannels(images.kernel.data(), params.kernelSize, images.interleavedSrc, params.height, params.width, params.numChannels, images.workingBuffer, level)
+		&& convolve1DVerticalInterleavedAllChannels(images.kernel.data(), params.kernelSize, images.workingBuffer, params.height, params.width, params.numChannels, images.dst, level);
+}
+
+/**
+ * Converts the interleaved source to planar layout, blurs it with the SIMD passes, and converts the result back.  Interleaved
+ * only, to compare with the interleaved cases.
+ */
+static bool runConverted(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	if (layout != ImageLayout::Interleaved) {
+		return false;
+	}
+
+	const SimdLevel level = getSimdLevel();
+	std::vector<float>& planar = images.transposed();
+	if (!interleavedToPlanar(images.interleavedSrc, params.height, params.width, params.numChannels, planar, level)) {
+		return false;
+	}
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve1DHorizontal(images.kernel.data(), params.kernelSize, ImageLayout::Planar, planar, params.height, params.width, params.numChannels, ch, images.workingBuffer, level)
+			|| !convolve1DVertical(images.kernel.data(), params.kernelSize, ImageLayout::Planar, images.workingBuffer, params.height, params.width, params.numChannels, ch, planar, level)) {
+			return false;
+		}
+	}
+
+	return planarToInterleaved(planar, params.height, params.width, params.numChannels, images.dst, level);
+}
+
+static bool runFused(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const SimdLevel level = getSimdLevel();
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!convolve2DSeparable(images.kernel.data(), params.kernelSize, images.kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, ch, images.dst, level)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool runBox(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const unsigned int radius = params.kernelSize / 2;
+
+	for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+		if (!boxFilter1DHorizontal(radius, layout, images.src(layout), params.height, params.width, params.numChannels, ch, images.workingBuffer)
+			|| !boxFilter1DVertical(radius, layout, images.workingBuffer, params.height, params.width, params.numChannels, ch, images.dst)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool runParallel(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const SimdLevel level = getSimdLevel();
+	return convolve1DHorizontalParallel(images.kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, images.workingBuffer, *images.pool, level)
+		&& convolve1DVerticalParallel(images.kernel.data(), params.kernelSize, layout, images.workingBuffer, params.height, params.width, params.numChannels, images.dst, *images.pool, level);
+}
+
+static bool runFusedParallel(ImageLayout layout, const tBenchmarkParams& params, tBenchmarkImages& images) {
+	return convolve2DSeparableParallel(images.kernel.data(), params.kernelSize, images.kernel.data(), params.kernelSize, layout, images.src(layout), params.height, params.width, params.numChannels, images.dst, *images.pool, getSimdLevel());
+}
+
+static const BenchmarkRegistration interleavedReference(makeCase("reference", ImageLayout::Interleaved, false, runReference, separableWork));
+static const BenchmarkRegistration planarReference(makeCase("reference", ImageLayout::Planar, false, runReference, separableWork));
+// peakResidentMiB is the peak of the whole process, so it only tells the two transposes apart when each runs in its own
+// process (cases=transposeInPlace, cases=transpose)
+static const BenchmarkRegistration planarTransposeInPlace(makeCase("transposeInPlace", ImageLayout::Planar, false, runTransposeInPlace, transposeWork));
+static const BenchmarkRegistration planarTranspose(makeCase("transpose", ImageLayout::Planar, false, runTranspose, transposeWork));
+// every pass reads and writes the image once, like the separable passes
+static const BenchmarkRegistration planarTransposedConvolve(makeCase("transposedConvolve", ImageLayout::Planar, false, runTransposedConvolve, separableWork));
+static const BenchmarkRegistration interleavedUnrolled(makeCase("unrolled", ImageLayout::Interleaved, false, runUnrolled<false>, separableWork));
+static const BenchmarkRegistration planarUnrolled(makeCase("unrolled", ImageLayout::Planar, false, runUnrolled<false>, separableWork));
+static const BenchmarkRegistration interleavedSymmetric(makeCase("symmetric", ImageLayout::Interleaved, false, runUnrolled<true>, separableWork));
+static const BenchmarkRegistration planarSymmetric(makeCase("symmetric", ImageLayout::Planar, false, runUnrolled<true>, separableWork));
+static const BenchmarkRegistration interleavedSimd(makeCase("simd", ImageLayout::Interleaved, false, runSimd, separableWork));
+static const BenchmarkRegistration planarSimd(makeCase("simd", ImageLayout::Planar, false, runSimd, separableWork));
+static const BenchmarkRegistration interleavedFft(makeCase("fft", ImageLayout::Interleaved, false, runFft, separableWork));
+static const BenchmarkRegistration planarFft(makeCase("fft", ImageLayout::Planar, false, runFft, separableWork));
+static const BenchmarkRegistration interleavedNonSeparable(makeCase("nonSeparable", ImageLayout::Interleaved, false, runNonSeparable, nonSeparableWork));
+static const BenchmarkRegistration planarNonSeparable(makeCase("nonSeparable", ImageLayout::Planar, false, runNonSeparable, nonSeparableWork));
+static const BenchmarkRegistration interleavedAllChannels(makeCase("allChannels", ImageLayout::Interleaved, false, runAllChannels, separableWork));
+static const BenchmarkRegistration interleavedConverted(makeCase("converted", ImageLayout::Interleaved, false, runConverted, transposeWork));
+static const BenchmarkRegistration interleavedFused(makeCase("fused", ImageLayout::Interleaved, false, runFused, fusedWork));
+static const BenchmarkRegistration planarFused(makeCase("fused", ImageLayout::Planar, false, runFused, fusedWork));
+static const BenchmarkRegistration interleavedBox(makeCase("box", ImageLayout::Interleaved, false, runBox, boxWork));
+static const BenchmarkRegistration planarBox(makeCase("box", ImageLayout::Planar, false, runBox, boxWork));
+static const BenchmarkRegistration interleavedParallel(makeCase("parallel", ImageLayout::Interleaved, true, runParallel, separableWork));
+static const BenchmarkRegistration planarParallel(makeCase("parallel", ImageLayout::Planar, true, runParallel, separableWork));
+static const BenchmarkRegistration interleavedFusedParallel(makeCase("fusedParallel", ImageLayout::Interleaved, true, runFusedParallel, fusedWork));
+static const BenchmarkRegistration planarFusedParallel(makeCase("fusedParallel", ImageLayout::Planar, true, runFusedParallel, fusedWork));
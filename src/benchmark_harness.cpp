@@ -0,0 +1,399 @@
+#include "benchmark_harness.h"
+#include "cpu_features.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#elif defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+std::vector<tBenchmarkCase>& benchmarkRegistry() {
+	static std::vector<tBenchmarkCase> registry;
+	return registry;
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const tBenchmarkCase& benchmarkCase) {
+	benchmarkRegistry().push_back(benchmarkCase);
+}
+
+/**
+ * @return  \p text without leading and trailing whitespace
+ */
+static std::string trim(const std::string& text) {
+	const auto begin = text.find_first_not_of(" \t\r\n");
+	if (begin == std::string::npos) {
+		return std::string();
+	}
+
+	const auto end = text.find_last_not_of(" \t\r\n");
+	return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * Splits a comma separated list into its trimmed, non-empty items
+ */
+static std::vector<std::string> splitList(const std::string& text) {
+	std::vector<std::string> items;
+	std::stringstream ss(text);
+	std::string item;
+	while (std::getline(ss, item, ',')) {
+		item = trim(item);
+		if (!item.empty()) {
+			items.push_back(item);
+		}
+	}
+
+	return items;
+}
+
+static bool parseUnsigned(const std::string& text, unsigned int& value) {
+	if (text.empty() || (text.find_first_not_of("0123456789") != std::string::npos)) {
+		return false;
+	}
+
+	std::stringstream ss(text);
+	ss >> value;
+	return !ss.fail();
+}
+
+/**
+ * Parses a list of positive integers.  Leaves \p values unchanged if any item is invalid.
+ */
+static bool parsePositiveList(const std::string& text, std::vector<unsigned int>& values) {
+	std::vector<unsigned int> parsed;
+	for (const auto& item : splitList(text)) {
+		unsigned int value = 0;
+		if (!parseUnsigned(item, value) || (value == 0)) {
+			return false;
+		}
+		parsed.push_back(value);
+	}
+
+	if (parsed.empty()) {
+		return false;
+	}
+
+	values = parsed;
+	return true;
+}
+
+bool parseBenchmarkConfigLine(const std::string& line, tBenchmarkConfig& config) {
+	const std::string content = trim(line);
+	if (content.empty() || (content[0] == '#')) {
+		return true;
+	}
+
+	const auto equals = content.find('=');
+	if (equals == std::string::npos) {
+		return false;
+	}
+
+	const std::string key = trim(content.substr(0, equals));
+	const std::string value = trim(content.substr(equals + 1));
+
+	if (key == "height") {
+		return parsePositiveList(value, config.heights);
+	}
+	if (key == "width") {
+		return parsePositiveList(value, config.widths);
+	}
+	if (key == "channels") {
+		return parsePositiveList(value, config.channels);
+	}
+	if (key == "kernel") {
+		if (!parsePositiveList(value, config.kernelSizes)) {
+			return false;
+		}
+		return std::all_of(config.kernelSizes.begin(), config.kernelSizes.end(), [](unsigned int size) { return size % 2 == 1; });
+	}
+	if (key == "threads") {
+		return parsePositiveList(value, config.threads);
+	}
+	if (key == "cases") {
+		config.cases = splitList(value);
+		return true;
+	}
+	if (key == "layouts") {
+		config.layouts = splitList(value);
+		return std::all_of(config.layouts.begin(), config.layouts.end(), [](const std::string& layout) { return (layout == "planar") || (layout == "interleaved"); });
+	}
+	if (key == "warmup") {
+		return parseUnsigned(value, config.warmup);
+	}
+	if (key == "iterations") {
+		return parseUnsigned(value, config.iterations) && (config.iterations > 0);
+	}
+	if (key == "cpu") {
+		if (value == "none") {
+			config.cpu = -1;
+			return true;
+		}
+		unsigned int cpu = 0;
+		if (!parseUnsigned(value, cpu)) {
+			return false;
+		}
+		config.cpu = static_cast<int>(cpu);
+		return true;
+	}
+	if (key == "csv") {
+		config.csvPath = value;
+		return true;
+	}
+	if (key == "json") {
+		config.jsonPath = value;
+		return true;
+	}
+
+	return false;
+}
+
+bool loadBenchmarkConfig(const std::string& path, tBenchmarkConfig& config, std::string& error) {
+	std::ifstream file(path);
+	if (!file) {
+		error = "can't open " + path;
+		return false;
+	}
+
+	std::string line;
+	unsigned int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		if (!parseBenchmarkConfigLine(line, config)) {
+			std::stringstream ss;
+			ss << path << ":" << lineNumber << ": invalid line: " << line;
+			error = ss.str();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+tSampleStats computeSampleStats(std::vector<double> samples) {
+	std::sort(samples.begin(), samples.end());
+	const std::size_t count = samples.size();
+
+	tSampleStats stats;
+	stats.min = samples.front();
+	stats.median = count % 2 == 1 ? samples[count / 2] : (samples[count / 2 - 1] + samples[count / 2]) / 2.0;
+
+	// nearest rank: the smallest sample that at least 95% of the samples are less than or equal to
+	const std::size_t p95Rank = static_cast<std::size_t>(std::ceil(0.95 * static_cast<double>(count)));
+	stats.p95 = samples[std::max<std::size_t>(p95Rank, 1) - 1];
+
+	double sum = 0.0;
+	for (const double sample : samples) {
+		sum += sample;
+	}
+	stats.mean = sum / static_cast<double>(count);
+
+	double squaredDeviations = 0.0;
+	for (const double sample : samples) {
+		squaredDeviations += (sample - stats.mean) * (sample - stats.mean);
+	}
+	stats.stddev = count > 1 ? std::sqrt(squaredDeviations / static_cast<double>(count - 1)) : 0.0;
+
+	return stats;
+}
+
+bool pinToCpus(unsigned int firstCpu, unsigned int count) {
+#if defined(__linux__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (unsigned int cpu = firstCpu; cpu < firstCpu + count; cpu++) {
+		if (cpu >= CPU_SETSIZE) {
+			return false;
+		}
+		CPU_SET(cpu, &cpus);
+	}
+
+	// pid 0 is the calling thread
+	return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#elif defined(_WIN32)
+	if (firstCpu + count > sizeof(DWORD_PTR) * 8) {
+		return false;
+	}
+
+	DWORD_PTR mask = 0;
+	for (unsigned int cpu = firstCpu; cpu < firstCpu + count; cpu++) {
+		mask |= static_cast<DWORD_PTR>(1) << cpu;
+	}
+
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+	(void)firstCpu;
+	(void)count;
+	return false;
+#endif
+}
+
+static const char* layoutName(ImageLayout layout) {
+	return layout == ImageLayout::Planar ? "planar" : "interleaved";
+}
+
+static bool isSelected(const std::vector<std::string>& selection, const std::string& name) {
+	return selection.empty() || (std::find(selection.begin(), selection.end(), name) != selection.end());
+}
+
+/**
+ * @return  The peak resident memory of the process so far in MiB, or 0 where it can't be read
+ */
+static double peakResidentMiB() {
+#if defined(__linux__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		// ru_maxrss is in KiB on Linux
+		return static_cast<double>(usage.ru_maxrss) / 1024.0;
+	}
+#endif
+
+	return 0.0;
+}
+
+/**
+ * Allocates the images of one sweep point and fills the sources with the same random values in [0, 1] every time
+ */
+static void prepareImages(const tBenchmarkParams& params, tBenchmarkImages& images) {
+	const std::size_t numElements = static_cast<std::size_t>(params.height) * params.width * params.numChannels;
+
+	images.interleavedSrc.assign(numElements, 0.0f);
+	images.planarSrc.assign(numElements, 0.0f);
+	images.dst.assign(numElements, 0.0f);
+	images.workingBuffer.assign(numElements, 0.0f);
+	// only the cases that use it allocate it again, see transposed()
+	std::vector<float>().swap(images.transposedBuffer);
+	images.kernel.assign(params.kernelSize, 1.0f / static_cast<float>(params.kernelSize));
+	images.pool = nullptr;
+
+	std::default_random_engine generator;
+	std::uniform_real_distribution<float> dist(0, 1);
+	for (auto& value : images.interleavedSrc) {
+		value = dist(generator);
+	}
+
+	const std::size_t planeSize = static_cast<std::size_t>(params.height) * params.width;
+	for (std::size_t px = 0; px < planeSize; px++) {
+		for (unsigned int ch = 0; ch < params.numChannels; ch++) {
+			images.planarSrc[ch * planeSize + px] = images.interleavedSrc[px * params.numChannels + ch];
+		}
+	}
+}
+
+std::vector<tBenchmarkResult> runBenchmarks(const tBenchmarkConfig& config, std::ostream& log) {
+	std::vector<tBenchmarkResult> results;
+	tBenchmarkImages images;
+
+	for (const unsigned int height : config.heights) {
+		for (const unsigned int width : config.widths) {
+			for (const unsigned int numChannels : config.channels) {
+				for (const unsigned int kernelSize : config.kernelSizes) {
+					tBenchmarkParams params{ height, width, numChannels, kernelSize, 1 };
+					prepareImages(params, images);
+
+					for (const auto& benchmarkCase : benchmarkRegistry()) {
+						if (!isSelected(config.cases, benchmarkCase.name) || !isSelected(config.layouts, layoutName(benchmarkCase.layout))) {
+							continue;
+						}
+
+						const std::vector<unsigned int> threadCounts = benchmarkCase.threaded ? config.threads : std::vector<unsigned int>{ 1 };
+						for (const unsigned int threads : threadCounts) {
+							params.threads = threads;
+
+							// pin before the pool starts its threads, so they inherit the mask
+							if ((config.cpu >= 0) && !pinToCpus(static_cast<unsigned int>(config.cpu), threads)) {
+								log << "warning: can't pin to CPUs " << config.cpu << " to " << config.cpu + static_cast<int>(threads) - 1 << ", running unpinned" << std::endl;
+							}
+
+							std::unique_ptr<ThreadPool> pool(benchmarkCase.threaded ? new ThreadPool(threads) : nullptr);
+							images.pool = pool.get();
+
+							bool supported = true;
+							for (unsigned int i = 0; supported && (i < config.warmup); i++) {
+								supported = benchmarkCase.run(params, images);
+							}
+
+							std::vector<double> samples;
+							for (unsigned int i = 0; supported && (i < config.iterations); i++) {
+								const auto start = std::chrono::steady_clock::now();
+								supported = benchmarkCase.run(params, images);
+								const auto end = std::chrono::steady_clock::now();
+								samples.push_back(std::chrono::duration<double>(end - start).count());
+							}
+
+							images.pool = nullptr;
+
+							if (!supported) {
+								log << "skipping " << layoutName(benchmarkCase.layout) << "/" << benchmarkCase.name << " at kernel size " << kernelSize << std::endl;
+								continue;
+							}
+
+							tBenchmarkResult result;
+							result.name = benchmarkCase.name;
+							result.layout = benchmarkCase.layout;
+							result.params = params;
+							result.iterations = config.iterations;
+							result.stats = computeSampleStats(samples);
+
+							const tBenchmarkWork work = benchmarkCase.work(params);
+							result.gbPerSecond = work.bytes / result.stats.median / 1.0e9;
+							result.gflopPerSecond = work.flops / result.stats.median / 1.0e9;
+							result.peakResidentMiB = peakResidentMiB();
+
+							log << layoutName(result.layout) << "/" << result.name << " " << height << "x" << width << "x" << numChannels << " kernel " << kernelSize << " threads " << threads
+								<< ": median " << result.stats.median << " s" << std::endl;
+							results.push_back(result);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	return results;
+}
+
+void writeBenchmarkCsv(const std::vector<tBenchmarkResult>& results, std::ostream& out) {
+	out << "case,layout,height,width,channels,kernel,threads,iterations,min,median,p95,mean,stddev,gbPerSecond,gflopPerSecond,peakResidentMiB" << std::endl;
+	for (const auto& result : results) {
+		out << result.name << "," << layoutName(result.layout) << ","
+			<< result.params.height << "," << result.params.width << "," << result.params.numChannels << "," << result.params.kernelSize << "," << result.params.threads << ","
+			<< result.iterations << ","
+			<< result.stats.min << "," << result.stats.median << "," << result.stats.p95 << "," << result.stats.mean << "," << result.stats.stddev << ","
+			<< result.gbPerSecond << "," << result.gflopPerSecond << "," << result.peakResidentMiB << std::endl;
+	}
+}
+
+void writeBenchmarkJson(const std::vector<tBenchmarkResult>& results, const tBenchmarkConfig& config, std::ostream& out) {
+	// the case names are identifiers, so nothing needs escaping
+	out << "{" << std::endl;
+	out << "\t\"simdLevel\": \"" << simdLevelName(getSimdLevel()) << "\"," << std::endl;
+	out << "\t\"firstPinnedCpu\": " << config.cpu << "," << std::endl;
+	out << "\t\"warmup\": " << config.warmup << "," << std::endl;
+	out << "\t\"results\": [" << std::endl;
+
+	for (std::size_t i = 0; i < results.size(); i++) {
+		const auto& result = results[i];
+		out << "\t\t{ \"case\": \"" << result.name << "\", \"layout\": \"" << layoutName(result.layout) << "\""
+			<< ", \"height\": " << result.params.height << ", \"width\": " << result.params.width << ", \"channels\": " << result.params.numChannels
+			<< ", \"kernel\": " << result.params.kernelSize << ", \"threads\": " << result.params.threads << ", \"iterations\": " << result.iterations
+			<< ", \"min\": " << result.stats.min << ", \"median\": " << result.stats.median << ", \"p95\": " << result.stats.p95
+			<< ", \"mean\": " << result.stats.mean << ", \"stddev\": " << result.stats.stddev
+			<< ", \"gbPerSecond\": " << result.gbPerSecond << ", \"gflopPerSecond\": " << result.gflopPerSecond << ", \"peakResidentMiB\": " << result.peakResidentMiB << " }"
+			<< (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+
+	out << "\t]" << std::endl;
+	out << "}" << std::endl;
+}
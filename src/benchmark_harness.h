@@ -0,0 +1,180 @@
+#pragma once
+
+#include "image_view.h"
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * One point of the parameter sweep
+ */
+typedef struct benchmarkParams {
+	unsigned int height;
+	unsigned int width;
+	unsigned int numChannels;
+	unsigned int kernelSize;
+	unsigned int threads;
+} tBenchmarkParams;
+
+/**
+ * Images shared by every case of one sweep point.  Allocated and filled once, before the first case runs, so no case
+ * measures their allocation.  Every image has height * width * numChannels floats.
+ */
+typedef struct benchmarkImages {
+	std::vector<float> interleavedSrc;
+	std::vector<float> planarSrc;	// the same pixels as interleavedSrc, in planar layout
+	std::vector<float> dst;
+	std::vector<float> workingBuffer;
+	std::vector<float> transposedBuffer;	// only allocated by transposed(), see there
+	std::vector<float> kernel;	// blur kernel of kernelSize taps of 1 / kernelSize
+	ThreadPool* pool;		// pool of params.threads threads, for the threaded cases
+
+	const std::vector<float>& src(ImageLayout layout) const {
+		return layout == ImageLayout::Planar ? planarSrc : interleavedSrc;
+	}
+
+	/**
+	 * @return  transposedBuffer, allocated by the first case of the sweep point that uses it, in a warm-up iteration, so
+	 *          the allocation isn't measured.  It is released when the next sweep point is prepared, but the peak resident
+	 *          memory of the process still includes it, so only a process that runs none of the cases using it never holds
+	 *          it, and peakResidentMiB only shows the difference across separate processes.
+	 */
+	std::vector<float>& transposed() {
+		if (transposedBuffer.size() != dst.size()) {
+			transposedBuffer.assign(dst.size(), 0.0f);
+		}
+
+		return transposedBuffer;
+	}
+} tBenchmarkImages;
+
+/**
+ * Memory traffic and arithmetic of one iteration of a case, used to derive GB/s and GFLOP/s.  The bytes are the compulsory
+ * traffic of the algorithm (every pass reads and writes the whole image once), not measured cache misses.
+ */
+typedef struct benchmarkWork {
+	double bytes;
+	double flops;
+} tBenchmarkWork;
+
+/**
+ * A benchmarked strategy, e.g. the SIMD blur on planar images
+ */
+typedef struct benchmarkCase {
+	std::string name;	// strategy, e.g. "simd".  Together with the layout, identifies the case.
+	ImageLayout layout;
+	bool threaded;		// whether the case runs on images.pool, and is swept over the thread counts
+
+	// runs one iteration: a 2D blur of every channel of images.src(layout) into images.dst.  Returns false if the case
+	// doesn't support params (e.g. a kernel size it has no instantiation for), in which case the sweep point is skipped.
+	std::function<bool(const tBenchmarkParams& params, tBenchmarkImages& images)> run;
+	std::function<tBenchmarkWork(const tBenchmarkParams& params)> work;
+} tBenchmarkCase;
+
+/**
+ * @return  Every registered case, in registration order
+ */
+std::vector<tBenchmarkCase>& benchmarkRegistry();
+
+/**
+ * Registers a case when it is constructed.  Declare one as a static object next to the case, so the case registers itself
+ * before main runs.
+ */
+struct BenchmarkRegistration {
+	explicit BenchmarkRegistration(const tBenchmarkCase& benchmarkCase);
+};
+
+/**
+ * What to run, how often, and where to write the results.  Every list is swept as a cross product.
+ */
+typedef struct benchmarkConfig {
+	std::vector<unsigned int> heights{ 1080 };
+	std::vector<unsigned int> widths{ 1920 };
+	std::vector<unsigned int> channels{ 1, 4 };
+	std::vector<unsigned int> kernelSizes{ 3, 7 };
+	std::vector<unsigned int> threads{ 1 };		// only used by the threaded cases
+	std::vector<std::string> cases;			// names of the cases to run.  Empty runs every case.
+	std::vector<std::string> layouts;		// "planar" and / or "interleaved".  Empty runs both.
+	unsigned int warmup = 2;			// iterations run before the measured ones, and discarded
+	unsigned int iterations = 10;
+	int cpu = -1;					// first CPU to pin to, or -1 to not pin
+	std::string csvPath;				// empty writes the CSV to stdout
+	std::string jsonPath;				// empty doesn't write JSON
+} tBenchmarkConfig;
+
+/**
+ * Applies one "key = value[, value ...]" line to \p config.  Empty lines and lines starting with # are ignored.
+ *
+ * Keys: height, width, channels, kernel, threads, cases, layouts, warmup, iterations, cpu, csv, json
+ *
+ * @return  true if the line was applied or ignored, false if the key is unknown or a value is invalid
+ */
+bool parseBenchmarkConfigLine(const std::string& line, tBenchmarkConfig& config);
+
+/**
+ * Applies every line of the file at \p path to \p config, see parseBenchmarkConfigLine
+ *
+ * @param[out] error  Description of the first problem, if the return value is false
+ *
+ * @return  true if the file was read and every line was valid
+ */
+bool loadBenchmarkConfig(const std::string& path, tBenchmarkConfig& config, std::string& error);
+
+/**
+ * Summary of the measured iterations of one case at one sweep point, in seconds
+ */
+typedef struct sampleStats {
+	double min;
+	double median;
+	double p95;		// nearest-rank 95th percentile
+	double mean;
+	double stddev;		// sample standard deviation
+} tSampleStats;
+
+/**
+ * @param[in] samples  Runtimes in seconds.  Must not be empty.
+ */
+tSampleStats computeSampleStats(std::vector<double> samples);
+
+typedef struct benchmarkResult {
+	std::string name;
+	ImageLayout layout;
+	tBenchmarkParams params;
+	unsigned int iterations;
+	tSampleStats stats;
+	double gbPerSecond;		// bytes of the work model over the median time
+	double gflopPerSecond;		// flops of the work model over the median time
+	double peakResidentMiB;		// peak resident memory of the process so far, over every case and sweep point run before, 0 where it can't be read
+} tBenchmarkResult;
+
+/**
+ * Pins the calling thread to the \p count CPUs starting at \p firstCpu.  Threads it creates afterwards (e.g. the workers of a
+ * ThreadPool) inherit the mask.
+ *
+ * @return  true if the thread was pinned, false if pinning isn't supported on this platform or failed
+ */
+bool pinToCpus(unsigned int firstCpu, unsigned int count);
+
+/**
+ * Runs every case selected by \p config at every sweep point
+ *
+ * @param[in] config  What to run
+ * @param[out] log  Progress and warnings, one line per case and sweep point
+ *
+ * @return  The results, in the order they were run
+ */
+std::vector<tBenchmarkResult> runBenchmarks(const tBenchmarkConfig& config, std::ostream& log);
+
+/**
+ * Writes \p results as CSV, one row per result, with a header row
+ */
+void writeBenchmarkCsv(const std::vector<tBenchmarkResult>& results, std::ostream& out);
+
+/**
+ * Writes \p results as a JSON object, together with the instruction set level and the CPU pinning of the run
+ */
+void writeBenchmarkJson(const std::vector<tBenchmarkResult>& results, const tBenchmarkConfig& config, std::ostream& out);
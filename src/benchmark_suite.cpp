@@ -0,0 +1,77 @@
+#include "benchmark_harness.h"
+#include "cpu_features.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char ** argv) {
+	tBenchmarkConfig config;
+
+	// a config file, then key=value overrides, applied in order
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		if ((arg == "-h") || (arg == "--help")) {
+			std::cout << "Usage: " << argv[0] << " [config file] [key=value ...]" << std::endl;
+			std::cout << "Runs every registered benchmark case over the cross product of the swept parameters." << std::endl;
+			std::cout << "Keys (lists are comma separated):" << std::endl;
+			std::cout << "  height, width, channels: image sizes to sweep" << std::endl;
+			std::cout << "  kernel: odd kernel sizes to sweep" << std::endl;
+			std::cout << "  threads: thread counts to sweep, for the threaded cases" << std::endl;
+			std::cout << "  cases: names of the cases to run (default: all)" << std::endl;
+			std::cout << "  layouts: planar and / or interleaved (default: both)" << std::endl;
+			std::cout << "  warmup: discarded iterations before the measured ones" << std::endl;
+			std::cout << "  iterations: measured iterations" << std::endl;
+			std::cout << "  cpu: first CPU to pin to, or none" << std::endl;
+			std::cout << "  csv: path of the CSV output (default: stdout)" << std::endl;
+			std::cout << "  json: path of the JSON output (default: none)" << std::endl;
+			std::cout << "Cases:";
+			for (const auto& benchmarkCase : benchmarkRegistry()) {
+				std::cout << " " << (benchmarkCase.layout == ImageLayout::Planar ? "planar/" : "interleaved/") << benchmarkCase.name;
+			}
+			std::cout << std::endl;
+			return 0;
+		}
+
+		if (arg.find('=') != std::string::npos) {
+			if (!parseBenchmarkConfigLine(arg, config)) {
+				std::cerr << "invalid argument: " << arg << std::endl;
+				return 1;
+			}
+		}
+		else {
+			std::string error;
+			if (!loadBenchmarkConfig(arg, config, error)) {
+				std::cerr << error << std::endl;
+				return 1;
+			}
+		}
+	}
+
+	// progress goes to stderr, so the CSV can be piped from stdout
+	std::cerr << "SIMD level: " << simdLevelName(getSimdLevel()) << std::endl;
+	const std::vector<tBenchmarkResult> results = runBenchmarks(config, std::cerr);
+
+	if (config.csvPath.empty()) {
+		writeBenchmarkCsv(results, std::cout);
+	}
+	else {
+		std::ofstream csv(config.csvPath);
+		if (!csv) {
+			std::cerr << "can't write " << config.csvPath << std::endl;
+			return 1;
+		}
+		writeBenchmarkCsv(results, csv);
+	}
+
+	if (!config.jsonPath.empty()) {
+		std::ofstream json(config.jsonPath);
+		if (!json) {
+			std::cerr << "can't write " << config.jsonPath << std::endl;
+			return 1;
+		}
+		writeBenchmarkJson(results, config, json);
+	}
+
+	return 0;
+}
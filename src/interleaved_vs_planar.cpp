@@ -1,12 +1,25 @@
 #include "convolution.h"
+#include "parallel_convolution.h"
+#include "batch_convolution.h"
+#include "fft_convolution.h"
+#include "nonseparable_convolution.h"
+#include "frame_pipeline.h"
+#include "iterated_convolution.h"
+#include "buffer_pool.h"
+#include "perf_counters.h"
 
 #include <vector>
 #include <array>
+#include <cstdint>
 #include <iostream>
 #include <sstream>
 #include <random>
 #include <chrono>
+#include <cmath>
 #include <functional>
+#include <memory>
+#include <string>
+#include <utility>
 
 typedef struct runtimeInfo {
 	runtimeInfo(double h, double t, double v)
@@ -34,8 +47,33 @@ typedef struct runtimeInfo {
 	double horizontal;
 	double transpose;
 	double vertical;
+
+	// hardware events of each phase, if the counters are enabled (-p) and the measurement records them
+	tPerfCounts horizontalCounts;
+	tPerfCounts transposeCounts;
+	tPerfCounts verticalCounts;
 } tRuntimeInfo;
 
+// hardware counters of the main thread, or nullptr if they are disabled
+static PerfCounters* phaseCounters = nullptr;
+
+/**
+ * Starts counting the hardware events of a phase, if the counters are enabled.  Call before starting the phase's timer, so
+ * the cost of starting the counters isn't timed.
+ */
+static void startPhaseCounters() {
+	if (phaseCounters != nullptr) {
+		phaseCounters->start();
+	}
+}
+
+/**
+ * @return  The hardware events since startPhaseCounters, or unavailable counts if the counters are disabled
+ */
+static tPerfCounts stopPhaseCounters() {
+	return phaseCounters != nullptr ? phaseCounters->stop() : tPerfCounts();
+}
+
 /**
  * Fills the vector with random values in [0, 1].  This range for float values is typical in
  * image processing, where the value represents 0% to 100% ink coverage of a dot (for print) or light intensity (for screen).
@@ -52,12 +90,19 @@ void fillRandom(std::vector<float>& src) {
 }
 
 // typedefs for the functions being passed around
-template <typename BlurT>
-using blurFn = std::function<bool(const BlurT&, const std::vector<float>&, unsigned int, unsigned int, unsigned int, unsigned int, std::vector<float>&)>;
+template <typename BlurT, typename PixelT = float>
+using blurFn = std::function<bool(const BlurT&, const std::vector<PixelT>&, unsigned int, unsigned int, unsigned int, unsigned int, std::vector<PixelT>&)>;
 using blur3Fn = blurFn<std::array<float, 3>>;
 using blur7Fn = blurFn<std::array<float, 7>>;
 
-using transposeFn = std::function<bool(const std::vector<float>&, unsigned int, unsigned int, unsigned int, std::vector<float>&)>;
+template <typename BlurT>
+using blurAllChannelsFn = std::function<bool(const BlurT&, const std::vector<float>&, unsigned int, unsigned int, unsigned int, std::vector<float>&)>;
+using blur3AllChannelsFn = blurAllChannelsFn<std::array<float, 3>>;
+using blur7AllChannelsFn = blurAllChannelsFn<std::array<float, 7>>;
+
+template <typename PixelT>
+using pixelTransposeFn = std::function<bool(const std::vector<PixelT>&, unsigned int, unsigned int, unsigned int, std::vector<PixelT>&)>;
+using transposeFn = pixelTransposeFn<float>;
 
 /**
  * Measures the runtime of convolving a blur kernel of size BlurSpread across all image channels.
@@ -65,6 +110,7 @@ using transposeFn = std::function<bool(const std::vector<float>&, unsigned int,
  * is assumed and tested in the included tests.
  *
  * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @tparam PixelT  Pixel type of the images, see pixelTraits
  * @param[in] src  Input data of size height * width * depth
  * @param[in] height  Number of elements in \p src in the height dimension
  * @param[in] width  Number of elements in \p src in the width dimension
@@ -73,13 +119,15 @@ using transposeFn = std::function<bool(const std::vector<float>&, unsigned int,
  * @param[in] transposeFn  The optional function that transposes the data.  If this is not empty, the convolution will be performed using the horizontal function, a transpose, and the horizontal function again
  * @param[in] verticalConvolveFn  The function that performs the vertical convolution in 1 channel across the whole image
  * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth.  Allocated once by the caller and reused by every call, so its allocation and page faults stay out of the measurement.
+ * @param[out] transposedBuffer  Scratch buffer of size height * width * depth for the transposed image, reused like \p workingBuffer
  */
-template <typename BlurKernelT>
-tRuntimeInfo measureRuntimeBlur1D(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
-	blurFn<BlurKernelT> horizontalConvolveFn,
-	transposeFn dataTransposeFn,
-	blurFn<BlurKernelT> verticalConvolveFn,
-	std::vector<float>& dst) {
+template <typename BlurKernelT, typename PixelT = float>
+tRuntimeInfo measureRuntimeBlur1D(const std::vector<PixelT>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurFn<BlurKernelT, PixelT> horizontalConvolveFn,
+	pixelTransposeFn<PixelT> dataTransposeFn,
+	blurFn<BlurKernelT, PixelT> verticalConvolveFn,
+	std::vector<PixelT>& dst, std::vector<PixelT>& workingBuffer, std::vector<PixelT>& transposedBuffer) {
 
 	tRuntimeInfo runtimeInfo;
 
@@ -93,17 +141,16 @@ tRuntimeInfo measureRuntimeBlur1D(const std::vector<float>& src, const unsigned
 	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
 
 	// initialize dst with 0s
-	std::fill(dst.begin(), dst.end(), 0.0f);
-
-	// working buffer
-	std::vector<float> workingBuffer(dst.size());
+	std::fill(dst.begin(), dst.end(), PixelT());
 
 	// horizontal convolution in every channel
+	startPhaseCounters();
 	const auto horizStart = std::chrono::high_resolution_clock::now();
 	for (auto i = 0U; i < depth; i++) {
 		horizontalConvolveFn(blurKernel, src, height, width, depth, i, dst);
 	}
 	const auto horizEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.horizontalCounts = stopPhaseCounters();
 
 	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
 
@@ -114,40 +161,46 @@ tRuntimeInfo measureRuntimeBlur1D(const std::vector<float>& src, const unsigned
 
 		// Transpose time includes both transposes
 
-		std::vector<float> transposed(dst.size());
-
+		startPhaseCounters();
 		const auto transposeStart = std::chrono::high_resolution_clock::now();
-		dataTransposeFn(dst, height, width, depth, transposed);
+		dataTransposeFn(dst, height, width, depth, transposedBuffer);
 		const auto transposeEnd = std::chrono::high_resolution_clock::now();
+		runtimeInfo.transposeCounts = stopPhaseCounters();
 
 		runtimeInfo.transpose = std::chrono::duration<double>(transposeEnd - transposeStart).count();
 
+		startPhaseCounters();
 		const auto vertStart = std::chrono::high_resolution_clock::now();
 		for (auto i = 0U; i < depth; i++) {
-			horizontalConvolveFn(blurKernel, transposed, height, width, depth, i, workingBuffer);
+			horizontalConvolveFn(blurKernel, transposedBuffer, width, height, depth, i, workingBuffer);
 		}
 		const auto vertEnd = std::chrono::high_resolution_clock::now();
+		runtimeInfo.verticalCounts = stopPhaseCounters();
 
 		runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
 
+		startPhaseCounters();
 		const auto transpose2Start = std::chrono::high_resolution_clock::now();
-		dataTransposeFn(workingBuffer, height, width, depth, dst);
+		dataTransposeFn(workingBuffer, width, height, depth, dst);
 		const auto transpose2End = std::chrono::high_resolution_clock::now();
+		runtimeInfo.transposeCounts.add(stopPhaseCounters());
 
 		runtimeInfo.transpose += std::chrono::duration<double>(transpose2End - transpose2Start).count();
 
 	}
 	else {
 		// vertical convolution only.  Since this is an out of place operation, the output of the vertical convolve
-		// goes into a working buffer, then we copy all the data back into the dst.  We don't include the allocation time
-		// in the vertical convolution time, but we do include the final copy.
+		// goes into a working buffer, then we copy all the data back into the dst.  The working buffer is allocated by the
+		// caller, so its allocation isn't part of the vertical convolution time, but the final copy is.
 
+		startPhaseCounters();
 		const auto vertStart = std::chrono::high_resolution_clock::now();
 		for (auto i = 0U; i < depth; i++) {
 			verticalConvolveFn(blurKernel, dst, height, width, depth, i, workingBuffer);
 		}
 		std::copy(workingBuffer.begin(), workingBuffer.end(), dst.begin());
 		const auto vertEnd = std::chrono::high_resolution_clock::now();
+		runtimeInfo.verticalCounts = stopPhaseCounters();
 
 		runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
 	}
@@ -156,126 +209,1261 @@ tRuntimeInfo measureRuntimeBlur1D(const std::vector<float>& src, const unsigned
 }
 
 /**
- * Converts an image in interleaved layout to planar layout
+ * Same as measureRuntimeBlur1D with a transpose, but transposes the images in place with transposePlanarInPlace, so the
+ * blur needs no transposed buffer: the horizontal pass goes into \p workingBuffer, which is transposed in place, the second
+ * horizontal pass goes from there into \p dst, and \p dst is transposed back in place.
  *
- * @param[in] interleavedSrc  Input image, in interleaved layout.  Stride is assumed to be \p width * \p depth
- * @param[in] height  Number of rows in the image
- * @param[in] width  Number of columns in the image
- * @param[in] depth  Number of channels in the image
- * @param[out] planarDst  Output image, in planar layout.  Stride is assumed to be \p width
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] src  Input planar data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] horizontalConvolveFn  The function that performs the horizontal convolution in 1 channel across the whole image
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, see measureRuntimeBlur1D
  */
-void interleaved2Planar(const std::vector<float>& interleavedSrc, const unsigned int height, const unsigned int width, const unsigned int depth, std::vector<float>& planarDst) {
-	for (auto row = 0U; row < height; row++) {
-		for (auto col = 0U; col < width; col++) {
-			for (auto ch = 0U; ch < depth; ch++) {
-				const auto interleavedPosition = (row * width + col) * depth + ch;
-				const auto planarPosition = (ch * height * width) + row * width + col;
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlur1DTransposedInPlace(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurFn<BlurKernelT> horizontalConvolveFn, std::vector<float>& dst, std::vector<float>& workingBuffer) {
 
-				planarDst[planarPosition] = interleavedSrc[interleavedPosition];
-			}
-		}
+	tRuntimeInfo runtimeInfo;
+
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
+	}
+
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
+
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	const SimdLevel level = getSimdLevel();
+
+	startPhaseCounters();
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		horizontalConvolveFn(blurKernel, src, height, width, depth, i, workingBuffer);
+	}
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.horizontalCounts = stopPhaseCounters();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	startPhaseCounters();
+	const auto transposeStart = std::chrono::high_resolution_clock::now();
+	transposePlanarInPlace(workingBuffer, height, width, depth, level);
+	const auto transposeEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.transposeCounts = stopPhaseCounters();
+
+	runtimeInfo.transpose = std::chrono::duration<double>(transposeEnd - transposeStart).count();
+
+	startPhaseCounters();
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		horizontalConvolveFn(blurKernel, workingBuffer, width, height, depth, i, dst);
 	}
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.verticalCounts = stopPhaseCounters();
+
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	startPhaseCounters();
+	const auto transpose2Start = std::chrono::high_resolution_clock::now();
+	transposePlanarInPlace(dst, width, height, depth, level);
+	const auto transpose2End = std::chrono::high_resolution_clock::now();
+	runtimeInfo.transposeCounts.add(stopPhaseCounters());
+
+	runtimeInfo.transpose += std::chrono::duration<double>(transpose2End - transpose2Start).count();
+
+	return runtimeInfo;
 }
 
-int main(int argc, char ** argv) {
-	if (argc != 5) {
-		std::cout << "Usage: " << argv[0] << " H W D I" << std::endl;
-		std::cout << "H: height of the source matrix to convolve" << std::endl;
-		std::cout << "W: width of the source matrix to convolve" << std::endl;
-		std::cout << "D: depth (number of channels) of the source matrix to convolve" << std::endl;
-		std::cout << "I: Number of iterations to perform.  The minimum total time for a single iteration is reported" << std::endl;
-		return 1;
+/**
+ * Same as measureRuntimeBlur1D with a transpose, but each horizontal pass writes its output already transposed (e.g.
+ * convolve1DHorizontalTransposedPlanarSimd), so there is no transpose pass: the first pass goes from \p src into
+ * \p workingBuffer, and the second from there into \p dst, in the orientation of \p src.  The transpose time is 0.
+ *
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] src  Input planar data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] horizontalTransposedConvolveFn  The function that performs the horizontal convolution in 1 channel across the whole image, and writes it transposed
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, see measureRuntimeBlur1D
+ */
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlur1DTransposedConvolve(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurFn<BlurKernelT> horizontalTransposedConvolveFn, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
 	}
 
-	std::stringstream ssH(argv[1]);
-	std::stringstream ssW(argv[2]);
-	std::stringstream ssD(argv[3]);
-	std::stringstream ssI(argv[4]);
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
 
-	unsigned int H = 0;
-	unsigned int W = 0;
-	unsigned int D = 0;
-	unsigned int I = 0;
+	std::fill(dst.begin(), dst.end(), 0.0f);
 
-	ssH >> H;
-	ssW >> W;
-	ssD >> D;
-	ssI >> I;
+	startPhaseCounters();
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		horizontalTransposedConvolveFn(blurKernel, src, height, width, depth, i, workingBuffer);
+	}
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.horizontalCounts = stopPhaseCounters();
 
-	if ((H == 0) || (W == 0) || (D == 0) || (I == 0)) {
-		std::cout << "H, W, D, and I must all be positive integers." << std::endl;
-		return 1;
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	startPhaseCounters();
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		horizontalTransposedConvolveFn(blurKernel, workingBuffer, width, height, depth, i, dst);
 	}
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.verticalCounts = stopPhaseCounters();
 
-	// create H x W x D float buffers for the source & dst
-	const auto numElements = H * W * D;
-	std::vector<float> interleavedSrc(numElements);
-	std::vector<float> planarSrc(numElements);
-	std::vector<float> dst(numElements);
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
 
-	// fill src with random float values in [0, 1]
-	fillRandom(interleavedSrc);
-	interleaved2Planar(interleavedSrc, H, W, D, planarSrc);
+	return runtimeInfo;
+}
 
-	blur3Fn horizInterleavedBlur3 = convolve1DHorizontalInterleaved<std::array<float, 3>>;
-	blur3Fn vertInterleavedBlur3 = convolve1DVerticalInterleaved<std::array<float, 3>>;
-	blur3Fn horizPlanarBlur3 = convolve1DHorizontalPlanar<std::array<float, 3>>;
-	blur3Fn vertPlanarBlur3 = convolve1DVerticalPlanar<std::array<float, 3>>;
+/**
+ * Measures the runtime of convolving a blur kernel of size BlurSpread across all image channels, where each pass covers
+ * every channel in a single call (e.g. convolve1DHorizontalInterleavedAll) instead of one call per channel.
+ *
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] horizontalConvolveFn  The function that performs the horizontal convolution in all channels across the whole image
+ * @param[in] verticalConvolveFn  The function that performs the vertical convolution in all channels across the whole image
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ */
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlur1DAllChannels(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurAllChannelsFn<BlurKernelT> horizontalConvolveFn,
+	blurAllChannelsFn<BlurKernelT> verticalConvolveFn,
+	std::vector<float>& dst, std::vector<float>& workingBuffer) {
 
-	blur7Fn horizInterleavedBlur7 = convolve1DHorizontalInterleaved<std::array<float, 7>>;
-	blur7Fn vertInterleavedBlur7 = convolve1DVerticalInterleaved<std::array<float, 7>>;
-	blur7Fn horizPlanarBlur7 = convolve1DHorizontalPlanar<std::array<float, 7>>;
-	blur7Fn vertPlanarBlur7 = convolve1DVerticalPlanar<std::array<float, 7>>;
+	tRuntimeInfo runtimeInfo;
 
-	transposeFn noTransposeFn;
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
+	}
 
-	tRuntimeInfo minInterleavedBlur3Runtime = tRuntimeInfo::Max();
-	tRuntimeInfo minPlanarBlur3Runtime = tRuntimeInfo::Max();
-	tRuntimeInfo minInterleavedBlur7Runtime = tRuntimeInfo::Max();
-	tRuntimeInfo minPlanarBlur7Runtime = tRuntimeInfo::Max();
-	tRuntimeInfo minPlanarBlur7WithTransposeRuntime = tRuntimeInfo::Max();
+	// fill the blur kernel with (1 / size) to get equal contributions from every component
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
 
-	for (auto i = 0U; i < I; i++) {
-		tRuntimeInfo runtime = measureRuntimeBlur1D<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedBlur3, noTransposeFn, vertInterleavedBlur3, dst);
-		if (runtime.GetTotal() < minInterleavedBlur3Runtime.GetTotal()) {
-			minInterleavedBlur3Runtime = runtime;
-		}
+	// initialize dst with 0s
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	horizontalConvolveFn(blurKernel, src, height, width, depth, dst);
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	// same as measureRuntimeBlur1D: the final copy back from the working buffer is part of the vertical time
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	verticalConvolveFn(blurKernel, dst, height, width, depth, workingBuffer);
+	std::copy(workingBuffer.begin(), workingBuffer.end(), dst.begin());
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of a separable blur with kernel size BlurSpread across all image channels, where each channel is
+ * blurred by a single fused call that performs both the horizontal and the vertical pass (e.g. convolve2DSeparablePlanar).
+ * The fused time is reported as the horizontal time.
+ *
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] fusedConvolveFn  The function that performs the horizontal and vertical convolution in 1 channel across the whole image
+ * @param[out] dst  Output buffer of size height * width * depth
+ */
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlur2DFused(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurFn<BlurKernelT> fusedConvolveFn,
+	std::vector<float>& dst) {
+
+	tRuntimeInfo runtimeInfo;
+
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
 	}
 
-	for (auto i = 0U; i < I; i++) {
-		const tRuntimeInfo runtime = measureRuntimeBlur1D<std::array<float, 3>>(planarSrc, H, W, D, horizPlanarBlur3, noTransposeFn, vertPlanarBlur3, dst);
-		if (runtime.GetTotal() < minPlanarBlur3Runtime.GetTotal()) {
-			minPlanarBlur3Runtime = runtime;
-		}
+	// fill the blur kernel with (1 / size) to get equal contributions from every component
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
+
+	// initialize dst with 0s
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	const auto fusedStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		fusedConvolveFn(blurKernel, src, height, width, depth, i, dst);
 	}
+	const auto fusedEnd = std::chrono::high_resolution_clock::now();
 
-	for (auto i = 0U; i < I; i++) {
-		tRuntimeInfo runtime = measureRuntimeBlur1D<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedBlur7, noTransposeFn, vertInterleavedBlur7, dst);
-		if (runtime.GetTotal() < minInterleavedBlur7Runtime.GetTotal()) {
-			minInterleavedBlur7Runtime = runtime;
-		}
+	runtimeInfo.horizontal = std::chrono::duration<double>(fusedEnd - fusedStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of a box blur of radius \p radius across all image channels, using the sliding-sum box filters
+ * (boxFilter1DHorizontal / boxFilter1DVertical).  This is the same blur as measureRuntimeBlur1D with a kernel of size
+ * 2 * \p radius + 1, and is reported the same way, including the copy back from the working buffer in the vertical time.
+ *
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] layout  Layout of \p src and \p dst
+ * @param[in] radius  Radius of the box
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ */
+tRuntimeInfo measureRuntimeBoxFilter(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, unsigned int radius, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	// initialize dst with 0s
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		boxFilter1DHorizontal(radius, layout, src, height, width, depth, i, dst);
 	}
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
 
-	for (auto i = 0U; i < I; i++) {
-		tRuntimeInfo runtime = measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, noTransposeFn, vertPlanarBlur7, dst);
-		if (runtime.GetTotal() < minPlanarBlur7Runtime.GetTotal()) {
-			minPlanarBlur7Runtime = runtime;
-		}
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		boxFilter1DVertical(radius, layout, dst, height, width, depth, i, workingBuffer);
 	}
+	std::copy(workingBuffer.begin(), workingBuffer.end(), dst.begin());
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
 
-	for (auto i = 0U; i < I; i++) {
-		tRuntimeInfo runtime = measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, transposePlanar, vertPlanarBlur7, dst);
-		if (runtime.GetTotal() < minPlanarBlur7WithTransposeRuntime.GetTotal()) {
-			minPlanarBlur7WithTransposeRuntime = runtime;
-		}
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of blurring an interleaved image by converting it to planar layout, blurring every channel of the
+ * planar image, and converting the result back to interleaved layout (interleavedToPlanar / planarToInterleaved), so the
+ * planar blur can be compared with blurring the interleaved image directly.  Both conversions are reported as the transpose
+ * time.  Since the result is converted out of the working buffer, the vertical time has no copy back.
+ *
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] interleavedSrc  Input data of size height * width * depth, in interleaved layout
+ * @param[in] height  Number of elements in \p interleavedSrc in the height dimension
+ * @param[in] width  Number of elements in \p interleavedSrc in the width dimension
+ * @param[in] depth  Number of elements in \p interleavedSrc in the depth dimension
+ * @param[in] horizontalConvolveFn  The function that performs the horizontal convolution in 1 channel across the whole planar image
+ * @param[in] verticalConvolveFn  The function that performs the vertical convolution in 1 channel across the whole planar image
+ * @param[out] dst  Output buffer of size height * width * depth, in interleaved layout
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ * @param[out] planarBuffer  Scratch buffer of size height * width * depth for the planar source, reused like \p workingBuffer
+ */
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlur1DConverted(const std::vector<float>& interleavedSrc, const unsigned int height, const unsigned int width, const unsigned int depth,
+	blurFn<BlurKernelT> horizontalConvolveFn,
+	blurFn<BlurKernelT> verticalConvolveFn,
+	std::vector<float>& dst, std::vector<float>& workingBuffer, std::vector<float>& planarBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
+	}
+
+	// fill the blur kernel with (1 / size) to get equal contributions from every component
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
+
+	// initialize dst with 0s
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	startPhaseCounters();
+	const auto toPlanarStart = std::chrono::high_resolution_clock::now();
+	interleavedToPlanar(interleavedSrc, height, width, depth, planarBuffer, getSimdLevel());
+	const auto toPlanarEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.transposeCounts = stopPhaseCounters();
+
+	runtimeInfo.transpose = std::chrono::duration<double>(toPlanarEnd - toPlanarStart).count();
+
+	startPhaseCounters();
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		horizontalConvolveFn(blurKernel, planarBuffer, height, width, depth, i, dst);
+	}
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.horizontalCounts = stopPhaseCounters();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	startPhaseCounters();
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		verticalConvolveFn(blurKernel, dst, height, width, depth, i, workingBuffer);
 	}
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.verticalCounts = stopPhaseCounters();
+
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	startPhaseCounters();
+	const auto toInterleavedStart = std::chrono::high_resolution_clock::now();
+	planarToInterleaved(workingBuffer, height, width, depth, dst, getSimdLevel());
+	const auto toInterleavedEnd = std::chrono::high_resolution_clock::now();
+	runtimeInfo.transposeCounts.add(stopPhaseCounters());
+
+	runtimeInfo.transpose += std::chrono::duration<double>(toInterleavedEnd - toInterleavedStart).count();
+
+	return runtimeInfo;
+}
 
-	std::cout << "test,horizontal,transpose,vertical,total" << std::endl;
-	std::cout << "interleaved3," << minInterleavedBlur3Runtime.toCsv() << std::endl;
-	std::cout << "planar3," << minPlanarBlur3Runtime.toCsv() << std::endl;
-	std::cout << "interleaved7," << minInterleavedBlur7Runtime.toCsv() << std::endl;
-	std::cout << "planar7," << minPlanarBlur7Runtime.toCsv() << std::endl;
-	std::cout << "planar7withTranspose," << minPlanarBlur7WithTransposeRuntime.toCsv() << std::endl;
+/**
+ * Measures the runtime of blurring every channel of the image with the multi-threaded engine, i.e. the (channel, row band)
+ * tasks of every channel run on \p pool at once.  The separable version reports the horizontal and vertical passes (including
+ * the copy back from the working buffer) like measureRuntimeBlur1D.  The fused version reports its single pass as the
+ * horizontal time, like measureRuntimeBlur2DFused.
+ *
+ * @tparam BlurKernel  The array-ish blur kernel.  Required to be odd size
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] layout  Layout of \p src and \p dst
+ * @param[in] fused  If true, use convolve2DSeparableParallel, otherwise convolve1DHorizontalParallel followed by convolve1DVerticalParallel
+ * @param[in] pool  Threads to blur with
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ */
+template <typename BlurKernelT>
+tRuntimeInfo measureRuntimeBlurParallel(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, bool fused, ThreadPool& pool, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	BlurKernelT blurKernel;
+	if (blurKernel.size() % 2 != 1) {
+		return runtimeInfo;
+	}
+
+	// fill the blur kernel with (1 / size) to get equal contributions from every component
+	const auto contribution = 1.0f / static_cast<float>(blurKernel.size());
+	std::fill(blurKernel.begin(), blurKernel.end(), contribution);
+	const auto kernelSize = static_cast<unsigned int>(blurKernel.size());
+
+	// initialize dst with 0s
+	std::fill(dst.begin(), dst.end(), 0.0f);
+
+	if (fused) {
+		const auto fusedStart = std::chrono::high_resolution_clock::now();
+		convolve2DSeparableParallel(blurKernel.data(), kernelSize, blurKernel.data(), kernelSize, layout, src, height, width, depth, dst, pool, getSimdLevel());
+		const auto fusedEnd = std::chrono::high_resolution_clock::now();
+
+		runtimeInfo.horizontal = std::chrono::duration<double>(fusedEnd - fusedStart).count();
+		return runtimeInfo;
+	}
+
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	convolve1DHorizontalParallel(blurKernel.data(), kernelSize, layout, src, height, width, depth, dst, pool, getSimdLevel());
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	convolve1DVerticalParallel(blurKernel.data(), kernelSize, layout, dst, height, width, depth, workingBuffer, pool, getSimdLevel());
+	std::copy(workingBuffer.begin(), workingBuffer.end(), dst.begin());
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of converting an image between interleaved and planar layout with the multi-threaded conversion
+ * (interleavedToPlanarParallel / planarToInterleavedParallel).  The conversion is reported as the transpose time.
+ *
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] srcLayout  Layout of \p src.  \p dst gets the other layout.
+ * @param[in] pool  Threads to convert with
+ * @param[out] dst  Output buffer of size height * width * depth
+ */
+tRuntimeInfo measureRuntimeConversionParallel(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout srcLayout, ThreadPool& pool, std::vector<float>& dst) {
+
+	tRuntimeInfo runtimeInfo;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	if (srcLayout == ImageLayout::Interleaved) {
+		interleavedToPlanarParallel(src, height, width, depth, dst, pool, getSimdLevel());
+	}
+	else {
+		planarToInterleavedParallel(src, height, width, depth, dst, pool, getSimdLevel());
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.transpose = std::chrono::duration<double>(end - start).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * How measureRuntimeBatch blurs a batch of images
+ */
+enum class BatchMode {
+	ReferencePerImage,	// the reference templates, once per image and channel
+	SimdPerImage,		// convolve1DHorizontal / convolve1DVertical, once per image and channel
+	Batch,			// convolve1DHorizontalBatch and convolve1DVerticalBatch, once each
+	SeparableBatch		// convolve2DSeparableBatch, once
+};
+
+/**
+ * Measures the runtime of blurring a batch of images with the 7-tap blur, as given by \p mode.  The calls per image work on
+ * one std::vector per image, the way a caller without the batch functions would store them, and the batch functions on
+ * the same images back to back in one buffer.  The blur of the whole batch is reported as the horizontal time.
+ *
+ * @param[in] images  \p numImages images of size height * width * depth, back to back
+ * @param[in] imageList  The same images, one std::vector each
+ * @param[in] height  Height of every image
+ * @param[in] width  Width of every image
+ * @param[in] depth  Number of channels of every image
+ * @param[in] layout  Layout of the images
+ * @param[in] mode  How to blur the images
+ * @param[in] pool  Threads to run the batch functions on
+ * @param[out] dst  Output buffer of the size of \p images, for the batch functions
+ * @param[out] workingBuffer  Scratch buffer of the size of \p images, for the batch functions
+ * @param[out] dstList  Output buffers of the size of an image, one per image, for the calls per image
+ * @param[out] imageWorkingBuffer  Scratch buffer of the size of an image, for the calls per image
+ */
+tRuntimeInfo measureRuntimeBatch(const std::vector<float>& images, const std::vector<std::vector<float>>& imageList, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, BatchMode mode, ThreadPool& pool, std::vector<float>& dst, std::vector<float>& workingBuffer, std::vector<std::vector<float>>& dstList, std::vector<float>& imageWorkingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	std::array<float, 7> blurKernel;
+	std::fill(blurKernel.begin(), blurKernel.end(), 1.0f / static_cast<float>(blurKernel.size()));
+
+	const SimdLevel level = getSimdLevel();
+	const unsigned int numImages = static_cast<unsigned int>(imageList.size());
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	if (mode == BatchMode::Batch) {
+		convolve1DHorizontalBatch(blurKernel.data(), 7, layout, images, numImages, height, width, depth, workingBuffer, pool, level);
+		convolve1DVerticalBatch(blurKernel.data(), 7, layout, workingBuffer, numImages, height, width, depth, dst, pool, level);
+	}
+	else if (mode == BatchMode::SeparableBatch) {
+		convolve2DSeparableBatch(blurKernel.data(), 7, blurKernel.data(), 7, layout, images, numImages, height, width, depth, dst, pool, level);
+	}
+	else {
+		for (auto i = 0U; i < numImages; i++) {
+			for (auto ch = 0U; ch < depth; ch++) {
+				if (mode == BatchMode::SimdPerImage) {
+					convolve1DHorizontal(blurKernel.data(), 7, layout, imageList[i], height, width, depth, ch, imageWorkingBuffer, level);
+					convolve1DVertical(blurKernel.data(), 7, layout, imageWorkingBuffer, height, width, depth, ch, dstList[i], level);
+				}
+				else if (layout == ImageLayout::Planar) {
+					convolve1DHorizontalPlanar(blurKernel, imageList[i], height, width, depth, ch, imageWorkingBuffer);
+					convolve1DVerticalPlanar(blurKernel, imageWorkingBuffer, height, width, depth, ch, dstList[i]);
+				}
+				else {
+					convolve1DHorizontalInterleaved(blurKernel, imageList[i], height, width, depth, ch, imageWorkingBuffer);
+					convolve1DVerticalInterleaved(blurKernel, imageWorkingBuffer, height, width, depth, ch, dstList[i]);
+				}
+			}
+		}
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(end - start).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of blurring every channel of an image with a wide kernel, horizontally and then vertically, with
+ * the direct SIMD kernels (convolve1DHorizontal / convolve1DVertical) or in the frequency domain (convolve1DHorizontalFft /
+ * convolve1DVerticalFft).
+ *
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] layout  Layout of \p src and \p dst
+ * @param[in] kernel  Taps of the blur.  Must have odd length.
+ * @param[in] fft  If true, convolve in the frequency domain, otherwise with the direct kernels
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ */
+tRuntimeInfo measureRuntimeWideBlur(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, const std::vector<float>& kernel, bool fft, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	const SimdLevel level = getSimdLevel();
+	const unsigned int kernelSize = static_cast<unsigned int>(kernel.size());
+
+	const auto horizStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		if (fft) {
+			convolve1DHorizontalFft(kernel.data(), kernelSize, layout, src, height, width, depth, i, workingBuffer, level);
+		}
+		else {
+			convolve1DHorizontal(kernel.data(), kernelSize, layout, src, height, width, depth, i, workingBuffer, level);
+		}
+	}
+	const auto horizEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(horizEnd - horizStart).count();
+
+	const auto vertStart = std::chrono::high_resolution_clock::now();
+	for (auto i = 0U; i < depth; i++) {
+		if (fft) {
+			convolve1DVerticalFft(kernel.data(), kernelSize, layout, workingBuffer, height, width, depth, i, dst, level);
+		}
+		else {
+			convolve1DVertical(kernel.data(), kernelSize, layout, workingBuffer, height, width, depth, i, dst, level);
+		}
+	}
+	const auto vertEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * How measureRuntimeBlur2D blurs an image with a separable kernel
+ */
+enum class Blur2DMode {
+	Separable,		// convolve1DHorizontal, then convolve1DVertical
+	Fused,			// convolve2DSeparable
+	NonSeparable,		// convolve2D with the outer product of the kernel with itself
+	NonSeparableAllChannels	// convolve2DInterleavedAllChannels with the outer product, once for all channels.  Interleaved only.
+};
+
+/**
+ * Measures the runtime of blurring every channel of an image with a \p kernel x \p kernel box, as given by \p mode.  The
+ * two passes of Separable are reported as the horizontal and vertical times, every other mode as the horizontal time.
+ *
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] layout  Layout of \p src and \p dst
+ * @param[in] kernelSize  Taps of the box in each direction.  Must be odd.
+ * @param[in] mode  How to blur the image
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth, reused by every call (see measureRuntimeBlur1D)
+ */
+tRuntimeInfo measureRuntimeBlur2D(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, unsigned int kernelSize, Blur2DMode mode, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	const SimdLevel level = getSimdLevel();
+	const std::vector<float> kernel(kernelSize, 1.0f / static_cast<float>(kernelSize));
+	const std::vector<float> kernel2D(kernelSize * kernelSize, 1.0f / static_cast<float>(kernelSize * kernelSize));
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	if (mode == Blur2DMode::NonSeparableAllChannels) {
+		convolve2DInterleavedAllChannels(kernel2D.data(), kernelSize, src, height, width, depth, dst, level);
+	}
+	else {
+		for (auto i = 0U; i < depth; i++) {
+			if (mode == Blur2DMode::Separable) {
+				convolve1DHorizontal(kernel.data(), kernelSize, layout, src, height, width, depth, i, workingBuffer, level);
+			}
+			else if (mode == Blur2DMode::Fused) {
+				convolve2DSeparable(kernel.data(), kernelSize, kernel.data(), kernelSize, layout, src, height, width, depth, i, dst, level);
+			}
+			else {
+				convolve2D(kernel2D.data(), kernelSize, layout, src, height, width, depth, i, dst, level);
+			}
+		}
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(end - start).count();
+
+	if (mode == Blur2DMode::Separable) {
+		const auto vertStart = std::chrono::high_resolution_clock::now();
+		for (auto i = 0U; i < depth; i++) {
+			convolve1DVertical(kernel.data(), kernelSize, layout, workingBuffer, height, width, depth, i, dst, level);
+		}
+		const auto vertEnd = std::chrono::high_resolution_clock::now();
+
+		runtimeInfo.vertical = std::chrono::duration<double>(vertEnd - vertStart).count();
+	}
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of blurring every channel of an image \p numPasses times with a 7-tap box in both directions.  Pass
+ * by pass, every pass runs convolve2DSeparable on every channel of the whole image, ping-ponging between \p dst and
+ * \p workingBuffer; tiled, every channel is blurred by a single call of convolve2DSeparableIterated.  The time is reported
+ * as the horizontal time.
+ *
+ * @param[in] src  Input data of size height * width * depth
+ * @param[in] height  Number of elements in \p src in the height dimension
+ * @param[in] width  Number of elements in \p src in the width dimension
+ * @param[in] depth  Number of elements in \p src in the depth dimension
+ * @param[in] layout  Layout of \p src and \p dst
+ * @param[in] numPasses  Number of times to blur the image
+ * @param[in] tiled  Whether to run all passes tile by tile
+ * @param[out] dst  Output buffer of size height * width * depth
+ * @param[out] workingBuffer  Scratch buffer of size height * width * depth for the passes in between
+ */
+tRuntimeInfo measureRuntimeIteratedBlur(const std::vector<float>& src, const unsigned int height, const unsigned int width, const unsigned int depth,
+	ImageLayout layout, unsigned int numPasses, bool tiled, std::vector<float>& dst, std::vector<float>& workingBuffer) {
+
+	tRuntimeInfo runtimeInfo;
+
+	const SimdLevel level = getSimdLevel();
+	const std::array<float, 7> kernel{ { 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7 } };
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	if (tiled) {
+		for (auto i = 0U; i < depth; i++) {
+			convolve2DSeparableIterated(kernel.data(), 7, kernel.data(), 7, numPasses, layout, src, height, width, depth, i, dst, defaultIteratedTileBytes, level);
+		}
+	}
+	else {
+		// the last pass writes dst
+		const std::vector<float>* passSrc = &src;
+		std::vector<float>* passDst = numPasses % 2 == 1 ? &dst : &workingBuffer;
+		for (auto pass = 0U; pass < numPasses; pass++) {
+			for (auto i = 0U; i < depth; i++) {
+				convolve2DSeparable(kernel.data(), 7, kernel.data(), 7, layout, *passSrc, height, width, depth, i, *passDst, level);
+			}
+
+			passSrc = passDst;
+			passDst = passDst == &dst ? &workingBuffer : &dst;
+		}
+	}
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.horizontal = std::chrono::duration<double>(end - start).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Bytes of the pixels a blur of every channel of an image with \p numPasses passes of a kernel of \p kernelSize taps reads
+ * and writes: pass by pass, every pass reads and writes the whole image; tiled, every tile of convolve2DSeparableIterated
+ * is read once with its halo, clipped to the image, and written once.
+ */
+double iteratedBlurBytes(unsigned int height, unsigned int width, unsigned int depth, unsigned int numPasses, unsigned int kernelSize, bool tiled) {
+	const double imageBytes = static_cast<double>(height) * width * depth * sizeof(float);
+	if (!tiled) {
+		return 2.0 * numPasses * imageBytes;
+	}
+
+	const unsigned int tileSize = iteratedTileSize(kernelSize, kernelSize, numPasses, defaultIteratedTileBytes);
+	const unsigned int halo = numPasses * (kernelSize / 2);
+	const auto haloLength = [&](unsigned int begin, unsigned int size, unsigned int length) {
+		const unsigned int end = begin + std::min(size, length - begin);
+		return static_cast<double>(std::min(end + halo, length) - (begin > halo ? begin - halo : 0));
+	};
+
+	double tileBytes = 0.0;
+	for (auto row = 0U; row < height; row += tileSize) {
+		for (auto col = 0U; col < width; col += tileSize) {
+			tileBytes += haloLength(row, tileSize, height) * haloLength(col, tileSize, width);
+		}
+	}
+
+	return tileBytes * depth * sizeof(float) + imageBytes;
+}
+
+/**
+ * Blurs a stream of \p numFrames frames with a 7-tap box in a FramePipeline, \p iterations times, and returns the timings of
+ * the run with the most frames per second.  The source copies \p interleavedSrc into each frame, and the sink copies the
+ * planar result into \p dst, standing in for decoding and encoding the frames.
+ *
+ * @param[in] interleavedSrc  Frame of size height * width * depth, in interleaved layout
+ * @param[in] height  Number of rows in a frame
+ * @param[in] width  Number of columns in a frame
+ * @param[in] depth  Number of channels in a frame
+ * @param[in] numFrames  Number of frames in the stream
+ * @param[in] numSlots  Number of frame buffers of the pipeline
+ * @param[in] pipelined  Whether the stages run concurrently (FramePipeline::run) or one after another (FramePipeline::runSequential)
+ * @param[in] iterations  Number of times to run the stream
+ * @param[out] dst  Output buffer of size height * width * depth
+ */
+tFramePipelineStats measureFramePipeline(const std::vector<float>& interleavedSrc, const unsigned int height, const unsigned int width, const unsigned int depth,
+	unsigned int numFrames, unsigned int numSlots, bool pipelined, unsigned int iterations, std::vector<float>& dst) {
+
+	const std::array<float, 7> kernel{ { 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7, 1.0f / 7 } };
+	FramePipeline pipeline(kernel.data(), 7, kernel.data(), 7, height, width, depth, numSlots, getSimdLevel());
+
+	const ImageView src = makeImageView(interleavedSrc, ImageLayout::Interleaved, height, width, depth);
+	const MutableImageView result = makeImageView(dst, ImageLayout::Planar, height, width, depth);
+	const frameSourceFn source = [&](unsigned int, const MutableImageView& frame) { return copyImage(src, frame); };
+	const frameSinkFn sink = [&](unsigned int, const ImageView& frame) { return copyImage(frame, result); };
+
+	tFramePipelineStats fastest{};
+	for (auto i = 0U; i < iterations; i++) {
+		tFramePipelineStats stats{};
+		const bool succeeded = pipelined ? pipeline.run(numFrames, source, sink, stats) : pipeline.runSequential(numFrames, source, sink, stats);
+		if (succeeded && (stats.framesPerSecond > fastest.framesPerSecond)) {
+			fastest = stats;
+		}
+	}
+
+	return fastest;
+}
+
+/**
+ * Calls \p measureFn \p iterations times back-to-back, and returns the runtime of the iteration that consumed the least total time.
+ *
+ * @param[in] iterations  Number of times to run the measurement
+ * @param[in] measureFn  Function that performs one measurement, e.g. a call to measureRuntimeBlur1D
+ */
+tRuntimeInfo measureMinRuntime(const unsigned int iterations, const std::function<tRuntimeInfo()>& measureFn) {
+	tRuntimeInfo minRuntime = tRuntimeInfo::Max();
+
+	for (auto i = 0U; i < iterations; i++) {
+		const tRuntimeInfo runtime = measureFn();
+		if (runtime.GetTotal() < minRuntime.GetTotal()) {
+			minRuntime = runtime;
+		}
+	}
+
+	return minRuntime;
+}
+
+/**
+ * Runtime of a test right after it starts (first touch) and once it has warmed up (steady state)
+ */
+typedef struct runtimeStats {
+	std::string toCsv() const {
+		std::stringstream ss;
+		ss << steadyState.toCsv() << "," << firstIteration;
+		if (phaseCounters != nullptr) {
+			ss << "," << steadyState.horizontalCounts.toCsv() << "," << steadyState.transposeCounts.toCsv() << "," << steadyState.verticalCounts.toCsv();
+		}
+		return ss.str();
+	}
+
+	tRuntimeInfo steadyState;	// fastest of the iterations after the first
+	double firstIteration;		// total time of the first iteration
+} tRuntimeStats;
+
+/**
+ * Empties the library's scratch buffer pool, then calls \p measureFn \p iterations times back-to-back.  The first iteration
+ * pays for allocating and page-faulting the scratch buffers and runs with cold caches, like the first frame an application
+ * processes.  The later iterations reuse the pooled buffers, and the fastest of them is the steady-state runtime.
+ *
+ * @param[in] iterations  Number of times to run the measurement.  If 1, the first iteration is also reported as the steady state.
+ * @param[in] measureFn  Function that performs one measurement, e.g. a call to measureRuntimeBlur1D
+ */
+tRuntimeStats measureRuntimeStats(const unsigned int iterations, const std::function<tRuntimeInfo()>& measureFn) {
+	scratchBufferPool().trim();
+
+	tRuntimeStats stats;
+	const tRuntimeInfo first = measureFn();
+	stats.firstIteration = first.GetTotal();
+	stats.steadyState = iterations > 1 ? measureMinRuntime(iterations - 1, measureFn) : first;
+
+	return stats;
+}
+
+/**
+ * Measures the 7-tap blur of the reference templates on images stored as \p PixelT instead of float, and prints the
+ * interleaved7, planar7 and planar7withTranspose rows with \p suffix appended to their names.  The images only exist for
+ * the duration of the call.
+ *
+ * @tparam PixelT  Pixel type - std::uint8_t, std::uint16_t or tHalf
+ * @param[in] suffix  Appended to the test names, e.g. "u8"
+ * @param[in] scale  Scale from the [0, 1] float sources to the range of \p PixelT, e.g. 255 for 8-bit pixels
+ * @param[in] interleavedSrc  Float source image, in interleaved layout
+ * @param[in] planarSrc  The same image in planar layout
+ * @param[in] height  Number of rows in the image
+ * @param[in] width  Number of columns in the image
+ * @param[in] depth  Number of channels in the image
+ * @param[in] iterations  Number of times to run each measurement
+ */
+template <typename PixelT>
+void printLowPrecisionBlur7(const std::string& suffix, const float scale, const std::vector<float>& interleavedSrc, const std::vector<float>& planarSrc,
+	const unsigned int height, const unsigned int width, const unsigned int depth, const unsigned int iterations) {
+
+	const auto toPixel = [scale](float value) { return pixelTraits<PixelT>::store(value * scale); };
+
+	std::vector<PixelT> interleavedPixels(interleavedSrc.size());
+	std::vector<PixelT> planarPixels(planarSrc.size());
+	std::transform(interleavedSrc.begin(), interleavedSrc.end(), interleavedPixels.begin(), toPixel);
+	std::transform(planarSrc.begin(), planarSrc.end(), planarPixels.begin(), toPixel);
+
+	std::vector<PixelT> dst(interleavedSrc.size());
+	std::vector<PixelT> workingBuffer(interleavedSrc.size());
+	std::vector<PixelT> transposedBuffer(interleavedSrc.size());
+
+	typedef std::array<float, 7> blur7T;
+	const blurFn<blur7T, PixelT> horizInterleaved = convolve1DHorizontalInterleaved<blur7T, PixelT>;
+	const blurFn<blur7T, PixelT> vertInterleaved = convolve1DVerticalInterleaved<blur7T, PixelT>;
+	const blurFn<blur7T, PixelT> horizPlanar = convolve1DHorizontalPlanar<blur7T, PixelT>;
+	const blurFn<blur7T, PixelT> vertPlanar = convolve1DVerticalPlanar<blur7T, PixelT>;
+	const pixelTransposeFn<PixelT> noTranspose;
+	const pixelTransposeFn<PixelT> tiledTranspose = transposePlanar<PixelT>;
+
+	std::cout << "interleaved7" << suffix << "," << measureRuntimeStats(iterations, [&]() { return measureRuntimeBlur1D<blur7T, PixelT>(interleavedPixels, height, width, depth, horizInterleaved, noTranspose, vertInterleaved, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7" << suffix << "," << measureRuntimeStats(iterations, [&]() { return measureRuntimeBlur1D<blur7T, PixelT>(planarPixels, height, width, depth, horizPlanar, noTranspose, vertPlanar, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7" << suffix << "withTranspose," << measureRuntimeStats(iterations, [&]() { return measureRuntimeBlur1D<blur7T, PixelT>(planarPixels, height, width, depth, horizPlanar, tiledTranspose, vertPlanar, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+}
+
+int main(int argc, char ** argv) {
+	// optional flags come before the positional arguments
+	unsigned int T = 0;
+	unsigned int B = 0;
+	unsigned int F = 0;
+	bool countEvents = false;
+	bool sweepKernelSize = false;
+	bool nonSeparable = false;
+	bool iteratedPasses = false;
+	std::vector<std::string> positional;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		if ((arg == "-t") && (i + 1 < argc)) {
+			std::stringstream ssT(argv[++i]);
+			ssT >> T;
+			if (T == 0) {
+				std::cout << "T must be a positive integer." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-b") && (i + 1 < argc)) {
+			std::stringstream ssB(argv[++i]);
+			ssB >> B;
+			if (B == 0) {
+				std::cout << "B must be a positive integer." << std::endl;
+				return 1;
+			}
+		}
+		else if ((arg == "-f") && (i + 1 < argc)) {
+			std::stringstream ssF(argv[++i]);
+			ssF >> F;
+			if (F == 0) {
+				std::cout << "F must be a positive integer." << std::endl;
+				return 1;
+			}
+		}
+		else if (arg == "-p") {
+			countEvents = true;
+		}
+		else if (arg == "-k") {
+			sweepKernelSize = true;
+		}
+		else if (arg == "-n") {
+			nonSeparable = true;
+		}
+		else if (arg == "-r") {
+			iteratedPasses = true;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if (positional.size() != 4) {
+		std::cout << "Usage: " << argv[0] << " [-t T] [-b B] [-f F] [-k] [-n] [-r] [-p] H W D I" << std::endl;
+		std::cout << "H: height of the source matrix to convolve" << std::endl;
+		std::cout << "W: width of the source matrix to convolve" << std::endl;
+		std::cout << "D: depth (number of channels) of the source matrix to convolve" << std::endl;
+		std::cout << "I: Number of iterations to perform.  The minimum total time for a single iteration is reported" << std::endl;
+		std::cout << "-t T: Also run the multi-threaded blur with T threads, and report its speedup and parallel efficiency over 1 thread" << std::endl;
+		std::cout << "-b B: Also blur a batch of B images of H x W x D, one call per image and channel and with the batch functions, and report images per second (with -t, also on T threads)" << std::endl;
+		std::cout << "-f F: Also blur a stream of F frames of H x W x D, with the stages of each frame run one after another and pipelined across frames, and report the frames per second and the latency of each stage" << std::endl;
+		std::cout << "-k: Also blur with Gaussians of 7 to 255 taps, with the direct kernels and in the frequency domain, to show where the FFT starts to win" << std::endl;
+		std::cout << "-n: Also blur with boxes of 3 x 3 to 15 x 15 taps, with the separable passes and as non-separable 2D kernels, to show what a kernel that can't be split costs" << std::endl;
+		std::cout << "-r: Also blur with 1 to 4 passes of a 7 x 7 box, pass by pass over the whole image and all passes tile by tile, to show the memory traffic tiling saves" << std::endl;
+		std::cout << "-p: Also report the cycles, instructions, L1D, LLC and dTLB misses of each phase, read from the Linux perf_event_open counters" << std::endl;
+		return 1;
+	}
+
+	std::stringstream ssH(positional[0]);
+	std::stringstream ssW(positional[1]);
+	std::stringstream ssD(positional[2]);
+	std::stringstream ssI(positional[3]);
+
+	unsigned int H = 0;
+	unsigned int W = 0;
+	unsigned int D = 0;
+	unsigned int I = 0;
+
+	ssH >> H;
+	ssW >> W;
+	ssD >> D;
+	ssI >> I;
+
+	if ((H == 0) || (W == 0) || (D == 0) || (I == 0)) {
+		std::cout << "H, W, D, and I must all be positive integers." << std::endl;
+		return 1;
+	}
+
+	// create H x W x D float buffers for the source & dst
+	const auto numElements = static_cast<std::size_t>(H) * W * D;
+	std::vector<float> interleavedSrc(numElements);
+	std::vector<float> planarSrc(numElements);
+	std::vector<float> dst(numElements);
+
+	// scratch images for the measurements, allocated (and touched) once so no test pays for them
+	std::vector<float> workingBuffer(numElements);
+	std::vector<float> transposedBuffer(numElements);
+
+	// fill src with random float values in [0, 1]
+	fillRandom(interleavedSrc);
+	interleavedToPlanar(interleavedSrc, H, W, D, planarSrc, getSimdLevel());
+
+	blur3Fn horizInterleavedBlur3 = convolve1DHorizontalInterleaved<std::array<float, 3>>;
+	blur3Fn vertInterleavedBlur3 = convolve1DVerticalInterleaved<std::array<float, 3>>;
+	blur3Fn horizPlanarBlur3 = convolve1DHorizontalPlanar<std::array<float, 3>>;
+	blur3Fn vertPlanarBlur3 = convolve1DVerticalPlanar<std::array<float, 3>>;
+
+	blur7Fn horizInterleavedBlur7 = convolve1DHorizontalInterleaved<std::array<float, 7>>;
+	blur7Fn vertInterleavedBlur7 = convolve1DVerticalInterleaved<std::array<float, 7>>;
+	blur7Fn horizPlanarBlur7 = convolve1DHorizontalPlanar<std::array<float, 7>>;
+	blur7Fn vertPlanarBlur7 = convolve1DVerticalPlanar<std::array<float, 7>>;
+
+	blur3Fn horizInterleavedSimdBlur3 = convolve1DHorizontalInterleavedSimd<std::array<float, 3>>;
+	blur3Fn vertInterleavedSimdBlur3 = convolve1DVerticalInterleavedSimd<std::array<float, 3>>;
+	blur3Fn horizPlanarSimdBlur3 = convolve1DHorizontalPlanarSimd<std::array<float, 3>>;
+	blur3Fn vertPlanarSimdBlur3 = convolve1DVerticalPlanarSimd<std::array<float, 3>>;
+
+	blur7Fn horizInterleavedSimdBlur7 = convolve1DHorizontalInterleavedSimd<std::array<float, 7>>;
+	blur7Fn vertInterleavedSimdBlur7 = convolve1DVerticalInterleavedSimd<std::array<float, 7>>;
+	blur7Fn horizPlanarSimdBlur7 = convolve1DHorizontalPlanarSimd<std::array<float, 7>>;
+	blur7Fn vertPlanarSimdBlur7 = convolve1DVerticalPlanarSimd<std::array<float, 7>>;
+	blur7Fn horizPlanarSimdTransposedBlur7 = convolve1DHorizontalTransposedPlanarSimd<std::array<float, 7>>;
+
+	blur3Fn horizInterleavedUnrolledBlur3 = convolve1DHorizontalInterleavedUnrolled<3>;
+	blur3Fn vertInterleavedUnrolledBlur3 = convolve1DVerticalInterleavedUnrolled<3>;
+	blur3Fn horizPlanarUnrolledBlur3 = convolve1DHorizontalPlanarUnrolled<3>;
+	blur3Fn vertPlanarUnrolledBlur3 = convolve1DVerticalPlanarUnrolled<3>;
+
+	blur7Fn horizInterleavedUnrolledBlur7 = convolve1DHorizontalInterleavedUnrolled<7>;
+	blur7Fn vertInterleavedUnrolledBlur7 = convolve1DVerticalInterleavedUnrolled<7>;
+	blur7Fn horizPlanarUnrolledBlur7 = convolve1DHorizontalPlanarUnrolled<7>;
+	blur7Fn vertPlanarUnrolledBlur7 = convolve1DVerticalPlanarUnrolled<7>;
+
+	blur3Fn horizInterleavedSymmetricBlur3 = convolve1DHorizontalInterleavedUnrolled<3, true>;
+	blur3Fn vertInterleavedSymmetricBlur3 = convolve1DVerticalInterleavedUnrolled<3, true>;
+	blur3Fn horizPlanarSymmetricBlur3 = convolve1DHorizontalPlanarUnrolled<3, true>;
+	blur3Fn vertPlanarSymmetricBlur3 = convolve1DVerticalPlanarUnrolled<3, true>;
+
+	blur7Fn horizInterleavedSymmetricBlur7 = convolve1DHorizontalInterleavedUnrolled<7, true>;
+	blur7Fn vertInterleavedSymmetricBlur7 = convolve1DVerticalInterleavedUnrolled<7, true>;
+	blur7Fn horizPlanarSymmetricBlur7 = convolve1DHorizontalPlanarUnrolled<7, true>;
+	blur7Fn vertPlanarSymmetricBlur7 = convolve1DVerticalPlanarUnrolled<7, true>;
+
+	blur3AllChannelsFn horizInterleavedAllBlur3 = convolve1DHorizontalInterleavedAll<std::array<float, 3>>;
+	blur3AllChannelsFn vertInterleavedAllBlur3 = convolve1DVerticalInterleavedAll<std::array<float, 3>>;
+	blur7AllChannelsFn horizInterleavedAllBlur7 = convolve1DHorizontalInterleavedAll<std::array<float, 7>>;
+	blur7AllChannelsFn vertInterleavedAllBlur7 = convolve1DVerticalInterleavedAll<std::array<float, 7>>;
+
+	blur3Fn interleavedFusedBlur3 = convolve2DSeparableInterleaved<std::array<float, 3>>;
+	blur3Fn planarFusedBlur3 = convolve2DSeparablePlanar<std::array<float, 3>>;
+	blur7Fn interleavedFusedBlur7 = convolve2DSeparableInterleaved<std::array<float, 7>>;
+	blur7Fn planarFusedBlur7 = convolve2DSeparablePlanar<std::array<float, 7>>;
+
+	// the border modes only change how the edge pixels are computed, so every mode runs the same interior loop as the tests without a border
+	typedef std::array<float, 7> blur7T;
+	const std::array<std::pair<const char*, BorderMode>, 4> borders{ { { "clamp", BorderMode::Clamp }, { "mirror", BorderMode::Mirror }, { "wrap", BorderMode::Wrap }, { "constant", BorderMode::Constant } } };
+
+	transposeFn noTransposeFn;
+
+	// transposePlanar and transposePlanarScalar are overloaded for image views, so pick the std::vector overloads explicitly
+	transposeFn tiledTransposeFn = static_cast<bool (*)(const std::vector<float>&, unsigned int, unsigned int, unsigned int, std::vector<float>&)>(transposePlanar);
+	transposeFn scalarTransposeFn = static_cast<bool (*)(const std::vector<float>&, unsigned int, unsigned int, unsigned int, std::vector<float>&)>(transposePlanarScalar);
+
+	// the CSV goes to stdout, so report the instruction set level the *Simd tests ran with on stderr
+	std::cerr << "SIMD level: " << simdLevelName(getSimdLevel()) << std::endl;
+
+	// the counters count the main thread, so they are opened here, and only with -p
+	std::unique_ptr<PerfCounters> counters;
+	if (countEvents) {
+		counters.reset(new PerfCounters());
+		phaseCounters = counters.get();
+		if (!counters->available()) {
+			std::cerr << "Hardware counters unavailable (not Linux, or perf_event_open is restricted, e.g. by perf_event_paranoid or a container), the counter columns are empty" << std::endl;
+		}
+	}
+
+	std::cout << "test,horizontal,transpose,vertical,total,firstIteration";
+	if (countEvents) {
+		std::cout << "," << PerfCounters::csvHeader("horizontal") << "," << PerfCounters::csvHeader("transpose") << "," << PerfCounters::csvHeader("vertical");
+	}
+	std::cout << std::endl;
+	std::cout << "interleaved3," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedBlur3, noTransposeFn, vertInterleavedBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar3," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(planarSrc, H, W, D, horizPlanarBlur3, noTransposeFn, vertPlanarBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved7," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedBlur7, noTransposeFn, vertInterleavedBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, noTransposeFn, vertPlanarBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7withTranspose," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, tiledTransposeFn, vertPlanarBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7withScalarTranspose," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, scalarTransposeFn, vertPlanarBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7withTransposeInPlace," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DTransposedInPlace<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarBlur7, dst, workingBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved3simd," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedSimdBlur3, noTransposeFn, vertInterleavedSimdBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar3simd," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(planarSrc, H, W, D, horizPlanarSimdBlur3, noTransposeFn, vertPlanarSimdBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved7simd," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedSimdBlur7, noTransposeFn, vertInterleavedSimdBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7simd," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarSimdBlur7, noTransposeFn, vertPlanarSimdBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7simdWithTranspose," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarSimdBlur7, tiledTransposeFn, vertPlanarSimdBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7simdTransposedConvolve," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DTransposedConvolve<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarSimdTransposedBlur7, dst, workingBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved3unrolled," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedUnrolledBlur3, noTransposeFn, vertInterleavedUnrolledBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar3unrolled," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(planarSrc, H, W, D, horizPlanarUnrolledBlur3, noTransposeFn, vertPlanarUnrolledBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved7unrolled," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedUnrolledBlur7, noTransposeFn, vertInterleavedUnrolledBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7unrolled," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarUnrolledBlur7, noTransposeFn, vertPlanarUnrolledBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved3symmetric," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedSymmetricBlur3, noTransposeFn, vertInterleavedSymmetricBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar3symmetric," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 3>>(planarSrc, H, W, D, horizPlanarSymmetricBlur3, noTransposeFn, vertPlanarSymmetricBlur3, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved7symmetric," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedSymmetricBlur7, noTransposeFn, vertInterleavedSymmetricBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7symmetric," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<std::array<float, 7>>(planarSrc, H, W, D, horizPlanarSymmetricBlur7, noTransposeFn, vertPlanarSymmetricBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved3allChannels," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DAllChannels<std::array<float, 3>>(interleavedSrc, H, W, D, horizInterleavedAllBlur3, vertInterleavedAllBlur3, dst, workingBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved7allChannels," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DAllChannels<std::array<float, 7>>(interleavedSrc, H, W, D, horizInterleavedAllBlur7, vertInterleavedAllBlur7, dst, workingBuffer); }).toCsv() << std::endl;
+	std::cout << "interleaved3fused," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur2DFused<std::array<float, 3>>(interleavedSrc, H, W, D, interleavedFusedBlur3, dst); }).toCsv() << std::endl;
+	std::cout << "planar3fused," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur2DFused<std::array<float, 3>>(planarSrc, H, W, D, planarFusedBlur3, dst); }).toCsv() << std::endl;
+	std::cout << "interleaved7fused," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur2DFused<std::array<float, 7>>(interleavedSrc, H, W, D, interleavedFusedBlur7, dst); }).toCsv() << std::endl;
+	std::cout << "planar7fused," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur2DFused<std::array<float, 7>>(planarSrc, H, W, D, planarFusedBlur7, dst); }).toCsv() << std::endl;
+
+	// convert the interleaved source to planar, blur it, and convert the result back, to compare with the interleaved rows
+	std::cout << "planar7withConversion," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DConverted<std::array<float, 7>>(interleavedSrc, H, W, D, horizPlanarBlur7, vertPlanarBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	std::cout << "planar7simdWithConversion," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1DConverted<std::array<float, 7>>(interleavedSrc, H, W, D, horizPlanarSimdBlur7, vertPlanarSimdBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+
+	for (const auto& border : borders) {
+		const BorderMode mode = border.second;
+		const blur7Fn horizInterleavedBorderBlur7 = [mode](const blur7T& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+			return convolve1DHorizontalInterleavedBordered(kernel, image, height, width, numChannels, channelIndex, result, mode);
+		};
+		const blur7Fn vertInterleavedBorderBlur7 = [mode](const blur7T& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+			return convolve1DVerticalInterleavedBordered(kernel, image, height, width, numChannels, channelIndex, result, mode);
+		};
+		const blur7Fn horizPlanarBorderBlur7 = [mode](const blur7T& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+			return convolve1DHorizontalPlanarBordered(kernel, image, height, width, numChannels, channelIndex, result, mode);
+		};
+		const blur7Fn vertPlanarBorderBlur7 = [mode](const blur7T& kernel, const std::vector<float>& image, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int channelIndex, std::vector<float>& result) {
+			return convolve1DVerticalPlanarBordered(kernel, image, height, width, numChannels, channelIndex, result, mode);
+		};
+
+		std::cout << "interleaved7" << border.first << "," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<blur7T>(interleavedSrc, H, W, D, horizInterleavedBorderBlur7, noTransposeFn, vertInterleavedBorderBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+		std::cout << "planar7" << border.first << "," << measureRuntimeStats(I, [&]() { return measureRuntimeBlur1D<blur7T>(planarSrc, H, W, D, horizPlanarBorderBlur7, noTransposeFn, vertPlanarBorderBlur7, dst, workingBuffer, transposedBuffer); }).toCsv() << std::endl;
+	}
+
+	// the 7-tap blur on 8-bit, 16-bit and half precision images, accumulated in float.  The smaller pixels move less memory.
+	printLowPrecisionBlur7<std::uint8_t>("u8", 255.0f, interleavedSrc, planarSrc, H, W, D, I);
+	printLowPrecisionBlur7<std::uint16_t>("u16", 65535.0f, interleavedSrc, planarSrc, H, W, D, I);
+	printLowPrecisionBlur7<tHalf>("f16", 1.0f, interleavedSrc, planarSrc, H, W, D, I);
+
+	// sliding-sum box filter.  The cost per pixel shouldn't depend on the radius.
+	const unsigned int maxBoxRadius = 50;
+	for (auto radius = 1U; radius <= maxBoxRadius; radius++) {
+		std::cout << "interleavedBox" << radius << "," << measureRuntimeStats(I, [&]() { return measureRuntimeBoxFilter(interleavedSrc, H, W, D, ImageLayout::Interleaved, radius, dst, workingBuffer); }).toCsv() << std::endl;
+		std::cout << "planarBox" << radius << "," << measureRuntimeStats(I, [&]() { return measureRuntimeBoxFilter(planarSrc, H, W, D, ImageLayout::Planar, radius, dst, workingBuffer); }).toCsv() << std::endl;
+	}
+
+	if (T > 0) {
+		// scaling of the multi-threaded engine.  The serial baseline is the same engine on a single thread, so the speedup
+		// only measures the parallelization.
+		ThreadPool serialPool(1);
+		ThreadPool parallelPool(T);
+
+		std::cout << std::endl;
+		std::cout << "test,threads,serial,parallel,speedup,efficiency" << std::endl;
+
+		const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+		const std::array<bool, 2> fusedModes{ { false, true } };
+
+		for (const bool fused : fusedModes) {
+			for (const auto& layout : layouts) {
+				const std::vector<float>& src = layout.second == ImageLayout::Interleaved ? interleavedSrc : planarSrc;
+
+				const double serial = measureMinRuntime(I, [&]() { return measureRuntimeBlurParallel<std::array<float, 7>>(src, H, W, D, layout.second, fused, serialPool, dst, workingBuffer); }).GetTotal();
+				const double parallel = measureMinRuntime(I, [&]() { return measureRuntimeBlurParallel<std::array<float, 7>>(src, H, W, D, layout.second, fused, parallelPool, dst, workingBuffer); }).GetTotal();
+				const double speedup = serial / parallel;
+
+				std::cout << layout.first << "7" << (fused ? "fused" : "") << "parallel," << T << "," << serial << "," << parallel << "," << speedup << "," << speedup / T << std::endl;
+			}
+		}
+
+		for (const auto& layout : layouts) {
+			const std::vector<float>& src = layout.second == ImageLayout::Interleaved ? interleavedSrc : planarSrc;
+
+			const double serial = measureMinRuntime(I, [&]() { return measureRuntimeConversionParallel(src, H, W, D, layout.second, serialPool, dst); }).GetTotal();
+			const double parallel = measureMinRuntime(I, [&]() { return measureRuntimeConversionParallel(src, H, W, D, layout.second, parallelPool, dst); }).GetTotal();
+			const double speedup = serial / parallel;
+
+			std::cout << (layout.second == ImageLayout::Interleaved ? "interleavedToPlanar" : "planarToInterleaved") << "parallel," << T << "," << serial << "," << parallel << "," << speedup << "," << speedup / T << std::endl;
+		}
+	}
+
+	if (B > 0) {
+		// a batch of small images, e.g. thumbnails, where the cost of a call per image and channel is no longer negligible
+		ThreadPool serialPool(1);
+		std::unique_ptr<ThreadPool> parallelPool(T > 0 ? new ThreadPool(T) : nullptr);
+
+		std::cout << std::endl;
+		std::cout << "test,images,threads,seconds,imagesPerSecond" << std::endl;
+
+		const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+		const std::array<std::pair<const char*, BatchMode>, 4> modes{ { { "perImage", BatchMode::ReferencePerImage }, { "simdPerImage", BatchMode::SimdPerImage }, { "batch", BatchMode::Batch }, { "separableBatch", BatchMode::SeparableBatch } } };
+
+		for (const auto& layout : layouts) {
+			// the same images twice: one std::vector each for the calls per image, and back to back for the batch functions
+			std::vector<std::vector<float>> imageList(B, std::vector<float>(numElements));
+			std::vector<float> images(static_cast<std::size_t>(B) * numElements);
+			for (auto i = 0U; i < B; i++) {
+				fillRandom(imageList[i]);
+				if (layout.second == ImageLayout::Planar) {
+					std::vector<float> interleavedImage = imageList[i];
+					interleavedToPlanar(interleavedImage, H, W, D, imageList[i], getSimdLevel());
+				}
+				std::copy(imageList[i].begin(), imageList[i].end(), images.begin() + static_cast<std::size_t>(i) * numElements);
+			}
+
+			std::vector<float> batchDst(images.size());
+			std::vector<float> batchWorkingBuffer(images.size());
+			std::vector<std::vector<float>> dstList(B, std::vector<float>(numElements));
+
+			for (const auto& mode : modes) {
+				const bool batchMode = (mode.second == BatchMode::Batch) || (mode.second == BatchMode::SeparableBatch);
+
+				std::vector<ThreadPool*> pools{ &serialPool };
+				if (batchMode && parallelPool) {
+					pools.push_back(parallelPool.get());
+				}
+
+				for (ThreadPool* pool : pools) {
+					const double seconds = measureMinRuntime(I, [&]() { return measureRuntimeBatch(images, imageList, H, W, D, layout.second, mode.second, *pool, batchDst, batchWorkingBuffer, dstList, workingBuffer); }).GetTotal();
+					std::cout << layout.first << "7" << mode.first << "," << B << "," << pool->size() << "," << seconds << "," << B / seconds << std::endl;
+				}
+			}
+		}
+	}
+
+	if (F > 0) {
+		// load, convert to planar, horizontal pass, vertical pass, store: one after another, then with the stages of
+		// consecutive frames overlapping on their own threads
+		std::cout << std::endl;
+		std::cout << "test,frames,slots,seconds,framesPerSecond,latencyMean,latencyMax,load,convert,horizontal,vertical,store" << std::endl;
+
+		const std::array<std::pair<const char*, unsigned int>, 3> runs{ { { "sequential", 1 }, { "doubleBuffered", 2 }, { "pipelined", numFrameStages } } };
+		for (const auto& run : runs) {
+			const bool pipelined = run.second > 1;
+			const tFramePipelineStats stats = measureFramePipeline(interleavedSrc, H, W, D, F, run.second, pipelined, I, dst);
+
+			std::cout << "frames7" << run.first << "," << F << "," << run.second << "," << stats.wallSeconds << "," << stats.framesPerSecond << "," << stats.latency.meanSeconds << "," << stats.latency.maxSeconds;
+			for (const tFrameTiming& stage : stats.stages) {
+				std::cout << "," << stage.meanSeconds;
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	if (sweepKernelSize) {
+		// the direct kernels cost kernelSize multiply-adds per pixel, the FFT about the same whatever the kernel size
+		std::cerr << "FFT crossover of the *Auto functions: " << fftCrossoverKernelSize(getSimdLevel()) << " taps" << std::endl;
+
+		std::cout << std::endl;
+		std::cout << "test,kernelSize,direct,fft,speedup" << std::endl;
+
+		const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+		const std::array<unsigned int, 10> kernelSizes{ { 7, 15, 31, 47, 63, 79, 95, 127, 191, 255 } };
+
+		for (const auto& layout : layouts) {
+			const std::vector<float>& src = layout.second == ImageLayout::Interleaved ? interleavedSrc : planarSrc;
+
+			for (const unsigned int kernelSize : kernelSizes) {
+				// Gaussian with the kernel covering +-3 sigma
+				std::vector<float> kernel(kernelSize);
+				const double sigma = kernelSize / 6.0;
+				double sum = 0.0;
+				for (auto i = 0U; i < kernelSize; i++) {
+					const double x = static_cast<double>(i) - kernelSize / 2;
+					kernel[i] = static_cast<float>(std::exp(-x * x / (2.0 * sigma * sigma)));
+					sum += kernel[i];
+				}
+				for (float& tap : kernel) {
+					tap = static_cast<float>(tap / sum);
+				}
+
+				const double direct = measureMinRuntime(I, [&]() { return measureRuntimeWideBlur(src, H, W, D, layout.second, kernel, false, dst, workingBuffer); }).GetTotal();
+				const double fft = measureMinRuntime(I, [&]() { return measureRuntimeWideBlur(src, H, W, D, layout.second, kernel, true, dst, workingBuffer); }).GetTotal();
+
+				std::cout << layout.first << "Gaussian," << kernelSize << "," << direct << "," << fft << "," << direct / fft << std::endl;
+			}
+		}
+	}
+
+	if (nonSeparable) {
+		// a separable kernel costs 2 * kernelSize multiply-adds per pixel, the same kernel as a 2D kernel kernelSize^2
+		std::cout << std::endl;
+		std::cout << "test,kernelSize,separable,fused,nonSeparable,nonSeparableAllChannels" << std::endl;
+
+		const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+		const std::array<unsigned int, 6> kernelSizes{ { 3, 5, 7, 9, 11, 15 } };
+
+		for (const auto& layout : layouts) {
+			const std::vector<float>& src = layout.second == ImageLayout::Interleaved ? interleavedSrc : planarSrc;
+
+			for (const unsigned int kernelSize : kernelSizes) {
+				const auto measure = [&](Blur2DMode mode) {
+					return measureMinRuntime(I, [&]() { return measureRuntimeBlur2D(src, H, W, D, layout.second, kernelSize, mode, dst, workingBuffer); }).GetTotal();
+				};
+
+				std::cout << layout.first << "Box," << kernelSize << "," << measure(Blur2DMode::Separable) << "," << measure(Blur2DMode::Fused) << "," << measure(Blur2DMode::NonSeparable) << ",";
+				if (layout.second == ImageLayout::Interleaved) {
+					std::cout << measure(Blur2DMode::NonSeparableAllChannels);
+				}
+				std::cout << std::endl;
+			}
+		}
+	}
+
+	if (iteratedPasses) {
+		// repeated box blurs approximate a Gaussian.  Pass by pass, every pass moves the whole image through memory.
+		std::cout << std::endl;
+		std::cout << "test,passes,tileSize,byPass,tiled,speedup,byPassMiB,tiledMiB" << std::endl;
+
+		const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+		const unsigned int mebibyte = 1024 * 1024;
+
+		for (const auto& layout : layouts) {
+			const std::vector<float>& src = layout.second == ImageLayout::Interleaved ? interleavedSrc : planarSrc;
+
+			for (auto numPasses = 1U; numPasses <= 4U; numPasses++) {
+				const double byPass = measureMinRuntime(I, [&]() { return measureRuntimeIteratedBlur(src, H, W, D, layout.second, numPasses, false, dst, workingBuffer); }).GetTotal();
+				const double tiled = measureMinRuntime(I, [&]() { return measureRuntimeIteratedBlur(src, H, W, D, layout.second, numPasses, true, dst, workingBuffer); }).GetTotal();
+
+				std::cout << layout.first << "Box7x" << numPasses << "," << numPasses << "," << iteratedTileSize(7, 7, numPasses, defaultIteratedTileBytes) << "," << byPass << "," << tiled << "," << byPass / tiled << ","
+					<< iteratedBlurBytes(H, W, D, numPasses, 7, false) / mebibyte << "," << iteratedBlurBytes(H, W, D, numPasses, 7, true) / mebibyte << std::endl;
+			}
+		}
+	}
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "convolution.h"
+#include "streaming_convolution.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+typedef struct fileRuntimeInfo {
+	double read;
+	double compute;
+	double write;
+	bool ok;	// false if the blur, or reading or writing a file, failed, in which case the times mean nothing
+
+	double GetTotal() const {
+		return read + compute + write;
+	}
+} tFileRuntimeInfo;
+
+/**
+ * @return  The peak resident memory of the process so far in MiB, as a CSV field.  Empty where it can't be read.
+ */
+static std::string peakResidentMiB() {
+#if defined(__linux__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		// ru_maxrss is in KiB on Linux
+		std::stringstream ss;
+		ss << usage.ru_maxrss / 1024;
+		return ss.str();
+	}
+#endif
+
+	return "";
+}
+
+/**
+ * Pixel value of the benchmark image, a hash of its position.  Both files are written from it a row at a time, so they hold
+ * the same image without it ever being in memory.
+ */
+static float pixelValue(unsigned int row, unsigned int col, unsigned int ch) {
+	std::uint32_t hash = (row * 73856093U) ^ (col * 19349663U) ^ (ch * 83492791U);
+	hash ^= hash >> 13;
+	hash *= 0x5bd1e995U;
+	hash ^= hash >> 15;
+	return static_cast<float>(hash & 0xFFFFFF) / static_cast<float>(0xFFFFFF);
+}
+
+/**
+ * Writes the height x width x depth benchmark image in \p layout to a raw file at \p path, one row at a time
+ *
+ * @return  true if the file was written
+ */
+static bool writeImageFile(const std::string& path, ImageLayout layout, unsigned int height, unsigned int width, unsigned int depth) {
+	std::ofstream file(path, std::ios::binary);
+
+	const unsigned int planes = layout == ImageLayout::Planar ? depth : 1;
+	const unsigned int channelsPerPlane = layout == ImageLayout::Planar ? 1 : depth;
+	std::vector<float> row(static_cast<std::size_t>(width) * channelsPerPlane);
+
+	for (auto plane = 0U; plane < planes; plane++) {
+		for (auto r = 0U; r < height; r++) {
+			for (auto col = 0U; col < width; col++) {
+				for (auto ch = 0U; ch < channelsPerPlane; ch++) {
+					row[col * channelsPerPlane + ch] = pixelValue(r, col, plane + ch);
+				}
+			}
+
+			file.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(float)));
+		}
+	}
+
+	return static_cast<bool>(file);
+}
+
+/**
+ * Measures the runtime of blurring every channel of the image in the file at \p inputPath with convolve2DSeparableMapped,
+ * which streams it through the output file in strips.  The file reads and writes happen as page faults during the
+ * convolution, so the whole time is reported as the compute time.  Fails if the files can't be opened or mapped.
+ */
+static tFileRuntimeInfo measureRuntimeMapped(const std::array<float, 7>& blurKernel, ImageLayout layout, const std::string& inputPath, unsigned int height, unsigned int width, unsigned int depth,
+	const std::string& outputPath, std::size_t maxResidentBytes) {
+
+	tFileRuntimeInfo runtimeInfo{ 0, 0, 0, true };
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	runtimeInfo.ok = convolve2DSeparableMapped(blurKernel.data(), 7, blurKernel.data(), 7, layout, inputPath, height, width, depth, outputPath, maxResidentBytes, getSimdLevel());
+	const auto end = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.compute = std::chrono::duration<double>(end - start).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Measures the runtime of reading the whole image in the file at \p inputPath into memory, blurring every channel with
+ * convolve2DSeparable, and writing the result to \p outputPath.  The image and result buffers are allocated by the caller.
+ */
+static tFileRuntimeInfo measureRuntimeInMemory(const std::array<float, 7>& blurKernel, ImageLayout layout, const std::string& inputPath, unsigned int height, unsigned int width, unsigned int depth,
+	const std::string& outputPath, std::vector<float>& image, std::vector<float>& result) {
+
+	tFileRuntimeInfo runtimeInfo{ 0, 0, 0, true };
+	const auto bytes = static_cast<std::streamsize>(image.size() * sizeof(float));
+
+	const auto readStart = std::chrono::high_resolution_clock::now();
+	{
+		std::ifstream file(inputPath, std::ios::binary);
+		file.read(reinterpret_cast<char*>(image.data()), bytes);
+		runtimeInfo.ok = static_cast<bool>(file);
+	}
+	const auto readEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.read = std::chrono::duration<double>(readEnd - readStart).count();
+
+	const auto computeStart = std::chrono::high_resolution_clock::now();
+	for (auto ch = 0U; ch < depth; ch++) {
+		runtimeInfo.ok = convolve2DSeparable(blurKernel.data(), 7, blurKernel.data(), 7, layout, image, height, width, depth, ch, result, getSimdLevel()) && runtimeInfo.ok;
+	}
+	const auto computeEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.compute = std::chrono::duration<double>(computeEnd - computeStart).count();
+
+	const auto writeStart = std::chrono::high_resolution_clock::now();
+	{
+		std::ofstream file(outputPath, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(result.data()), bytes);
+		runtimeInfo.ok = static_cast<bool>(file) && runtimeInfo.ok;
+	}
+	const auto writeEnd = std::chrono::high_resolution_clock::now();
+
+	runtimeInfo.write = std::chrono::duration<double>(writeEnd - writeStart).count();
+
+	return runtimeInfo;
+}
+
+/**
+ * Calls \p measureFn \p iterations times back-to-back, and returns the runtime of the iteration that consumed the least total time,
+ * or the first failed iteration.
+ */
+template <typename MeasureFnT>
+static tFileRuntimeInfo measureMinRuntime(unsigned int iterations, const MeasureFnT& measureFn) {
+	tFileRuntimeInfo minRuntime{ std::numeric_limits<double>::max(), 0, 0, true };
+
+	for (auto i = 0U; i < iterations; i++) {
+		const tFileRuntimeInfo runtime = measureFn();
+		if (!runtime.ok) {
+			return runtime;
+		}
+		if (runtime.GetTotal() < minRuntime.GetTotal()) {
+			minRuntime = runtime;
+		}
+	}
+
+	return minRuntime;
+}
+
+int main(int argc, char ** argv) {
+	// optional flags come before the positional arguments
+	std::size_t maxResidentBytes = defaultMappedResidentBytes;
+	bool mappedOnly = false;
+	std::vector<std::string> positional;
+	for (auto i = 1; i < argc; i++) {
+		const std::string arg(argv[i]);
+		if ((arg == "-m") && (i + 1 < argc)) {
+			std::stringstream ssM(argv[++i]);
+			std::size_t megabytes = 0;
+			ssM >> megabytes;
+			if (megabytes == 0) {
+				std::cout << "M must be a positive integer." << std::endl;
+				return 1;
+			}
+			maxResidentBytes = megabytes * 1024 * 1024;
+		}
+		else if (arg == "-s") {
+			mappedOnly = true;
+		}
+		else {
+			positional.push_back(arg);
+		}
+	}
+
+	if ((positional.size() != 4) && (positional.size() != 5)) {
+		std::cout << "Usage: " << argv[0] << " [-m M] [-s] H W D I [DIR]" << std::endl;
+		std::cout << "H: height of the image to blur" << std::endl;
+		std::cout << "W: width of the image to blur" << std::endl;
+		std::cout << "D: depth (number of channels) of the image to blur" << std::endl;
+		std::cout << "I: Number of iterations to perform.  The minimum total time for a single iteration is reported" << std::endl;
+		std::cout << "DIR: directory to write the image files to.  Defaults to the current directory.  The files are deleted at the end." << std::endl;
+		std::cout << "-m M: resident memory budget of the memory-mapped blur in MiB.  Defaults to " << defaultMappedResidentBytes / (1024 * 1024) << "." << std::endl;
+		std::cout << "-s: skip the in-memory tests, which need twice the image size in memory, e.g. for images larger than the memory" << std::endl;
+		return 1;
+	}
+
+	std::stringstream ssH(positional[0]);
+	std::stringstream ssW(positional[1]);
+	std::stringstream ssD(positional[2]);
+	std::stringstream ssI(positional[3]);
+	const std::string directory = positional.size() == 5 ? positional[4] + "/" : "";
+
+	unsigned int H = 0;
+	unsigned int W = 0;
+	unsigned int D = 0;
+	unsigned int I = 0;
+
+	ssH >> H;
+	ssW >> W;
+	ssD >> D;
+	ssI >> I;
+
+	if ((H == 0) || (W == 0) || (D == 0) || (I == 0)) {
+		std::cout << "H, W, D, and I must all be positive integers." << std::endl;
+		return 1;
+	}
+
+	std::cerr << "SIMD level: " << simdLevelName(getSimdLevel()) << std::endl;
+
+	std::array<float, 7> blurKernel;
+	std::fill(blurKernel.begin(), blurKernel.end(), 1.0f / 7.0f);
+
+	const std::array<std::pair<const char*, ImageLayout>, 2> layouts{ { { "interleaved", ImageLayout::Interleaved }, { "planar", ImageLayout::Planar } } };
+	const std::string outputPath = directory + "out_of_core_result.raw";
+
+	const auto removeFiles = [&]() {
+		for (const auto& layout : layouts) {
+			std::remove((directory + "out_of_core_" + layout.first + ".raw").c_str());
+		}
+		std::remove(outputPath.c_str());
+	};
+
+	for (const auto& layout : layouts) {
+		if (!writeImageFile(directory + "out_of_core_" + layout.first + ".raw", layout.second, H, W, D)) {
+			std::cout << "Could not write the image files to " << (directory.empty() ? std::string(".") : directory) << std::endl;
+			return 1;
+		}
+	}
+
+	const double imageBytes = static_cast<double>(H) * W * D * sizeof(float);
+
+	std::cout << "test,stripRows,read,compute,write,total,gbPerSecond,peakResidentMiB" << std::endl;
+
+	// the mapped tests run first, so the peak resident memory after them isn't raised by the in-memory buffers
+	for (const auto& layout : layouts) {
+		const std::string inputPath = directory + "out_of_core_" + layout.first + ".raw";
+		const unsigned int stripRows = mappedStripRows(layout.second, H, W, D, 7, maxResidentBytes);
+
+		const tFileRuntimeInfo runtime = measureMinRuntime(I, [&]() { return measureRuntimeMapped(blurKernel, layout.second, inputPath, H, W, D, outputPath, maxResidentBytes); });
+		if (!runtime.ok) {
+			std::cout << "Could not blur " << inputPath << " through memory-mapped strips, the files can't be opened or mapped" << std::endl;
+			removeFiles();
+			return 1;
+		}
+		std::cout << layout.first << "Mapped," << stripRows << ",," << runtime.compute << ",," << runtime.GetTotal() << "," << imageBytes / runtime.GetTotal() / 1e9 << "," << peakResidentMiB() << std::endl;
+	}
+
+	if (!mappedOnly) {
+		std::vector<float> image(static_cast<std::size_t>(H) * W * D);
+		std::vector<float> result(image.size(), 0.0f);
+
+		for (const auto& layout : layouts) {
+			const std::string inputPath = directory + "out_of_core_" + layout.first + ".raw";
+
+			const tFileRuntimeInfo runtime = measureMinRuntime(I, [&]() { return measureRuntimeInMemory(blurKernel, layout.second, inputPath, H, W, D, outputPath, image, result); });
+			if (!runtime.ok) {
+				std::cout << "Could not read, blur or write " << inputPath << " in memory" << std::endl;
+				removeFiles();
+				return 1;
+			}
+			std::cout << layout.first << "InMemory,," << runtime.read << "," << runtime.compute << "," << runtime.write << "," << runtime.GetTotal() << "," << imageBytes / runtime.GetTotal() / 1e9 << "," << peakResidentMiB() << std::endl;
+		}
+	}
+
+	removeFiles();
+
+	return 0;
+}
@@ -0,0 +1,150 @@
+#include "perf_counters.h"
+
+#include <cstdint>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+std::string tPerfCounts::toCsv() const {
+	std::stringstream ss;
+	const long long counts[PerfCounters::numEvents] = { cycles, instructions, l1dMisses, llcMisses, dtlbMisses };
+	for (unsigned int i = 0; i < PerfCounters::numEvents; i++) {
+		if (i > 0) {
+			ss << ",";
+		}
+		if (counts[i] >= 0) {
+			ss << counts[i];
+		}
+	}
+
+	return ss.str();
+}
+
+void tPerfCounts::add(const perfCounts& other) {
+	long long* counts[PerfCounters::numEvents] = { &cycles, &instructions, &l1dMisses, &llcMisses, &dtlbMisses };
+	const long long otherCounts[PerfCounters::numEvents] = { other.cycles, other.instructions, other.l1dMisses, other.llcMisses, other.dtlbMisses };
+	for (unsigned int i = 0; i < PerfCounters::numEvents; i++) {
+		*counts[i] = (*counts[i] >= 0) && (otherCounts[i] >= 0) ? *counts[i] + otherCounts[i] : -1;
+	}
+}
+
+#if defined(__linux__)
+
+/**
+ * Config of a PERF_TYPE_HW_CACHE event that counts read misses of \p cache
+ */
+static std::uint64_t cacheReadMisses(std::uint64_t cache) {
+	return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+static int openCounter(std::uint32_t type, std::uint64_t config) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	// this thread, any CPU, no group
+	return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters() {
+	fds[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+	fds[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+	fds[2] = openCounter(PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_L1D));
+	fds[3] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	fds[4] = openCounter(PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_DTLB));
+}
+
+PerfCounters::~PerfCounters() {
+	for (const int fd : fds) {
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+}
+
+void PerfCounters::start() {
+	for (const int fd : fds) {
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+tPerfCounts PerfCounters::stop() {
+	for (const int fd : fds) {
+		if (fd >= 0) {
+			ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		}
+	}
+
+	long long counts[numEvents];
+	for (unsigned int i = 0; i < numEvents; i++) {
+		counts[i] = -1;
+
+		// value, time enabled, time running
+		std::uint64_t values[3] = {};
+		if ((fds[i] < 0) || (read(fds[i], values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))) {
+			continue;
+		}
+
+		if (values[2] == 0) {
+			// never scheduled onto the PMU, e.g. more events than hardware counters for the whole phase
+			continue;
+		}
+
+		const double scale = static_cast<double>(values[1]) / static_cast<double>(values[2]);
+		counts[i] = static_cast<long long>(static_cast<double>(values[0]) * scale);
+	}
+
+	tPerfCounts result;
+	result.cycles = counts[0];
+	result.instructions = counts[1];
+	result.l1dMisses = counts[2];
+	result.llcMisses = counts[3];
+	result.dtlbMisses = counts[4];
+	return result;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+	fds.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::start() {}
+
+tPerfCounts PerfCounters::stop() {
+	return tPerfCounts();
+}
+
+#endif
+
+bool PerfCounters::available() const {
+	for (const int fd : fds) {
+		if (fd >= 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string PerfCounters::csvHeader(const std::string& prefix) {
+	return prefix + "Cycles," + prefix + "Instructions," + prefix + "L1dMisses," + prefix + "LlcMisses," + prefix + "DtlbMisses";
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+/**
+ * Hardware event counts of one measured phase.  A count is -1 if its counter couldn't be opened.
+ */
+typedef struct perfCounts {
+	perfCounts()
+		: cycles(-1), instructions(-1), l1dMisses(-1), llcMisses(-1), dtlbMisses(-1)
+	{}
+
+	/**
+	 * @return  The counts as 5 comma separated fields, in the order of PerfCounters::csvHeader.  Unavailable counts are empty fields.
+	 */
+	std::string toCsv() const;
+
+	/**
+	 * Adds the counts of \p other, e.g. of the second of two transposes.  A count stays -1 if it is -1 in either.
+	 */
+	void add(const perfCounts& other);
+
+	long long cycles;
+	long long instructions;
+	long long l1dMisses;	// L1 data cache read misses
+	long long llcMisses;	// last level cache misses
+	long long dtlbMisses;	// data TLB read misses
+} tPerfCounts;
+
+/**
+ * Hardware performance counters of the calling thread, read with Linux perf_event_open.  Every event is opened on its own, so
+ * an event the CPU (or the virtual machine) doesn't support only leaves its own count empty.  Only user-space events are
+ * counted, which works with the default perf_event_paranoid setting of 2.  If the kernel multiplexes the counters, the counts
+ * are scaled up to the whole phase.
+ *
+ * On other platforms, or if perf events are disabled, no counter opens and every count is -1.
+ */
+class PerfCounters {
+public:
+	/**
+	 * Opens the counters for the calling thread.  They only count between start and stop, and only on that thread.
+	 */
+	PerfCounters();
+	~PerfCounters();
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/**
+	 * @return  true if at least one counter opened
+	 */
+	bool available() const;
+
+	/**
+	 * Resets the counters and starts counting
+	 */
+	void start();
+
+	/**
+	 * Stops counting
+	 *
+	 * @return  The events since start
+	 */
+	tPerfCounts stop();
+
+	/**
+	 * @return  The 5 comma separated CSV column names of tPerfCounts::toCsv, each starting with \p prefix (e.g. "horizontal")
+	 */
+	static std::string csvHeader(const std::string& prefix);
+
+	/**
+	 * Number of counted events, i.e. of counts in a tPerfCounts
+	 */
+	static const unsigned int numEvents = 5;
+
+private:
+
+	// -1 for a counter that didn't open
+	std::array<int, numEvents> fds;
+};
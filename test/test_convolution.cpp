@@ -1,9 +1,30 @@
 #include "convolution.h"
+#include "simd_kernels.h"
+#include "parallel_convolution.h"
+#include "batch_convolution.h"
+#include "fft_convolution.h"
+#include "nonseparable_convolution.h"
+#include "iterated_convolution.h"
+#include "buffer_pool.h"
+#include "streaming_convolution.h"
+#include "mapped_file.h"
+#include "planner.h"
+#include "frame_pipeline.h"
+#include "benchmark_harness.h"
 
 #include "gtest/gtest.h"
 
 #include <vector>
 #include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
 
 const std::vector<float> interleaved2channel {
 	1.0f, 0, 2.0f, 0, 3.0f, 0, 1.0f, 0,
@@ -166,4 +187,1799 @@ TEST(planar, transpose) {
 	};
 
 	ASSERT_TRUE(std::equal(expectedDst.begin(), expectedDst.end(), dst.begin()));
-}
\ No newline at end of file
+}
+
+TEST(planar, transposeTiledMatchesScalar) {
+	// sizes that aren't multiples of the block or register tile sizes, so every edge path runs
+	const unsigned int height = 75U;
+	const unsigned int width = 41U;
+	const unsigned int numChannels = 2U;
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>(i);
+	}
+
+	std::vector<float> expectedDst(src.size());
+	ASSERT_TRUE(transposePlanarScalar(src, height, width, numChannels, expectedDst));
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		std::vector<float> dst(src.size(), -1.0f);
+		ASSERT_TRUE(transposePlanarTiled(src, height, width, numChannels, dst, static_cast<SimdLevel>(level)));
+		ASSERT_TRUE(std::equal(expectedDst.begin(), expectedDst.end(), dst.begin())) << "Mismatch at level " << simdLevelName(static_cast<SimdLevel>(level));
+	}
+}
+
+TEST(planar, transposeInPlaceMatchesScalar) {
+	// square with partial blocks, panels of rows, panels of columns, both dimensions prime, and a single row
+	const std::array<std::pair<unsigned int, unsigned int>, 7> shapes{ { { 67U, 67U }, { 64U, 96U }, { 96U, 64U }, { 50U, 7U }, { 7U, 50U }, { 37U, 41U }, { 1U, 13U } } };
+	const unsigned int numChannels = 2U;
+
+	for (const auto& shape : shapes) {
+		const unsigned int height = shape.first;
+		const unsigned int width = shape.second;
+
+		std::vector<float> src(height * width * numChannels);
+		for (auto i = 0U; i < src.size(); i++) {
+			src[i] = static_cast<float>(i);
+		}
+
+		std::vector<float> expectedDst(src.size());
+		ASSERT_TRUE(transposePlanarScalar(src, height, width, numChannels, expectedDst));
+
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			std::vector<float> image = src;
+			ASSERT_TRUE(transposePlanarInPlace(image, height, width, numChannels, static_cast<SimdLevel>(level)));
+			ASSERT_EQ(expectedDst, image) << height << "x" << width << ", level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+
+	std::vector<float> tooSmall(10);
+	ASSERT_FALSE(transposePlanarInPlace(tooSmall, 3, 4, 1, getSimdLevel()));
+}
+
+
+TEST(planar, transposeBlockKernels) {
+	// a stride that is a multiple of 8, so the 8x8 AVX kernel doesn't fall back to 4x4, and destinations at every offset
+	// from a 32 byte boundary, so it starts its 8x8 transposes after 0 to 7 leading rows
+	const unsigned int rows = 19U;
+	const unsigned int cols = 24U;
+	const unsigned int dstStride = 24U;
+
+	alignas(32) float src[rows * cols];
+	for (auto i = 0U; i < rows * cols; i++) {
+		src[i] = static_cast<float>(i);
+	}
+
+	alignas(32) float expectedDst[cols * dstStride] = {};
+	transposeBlockScalar(src, cols, expectedDst, dstStride, rows, cols);
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		for (auto offset = 0U; offset < 8U; offset++) {
+			alignas(32) float dstBuffer[cols * dstStride + 8] = {};
+			float* dst = dstBuffer + offset;
+			getSimdKernels(static_cast<SimdLevel>(level)).transposeBlock(src, cols, dst, dstStride, rows, cols);
+			ASSERT_TRUE(std::equal(expectedDst, expectedDst + cols * dstStride, dst)) << "Mismatch at level " << simdLevelName(static_cast<SimdLevel>(level)) << ", offset " << offset;
+		}
+	}
+}
+
+
+TEST(simd, horizontalMatchesReference) {
+	// wide enough for the 16/32-wide main loops plus a partial tail
+	const unsigned int height = 3U;
+	const unsigned int width = 61U;
+	const unsigned int numChannels = 3U;
+	const std::array<float, 7> kernel{ { 0.05f, 0.1f, 0.2f, 0.3f, 0.2f, 0.1f, 0.05f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 37U) % 101U) / 10.0f;
+	}
+
+	std::vector<float> expectedPlanar(src.size(), 0.0f);
+	std::vector<float> expectedInterleaved(src.size(), 0.0f);
+	ASSERT_TRUE(convolve1DHorizontalPlanar(kernel, src, height, width, numChannels, 1, expectedPlanar));
+	ASSERT_TRUE(convolve1DHorizontalInterleaved(kernel, src, height, width, numChannels, 1, expectedInterleaved));
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		std::vector<float> planarDst(src.size(), 0.0f);
+		std::vector<float> interleavedDst(src.size(), 0.0f);
+		ASSERT_TRUE(convolve1DHorizontal(kernel.data(), 7, ImageLayout::Planar, src, height, width, numChannels, 1, planarDst, static_cast<SimdLevel>(level)));
+		ASSERT_TRUE(convolve1DHorizontal(kernel.data(), 7, ImageLayout::Interleaved, src, height, width, numChannels, 1, interleavedDst, static_cast<SimdLevel>(level)));
+
+		for (auto i = 0U; i < src.size(); i++) {
+			ASSERT_NEAR(expectedPlanar[i], planarDst[i], 0.00001f) << "Planar mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+			ASSERT_NEAR(expectedInterleaved[i], interleavedDst[i], 0.00001f) << "Interleaved mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+}
+
+
+TEST(simd, verticalMatchesReference) {
+	const unsigned int height = 12U;
+	const unsigned int width = 53U;
+	const unsigned int numChannels = 4U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 29U) % 97U) / 10.0f;
+	}
+
+	std::vector<float> expectedPlanar(src.size(), 0.0f);
+	std::vector<float> expectedInterleaved(src.size(), 0.0f);
+	ASSERT_TRUE(convolve1DVerticalPlanar(kernel, src, height, width, numChannels, 2, expectedPlanar));
+	ASSERT_TRUE(convolve1DVerticalInterleaved(kernel, src, height, width, numChannels, 2, expectedInterleaved));
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		std::vector<float> planarDst(src.size(), 0.0f);
+		std::vector<float> interleavedDst(src.size(), 0.0f);
+		ASSERT_TRUE(convolve1DVertical(kernel.data(), 5, ImageLayout::Planar, src, height, width, numChannels, 2, planarDst, static_cast<SimdLevel>(level)));
+		ASSERT_TRUE(convolve1DVertical(kernel.data(), 5, ImageLayout::Interleaved, src, height, width, numChannels, 2, interleavedDst, static_cast<SimdLevel>(level)));
+
+		for (auto i = 0U; i < src.size(); i++) {
+			ASSERT_NEAR(expectedPlanar[i], planarDst[i], 0.00001f) << "Planar mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+			ASSERT_NEAR(expectedInterleaved[i], interleavedDst[i], 0.00001f) << "Interleaved mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+}
+
+
+TEST(simd, horizontalTransposedMatchesReference) {
+	// more rows and interior columns than fit in one tile, so the last tile is partial in both dimensions
+	const unsigned int height = 150U;
+	const unsigned int width = 1100U;
+	const unsigned int numChannels = 2U;
+	const std::array<float, 7> kernel{ { 0.05f, 0.1f, 0.2f, 0.3f, 0.2f, 0.1f, 0.05f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 37U) % 101U) / 10.0f;
+	}
+
+	// reference: horizontal pass and transpose, and for the second call the vertical pass of the separable blur
+	std::vector<float> horizontal(src.size(), 0.0f);
+	std::vector<float> expectedTransposed(src.size(), 0.0f);
+	std::vector<float> expectedBlur(src.size(), 0.0f);
+	ASSERT_TRUE(convolve1DHorizontalPlanar(kernel, src, height, width, numChannels, 1, horizontal));
+	ASSERT_TRUE(transposePlanarScalar(horizontal, height, width, numChannels, expectedTransposed));
+	ASSERT_TRUE(convolve1DVerticalPlanar(kernel, horizontal, height, width, numChannels, 1, expectedBlur));
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		std::vector<float> transposed(src.size(), 0.0f);
+		std::vector<float> blur(src.size(), 0.0f);
+		ASSERT_TRUE(convolve1DHorizontalTransposed(kernel.data(), 7, src, height, width, numChannels, 1, transposed, static_cast<SimdLevel>(level)));
+		ASSERT_TRUE(convolve1DHorizontalTransposed(kernel.data(), 7, transposed, width, height, numChannels, 1, blur, static_cast<SimdLevel>(level)));
+
+		for (auto i = 0U; i < src.size(); i++) {
+			ASSERT_NEAR(expectedTransposed[i], transposed[i], 0.00001f) << "Transposed mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+			ASSERT_NEAR(expectedBlur[i], blur[i], 0.00001f) << "Blur mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+
+	std::vector<float> dst(src.size());
+	ASSERT_FALSE(convolve1DHorizontalTransposed(kernel.data(), 6, src, height, width, numChannels, 1, dst, getSimdLevel()));
+	ASSERT_FALSE(convolve1DHorizontalTransposed(kernel.data(), 7, src, height, width, numChannels, 2, dst, getSimdLevel()));
+}
+
+
+TEST(fft, matchesDirect) {
+	// 90 rows and 333 columns leave the last transform of the rows and the last panel of the columns partly empty, and the
+	// 31-tap kernel needs several overlapping blocks per row
+	const unsigned int height = 90U;
+	const unsigned int width = 333U;
+	const unsigned int numChannels = 3U;
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 37U) % 101U) / 10.0f;
+	}
+
+	const unsigned int kernelSizes[] = { 31U, 63U };
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+
+	for (const unsigned int kernelSize : kernelSizes) {
+		// Gaussian-ish taps that sum to 1, so the documented tolerance is 1e-5 * the largest input
+		std::vector<float> kernel(kernelSize);
+		float sum = 0.0f;
+		for (auto i = 0U; i < kernelSize; i++) {
+			const float x = (static_cast<float>(i) - kernelSize / 2) / (kernelSize / 6.0f);
+			kernel[i] = std::exp(-0.5f * x * x);
+			sum += kernel[i];
+		}
+		for (float& tap : kernel) {
+			tap /= sum;
+		}
+		const float tolerance = 0.00001f * 10.0f;
+
+		for (const ImageLayout layout : layouts) {
+			for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+				const SimdLevel simdLevel = static_cast<SimdLevel>(level);
+
+				// the edge pixels are left untouched by both, so they must still hold the fill value
+				std::vector<float> expectedHorizontal(src.size(), -1.0f);
+				std::vector<float> expectedVertical(src.size(), -1.0f);
+				std::vector<float> horizontal(src.size(), -1.0f);
+				std::vector<float> vertical(src.size(), -1.0f);
+				ASSERT_TRUE(convolve1DHorizontal(kernel.data(), kernelSize, layout, src, height, width, numChannels, 1, expectedHorizontal, simdLevel));
+				ASSERT_TRUE(convolve1DVertical(kernel.data(), kernelSize, layout, src, height, width, numChannels, 1, expectedVertical, simdLevel));
+				ASSERT_TRUE(convolve1DHorizontalFft(kernel.data(), kernelSize, layout, src, height, width, numChannels, 1, horizontal, simdLevel));
+				ASSERT_TRUE(convolve1DVerticalFft(kernel.data(), kernelSize, layout, src, height, width, numChannels, 1, vertical, simdLevel));
+
+				for (auto i = 0U; i < src.size(); i++) {
+					ASSERT_NEAR(expectedHorizontal[i], horizontal[i], tolerance) << "Horizontal mismatch at position i = " << i << " kernel size " << kernelSize << " level " << simdLevelName(simdLevel);
+					ASSERT_NEAR(expectedVertical[i], vertical[i], tolerance) << "Vertical mismatch at position i = " << i << " kernel size " << kernelSize << " level " << simdLevelName(simdLevel);
+				}
+			}
+		}
+
+		// crops keep the pitches of the whole image, so their rows aren't dense
+		const ImageView srcCrop = makeImageView(src, ImageLayout::Planar, height, width, numChannels).crop(5, 7, 80, 300);
+		std::vector<float> expected(src.size(), -1.0f);
+		std::vector<float> dst(src.size(), -1.0f);
+		const MutableImageView expectedCrop = makeImageView(expected, ImageLayout::Planar, height, width, numChannels).crop(5, 7, 80, 300);
+		const MutableImageView dstCrop = makeImageView(dst, ImageLayout::Planar, height, width, numChannels).crop(5, 7, 80, 300);
+		ASSERT_TRUE(convolve1DVertical(kernel.data(), kernelSize, srcCrop, 2, expectedCrop, getSimdLevel()));
+		ASSERT_TRUE(convolve1DVerticalFft(kernel.data(), kernelSize, srcCrop, 2, dstCrop, getSimdLevel()));
+		for (auto i = 0U; i < src.size(); i++) {
+			ASSERT_NEAR(expected[i], dst[i], tolerance) << "Crop mismatch at position i = " << i << " kernel size " << kernelSize;
+		}
+
+		// the Auto functions pick one of the two
+		std::vector<float> direct(src.size(), -1.0f);
+		std::vector<float> fft(src.size(), -1.0f);
+		std::vector<float> automatic(src.size(), -1.0f);
+		ASSERT_TRUE(convolve1DHorizontal(kernel.data(), kernelSize, ImageLayout::Planar, src, height, width, numChannels, 0, direct, getSimdLevel()));
+		ASSERT_TRUE(convolve1DHorizontalFft(kernel.data(), kernelSize, ImageLayout::Planar, src, height, width, numChannels, 0, fft, getSimdLevel()));
+		ASSERT_TRUE(convolve1DHorizontalAuto(kernel.data(), kernelSize, ImageLayout::Planar, src, height, width, numChannels, 0, automatic, getSimdLevel()));
+		ASSERT_EQ(kernelSize >= fftCrossoverKernelSize(getSimdLevel()) ? fft : direct, automatic);
+	}
+
+	std::vector<float> kernel(31, 1.0f / 31.0f);
+	std::vector<float> dst(src.size());
+	std::vector<float> smallDst(src.size() - 1);
+	ASSERT_FALSE(convolve1DHorizontalFft(kernel.data(), 30, ImageLayout::Planar, src, height, width, numChannels, 0, dst, getSimdLevel()));
+	ASSERT_FALSE(convolve1DVerticalFft(kernel.data(), 31, ImageLayout::Planar, src, height, width, numChannels, 3, dst, getSimdLevel()));
+	ASSERT_FALSE(convolve1DVerticalFft(kernel.data(), 31, ImageLayout::Planar, src, height, width, numChannels, 0, smallDst, getSimdLevel()));
+}
+
+
+TEST(nonSeparable, matchesNaive) {
+	// 45 columns leave a partial vector after the 32-element blocks of the interior, and 23 rows a block of fewer than 4 rows
+	const unsigned int height = 23U;
+	const unsigned int width = 45U;
+	const unsigned int numChannels = 3U;
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 37U) % 101U) / 10.0f;
+	}
+
+	const unsigned int kernelSizes[] = { 1U, 3U, 5U, 7U };
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+
+	for (const unsigned int kernelSize : kernelSizes) {
+		// no two rows of the kernel are proportional, so it isn't separable
+		std::vector<float> kernel(kernelSize * kernelSize);
+		for (auto i = 0U; i < kernel.size(); i++) {
+			kernel[i] = static_cast<float>(static_cast<int>((i * 7U) % 11U) - 5) / 10.0f;
+		}
+		const unsigned int center = kernelSize / 2;
+
+		for (const ImageLayout layout : layouts) {
+			const ImageView srcView = makeImageView(src, layout, height, width, numChannels);
+
+			// the edge pixels are left untouched, so they must still hold the fill value
+			std::vector<float> expected(src.size(), -1.0f);
+			const MutableImageView expectedView = makeImageView(expected, layout, height, width, numChannels);
+			for (auto ch = 0U; ch < numChannels; ch++) {
+				for (auto row = center; row < height - center; row++) {
+					for (auto col = center; col < width - center; col++) {
+						float sum = 0.0f;
+						for (auto kernelRow = 0U; kernelRow < kernelSize; kernelRow++) {
+							for (auto kernelCol = 0U; kernelCol < kernelSize; kernelCol++) {
+								sum += kernel[kernelRow * kernelSize + kernelCol] * srcView.row(ch, row - center + kernelRow)[(col - center + kernelCol) * srcView.pixelStride()];
+							}
+						}
+						expectedView.row(ch, row)[col * expectedView.pixelStride()] = sum;
+					}
+				}
+			}
+
+			for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+				const SimdLevel simdLevel = static_cast<SimdLevel>(level);
+
+				std::vector<float> dst(src.size(), -1.0f);
+				for (auto ch = 0U; ch < numChannels; ch++) {
+					ASSERT_TRUE(convolve2D(kernel.data(), kernelSize, layout, src, height, width, numChannels, ch, dst, simdLevel));
+				}
+
+				for (auto i = 0U; i < src.size(); i++) {
+					ASSERT_NEAR(expected[i], dst[i], 0.0001f) << "Mismatch at position i = " << i << " kernel size " << kernelSize << " level " << simdLevelName(simdLevel);
+				}
+
+				// bands of rows add up to the whole image
+				std::vector<float> bands(src.size(), -1.0f);
+				for (auto ch = 0U; ch < numChannels; ch++) {
+					ASSERT_TRUE(convolve2DRows(kernel.data(), kernelSize, layout, src, height, width, numChannels, ch, 0, 10, bands, simdLevel));
+					ASSERT_TRUE(convolve2DRows(kernel.data(), kernelSize, layout, src, height, width, numChannels, ch, 10, height, bands, simdLevel));
+				}
+				ASSERT_EQ(dst, bands);
+
+				if (layout == ImageLayout::Interleaved) {
+					std::vector<float> allChannels(src.size(), -1.0f);
+					ASSERT_TRUE(convolve2DInterleavedAllChannels(kernel.data(), kernelSize, src, height, width, numChannels, allChannels, simdLevel));
+					for (auto i = 0U; i < src.size(); i++) {
+						ASSERT_NEAR(expected[i], allChannels[i], 0.0001f) << "All channels mismatch at position i = " << i << " kernel size " << kernelSize << " level " << simdLevelName(simdLevel);
+					}
+				}
+			}
+		}
+	}
+
+	// a separable kernel gives the same pixels as the two passes
+	const std::array<float, 5> horizontalKernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::array<float, 3> verticalKernel{ { 0.25f, 0.5f, 0.25f } };
+	std::vector<float> outerProduct(5 * 5, 0.0f);
+	for (auto kernelRow = 0U; kernelRow < verticalKernel.size(); kernelRow++) {
+		for (auto kernelCol = 0U; kernelCol < horizontalKernel.size(); kernelCol++) {
+			outerProduct[(kernelRow + 1) * 5 + kernelCol] = verticalKernel[kernelRow] * horizontalKernel[kernelCol];
+		}
+	}
+
+	for (const ImageLayout layout : layouts) {
+		std::vector<float> separable(src.size(), -1.0f);
+		std::vector<float> dst(src.size(), -1.0f);
+		ASSERT_TRUE(convolve2DSeparable(horizontalKernel.data(), 5, verticalKernel.data(), 3, layout, src, height, width, numChannels, 2, separable, getSimdLevel()));
+		ASSERT_TRUE(convolve2D(outerProduct.data(), 5, layout, src, height, width, numChannels, 2, dst, getSimdLevel()));
+
+		// the 3-tap vertical kernel leaves only 1 edge row untouched, the 5 x 5 kernel 2
+		const ImageView separableView = makeImageView(separable, layout, height, width, numChannels);
+		const ImageView dstView = makeImageView(dst, layout, height, width, numChannels);
+		for (auto row = 2U; row < height - 2; row++) {
+			for (auto col = 0U; col < width; col++) {
+				ASSERT_NEAR(separableView.row(2, row)[col * separableView.pixelStride()], dstView.row(2, row)[col * dstView.pixelStride()], 0.0001f) << "Separable mismatch at row " << row << " col " << col;
+			}
+		}
+	}
+
+	std::vector<float> kernel(9, 1.0f / 9.0f);
+	std::vector<float> dst(src.size());
+	std::vector<float> smallDst(src.size() - 1);
+	ASSERT_FALSE(convolve2D(kernel.data(), 2, ImageLayout::Planar, src, height, width, numChannels, 0, dst, getSimdLevel()));
+	ASSERT_FALSE(convolve2D(kernel.data(), 3, ImageLayout::Planar, src, height, width, numChannels, 3, dst, getSimdLevel()));
+	ASSERT_FALSE(convolve2D(kernel.data(), 3, ImageLayout::Planar, src, height, width, numChannels, 0, smallDst, getSimdLevel()));
+	ASSERT_FALSE(convolve2DInterleavedAllChannels(kernel.data(), 3, makeImageView(src, ImageLayout::Planar, height, width, numChannels), makeImageView(dst, ImageLayout::Planar, height, width, numChannels), getSimdLevel()));
+}
+
+
+TEST(fused, separableMatchesTwoPasses) {
+	const unsigned int height = 23U;
+	const unsigned int width = 37U;
+	const unsigned int numChannels = 3U;
+	const std::array<float, 5> horizontalKernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::array<float, 3> verticalKernel{ { 0.25f, 0.5f, 0.25f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 31U) % 89U) / 10.0f;
+	}
+
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+	for (const ImageLayout layout : layouts) {
+		// reference: full horizontal pass into a zeroed intermediate, then a full vertical pass, for the interior rows and columns
+		std::vector<float> intermediate(src.size(), 0.0f);
+		std::vector<float> expectedDst(src.size(), 0.0f);
+		if (layout == ImageLayout::Planar) {
+			ASSERT_TRUE(convolve1DHorizontalPlanar(horizontalKernel, src, height, width, numChannels, 1, intermediate));
+			ASSERT_TRUE(convolve1DVerticalPlanar(verticalKernel, intermediate, height, width, numChannels, 1, expectedDst));
+		}
+		else {
+			ASSERT_TRUE(convolve1DHorizontalInterleaved(horizontalKernel, src, height, width, numChannels, 1, intermediate));
+			ASSERT_TRUE(convolve1DVerticalInterleaved(verticalKernel, intermediate, height, width, numChannels, 1, expectedDst));
+		}
+
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			std::vector<float> dst(src.size(), 0.0f);
+			ASSERT_TRUE(convolve2DSeparable(horizontalKernel.data(), 5, verticalKernel.data(), 3, layout, src, height, width, numChannels, 1, dst, static_cast<SimdLevel>(level)));
+
+			for (auto i = 0U; i < src.size(); i++) {
+				ASSERT_NEAR(expectedDst[i], dst[i], 0.00001f) << "Mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+			}
+		}
+	}
+}
+
+
+TEST(iterated, tilesMatchSequentialPasses) {
+	const unsigned int numChannels = 2U;
+	const std::array<float, 5> horizontalKernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::array<float, 3> verticalKernel{ { 0.25f, 0.5f, 0.25f } };
+
+	// images smaller than a tile, a few tiles with partial tiles at the edges, and images smaller than the kernels
+	const std::array<std::pair<unsigned int, unsigned int>, 4> shapes{ { { 41U, 67U }, { 150U, 93U }, { 2U, 40U }, { 30U, 4U } } };
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+	for (const auto& shape : shapes) {
+		const unsigned int height = shape.first;
+		const unsigned int width = shape.second;
+
+		std::vector<float> src(height * width * numChannels);
+		for (auto i = 0U; i < src.size(); i++) {
+			src[i] = static_cast<float>((i * 29U) % 97U) / 10.0f;
+		}
+
+		for (const ImageLayout layout : layouts) {
+			for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+				for (auto numPasses = 1U; numPasses <= 4U; numPasses++) {
+					// reference: numPasses full-image passes, each into a zeroed image.  The other channel is never written.
+					std::vector<float> expectedDst = src;
+					for (auto pass = 0U; pass < numPasses; pass++) {
+						std::vector<float> passDst(src.size(), 0.0f);
+						ASSERT_TRUE(convolve2DSeparable(horizontalKernel.data(), 5, verticalKernel.data(), 3, layout, expectedDst, height, width, numChannels, 1, passDst, static_cast<SimdLevel>(level)));
+						expectedDst = passDst;
+					}
+					for (auto i = 0U; i < src.size(); i++) {
+						const bool inChannel = layout == ImageLayout::Planar ? i / (height * width) == 1 : i % numChannels == 1;
+						if (!inChannel) {
+							expectedDst[i] = -1.0f;
+						}
+					}
+
+					// the smallest tiles, and tiles larger than the image.  The SIMD kernels may round the pixels of a row's
+					// tail differently, and the tiles cut the rows elsewhere than the image.
+					const std::size_t budgets[] = { 0, defaultIteratedTileBytes };
+					for (const std::size_t budget : budgets) {
+						std::vector<float> dst(src.size(), -1.0f);
+						ASSERT_TRUE(convolve2DSeparableIterated(horizontalKernel.data(), 5, verticalKernel.data(), 3, numPasses, layout, src, height, width, numChannels, 1, dst, budget, static_cast<SimdLevel>(level)));
+						for (auto i = 0U; i < src.size(); i++) {
+							ASSERT_NEAR(expectedDst[i], dst[i], 0.00001f) << "Mismatch at position i = " << i << " passes " << numPasses << " budget " << budget << " level " << simdLevelName(static_cast<SimdLevel>(level));
+						}
+					}
+				}
+			}
+		}
+	}
+
+	ASSERT_EQ(16U, iteratedTileSize(5, 3, 4, 0));
+	const unsigned int tileSize = iteratedTileSize(5, 3, 4, defaultIteratedTileBytes);
+	ASSERT_EQ(0U, tileSize % 16);
+	ASSERT_LE(2 * (tileSize + 8) * (tileSize + 16) * sizeof(float), defaultIteratedTileBytes);
+	ASSERT_GT(2 * (tileSize + 16 + 8) * (tileSize + 16 + 16) * sizeof(float), defaultIteratedTileBytes);
+
+	const SimdLevel level = getSimdLevel();
+	std::vector<float> image(16 * 16, 1.0f);
+	std::vector<float> result(image.size());
+	ASSERT_FALSE(convolve2DSeparableIterated(horizontalKernel.data(), 4, verticalKernel.data(), 3, 2, ImageLayout::Planar, image, 16, 16, 1, 0, result, 0, level));
+	ASSERT_FALSE(convolve2DSeparableIterated(horizontalKernel.data(), 5, verticalKernel.data(), 3, 0, ImageLayout::Planar, image, 16, 16, 1, 0, result, 0, level));
+	ASSERT_FALSE(convolve2DSeparableIterated(horizontalKernel.data(), 5, verticalKernel.data(), 3, 2, ImageLayout::Planar, image, 16, 16, 1, 1, result, 0, level));
+	ASSERT_FALSE(convolve2DSeparableIterated(horizontalKernel.data(), 5, verticalKernel.data(), 3, 2, ImageLayout::Planar, image, 17, 16, 1, 0, result, 0, level));
+}
+
+TEST(parallel, threadPoolRunsEveryTaskOnce) {
+	ThreadPool pool(4);
+	ASSERT_EQ(4U, pool.size());
+
+	// several batches on the same pool, with uneven task costs so stealing kicks in
+	for (auto batch = 0U; batch < 3U; batch++) {
+		std::vector<std::atomic<unsigned int>> counts(257);
+		for (auto& count : counts) {
+			count = 0;
+		}
+
+		pool.parallelFor(static_cast<unsigned int>(counts.size()), [&](unsigned int task) {
+			volatile unsigned int spin = 0;
+			for (auto i = 0U; i < (task % 7U) * 1000U; i++) {
+				spin = spin + 1;
+			}
+			counts[task]++;
+		});
+
+		for (auto i = 0U; i < counts.size(); i++) {
+			ASSERT_EQ(1U, counts[i].load()) << "Task " << i << " in batch " << batch;
+		}
+	}
+}
+
+TEST(parallel, bandsMatchSerial) {
+	const unsigned int height = 67U;
+	const unsigned int width = 29U;
+	const unsigned int numChannels = 3U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 41U) % 103U) / 10.0f;
+	}
+
+	// more threads than bands per channel would need, so the bands are short and every band boundary needs its halo
+	ThreadPool pool(8);
+	const SimdLevel level = getSimdLevel();
+
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+	for (const ImageLayout layout : layouts) {
+		std::vector<float> expectedHorizontal(src.size(), 0.0f);
+		std::vector<float> expectedVertical(src.size(), 0.0f);
+		std::vector<float> expectedFused(src.size(), 0.0f);
+		for (auto ch = 0U; ch < numChannels; ch++) {
+			ASSERT_TRUE(convolve1DHorizontal(kernel.data(), 5, layout, src, height, width, numChannels, ch, expectedHorizontal, level));
+			ASSERT_TRUE(convolve1DVertical(kernel.data(), 5, layout, src, height, width, numChannels, ch, expectedVertical, level));
+			ASSERT_TRUE(convolve2DSeparable(kernel.data(), 5, kernel.data(), 5, layout, src, height, width, numChannels, ch, expectedFused, level));
+		}
+
+		std::vector<float> horizontal(src.size(), 0.0f);
+		std::vector<float> vertical(src.size(), 0.0f);
+		std::vector<float> fused(src.size(), 0.0f);
+		ASSERT_TRUE(convolve1DHorizontalParallel(kernel.data(), 5, layout, src, height, width, numChannels, horizontal, pool, level));
+		ASSERT_TRUE(convolve1DVerticalParallel(kernel.data(), 5, layout, src, height, width, numChannels, vertical, pool, level));
+		ASSERT_TRUE(convolve2DSeparableParallel(kernel.data(), 5, kernel.data(), 5, layout, src, height, width, numChannels, fused, pool, level));
+
+		ASSERT_TRUE(std::equal(expectedHorizontal.begin(), expectedHorizontal.end(), horizontal.begin()));
+		ASSERT_TRUE(std::equal(expectedVertical.begin(), expectedVertical.end(), vertical.begin()));
+		ASSERT_TRUE(std::equal(expectedFused.begin(), expectedFused.end(), fused.begin()));
+	}
+}
+
+
+TEST(batch, matchesPerImage) {
+	const unsigned int numImages = 5U;
+	const unsigned int height = 13U;
+	const unsigned int width = 17U;
+	const unsigned int numChannels = 3U;
+	const unsigned int imageSize = height * width * numChannels;
+	const std::array<float, 5> horizontalKernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::array<float, 3> verticalKernel{ { 0.25f, 0.5f, 0.25f } };
+
+	std::vector<float> images(numImages * imageSize);
+	for (auto i = 0U; i < images.size(); i++) {
+		images[i] = static_cast<float>((i * 41U) % 103U) / 10.0f;
+	}
+
+	// 12 chunks, so the 15 planes of the planar batch make some chunks convolve 2 planes
+	ThreadPool pool(3);
+
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+	for (const ImageLayout layout : layouts) {
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			const SimdLevel simdLevel = static_cast<SimdLevel>(level);
+
+			std::vector<float> horizontal(images.size(), 0.0f);
+			std::vector<float> vertical(images.size(), 0.0f);
+			std::vector<float> separable(images.size(), 0.0f);
+			ASSERT_TRUE(convolve1DHorizontalBatch(horizontalKernel.data(), 5, layout, images, numImages, height, width, numChannels, horizontal, pool, simdLevel));
+			ASSERT_TRUE(convolve1DVerticalBatch(verticalKernel.data(), 3, layout, images, numImages, height, width, numChannels, vertical, pool, simdLevel));
+			ASSERT_TRUE(convolve2DSeparableBatch(horizontalKernel.data(), 5, verticalKernel.data(), 3, layout, images, numImages, height, width, numChannels, separable, pool, simdLevel));
+
+			for (auto image = 0U; image < numImages; image++) {
+				const std::vector<float> src(images.begin() + image * imageSize, images.begin() + (image + 1) * imageSize);
+				std::vector<float> expectedHorizontal(imageSize, 0.0f);
+				std::vector<float> expectedVertical(imageSize, 0.0f);
+				std::vector<float> expectedSeparable(imageSize, 0.0f);
+				for (auto ch = 0U; ch < numChannels; ch++) {
+					ASSERT_TRUE(convolve1DHorizontal(horizontalKernel.data(), 5, layout, src, height, width, numChannels, ch, expectedHorizontal, simdLevel));
+					ASSERT_TRUE(convolve1DVertical(verticalKernel.data(), 3, layout, src, height, width, numChannels, ch, expectedVertical, simdLevel));
+					ASSERT_TRUE(convolve2DSeparable(horizontalKernel.data(), 5, verticalKernel.data(), 3, layout, src, height, width, numChannels, ch, expectedSeparable, simdLevel));
+				}
+
+				for (auto i = 0U; i < imageSize; i++) {
+					ASSERT_NEAR(expectedHorizontal[i], horizontal[image * imageSize + i], 0.00001f) << "Horizontal mismatch in image " << image << " at position i = " << i << " level " << simdLevelName(simdLevel);
+					ASSERT_NEAR(expectedVertical[i], vertical[image * imageSize + i], 0.00001f) << "Vertical mismatch in image " << image << " at position i = " << i << " level " << simdLevelName(simdLevel);
+					ASSERT_NEAR(expectedSeparable[i], separable[image * imageSize + i], 0.00001f) << "Separable mismatch in image " << image << " at position i = " << i << " level " << simdLevelName(simdLevel);
+				}
+			}
+		}
+	}
+
+	// the whole batch is validated up front
+	std::vector<float> tooSmall(images.size() - 1);
+	ASSERT_FALSE(convolve1DHorizontalBatch(horizontalKernel.data(), 4, ImageLayout::Planar, images, numImages, height, width, numChannels, tooSmall, pool, getSimdLevel()));
+	ASSERT_FALSE(convolve1DHorizontalBatch(horizontalKernel.data(), 5, ImageLayout::Planar, images, numImages, height, width, numChannels, tooSmall, pool, getSimdLevel()));
+	ASSERT_FALSE(convolve2DSeparableBatch(horizontalKernel.data(), 5, verticalKernel.data(), 3, ImageLayout::Planar, tooSmall, numImages, height, width, numChannels, images, pool, getSimdLevel()));
+}
+
+
+TEST(interleaved, allChannelsMatchesPerChannel) {
+	const unsigned int height = 14U;
+	const unsigned int width = 27U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+
+	for (auto numChannels = 1U; numChannels <= 5U; numChannels++) {
+		std::vector<float> src(height * width * numChannels);
+		for (auto i = 0U; i < src.size(); i++) {
+			src[i] = static_cast<float>((i * 43U) % 107U) / 10.0f;
+		}
+
+		std::vector<float> expectedHorizontal(src.size(), 0.0f);
+		std::vector<float> expectedVertical(src.size(), 0.0f);
+		for (auto ch = 0U; ch < numChannels; ch++) {
+			ASSERT_TRUE(convolve1DHorizontalInterleaved(kernel, src, height, width, numChannels, ch, expectedHorizontal));
+			ASSERT_TRUE(convolve1DVerticalInterleaved(kernel, src, height, width, numChannels, ch, expectedVertical));
+		}
+
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			std::vector<float> horizontal(src.size(), 0.0f);
+			std::vector<float> vertical(src.size(), 0.0f);
+			ASSERT_TRUE(convolve1DHorizontalInterleavedAllChannels(kernel.data(), 5, src, height, width, numChannels, horizontal, static_cast<SimdLevel>(level)));
+			ASSERT_TRUE(convolve1DVerticalInterleavedAllChannels(kernel.data(), 5, src, height, width, numChannels, vertical, static_cast<SimdLevel>(level)));
+
+			for (auto i = 0U; i < src.size(); i++) {
+				ASSERT_NEAR(expectedHorizontal[i], horizontal[i], 0.00001f) << "Horizontal mismatch at position i = " << i << " with " << numChannels << " channels, level " << simdLevelName(static_cast<SimdLevel>(level));
+				ASSERT_NEAR(expectedVertical[i], vertical[i], 0.00001f) << "Vertical mismatch at position i = " << i << " with " << numChannels << " channels, level " << simdLevelName(static_cast<SimdLevel>(level));
+			}
+		}
+	}
+}
+
+
+TEST(unrolled, matchesReference) {
+	const unsigned int height = 11U;
+	const unsigned int width = 13U;
+	const unsigned int numChannels = 2U;
+	const std::array<float, 7> kernel{ { 0.05f, 0.1f, 0.2f, 0.3f, 0.2f, 0.1f, 0.05f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 53U) % 109U) / 10.0f;
+	}
+
+	using convolveFn = bool (*)(const std::array<float, 7>&, const std::vector<float>&, unsigned int, unsigned int, unsigned int, unsigned int, std::vector<float>&);
+	const std::array<std::array<convolveFn, 3>, 4> variants{ {
+		{ { convolve1DHorizontalPlanar<std::array<float, 7>>, convolve1DHorizontalPlanarUnrolled<7>, convolve1DHorizontalPlanarUnrolled<7, true> } },
+		{ { convolve1DVerticalPlanar<std::array<float, 7>>, convolve1DVerticalPlanarUnrolled<7>, convolve1DVerticalPlanarUnrolled<7, true> } },
+		{ { convolve1DHorizontalInterleaved<std::array<float, 7>>, convolve1DHorizontalInterleavedUnrolled<7>, convolve1DHorizontalInterleavedUnrolled<7, true> } },
+		{ { convolve1DVerticalInterleaved<std::array<float, 7>>, convolve1DVerticalInterleavedUnrolled<7>, convolve1DVerticalInterleavedUnrolled<7, true> } },
+	} };
+
+	for (const auto& variant : variants) {
+		std::vector<float> expectedDst(src.size(), 0.0f);
+		ASSERT_TRUE(variant[0](kernel, src, height, width, numChannels, 1, expectedDst));
+
+		for (auto v = 1U; v < variant.size(); v++) {
+			std::vector<float> dst(src.size(), 0.0f);
+			ASSERT_TRUE(variant[v](kernel, src, height, width, numChannels, 1, dst));
+
+			for (auto i = 0U; i < expectedDst.size(); i++) {
+				ASSERT_NEAR(expectedDst[i], dst[i], 0.00001f) << "Mismatch at position i = " << i;
+			}
+		}
+	}
+}
+
+TEST(unrolled, symmetricRejectsAsymmetricKernel) {
+	const std::array<float, 3> kernel{ { 0.2f, 0.5f, 0.3f } };
+	std::vector<float> dst(planar3channel.size(), 0.0f);
+
+	ASSERT_TRUE(convolve1DHorizontalPlanarUnrolled<3>(kernel, planar3channel, planar3channelHeight, planar3channelWidth, planar3channelChannels, 0, dst));
+	ASSERT_FALSE((convolve1DHorizontalPlanarUnrolled<3, true>(kernel, planar3channel, planar3channelHeight, planar3channelWidth, planar3channelChannels, 0, dst)));
+}
+
+TEST(box, matchesConvolution) {
+	const unsigned int height = 23U;
+	const unsigned int width = 29U;
+	const unsigned int numChannels = 3U;
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 53U) % 109U) / 10.0f;
+	}
+
+	const std::array<ImageLayout, 2> layouts{ { ImageLayout::Planar, ImageLayout::Interleaved } };
+	const std::array<unsigned int, 4> radii{ { 0U, 1U, 5U, 14U } };
+
+	for (const auto layout : layouts) {
+		for (const auto radius : radii) {
+			const std::vector<float> kernel(2 * radius + 1, 1.0f / (2 * radius + 1));
+
+			for (auto channel = 0U; channel < numChannels; channel++) {
+				std::vector<float> expectedHorizontal(src.size(), 0.0f);
+				std::vector<float> expectedVertical(src.size(), 0.0f);
+				std::vector<float> horizontal(src.size(), 0.0f);
+				std::vector<float> vertical(src.size(), 0.0f);
+
+				if (layout == ImageLayout::Planar) {
+					ASSERT_TRUE(convolve1DHorizontalPlanar(kernel, src, height, width, numChannels, channel, expectedHorizontal));
+					ASSERT_TRUE(convolve1DVerticalPlanar(kernel, src, height, width, numChannels, channel, expectedVertical));
+				}
+				else {
+					ASSERT_TRUE(convolve1DHorizontalInterleaved(kernel, src, height, width, numChannels, channel, expectedHorizontal));
+					ASSERT_TRUE(convolve1DVerticalInterleaved(kernel, src, height, width, numChannels, channel, expectedVertical));
+				}
+
+				ASSERT_TRUE(boxFilter1DHorizontal(radius, layout, src, height, width, numChannels, channel, horizontal));
+				ASSERT_TRUE(boxFilter1DVertical(radius, layout, src, height, width, numChannels, channel, vertical));
+
+				for (auto i = 0U; i < src.size(); i++) {
+					ASSERT_NEAR(expectedHorizontal[i], horizontal[i], 0.00001f) << "Horizontal mismatch at position i = " << i << ", radius = " << radius;
+					ASSERT_NEAR(expectedVertical[i], vertical[i], 0.00001f) << "Vertical mismatch at position i = " << i << ", radius = " << radius;
+				}
+			}
+		}
+	}
+}
+
+TEST(box, noDriftOnLongRows) {
+	// large and small values alternate, so a float running sum would lose the small ones and drift along the row
+	const unsigned int width = 1U << 18;
+	const unsigned int radius = 3U;
+
+	std::vector<float> src(width);
+	for (auto i = 0U; i < width; i++) {
+		src[i] = (i % 7U == 0U) ? 1000.0f + static_cast<float>(i % 13U) : 0.001f * static_cast<float>(i % 11U);
+	}
+
+	std::vector<float> dst(width, 0.0f);
+	ASSERT_TRUE(boxFilter1DHorizontal(radius, ImageLayout::Planar, src, 1, width, 1, 0, dst));
+
+	for (auto col = radius; col < width - radius; col++) {
+		double expected = 0.0;
+		for (auto k = col - radius; k <= col + radius; k++) {
+			expected += src[k];
+		}
+		expected /= 2 * radius + 1;
+
+		ASSERT_NEAR(expected, dst[col], 0.0001) << "Mismatch at col = " << col;
+	}
+}
+
+TEST(view, alignedImageRowsAreAligned) {
+	const std::array<ImageLayout, 2> layouts{ { ImageLayout::Planar, ImageLayout::Interleaved } };
+
+	for (const auto layout : layouts) {
+		AlignedImage image(5, 13, 3, layout);
+		const MutableImageView view = image.view();
+
+		ASSERT_TRUE(isValidImageView(view));
+		ASSERT_GE(view.rowPitch, view.width * view.pixelStride());
+
+		const unsigned int planes = layout == ImageLayout::Planar ? view.numChannels : 1;
+		for (auto plane = 0U; plane < planes; plane++) {
+			for (auto row = 0U; row < view.height; row++) {
+				ASSERT_EQ(0U, reinterpret_cast<std::uintptr_t>(view.row(plane, row)) % AlignedImage::rowAlignment);
+			}
+		}
+	}
+}
+
+TEST(view, cropMatchesDenseCopy) {
+	const unsigned int height = 20U;
+	const unsigned int width = 24U;
+	const unsigned int numChannels = 3U;
+	const unsigned int cropRow = 3U;
+	const unsigned int cropCol = 5U;
+	const unsigned int cropHeight = 12U;
+	const unsigned int cropWidth = 14U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 53U) % 109U) / 10.0f;
+	}
+
+	const std::array<ImageLayout, 2> layouts{ { ImageLayout::Planar, ImageLayout::Interleaved } };
+
+	for (const auto layout : layouts) {
+		// the crop, padded and in place inside a larger aligned image
+		AlignedImage padded(height, width, numChannels, layout);
+		ASSERT_TRUE(copyImage(makeImageView(src, layout, height, width, numChannels), padded.view()));
+		const ImageView crop = padded.view().crop(cropRow, cropCol, cropHeight, cropWidth);
+
+		// the same crop, copied into a dense image
+		std::vector<float> denseCrop(cropHeight * cropWidth * numChannels);
+		ASSERT_TRUE(copyImage(crop, makeImageView(denseCrop, layout, cropHeight, cropWidth, numChannels)));
+
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			const SimdLevel simdLevel = static_cast<SimdLevel>(level);
+
+			for (auto channel = 0U; channel < numChannels; channel++) {
+				std::vector<float> expectedDst(denseCrop.size(), 0.0f);
+				AlignedImage dst(cropHeight, cropWidth, numChannels, layout);
+
+				ASSERT_TRUE(convolve2DSeparable(kernel.data(), 5, kernel.data(), 5, layout, denseCrop, cropHeight, cropWidth, numChannels, channel, expectedDst, simdLevel));
+				ASSERT_TRUE(convolve2DSeparable(kernel.data(), 5, kernel.data(), 5, crop, channel, dst.view(), simdLevel));
+
+				std::vector<float> actualDst(denseCrop.size(), 0.0f);
+				ASSERT_TRUE(copyImage(dst.view(), makeImageView(actualDst, layout, cropHeight, cropWidth, numChannels)));
+
+				for (auto i = 0U; i < expectedDst.size(); i++) {
+					ASSERT_NEAR(expectedDst[i], actualDst[i], 0.00001f) << "Mismatch at position i = " << i;
+				}
+			}
+		}
+	}
+}
+
+TEST(view, transposePaddedMatchesDense) {
+	const unsigned int height = 37U;
+	const unsigned int width = 45U;
+	const unsigned int numChannels = 2U;
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>(i);
+	}
+
+	std::vector<float> expectedDst(src.size(), 0.0f);
+	ASSERT_TRUE(transposePlanarScalar(src, height, width, numChannels, expectedDst));
+
+	AlignedImage paddedSrc(height, width, numChannels, ImageLayout::Planar);
+	AlignedImage paddedDst(width, height, numChannels, ImageLayout::Planar);
+	ASSERT_TRUE(copyImage(makeImageView(src, ImageLayout::Planar, height, width, numChannels), paddedSrc.view()));
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		ASSERT_TRUE(transposePlanarTiled(paddedSrc.view(), paddedDst.view(), static_cast<SimdLevel>(level)));
+
+		std::vector<float> dst(src.size(), 0.0f);
+		ASSERT_TRUE(copyImage(paddedDst.view(), makeImageView(dst, ImageLayout::Planar, width, height, numChannels)));
+
+		for (auto i = 0U; i < expectedDst.size(); i++) {
+			ASSERT_EQ(expectedDst[i], dst[i]) << "Mismatch at position i = " << i;
+		}
+	}
+
+	// the destination must have the transposed dimensions
+	ASSERT_FALSE(transposePlanar(paddedSrc.view(), paddedSrc.view()));
+}
+
+TEST(pool, reusesBuffersBySizeClass) {
+	BufferPool pool;
+
+	void* first = nullptr;
+	{
+		const PooledBuffer buffer = pool.acquire(100000);
+		first = buffer.data<void>();
+		ASSERT_NE(nullptr, first);
+		ASSERT_EQ(0U, reinterpret_cast<std::uintptr_t>(first) % BufferPool::alignment);
+		ASSERT_EQ(100000U, buffer.size());
+	}
+
+	ASSERT_EQ(1U, pool.allocationCount());
+	ASSERT_EQ(BufferPool::sizeClass(100000), pool.cachedBytes());
+
+	{
+		// same size class: the cached buffer comes back
+		const PooledBuffer buffer = pool.acquire(99000);
+		ASSERT_EQ(first, buffer.data<void>());
+		ASSERT_EQ(0U, pool.cachedBytes());
+
+		// leased buffers are never handed out twice
+		const PooledBuffer other = pool.acquire(99000);
+		ASSERT_NE(first, other.data<void>());
+	}
+
+	ASSERT_EQ(2U, pool.allocationCount());
+
+	pool.trim();
+	ASSERT_EQ(0U, pool.cachedBytes());
+
+	ASSERT_EQ(nullptr, pool.acquire(0).data<void>());
+}
+
+TEST(pool, sizeClassesBoundWaste) {
+	for (std::size_t numBytes = 1; numBytes < (std::size_t(1) << 28); numBytes = numBytes * 3 / 2 + 1) {
+		const std::size_t classBytes = BufferPool::sizeClass(numBytes);
+
+		ASSERT_GE(classBytes, numBytes);
+		ASSERT_EQ(0U, classBytes % 4096);
+		if (numBytes > 4 * 4096) {
+			ASSERT_LE(classBytes, numBytes + numBytes / 4) << "numBytes = " << numBytes;
+		}
+	}
+}
+
+TEST(pool, alignedImageFromPool) {
+	BufferPool pool;
+
+	for (auto frame = 0U; frame < 3U; frame++) {
+		AlignedImage image(17, 33, 3, ImageLayout::Interleaved, pool);
+		const MutableImageView view = image.view();
+
+		ASSERT_TRUE(isValidImageView(view));
+		for (auto row = 0U; row < view.height; row++) {
+			ASSERT_EQ(0U, reinterpret_cast<std::uintptr_t>(view.row(0, row)) % AlignedImage::rowAlignment);
+		}
+	}
+
+	// every frame after the first reused the first frame's buffer
+	ASSERT_EQ(1U, pool.allocationCount());
+}
+
+TEST(pixel, integerMatchesFloatReference) {
+	const std::array<float, 3> kernel{ { 0.25f, 0.5f, 0.25f } };
+
+	// 0 to about 223, the range of an 8-bit pixel
+	std::vector<std::uint8_t> src8(planar3channel.size());
+	std::vector<std::uint16_t> src16(planar3channel.size());
+	std::vector<float> srcFloat(planar3channel.size());
+	for (auto i = 0U; i < planar3channel.size(); i++) {
+		src8[i] = pixelTraits<std::uint8_t>::store(planar3channel[i] * 25.0f);
+		src16[i] = src8[i];
+		srcFloat[i] = src8[i];
+	}
+
+	for (auto ch = 0U; ch < planar3channelChannels; ch++) {
+		std::vector<float> expectedDst(srcFloat.size(), 0.0f);
+		std::vector<std::uint8_t> dst8(src8.size(), 0);
+		std::vector<std::uint16_t> dst16(src16.size(), 0);
+		ASSERT_TRUE(convolve1DVerticalPlanar(kernel, srcFloat, planar3channelHeight, planar3channelWidth, planar3channelChannels, ch, expectedDst));
+		ASSERT_TRUE(convolve1DVerticalPlanar(kernel, src8, planar3channelHeight, planar3channelWidth, planar3channelChannels, ch, dst8));
+		ASSERT_TRUE(convolve1DVerticalPlanar(kernel, src16, planar3channelHeight, planar3channelWidth, planar3channelChannels, ch, dst16));
+
+		// only the final rounding differs
+		for (auto i = 0U; i < expectedDst.size(); i++) {
+			ASSERT_NEAR(expectedDst[i], dst8[i], 0.5f) << "Mismatch at position i = " << i;
+			ASSERT_EQ(dst8[i], dst16[i]) << "Mismatch at position i = " << i;
+		}
+	}
+}
+
+TEST(pixel, integerSaturates) {
+	// a sharpening kernel overshoots both ends of the range at a step edge
+	const std::array<float, 3> kernel{ { -1.0f, 3.0f, -1.0f } };
+	const std::vector<std::uint8_t> src{ 0, 0, 0, 255, 255, 255 };
+	std::vector<std::uint8_t> dst(src.size(), 7);
+
+	ASSERT_TRUE(convolve1DHorizontalInterleaved(kernel, src, 1, 6, 1, 0, dst));
+
+	const std::vector<std::uint8_t> expectedDst{ 7, 0, 0, 255, 255, 7 };
+	ASSERT_EQ(expectedDst, dst);
+}
+
+TEST(pixel, halfConversion) {
+	ASSERT_EQ(0x3C00, floatToHalf(1.0f).bits);
+	ASSERT_EQ(0xC000, floatToHalf(-2.0f).bits);
+	ASSERT_EQ(0x7BFF, floatToHalf(65504.0f).bits);
+	ASSERT_EQ(0x7C00, floatToHalf(65520.0f).bits);
+	ASSERT_EQ(0x0001, floatToHalf(1.0f / 16777216.0f).bits);
+	ASSERT_EQ(0x0000, floatToHalf(1.0e-8f).bits);
+
+	// ties round to even
+	ASSERT_EQ(0x3C00, floatToHalf(1.0f + 1.0f / 2048.0f).bits);
+	ASSERT_EQ(0x3C02, floatToHalf(1.0f + 3.0f / 2048.0f).bits);
+
+	// every half that isn't a NaN survives a round trip through float
+	for (std::uint32_t bits = 0; bits <= 0xFFFF; bits++) {
+		if (((bits & 0x7C00) == 0x7C00) && ((bits & 0x3FF) != 0)) {
+			continue;
+		}
+
+		const tHalf value{ static_cast<std::uint16_t>(bits) };
+		ASSERT_EQ(bits, floatToHalf(halfToFloat(value)).bits) << "bits = " << bits;
+	}
+}
+
+TEST(pixel, bulkHalfConversionMatchesScalar) {
+	// not a multiple of 8, so the tail runs too
+	std::vector<float> src(1003);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = (static_cast<float>(i) - 500.0f) * 0.37f;
+	}
+
+	for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+		std::vector<tHalf> halves(src.size());
+		std::vector<float> roundTrip(src.size());
+		convertFloatToHalf(src.data(), halves.data(), static_cast<unsigned int>(src.size()), static_cast<SimdLevel>(level));
+		convertHalfToFloat(halves.data(), roundTrip.data(), static_cast<unsigned int>(src.size()), static_cast<SimdLevel>(level));
+
+		for (auto i = 0U; i < src.size(); i++) {
+			ASSERT_EQ(floatToHalf(src[i]).bits, halves[i].bits) << "Mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+			ASSERT_EQ(halfToFloat(halves[i]), roundTrip[i]) << "Mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+}
+
+TEST(pixel, halfRowsMatchPerPixelReference) {
+	const std::array<float, 5> kernel{ { 0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f } };
+	const unsigned int height = 23U;
+	const unsigned int width = 37U;
+	const unsigned int numChannels = 3U;
+
+	std::vector<tHalf> src(height * width * numChannels);
+	std::vector<float> srcFloat(src.size());
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = floatToHalf(static_cast<float>((i * 37U) % 101U) / 101.0f);
+		srcFloat[i] = halfToFloat(src[i]);
+	}
+
+	for (const auto layout : { ImageLayout::Planar, ImageLayout::Interleaved }) {
+		for (const auto vertical : { false, true }) {
+			for (auto ch = 0U; ch < numChannels; ch++) {
+				// the float template, with every result rounded to half precision pixel by pixel
+				std::vector<float> expectedFloat(srcFloat.size(), 0.0f);
+				if (layout == ImageLayout::Planar) {
+					ASSERT_TRUE(vertical ? convolve1DVerticalPlanar(kernel, srcFloat, height, width, numChannels, ch, expectedFloat) : convolve1DHorizontalPlanar(kernel, srcFloat, height, width, numChannels, ch, expectedFloat));
+				}
+				else {
+					ASSERT_TRUE(vertical ? convolve1DVerticalInterleaved(kernel, srcFloat, height, width, numChannels, ch, expectedFloat) : convolve1DHorizontalInterleaved(kernel, srcFloat, height, width, numChannels, ch, expectedFloat));
+				}
+
+				for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+					std::vector<tHalf> dst(src.size(), floatToHalf(0.0f));
+					ASSERT_TRUE(vertical ? convolve1DVertical(kernel.data(), 5, layout, src, height, width, numChannels, ch, dst, static_cast<SimdLevel>(level))
+						: convolve1DHorizontal(kernel.data(), 5, layout, src, height, width, numChannels, ch, dst, static_cast<SimdLevel>(level)));
+
+					for (auto i = 0U; i < dst.size(); i++) {
+						// the scalar kernels sum in the same order; the SIMD kernels may fuse the multiply-adds
+						if (static_cast<SimdLevel>(level) == SimdLevel::Scalar) {
+							ASSERT_EQ(floatToHalf(expectedFloat[i]).bits, dst[i].bits) << "Mismatch at position i = " << i;
+						}
+						else {
+							ASSERT_NEAR(expectedFloat[i], halfToFloat(dst[i]), 1e-3f) << "Mismatch at position i = " << i << " level " << simdLevelName(static_cast<SimdLevel>(level));
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(pixel, transposeMatchesFloat) {
+	const unsigned int height = 75U;
+	const unsigned int width = 41U;
+	const unsigned int numChannels = 2U;
+
+	std::vector<float> src(height * width * numChannels);
+	std::vector<std::uint16_t> src16(src.size());
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>(i);
+		src16[i] = static_cast<std::uint16_t>(i);
+	}
+
+	std::vector<float> expectedDst(src.size());
+	std::vector<std::uint16_t> dst16(src.size());
+	ASSERT_TRUE(transposePlanarScalar(src, height, width, numChannels, expectedDst));
+	ASSERT_TRUE(transposePlanar(src16, height, width, numChannels, dst16));
+
+	for (auto i = 0U; i < src.size(); i++) {
+		ASSERT_EQ(expectedDst[i], static_cast<float>(dst16[i])) << "Mismatch at position i = " << i;
+	}
+}
+
+/**
+ * Pads an image by \p pad pixels on every side the way \p border reads outside the image, independently of borderSourceIndex
+ */
+template <typename PixelT>
+static std::vector<PixelT> padImage(const std::vector<PixelT>& src, ImageLayout layout, unsigned int height, unsigned int width, unsigned int numChannels, unsigned int pad, BorderMode border, PixelT borderValue) {
+	const unsigned int paddedHeight = height + 2 * pad;
+	const unsigned int paddedWidth = width + 2 * pad;
+
+	const auto index = [layout, numChannels](unsigned int h, unsigned int w, unsigned int row, unsigned int col, unsigned int ch) {
+		return layout == ImageLayout::Planar ? (ch * h + row) * w + col : (row * w + col) * numChannels + ch;
+	};
+
+	// returns false for a constant border pixel
+	const auto source = [border](int pos, unsigned int length, unsigned int& sourcePos) {
+		const int n = static_cast<int>(length);
+		if (border == BorderMode::Constant) {
+			sourcePos = static_cast<unsigned int>(pos);
+			return (pos >= 0) && (pos < n);
+		}
+
+		if (border == BorderMode::Clamp) {
+			pos = pos < 0 ? 0 : (pos >= n ? n - 1 : pos);
+		}
+		else if (border == BorderMode::Wrap) {
+			pos = ((pos % n) + n) % n;
+		}
+		else {
+			while ((n > 1) && ((pos < 0) || (pos >= n))) {
+				pos = pos < 0 ? -pos : 2 * (n - 1) - pos;
+			}
+			pos = n > 1 ? pos : 0;
+		}
+
+		sourcePos = static_cast<unsigned int>(pos);
+		return true;
+	};
+
+	std::vector<PixelT> padded(paddedHeight * paddedWidth * numChannels);
+	for (auto ch = 0U; ch < numChannels; ch++) {
+		for (auto row = 0U; row < paddedHeight; row++) {
+			for (auto col = 0U; col < paddedWidth; col++) {
+				unsigned int srcRow = 0;
+				unsigned int srcCol = 0;
+				const bool rowInside = source(static_cast<int>(row) - static_cast<int>(pad), height, srcRow);
+				const bool colInside = source(static_cast<int>(col) - static_cast<int>(pad), width, srcCol);
+				padded[index(paddedHeight, paddedWidth, row, col, ch)] = rowInside && colInside ? src[index(height, width, srcRow, srcCol, ch)] : borderValue;
+			}
+		}
+	}
+
+	return padded;
+}
+
+TEST(border, matchesPaddedImage) {
+	const std::array<float, 3> kernel3{ { 0.2f, 0.5f, 0.3f } };
+	const std::array<float, 7> kernel7{ { 0.05f, 0.1f, 0.2f, 0.3f, 0.2f, 0.1f, 0.05f } };
+	const std::array<BorderMode, 4> borders{ { BorderMode::Clamp, BorderMode::Mirror, BorderMode::Wrap, BorderMode::Constant } };
+	const float borderValue = 2.5f;
+
+	const unsigned int height = planar3channelHeight;
+	const unsigned int width = planar3channelWidth;
+	const unsigned int numChannels = planar3channelChannels;
+
+	for (const BorderMode border : borders) {
+		// 7 taps on a 5x5 image, so the 7-tap windows reach past both ends of every row and column at once
+		for (const unsigned int pad : { 1U, 3U }) {
+			const auto convolve = [&](const auto& kernel, ImageLayout layout, bool horizontal, const std::vector<float>& image, unsigned int h, unsigned int w, unsigned int ch, std::vector<float>& result, bool withBorder) {
+				if (layout == ImageLayout::Planar) {
+					if (horizontal) {
+						return withBorder ? convolve1DHorizontalPlanarBordered(kernel, image, h, w, numChannels, ch, result, border, borderValue) : convolve1DHorizontalPlanar(kernel, image, h, w, numChannels, ch, result);
+					}
+					return withBorder ? convolve1DVerticalPlanarBordered(kernel, image, h, w, numChannels, ch, result, border, borderValue) : convolve1DVerticalPlanar(kernel, image, h, w, numChannels, ch, result);
+				}
+
+				if (horizontal) {
+					return withBorder ? convolve1DHorizontalInterleavedBordered(kernel, image, h, w, numChannels, ch, result, border, borderValue) : convolve1DHorizontalInterleaved(kernel, image, h, w, numChannels, ch, result);
+				}
+				return withBorder ? convolve1DVerticalInterleavedBordered(kernel, image, h, w, numChannels, ch, result, border, borderValue) : convolve1DVerticalInterleaved(kernel, image, h, w, numChannels, ch, result);
+			};
+			const auto convolveBoth = [&](ImageLayout layout, bool horizontal, const std::vector<float>& image, unsigned int h, unsigned int w, unsigned int ch, std::vector<float>& result, bool withBorder) {
+				return pad == 1 ? convolve(kernel3, layout, horizontal, image, h, w, ch, result, withBorder) : convolve(kernel7, layout, horizontal, image, h, w, ch, result, withBorder);
+			};
+
+			for (const ImageLayout layout : { ImageLayout::Planar, ImageLayout::Interleaved }) {
+				const std::vector<float> padded = padImage(planar3channel, layout, height, width, numChannels, pad, border, borderValue);
+				const unsigned int paddedHeight = height + 2 * pad;
+				const unsigned int paddedWidth = width + 2 * pad;
+
+				for (const bool horizontal : { true, false }) {
+					for (auto ch = 0U; ch < numChannels; ch++) {
+						std::vector<float> dst(planar3channel.size(), 0.0f);
+						std::vector<float> paddedDst(padded.size(), 0.0f);
+						ASSERT_TRUE(convolveBoth(layout, horizontal, planar3channel, height, width, ch, dst, true));
+						ASSERT_TRUE(convolveBoth(layout, horizontal, padded, paddedHeight, paddedWidth, ch, paddedDst, false));
+
+						for (auto row = 0U; row < height; row++) {
+							for (auto col = 0U; col < width; col++) {
+								const unsigned int i = layout == ImageLayout::Planar ? (ch * height + row) * width + col : (row * width + col) * numChannels + ch;
+								const unsigned int paddedI = layout == ImageLayout::Planar ? (ch * paddedHeight + row + pad) * paddedWidth + col + pad : ((row + pad) * paddedWidth + col + pad) * numChannels + ch;
+								ASSERT_EQ(paddedDst[paddedI], dst[i]) << "Mismatch at row " << row << " col " << col << " channel " << ch << " border " << static_cast<int>(border) << " pad " << pad << (horizontal ? " horizontal" : " vertical");
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(border, constantValueForIntegerPixels) {
+	const std::array<float, 3> kernel{ { 0.25f, 0.5f, 0.25f } };
+	const std::vector<std::uint8_t> src{ 100, 100, 100, 100 };
+	std::vector<std::uint8_t> dst(src.size(), 0);
+
+	ASSERT_TRUE(convolve1DHorizontalPlanarBordered(kernel, src, 1, 4, 1, 0, dst, BorderMode::Constant, 200));
+
+	const std::vector<std::uint8_t> expectedDst{ 125, 100, 100, 125 };
+	ASSERT_EQ(expectedDst, dst);
+}
+
+TEST(layout, conversionMatchesNaive) {
+	// a width that isn't a multiple of 4 runs the tails of the shuffle kernels, and 1, 5 and 6 channels the generic kernel
+	const unsigned int height = 5U;
+	const unsigned int width = 23U;
+
+	for (auto numChannels = 1U; numChannels <= 6U; numChannels++) {
+		std::vector<float> interleaved(height * width * numChannels);
+		for (auto i = 0U; i < interleaved.size(); i++) {
+			interleaved[i] = static_cast<float>(i);
+		}
+
+		std::vector<float> expectedPlanar(interleaved.size());
+		for (auto row = 0U; row < height; row++) {
+			for (auto col = 0U; col < width; col++) {
+				for (auto ch = 0U; ch < numChannels; ch++) {
+					expectedPlanar[(ch * height + row) * width + col] = interleaved[(row * width + col) * numChannels + ch];
+				}
+			}
+		}
+
+		for (auto level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(detectSimdLevel()); level++) {
+			std::vector<float> planar(interleaved.size(), -1.0f);
+			std::vector<float> roundTrip(interleaved.size(), -1.0f);
+			ASSERT_TRUE(interleavedToPlanar(interleaved, height, width, numChannels, planar, static_cast<SimdLevel>(level)));
+			ASSERT_TRUE(planarToInterleaved(planar, height, width, numChannels, roundTrip, static_cast<SimdLevel>(level)));
+
+			ASSERT_EQ(expectedPlanar, planar) << numChannels << " channels, level " << simdLevelName(static_cast<SimdLevel>(level));
+			ASSERT_EQ(interleaved, roundTrip) << numChannels << " channels, level " << simdLevelName(static_cast<SimdLevel>(level));
+		}
+	}
+}
+
+TEST(layout, paddedAndParallelMatchDense) {
+	const unsigned int height = 67U;
+	const unsigned int width = 29U;
+	const unsigned int numChannels = 3U;
+	const SimdLevel level = getSimdLevel();
+
+	std::vector<float> interleaved(height * width * numChannels);
+	for (auto i = 0U; i < interleaved.size(); i++) {
+		interleaved[i] = static_cast<float>((i * 41U) % 103U);
+	}
+
+	std::vector<float> expectedPlanar(interleaved.size(), 0.0f);
+	ASSERT_TRUE(interleavedToPlanar(interleaved, height, width, numChannels, expectedPlanar, level));
+
+	// padded rows and planes
+	AlignedImage paddedInterleaved(height, width, numChannels, ImageLayout::Interleaved);
+	AlignedImage paddedPlanar(height, width, numChannels, ImageLayout::Planar);
+	ASSERT_TRUE(copyImage(makeImageView(interleaved, ImageLayout::Interleaved, height, width, numChannels), paddedInterleaved.view()));
+	ASSERT_TRUE(interleavedToPlanar(paddedInterleaved.view(), paddedPlanar.view(), level));
+
+	std::vector<float> planar(interleaved.size(), 0.0f);
+	ASSERT_TRUE(copyImage(paddedPlanar.view(), makeImageView(planar, ImageLayout::Planar, height, width, numChannels)));
+	ASSERT_EQ(expectedPlanar, planar);
+
+	ASSERT_TRUE(planarToInterleaved(paddedPlanar.view(), paddedInterleaved.view(), level));
+	std::vector<float> roundTrip(interleaved.size(), 0.0f);
+	ASSERT_TRUE(copyImage(paddedInterleaved.view(), makeImageView(roundTrip, ImageLayout::Interleaved, height, width, numChannels)));
+	ASSERT_EQ(interleaved, roundTrip);
+
+	// row bands on a pool
+	ThreadPool pool(8);
+	std::vector<float> parallelPlanar(interleaved.size(), 0.0f);
+	std::vector<float> parallelRoundTrip(interleaved.size(), 0.0f);
+	ASSERT_TRUE(interleavedToPlanarParallel(interleaved, height, width, numChannels, parallelPlanar, pool, level));
+	ASSERT_TRUE(planarToInterleavedParallel(parallelPlanar, height, width, numChannels, parallelRoundTrip, pool, level));
+	ASSERT_EQ(expectedPlanar, parallelPlanar);
+	ASSERT_EQ(interleaved, parallelRoundTrip);
+
+	// the views must be in the layouts the conversion goes between
+	ASSERT_FALSE(interleavedToPlanar(paddedPlanar.view(), paddedInterleaved.view(), level));
+	ASSERT_FALSE(planarToInterleaved(paddedPlanar.view(), paddedPlanar.view(), level));
+}
+
+/**
+ * Writes \p image to a raw file at \p path, as convolve2DSeparableMapped reads it
+ */
+static bool writeRawFile(const std::string& path, const std::vector<float>& image) {
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size() * sizeof(float)));
+	return static_cast<bool>(file);
+}
+
+/**
+ * Reads \p count floats from the raw file at \p path, or returns an empty vector if the file is shorter
+ */
+static std::vector<float> readRawFile(const std::string& path, std::size_t count) {
+	std::vector<float> image(count);
+	std::ifstream file(path, std::ios::binary);
+	file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(count * sizeof(float)));
+	return file ? image : std::vector<float>();
+}
+
+TEST(mapped, stripsMatchInMemory) {
+	const unsigned int height = 53U;
+	const unsigned int width = 31U;
+	const unsigned int numChannels = 3U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const SimdLevel level = getSimdLevel();
+
+	std::vector<float> src(height * width * numChannels);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<float>((i * 41U) % 103U) / 10.0f;
+	}
+
+	const std::string inputPath = ::testing::TempDir() + "mapped_input.raw";
+	const std::string outputPath = ::testing::TempDir() + "mapped_output.raw";
+	ASSERT_TRUE(writeRawFile(inputPath, src));
+
+	const ImageLayout layouts[] = { ImageLayout::Planar, ImageLayout::Interleaved };
+	for (const ImageLayout layout : layouts) {
+		std::vector<float> expectedDst(src.size(), 0.0f);
+		for (auto ch = 0U; ch < numChannels; ch++) {
+			ASSERT_TRUE(convolve2DSeparable(kernel.data(), 5, kernel.data(), 5, layout, src, height, width, numChannels, ch, expectedDst, level));
+		}
+
+		// strips of 1 row (every output row needs the halo of 2 neighbouring strips), a few rows, and the whole image
+		const std::size_t budgets[] = { 0, 4096, 16384, defaultMappedResidentBytes };
+		for (const std::size_t budget : budgets) {
+			ASSERT_TRUE(convolve2DSeparableMapped(kernel.data(), 5, kernel.data(), 5, layout, inputPath, height, width, numChannels, outputPath, budget, level));
+			ASSERT_EQ(expectedDst, readRawFile(outputPath, src.size())) << "budget " << budget;
+		}
+	}
+
+	ASSERT_EQ(1U, mappedStripRows(ImageLayout::Interleaved, height, width, numChannels, 5, 0));
+	ASSERT_EQ(height, mappedStripRows(ImageLayout::Interleaved, height, width, numChannels, 5, defaultMappedResidentBytes));
+
+	// the input file must hold the whole image
+	ASSERT_FALSE(convolve2DSeparableMapped(kernel.data(), 5, kernel.data(), 5, ImageLayout::Planar, inputPath, height + 1, width, numChannels, outputPath, 0, level));
+	ASSERT_FALSE(convolve2DSeparableMapped(kernel.data(), 5, kernel.data(), 5, ImageLayout::Planar, inputPath + ".missing", height, width, numChannels, outputPath, 0, level));
+
+	std::remove(inputPath.c_str());
+	std::remove(outputPath.c_str());
+}
+
+TEST(large, sizeChecksDontWrap) {
+	// 65536 x 65536 is 2^32 pixels, which wraps to 0 in 32 bits and would pass the size checks of any small image
+	const unsigned int height = 65536U;
+	const unsigned int width = 65536U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const SimdLevel level = getSimdLevel();
+
+	std::vector<float> image(64, 1.0f);
+	std::vector<float> result(image.size(), 0.0f);
+
+	ASSERT_FALSE(convolve1DHorizontalPlanar(kernel, image, height, width, 1, 0, result));
+	ASSERT_FALSE(convolve1DVerticalPlanar(kernel, image, height, width, 1, 0, result));
+	ASSERT_FALSE(convolve1DHorizontalInterleaved(kernel, image, height, width, 1, 0, result));
+	ASSERT_FALSE(convolve1DVerticalInterleaved(kernel, image, height, width, 1, 0, result));
+	ASSERT_FALSE((convolve1DHorizontalPlanarUnrolled<5, true>(kernel, image, height, width, 1, 0, result)));
+	ASSERT_FALSE(convolve1DHorizontal(kernel.data(), 5, ImageLayout::Planar, image, height, width, 1, 0, result, level));
+	ASSERT_FALSE(convolve2DSeparable(kernel.data(), 5, kernel.data(), 5, ImageLayout::Interleaved, image, height, width, 1, 0, result, level));
+	ASSERT_FALSE(convolve2D(kernel.data(), 1, ImageLayout::Planar, image, height, width, 1, 0, result, level));
+	ASSERT_FALSE(transposePlanarScalar(image, height, width, 1, result));
+	ASSERT_FALSE(transposePlanarTiled(image, height, width, 1, result, level));
+	ASSERT_FALSE(interleavedToPlanar(image, height, width, 1, result, level));
+
+	// the planes of a 2^32-pixel planar image are 2^32 floats apart
+	const ImageView view = makeImageView(image, ImageLayout::Planar, height, width, 2);
+	ASSERT_EQ(static_cast<std::size_t>(height) * width, view.channelPitch);
+	ASSERT_TRUE(isValidImageView(view));
+}
+
+
+TEST(large, viewsPast4GiElements) {
+	// images of more than 2^32 floats (over 16 GiB) in sparse files.  Only a band of rows near the end is touched, so the
+	// files take a few MiB of disk, but the band's channel and row offsets don't fit in 32 bits.
+	const unsigned int height = 40000U;
+	const unsigned int bandBegin = height - 40U;
+	const unsigned int bandRows = 32U;
+	const unsigned int halo = 2U;
+	const unsigned int denseHeight = bandRows + 2 * halo;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::vector<float> kernel2D(25, 0.04f);
+	const SimdLevel level = getSimdLevel();
+
+	const std::string inputPath = ::testing::TempDir() + "large_input.raw";
+	const std::string outputPath = ::testing::TempDir() + "large_output.raw";
+
+	const std::pair<ImageLayout, unsigned int> shapes[] = { { ImageLayout::Planar, 2U }, { ImageLayout::Interleaved, 4U } };
+	for (const auto& shape : shapes) {
+		const ImageLayout layout = shape.first;
+		const unsigned int numChannels = shape.second;
+		const unsigned int width = 131072U / numChannels;
+		const unsigned int channelIndex = numChannels - 1;
+		const std::uint64_t bytes = static_cast<std::uint64_t>(height) * width * numChannels * sizeof(float);
+		ASSERT_GT(bytes, std::uint64_t(16) << 30);
+
+		MappedFile input;
+		MappedFile output;
+		ASSERT_TRUE(input.create(inputPath, bytes));
+		ASSERT_TRUE(output.create(outputPath, bytes));
+
+		{
+			const MappedRegion inputRegion = input.map(0, static_cast<std::size_t>(bytes));
+			const MappedRegion outputRegion = output.map(0, static_cast<std::size_t>(bytes));
+			ASSERT_TRUE(inputRegion.valid());
+			ASSERT_TRUE(outputRegion.valid());
+
+			const unsigned int rowPitch = layout == ImageLayout::Planar ? width : width * numChannels;
+			const std::size_t channelPitch = layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1;
+			const MutableImageView image{ inputRegion.data<float>(), height, width, numChannels, rowPitch, channelPitch, layout };
+			const MutableImageView result{ outputRegion.data<float>(), height, width, numChannels, rowPitch, channelPitch, layout };
+
+			// the band and its halo, which are also convolved as a dense image
+			std::vector<float> dense(static_cast<std::size_t>(denseHeight) * width * numChannels);
+			for (std::size_t i = 0; i < dense.size(); i++) {
+				dense[i] = static_cast<float>((i * 41U) % 103U) / 10.0f;
+			}
+			ASSERT_TRUE(copyImage(makeImageView(dense, layout, denseHeight, width, numChannels), image.crop(bandBegin - halo, 0, denseHeight, width)));
+
+			std::vector<float> expectedDst(dense.size(), 0.0f);
+			std::vector<float> actualDst(dense.size(), 0.0f);
+			ASSERT_TRUE(convolve2DSeparableRows(kernel.data(), 5, kernel.data(), 5, layout, dense, denseHeight, width, numChannels, channelIndex, halo, halo + bandRows, expectedDst, level));
+			ASSERT_TRUE(convolve2DSeparableRows(kernel.data(), 5, kernel.data(), 5, image, channelIndex, bandBegin, bandBegin + bandRows, result, level));
+			ASSERT_TRUE(copyImage(result.crop(bandBegin - halo, 0, denseHeight, width), makeImageView(actualDst, layout, denseHeight, width, numChannels)));
+			ASSERT_EQ(expectedDst, actualDst);
+
+			std::fill(expectedDst.begin(), expectedDst.end(), 0.0f);
+			ASSERT_TRUE(convolve2DRows(kernel2D.data(), 5, layout, dense, denseHeight, width, numChannels, channelIndex, halo, halo + bandRows, expectedDst, level));
+			ASSERT_TRUE(convolve2DRows(kernel2D.data(), 5, image, channelIndex, bandBegin, bandBegin + bandRows, result, level));
+			ASSERT_TRUE(copyImage(result.crop(bandBegin - halo, 0, denseHeight, width), makeImageView(actualDst, layout, denseHeight, width, numChannels)));
+			ASSERT_EQ(expectedDst, actualDst);
+
+			if (layout == ImageLayout::Planar) {
+				// a square of the band, transposed into the last rows of the result
+				const unsigned int size = bandRows;
+				std::vector<float> square(static_cast<std::size_t>(size) * size * numChannels);
+				std::vector<float> expectedSquare(square.size());
+				std::vector<float> actualSquare(square.size());
+				ASSERT_TRUE(copyImage(image.crop(bandBegin, width - size, size, size), makeImageView(square, layout, size, size, numChannels)));
+				ASSERT_TRUE(transposePlanarScalar(square, size, size, numChannels, expectedSquare));
+				ASSERT_TRUE(transposePlanarTiled(image.crop(bandBegin, width - size, size, size), result.crop(height - size, 0, size, size), level));
+				ASSERT_TRUE(copyImage(result.crop(height - size, 0, size, size), makeImageView(actualSquare, layout, size, size, numChannels)));
+				ASSERT_EQ(expectedSquare, actualSquare);
+			}
+		}
+
+		input.close();
+		output.close();
+		std::remove(inputPath.c_str());
+		std::remove(outputPath.c_str());
+	}
+}
+
+
+TEST(large, fftColumnsPast4GiElements) {
+	// a strip of columns of images with rows of 2^26 floats, in sparse files.  The FFT blocks of the vertical pass are at
+	// least 128 points long, so from point 64 of a block on, the offset of a point in the strip doesn't fit in 32 bits.
+	const unsigned int height = 136U;
+	const unsigned int stripWidth = 32U;
+	const std::vector<float> kernel(15, 1.0f / 15.0f);
+	const SimdLevel level = getSimdLevel();
+
+	const std::string inputPath = ::testing::TempDir() + "large_fft_input.raw";
+	const std::string outputPath = ::testing::TempDir() + "large_fft_output.raw";
+
+	const std::pair<ImageLayout, unsigned int> shapes[] = { { ImageLayout::Planar, 1U }, { ImageLayout::Interleaved, 4U } };
+	for (const auto& shape : shapes) {
+		const ImageLayout layout = shape.first;
+		const unsigned int numChannels = shape.second;
+		const unsigned int width = (1U << 26) / numChannels;
+		const unsigned int channelIndex = numChannels - 1;
+		const std::uint64_t bytes = static_cast<std::uint64_t>(height) * width * numChannels * sizeof(float);
+
+		MappedFile input;
+		MappedFile output;
+		ASSERT_TRUE(input.create(inputPath, bytes));
+		ASSERT_TRUE(output.create(outputPath, bytes));
+
+		{
+			const MappedRegion inputRegion = input.map(0, static_cast<std::size_t>(bytes));
+			const MappedRegion outputRegion = output.map(0, static_cast<std::size_t>(bytes));
+			ASSERT_TRUE(inputRegion.valid());
+			ASSERT_TRUE(outputRegion.valid());
+
+			const MutableImageView image{ inputRegion.data<float>(), height, width, numChannels, width * numChannels, layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1, layout };
+			const MutableImageView result{ outputRegion.data<float>(), height, width, numChannels, width * numChannels, layout == ImageLayout::Planar ? static_cast<std::size_t>(height) * width : 1, layout };
+
+			// the strip, which is also convolved as a dense image
+			std::vector<float> dense(static_cast<std::size_t>(height) * stripWidth * numChannels);
+			for (std::size_t i = 0; i < dense.size(); i++) {
+				dense[i] = static_cast<float>((i * 41U) % 103U) / 10.0f;
+			}
+			ASSERT_TRUE(copyImage(makeImageView(dense, layout, height, stripWidth, numChannels), image.crop(0, width - stripWidth, height, stripWidth)));
+
+			std::vector<float> expectedDst(dense.size(), 0.0f);
+			std::vector<float> actualDst(dense.size(), 0.0f);
+			ASSERT_TRUE(convolve1DVerticalFft(kernel.data(), 15, layout, dense, height, stripWidth, numChannels, channelIndex, expectedDst, level));
+			ASSERT_TRUE(convolve1DVerticalFft(kernel.data(), 15, image.crop(0, width - stripWidth, height, stripWidth), channelIndex, result.crop(0, width - stripWidth, height, stripWidth), level));
+			ASSERT_TRUE(copyImage(result.crop(0, width - stripWidth, height, stripWidth), makeImageView(actualDst, layout, height, stripWidth, numChannels)));
+			ASSERT_EQ(expectedDst, actualDst);
+		}
+
+		input.close();
+		output.close();
+		std::remove(inputPath.c_str());
+		std::remove(outputPath.c_str());
+	}
+}
+
+
+TEST(pipeline, framesMatchSynchronousPasses) {
+	const unsigned int height = 37U;
+	const unsigned int width = 45U;
+	const unsigned int numChannels = 3U;
+	const unsigned int numFrames = 9U;
+	const std::array<float, 5> horizontalKernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const std::array<float, 3> verticalKernel{ { 0.25f, 0.5f, 0.25f } };
+	const SimdLevel level = getSimdLevel();
+	const std::size_t frameSize = height * width * numChannels;
+
+	// every frame of the synthetic stream differs, so a frame stored under the wrong index is caught
+	const auto makeFrame = [frameSize](unsigned int frameIndex) {
+		std::vector<float> frame(frameSize);
+		for (auto i = 0U; i < frameSize; i++) {
+			frame[i] = static_cast<float>((i * 37U + frameIndex * 11U) % 101U) / 10.0f;
+		}
+		return frame;
+	};
+
+	std::vector<std::vector<float>> expected(numFrames);
+	for (auto frameIndex = 0U; frameIndex < numFrames; frameIndex++) {
+		std::vector<float> planar(frameSize);
+		std::vector<float> intermediate(frameSize, 0.0f);
+		expected[frameIndex].assign(frameSize, 0.0f);
+		ASSERT_TRUE(interleavedToPlanar(makeFrame(frameIndex), height, width, numChannels, planar, level));
+		for (auto ch = 0U; ch < numChannels; ch++) {
+			ASSERT_TRUE(convolve1DHorizontal(horizontalKernel.data(), 5, ImageLayout::Planar, planar, height, width, numChannels, ch, intermediate, level));
+			ASSERT_TRUE(convolve1DVertical(verticalKernel.data(), 3, ImageLayout::Planar, intermediate, height, width, numChannels, ch, expected[frameIndex], level));
+		}
+	}
+
+	const frameSourceFn source = [&](unsigned int frameIndex, const MutableImageView& frame) {
+		const std::vector<float> pixels = makeFrame(frameIndex);
+		return copyImage(makeImageView(pixels, ImageLayout::Interleaved, height, width, numChannels), frame);
+	};
+
+	std::vector<unsigned int> storedIndices;
+	std::vector<std::vector<float>> stored;
+	const frameSinkFn sink = [&](unsigned int frameIndex, const ImageView& result) {
+		storedIndices.push_back(frameIndex);
+		stored.emplace_back(frameSize);
+		return copyImage(result, makeImageView(stored.back(), ImageLayout::Planar, height, width, numChannels));
+	};
+
+	std::vector<unsigned int> inOrder(numFrames);
+	for (auto frameIndex = 0U; frameIndex < numFrames; frameIndex++) {
+		inOrder[frameIndex] = frameIndex;
+	}
+
+	// one slot (no overlap), double buffering, and the default of one slot per stage
+	const unsigned int slotCounts[] = { 1, 2, 0 };
+	for (const unsigned int numSlots : slotCounts) {
+		FramePipeline pipeline(horizontalKernel.data(), 5, verticalKernel.data(), 3, height, width, numChannels, numSlots, level);
+		ASSERT_EQ(numSlots > 0 ? numSlots : numFrameStages, pipeline.slots());
+
+		for (const bool pipelined : { true, false }) {
+			storedIndices.clear();
+			stored.clear();
+
+			tFramePipelineStats stats;
+			ASSERT_TRUE(pipelined ? pipeline.run(numFrames, source, sink, stats) : pipeline.runSequential(numFrames, source, sink, stats));
+			ASSERT_EQ(inOrder, storedIndices) << "slots " << numSlots;
+			ASSERT_EQ(expected, stored) << "slots " << numSlots;
+
+			ASSERT_EQ(numFrames, stats.numFrames);
+			ASSERT_GT(stats.framesPerSecond, 0.0);
+			for (const tFrameTiming& stage : stats.stages) {
+				ASSERT_LE(stage.meanSeconds, stage.maxSeconds);
+				ASSERT_LE(stage.maxSeconds, stats.latency.maxSeconds);
+			}
+			ASSERT_LE(stats.latency.maxSeconds, stats.wallSeconds);
+		}
+	}
+
+	// a failing sink stops the run, and the frames after it are not stored.  At most a slot per stage more is loaded.
+	FramePipeline pipeline(horizontalKernel.data(), 5, verticalKernel.data(), 3, height, width, numChannels, 0, level);
+	std::atomic<unsigned int> loaded(0);
+	const frameSourceFn countingSource = [&](unsigned int frameIndex, const MutableImageView& frame) {
+		loaded++;
+		return source(frameIndex, frame);
+	};
+	const frameSinkFn failingSink = [&](unsigned int frameIndex, const ImageView& result) {
+		return (frameIndex != 3) && sink(frameIndex, result);
+	};
+
+	storedIndices.clear();
+	stored.clear();
+	tFramePipelineStats stats;
+	ASSERT_FALSE(pipeline.run(4 * numFrames, countingSource, failingSink, stats));
+	ASSERT_EQ(std::vector<unsigned int>({ 0, 1, 2 }), storedIndices);
+	ASSERT_LE(loaded.load(), 4 + numFrameStages + 1);
+
+	// even kernels and empty frames are rejected
+	FramePipeline evenKernel(horizontalKernel.data(), 4, verticalKernel.data(), 3, height, width, numChannels, 0, level);
+	ASSERT_FALSE(evenKernel.run(numFrames, source, sink, stats));
+	FramePipeline emptyFrames(horizontalKernel.data(), 5, verticalKernel.data(), 3, 0, width, numChannels, 0, level);
+	ASSERT_FALSE(emptyFrames.runSequential(numFrames, source, sink, stats));
+}
+
+TEST(planner, strategiesMatchReference) {
+	const unsigned int height = 41U;
+	const unsigned int width = 37U;
+	const unsigned int numChannels = 3U;
+	const std::array<float, 5> kernel{ { 0.1f, 0.2f, 0.4f, 0.2f, 0.1f } };
+	const SimdLevel level = getSimdLevel();
+	const ConvolutionStrategy strategies[] = { ConvolutionStrategy::Interleaved, ConvolutionStrategy::Planar, ConvolutionStrategy::PlanarTranspose, ConvolutionStrategy::Fused };
+
+	std::vector<float> planar(height * width * numChannels);
+	for (auto i = 0U; i < planar.size(); i++) {
+		planar[i] = static_cast<float>((i * 41U) % 103U);
+	}
+
+	std::vector<float> interleaved(planar.size());
+	ASSERT_TRUE(planarToInterleaved(planar, height, width, numChannels, interleaved, level));
+
+	// both passes of the reference leave the edges at 0
+	std::vector<float> intermediate(planar.size(), 0.0f);
+	std::vector<float> expectedPlanar(planar.size(), 0.0f);
+	for (auto ch = 0U; ch < numChannels; ch++) {
+		ASSERT_TRUE(convolve1DHorizontalPlanar(kernel, planar, height, width, numChannels, ch, intermediate));
+		ASSERT_TRUE(convolve1DVerticalPlanar(kernel, intermediate, height, width, numChannels, ch, expectedPlanar));
+	}
+
+	std::vector<float> expectedInterleaved(planar.size());
+	ASSERT_TRUE(planarToInterleaved(expectedPlanar, height, width, numChannels, expectedInterleaved, level));
+
+	ThreadPool pool(3);
+	ThreadPool* pools[] = { nullptr, &pool };
+
+	for (const ConvolutionStrategy strategy : strategies) {
+		for (ThreadPool* strategyPool : pools) {
+			// the result starts out with garbage, which must not survive along the edges
+			std::vector<float> planarDst(planar.size(), -1.0f);
+			std::vector<float> interleavedDst(planar.size(), -1.0f);
+			ASSERT_TRUE(convolve2DWithStrategy(strategy, kernel.data(), 5, ImageLayout::Planar, planar, height, width, numChannels, planarDst, strategyPool, level));
+			ASSERT_TRUE(convolve2DWithStrategy(strategy, kernel.data(), 5, ImageLayout::Interleaved, interleaved, height, width, numChannels, interleavedDst, strategyPool, level));
+
+			for (auto i = 0U; i < planar.size(); i++) {
+				ASSERT_NEAR(expectedPlanar[i], planarDst[i], 1e-3f) << convolutionStrategyName(strategy) << " planar, mismatch at position i = " << i;
+				ASSERT_NEAR(expectedInterleaved[i], interleavedDst[i], 1e-3f) << convolutionStrategyName(strategy) << " interleaved, mismatch at position i = " << i;
+			}
+		}
+	}
+
+	// the integer strategies round the intermediate image the same way, so they agree exactly
+	std::vector<std::uint8_t> planar8(planar.size());
+	for (auto i = 0U; i < planar.size(); i++) {
+		planar8[i] = pixelTraits<std::uint8_t>::store(planar[i]);
+	}
+
+	std::vector<std::uint8_t> expected8(planar.size(), 1);
+	ASSERT_TRUE(convolve2DWithStrategy(ConvolutionStrategy::Planar, kernel.data(), 5, ImageLayout::Planar, planar8, height, width, numChannels, expected8, nullptr, level));
+	for (auto i = 0U; i < planar.size(); i++) {
+		ASSERT_NEAR(expectedPlanar[i], expected8[i], 1.0f) << "Mismatch at position i = " << i;
+	}
+
+	for (const ConvolutionStrategy strategy : { ConvolutionStrategy::Interleaved, ConvolutionStrategy::PlanarTranspose }) {
+		std::vector<std::uint8_t> dst8(planar.size(), 1);
+		ASSERT_TRUE(convolve2DWithStrategy(strategy, kernel.data(), 5, ImageLayout::Planar, planar8, height, width, numChannels, dst8, nullptr, level));
+		ASSERT_EQ(expected8, dst8) << convolutionStrategyName(strategy);
+	}
+
+	std::vector<std::uint8_t> dst8(planar.size(), 1);
+	ASSERT_FALSE(convolve2DWithStrategy(ConvolutionStrategy::Fused, kernel.data(), 5, ImageLayout::Planar, planar8, height, width, numChannels, dst8, nullptr, level));
+	ASSERT_FALSE(convolve2DWithStrategy(ConvolutionStrategy::Planar, kernel.data(), 4, ImageLayout::Planar, planar, height, width, numChannels, expectedPlanar, nullptr, level));
+}
+
+TEST(planner, decisionsPersistAcrossPlanners) {
+	const std::string cachePath = ::testing::TempDir() + "planner_cache.txt";
+	{
+		// a decision of another machine sharing the file, and a line that isn't a decision
+		std::ofstream file(cachePath);
+		file << "Other CPU\tplanar\tfloat32\t10\t10\t1\t3\t1\tfused\n";
+		file << "not a decision\n";
+	}
+
+	const tPlanKey floatKey{ ImageLayout::Interleaved, 32U, 48U, 3U, 5U, PixelType::Float32, 1U };
+	const tPlanKey pinnedKey{ ImageLayout::Planar, 16U, 16U, 1U, 3U, PixelType::UInt8, 1U };
+
+	ConvolutionStrategy tuned;
+	{
+		ConvolutionPlanner planner(cachePath);
+		ASSERT_FALSE(planner.findStrategy(floatKey, tuned));
+		ASSERT_TRUE(planner.plan<float>(floatKey.layout, floatKey.height, floatKey.width, floatKey.numChannels, floatKey.kernelSize, nullptr, tuned));
+		ASSERT_FALSE(planner.plan<float>(floatKey.layout, floatKey.height, floatKey.width, floatKey.numChannels, 4U, nullptr, tuned));
+	}
+
+	{
+		// a new planner (as in a new process) finds the decision without tuning
+		ConvolutionPlanner planner(cachePath);
+		ConvolutionStrategy found;
+		ASSERT_TRUE(planner.findStrategy(floatKey, found));
+		ASSERT_EQ(tuned, found);
+
+		ASSERT_TRUE(planner.setStrategy(pinnedKey, ConvolutionStrategy::PlanarTranspose));
+	}
+
+	ConvolutionPlanner planner(cachePath);
+	ConvolutionStrategy pinned;
+	ASSERT_TRUE(planner.findStrategy(pinnedKey, pinned));
+	ASSERT_EQ(ConvolutionStrategy::PlanarTranspose, pinned);
+
+	// the planned convolution uses the pinned strategy
+	const std::array<float, 3> kernel{ { 0.25f, 0.5f, 0.25f } };
+	std::vector<std::uint8_t> src(16 * 16);
+	for (auto i = 0U; i < src.size(); i++) {
+		src[i] = static_cast<std::uint8_t>((i * 41U) % 103U);
+	}
+
+	std::vector<std::uint8_t> expectedDst(src.size(), 0);
+	std::vector<std::uint8_t> dst(src.size(), 0);
+	ASSERT_TRUE(convolve2DWithStrategy(ConvolutionStrategy::PlanarTranspose, kernel.data(), 3, ImageLayout::Planar, src, 16, 16, 1, expectedDst, nullptr, getSimdLevel()));
+	ASSERT_TRUE(planner.convolve(kernel.data(), 3, ImageLayout::Planar, src, 16, 16, 1, dst, nullptr));
+	ASSERT_EQ(expectedDst, dst);
+
+	std::ifstream file(cachePath);
+	const std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	ASSERT_NE(std::string::npos, contents.find("Other CPU\tplanar\tfloat32\t10\t10\t1\t3\t1\tfused\n"));
+	ASSERT_NE(std::string::npos, contents.find(planner.cpuModel() + "\tinterleaved\tfloat32\t32\t48\t3\t5\t1\t" + convolutionStrategyName(tuned) + "\n"));
+	ASSERT_EQ(std::string::npos, contents.find("not a decision"));
+
+	file.close();
+	std::remove(cachePath.c_str());
+}
+
+
+TEST(planner, concurrentPlannersKeepEachOthersDecisions) {
+	const std::string cachePath = ::testing::TempDir() + "planner_shared_cache.txt";
+	std::remove(cachePath.c_str());
+
+	const tPlanKey firstKey{ ImageLayout::Planar, 16U, 16U, 1U, 3U, PixelType::Float32, 1U };
+	const tPlanKey secondKey{ ImageLayout::Interleaved, 16U, 16U, 3U, 3U, PixelType::Float32, 1U };
+	const tPlanKey sharedKey{ ImageLayout::Planar, 32U, 32U, 1U, 5U, PixelType::UInt8, 1U };
+
+	// both planners load the empty cache, as two processes started at the same time would
+	ConvolutionPlanner first(cachePath);
+	ConvolutionPlanner second(cachePath);
+
+	ASSERT_TRUE(first.setStrategy(firstKey, ConvolutionStrategy::Fused));
+	ASSERT_TRUE(first.setStrategy(sharedKey, ConvolutionStrategy::Planar));
+	ASSERT_TRUE(second.setStrategy(secondKey, ConvolutionStrategy::Interleaved));
+	ASSERT_TRUE(second.setStrategy(sharedKey, ConvolutionStrategy::PlanarTranspose));
+
+	// the second planner's rewrites kept the first one's decision, and its own decision for the shared key won
+	ConvolutionPlanner reloaded(cachePath);
+	ConvolutionStrategy strategy;
+	ASSERT_TRUE(reloaded.findStrategy(firstKey, strategy));
+	ASSERT_EQ(ConvolutionStrategy::Fused, strategy);
+	ASSERT_TRUE(reloaded.findStrategy(secondKey, strategy));
+	ASSERT_EQ(ConvolutionStrategy::Interleaved, strategy);
+	ASSERT_TRUE(reloaded.findStrategy(sharedKey, strategy));
+	ASSERT_EQ(ConvolutionStrategy::PlanarTranspose, strategy);
+
+	std::remove(cachePath.c_str());
+}
+
+TEST(benchmark, sampleStats) {
+	const tSampleStats odd = computeSampleStats({ 3.0, 1.0, 4.0, 1.0, 5.0 });
+	ASSERT_EQ(1.0, odd.min);
+	ASSERT_EQ(3.0, odd.median);
+	ASSERT_EQ(5.0, odd.p95);
+	ASSERT_DOUBLE_EQ(2.8, odd.mean);
+	ASSERT_DOUBLE_EQ(std::sqrt(3.2), odd.stddev);
+
+	// the median of an even count is the mean of the middle two
+	const tSampleStats even = computeSampleStats({ 4.0, 1.0, 3.0, 2.0 });
+	ASSERT_EQ(1.0, even.min);
+	ASSERT_EQ(2.5, even.median);
+	ASSERT_EQ(4.0, even.p95);
+
+	const tSampleStats single = computeSampleStats({ 0.5 });
+	ASSERT_EQ(0.5, single.median);
+	ASSERT_EQ(0.0, single.stddev);
+}
+
+TEST(benchmark, sweepRunsEveryPoint) {
+	// a threaded case that supports kernel size 3 but not 5
+	static unsigned int numCalls = 0;
+	static const BenchmarkRegistration registration(tBenchmarkCase{ "sweepTestCase", ImageLayout::Planar, true,
+		[](const tBenchmarkParams& params, tBenchmarkImages& images) {
+			numCalls++;
+			return (params.kernelSize == 3) && (images.pool != nullptr) && (images.src(ImageLayout::Planar).size() == static_cast<std::size_t>(params.height) * params.width * params.numChannels);
+		},
+		[](const tBenchmarkParams& params) {
+			return tBenchmarkWork{ static_cast<double>(params.height) * params.width * params.numChannels * 8.0, 1.0 };
+		} });
+
+	tBenchmarkConfig config;
+	config.heights = { 4, 8 };
+	config.widths = { 5 };
+	config.channels = { 1, 2 };
+	config.kernelSizes = { 3, 5 };
+	config.threads = { 1, 2 };
+	config.cases = { "sweepTestCase" };
+	config.warmup = 2;
+	config.iterations = 3;
+
+	numCalls = 0;
+	std::ostringstream log;
+	const std::vector<tBenchmarkResult> results = runBenchmarks(config, log);
+
+	// 4 points of kernel size 3 on 2 thread counts, each run warmup + iterations times, and the points of kernel size 5
+	// stop at their first warm-up call
+	ASSERT_EQ(8U, results.size());
+	ASSERT_EQ(8U * 5U + 8U, numCalls);
+	ASSERT_NE(std::string::npos, log.str().find("skipping planar/sweepTestCase at kernel size 5"));
+
+	unsigned int index = 0;
+	for (const unsigned int height : config.heights) {
+		for (const unsigned int numChannels : config.channels) {
+			for (const unsigned int threads : config.threads) {
+				const tBenchmarkResult& result = results[index++];
+				ASSERT_EQ("sweepTestCase", result.name);
+				ASSERT_EQ(height, result.params.height);
+				ASSERT_EQ(numChannels, result.params.numChannels);
+				ASSERT_EQ(3U, result.params.kernelSize);
+				ASSERT_EQ(threads, result.params.threads);
+				ASSERT_EQ(3U, result.iterations);
+				ASSERT_LE(result.stats.min, result.stats.median);
+				ASSERT_LE(result.stats.median, result.stats.p95);
+				ASSERT_GE(result.stats.stddev, 0.0);
+				ASSERT_GT(result.gbPerSecond, 0.0);
+			}
+		}
+	}
+}